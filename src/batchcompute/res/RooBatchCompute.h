@@ -58,8 +58,15 @@ public:
    void setCudaStream(CudaInterface::CudaStream *cudaStream) { _cudaStream = cudaStream; }
    CudaInterface::CudaStream *cudaStream() const { return _cudaStream; }
 
+   /// Whether the compute functions may do their arithmetic in single
+   /// precision. Inputs and outputs are always double arrays, and the
+   /// reductions are always done in double precision.
+   bool useSinglePrecision() const { return _useSinglePrecision; }
+   void setUseSinglePrecision(bool flag) { _useSinglePrecision = flag; }
+
 private:
    CudaInterface::CudaStream *_cudaStream = nullptr;
+   bool _useSinglePrecision = false;
 };
 
 enum class Architecture {
@@ -177,6 +184,9 @@ public:
 
    virtual Architecture architecture() const = 0;
    virtual std::string architectureName() const = 0;
+   /// Whether any compute function has a single precision implementation,
+   /// see Config::useSinglePrecision().
+   virtual bool hasSinglePrecisionFunctions() const = 0;
 
    virtual std::unique_ptr<AbsBufferManager> createBufferManager() const = 0;
 
@@ -209,6 +219,11 @@ inline std::string cpuArchitectureName()
    return dispatchCPU->architectureName();
 }
 
+inline bool cpuHasSinglePrecisionFunctions()
+{
+   return dispatchCPU->hasSinglePrecisionFunctions();
+}
+
 inline void compute(Config cfg, Computer comp, std::span<double> output, VarSpan vars, ArgSpan extraArgs = {})
 {
    auto dispatch = cfg.useCuda() ? dispatchCUDA : dispatchCPU;
@@ -916,48 +916,58 @@ __rooglobal__ void computeVoigtian(Batches &batches)
    }
 }
 
+#ifndef __CUDACC__
+void replaceWithSIMDFunctions(std::vector<void (*)(Batches &)> &functions);
+#endif
+
 /// Returns a std::vector of pointers to the compute functions in this file.
+/// On the CPU, the functions that have an explicitly vectorized implementation
+/// for the architecture of this library are replaced with these.
 std::vector<void (*)(Batches &)> getFunctions()
 {
-   return {computeAddPdf,
-           computeArgusBG,
-           computeBMixDecay,
-           computeBernstein,
-           computeBifurGauss,
-           computeBreitWigner,
-           computeBukin,
-           computeCBShape,
-           computeChebychev,
-           computeChiSquare,
-           computeDeltaFunction,
-           computeDstD0BG,
-           computeExpPoly,
-           computeExponential,
-           computeExponentialNeg,
-           computeGamma,
-           computeGaussModelExpBasis,
-           computeGaussian,
-           computeIdentity,
-           computeJohnson,
-           computeLandau,
-           computeLognormal,
-           computeLognormalStandard,
-           computeNegativeLogarithms,
-           computeNormalizedPdf,
-           computeNovosibirsk,
-           computePoisson,
-           computePolynomial,
-           computePower,
-           computeProdPdf,
-           computeRatio,
-           computeTruthModelExpBasis,
-           computeTruthModelSinBasis,
-           computeTruthModelCosBasis,
-           computeTruthModelLinBasis,
-           computeTruthModelQuadBasis,
-           computeTruthModelSinhBasis,
-           computeTruthModelCoshBasis,
-           computeVoigtian};
+   std::vector<void (*)(Batches &)> functions{computeAddPdf,
+                                              computeArgusBG,
+                                              computeBMixDecay,
+                                              computeBernstein,
+                                              computeBifurGauss,
+                                              computeBreitWigner,
+                                              computeBukin,
+                                              computeCBShape,
+                                              computeChebychev,
+                                              computeChiSquare,
+                                              computeDeltaFunction,
+                                              computeDstD0BG,
+                                              computeExpPoly,
+                                              computeExponential,
+                                              computeExponentialNeg,
+                                              computeGamma,
+                                              computeGaussModelExpBasis,
+                                              computeGaussian,
+                                              computeIdentity,
+                                              computeJohnson,
+                                              computeLandau,
+                                              computeLognormal,
+                                              computeLognormalStandard,
+                                              computeNegativeLogarithms,
+                                              computeNormalizedPdf,
+                                              computeNovosibirsk,
+                                              computePoisson,
+                                              computePolynomial,
+                                              computePower,
+                                              computeProdPdf,
+                                              computeRatio,
+                                              computeTruthModelExpBasis,
+                                              computeTruthModelSinBasis,
+                                              computeTruthModelCosBasis,
+                                              computeTruthModelLinBasis,
+                                              computeTruthModelQuadBasis,
+                                              computeTruthModelSinhBasis,
+                                              computeTruthModelCoshBasis,
+                                              computeVoigtian};
+#ifndef __CUDACC__
+   replaceWithSIMDFunctions(functions);
+#endif
+   return functions;
 }
 } // End namespace RF_ARCH
 } // End namespace RooBatchCompute
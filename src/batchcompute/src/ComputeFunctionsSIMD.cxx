@@ -0,0 +1,421 @@
+/*
+ * Project: RooFit
+ *
+ * Copyright (c) 2024, CERN
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted according to the terms
+ * listed in LICENSE (http://roofit.sourceforge.net/license.txt)
+ */
+
+/**
+\file ComputeFunctionsSIMD.cxx
+
+Explicitly vectorized versions of some of the compute functions in
+ComputeFunctions.cxx, for the AVX2 and AVX-512 builds of the library. These
+are functions where the auto-vectorization of the original loops is prevented
+by calls to transcendental functions or by branches. The kernels are written
+once as generic lambdas that are called both with SIMD vectors and with
+scalars for the remaining events, using the primitives from RooSIMD.h.
+
+The kernels are instantiated for double and single precision vectors. The
+single precision versions are used if the evaluation in single precision is
+requested in the RooBatchCompute::Config, which doubles the number of events
+that are processed per instruction. Only the arithmetic is done in single
+precision, the inputs and outputs are still double arrays. Events for which
+the exponential would underflow or overflow in single precision, like events
+in the far tails of a Gaussian, are evaluated again in double precision.
+
+For all other architectures, the original compute functions are used.
+**/
+
+#include "RooBatchCompute.h"
+#include "RooSIMD.h"
+#include "Batches.h"
+
+#include <TMath.h>
+
+#include <cmath>
+#include <complex>
+#include <type_traits>
+#include <vector>
+
+namespace RooBatchCompute {
+namespace RF_ARCH {
+
+#ifdef ROOBATCHCOMPUTE_EXPLICIT_SIMD
+
+namespace {
+
+/// Call the kernel for all events, with full SIMD vectors as long as possible
+/// and with scalars for the remaining events. The first argument of the
+/// kernel is a tag to tell the type. The kernel returns false if its result
+/// can't be represented in single precision, for example in the far tails of
+/// a distribution, in which case these events are evaluated again in double
+/// precision.
+template <class Vec_t, class Kernel>
+inline void forEachEvent(std::size_t nEvents, Kernel &&kernel)
+{
+   using Scalar_t = typename Simd::Scalar<Vec_t>::type;
+   std::size_t i = 0;
+   for (; i + Vec_t::size <= nEvents; i += Vec_t::size) {
+      if (!kernel(Vec_t{Scalar_t(0)}, i)) {
+         // The single precision vectors are always twice as long as the
+         // double precision vectors.
+         for (std::size_t j = i; j < i + Vec_t::size; j += Simd::Vec::size) {
+            kernel(Simd::Vec{0.0}, j);
+         }
+      }
+   }
+   for (; i < nEvents; ++i) {
+      if (!kernel(Scalar_t(0), i)) {
+         kernel(0.0, i);
+      }
+   }
+}
+
+/// Store the exponential of x, and return whether it was in the range of the
+/// precision of V.
+template <class V>
+inline bool storeExp(double *output, V x)
+{
+   Simd::store(output, Simd::exp(x));
+   return !Simd::expOutOfFloatRange(x);
+}
+
+/// Number of events that a kernel processes at once with the type V.
+template <class V>
+constexpr std::size_t nLanes()
+{
+   if constexpr (std::is_floating_point<V>::value) {
+      return 1;
+   } else {
+      return V::size;
+   }
+}
+
+template <class V>
+inline V load(Batch const &batch, std::size_t i)
+{
+   return Simd::load<V>(batch._array + i);
+}
+
+template <class Vec_t>
+void computeBernstein(Batches &batches)
+{
+   const int nCoef = batches.nExtra - 2;
+   const int degree = nCoef - 1;
+   const double xmin = batches.extra[nCoef];
+   const double xmax = batches.extra[nCoef + 1];
+   Batch xData = batches.args[0];
+
+   // apply binomial coefficient in-place so we don't have to allocate new memory
+   double binomial = 1.0;
+   for (int k = 0; k < nCoef; k++) {
+      batches.extra[k] = batches.extra[k] * binomial;
+      binomial = (binomial * (degree - k)) / (k + 1);
+   }
+
+   forEachEvent<Vec_t>(batches.nEvents, [&](auto tag, std::size_t i) {
+      using V = decltype(tag);
+      const V X = (load<V>(xData, i) - V(xmin)) / V(xmax - xmin);
+      const V oneMinusX = V(1.0) - X;
+
+      // raising 1-x to the power of degree
+      V powOneMinusX = V(1.0);
+      for (int k = 2; k <= degree; k += 2)
+         powOneMinusX = powOneMinusX * (oneMinusX * oneMinusX);
+      if (degree % 2 == 1)
+         powOneMinusX = powOneMinusX * oneMinusX;
+
+      const V invOneMinusX = V(1.0) / oneMinusX;
+      V powX = V(1.0);
+      V out = V(0.0);
+      for (int k = 0; k < nCoef; k++) {
+         out = out + V(batches.extra[k]) * powX * powOneMinusX;
+         powX = powX * X;
+         powOneMinusX = powOneMinusX * invOneMinusX;
+      }
+      Simd::store(batches.output + i, out);
+      return true;
+   });
+
+   // reset extraArgs values so we don't mutate the Batches object
+   binomial = 1.0;
+   for (int k = 0; k < nCoef; k++) {
+      batches.extra[k] = batches.extra[k] / binomial;
+      binomial = (binomial * (degree - k)) / (k + 1);
+   }
+}
+
+template <class Vec_t>
+void computeCBShape(Batches &batches)
+{
+   Batch M = batches.args[0];
+   Batch M0 = batches.args[1];
+   Batch S = batches.args[2];
+   Batch A = batches.args[3];
+   Batch N = batches.args[4];
+   forEachEvent<Vec_t>(batches.nEvents, [&](auto tag, std::size_t i) {
+      using V = decltype(tag);
+      const V a = load<V>(A, i);
+      const V n = load<V>(N, i);
+      const V t = (load<V>(M, i) - load<V>(M0, i)) / load<V>(S, i);
+      const auto inCore = ((a > V(0.0)) & (t >= -a)) | ((a < V(0.0)) & (-t >= a));
+      // The logarithm is evaluated for all events, but only used in the tail.
+      const V tail = n * Simd::log(n / (n - a * a - a * t)) - V(0.5) * a * a;
+      return storeExp(batches.output + i, Simd::select(inCore, V(-0.5) * t * t, tail));
+   });
+}
+
+template <class Vec_t>
+void computeExponential(Batches &batches)
+{
+   Batch x = batches.args[0];
+   Batch c = batches.args[1];
+   forEachEvent<Vec_t>(batches.nEvents, [&](auto tag, std::size_t i) {
+      using V = decltype(tag);
+      return storeExp(batches.output + i, load<V>(x, i) * load<V>(c, i));
+   });
+}
+
+template <class Vec_t>
+void computeExponentialNeg(Batches &batches)
+{
+   Batch x = batches.args[0];
+   Batch c = batches.args[1];
+   forEachEvent<Vec_t>(batches.nEvents, [&](auto tag, std::size_t i) {
+      using V = decltype(tag);
+      return storeExp(batches.output + i, -load<V>(x, i) * load<V>(c, i));
+   });
+}
+
+/// Real part of RooHeterogeneousMath::evalCerf() for a purely imaginary
+/// argument, i.e. exp(-u^2) w(i(u + c)) = exp(c(c + 2u)) erfc(u + c).
+template <class V>
+inline V evalCerfImaginary(V u, V c)
+{
+   const V z = u + c;
+   // For z >= 1, exp(c (c + 2u)) erfc(z) = exp(-u^2) exp(z^2) erfc(z) is
+   // evaluated with the scaled erfc, which doesn't overflow or underflow.
+   const V viaErfc = Simd::select(z >= V(1.0), Simd::expMinusXSquared(u) * Simd::erfcxLargeArg(z),
+                                  Simd::exp(c * (c + V(2.0) * u)) * Simd::erfc(z));
+   // Approximation that cancels the divergence of exp(z^2) for large negative z
+   const V zsq = z * z;
+   const V approx = V(2.0) * (Simd::exp(zsq - u * u) *
+                              (V(1.0) - Simd::exp(-zsq) / (z * V(1.772453850905516027298167483341))));
+   return Simd::select(z > V(-4.0), viaErfc, approx);
+}
+
+template <class Vec_t>
+void computeGaussModelExpBasis(Batches &batches)
+{
+   const double root2 = std::sqrt(2.);
+   const double root2pi = std::sqrt(2. * std::atan2(0., -1.));
+
+   const bool isMinus = batches.extra[0] < 0.0;
+   const bool isPlus = batches.extra[0] > 0.0;
+
+   forEachEvent<Vec_t>(batches.nEvents, [&](auto tag, std::size_t i) {
+      using V = decltype(tag);
+      const V x = load<V>(batches.args[0], i);
+      const V mean = load<V>(batches.args[1], i) * load<V>(batches.args[2], i);
+      const V sigma = load<V>(batches.args[3], i) * load<V>(batches.args[4], i);
+      const V tau = load<V>(batches.args[5], i);
+
+      // Straight Gaussian, used for unconvoluted PDF or expBasis with 0 lifetime
+      const V xGauss = (x - mean) / sigma;
+      V gauss = Simd::exp(V(-0.5) * xGauss * xGauss) / (sigma * V(root2pi));
+      if (!isMinus && !isPlus)
+         gauss = gauss * V(2.0);
+
+      // Convolution with exp(-t/tau)
+      const V xprime = (x - mean) / tau;
+      const V c = sigma / (V(root2) * tau);
+      const V u = xprime / (V(2.0) * c);
+      V convolution = V(0.0);
+      if (!isMinus)
+         convolution = convolution + evalCerfImaginary(-u, c);
+      if (!isPlus)
+         convolution = convolution + evalCerfImaginary(u, c);
+
+      Simd::store(batches.output + i, Simd::select(tau == V(0.0), gauss, convolution));
+      return true;
+   });
+}
+
+template <class Vec_t>
+void computeGaussian(Batches &batches)
+{
+   Batch x = batches.args[0];
+   Batch mean = batches.args[1];
+   Batch sigma = batches.args[2];
+   forEachEvent<Vec_t>(batches.nEvents, [&](auto tag, std::size_t i) {
+      using V = decltype(tag);
+      const V arg = load<V>(x, i) - load<V>(mean, i);
+      const V sig = load<V>(sigma, i);
+      const V halfBySigmaSq = V(-0.5) / (sig * sig);
+      return storeExp(batches.output + i, arg * arg * halfBySigmaSq);
+   });
+}
+
+template <class Vec_t>
+void computeJohnson(Batches &batches)
+{
+   Batch mass = batches.args[0];
+   Batch mu = batches.args[1];
+   Batch lambda = batches.args[2];
+   Batch gamma = batches.args[3];
+   Batch delta = batches.args[4];
+   const double sqrtTwoPi = std::sqrt(TMath::TwoPi());
+   const double massThreshold = batches.extra[0];
+
+   forEachEvent<Vec_t>(batches.nEvents, [&](auto tag, std::size_t i) {
+      using V = decltype(tag);
+      const V m = load<V>(mass, i);
+      const V lam = load<V>(lambda, i);
+      const V del = load<V>(delta, i);
+      const V arg = (m - load<V>(mu, i)) / lam;
+      const V sqrtArgSqPlusOne = Simd::sqrt(arg * arg + V(1.0));
+      // asinh(x) = sign(x) * log(|x| + sqrt(x^2 + 1)), which avoids the
+      // cancellation for negative arguments
+      const V absArg = Simd::abs(arg);
+      const V absAsinh = Simd::log(absArg + sqrtArgSqPlusOne);
+      const V asinhArg = Simd::select(arg < V(0.0), -absAsinh, absAsinh);
+      const V expo = load<V>(gamma, i) + del * asinhArg;
+      const V expArg = V(-0.5) * expo * expo;
+      const V result = del * Simd::exp(expArg) / (sqrtArgSqPlusOne * V(sqrtTwoPi) * lam);
+      Simd::store(batches.output + i, Simd::select(m >= V(massThreshold), result, V(0.0)));
+      return !Simd::expOutOfFloatRange(expArg);
+   });
+}
+
+template <class Vec_t>
+void computePoisson(Batches &batches)
+{
+   Batch x = batches.args[0];
+   Batch mean = batches.args[1];
+   bool protectNegative = batches.extra[0];
+   bool noRounding = batches.extra[1];
+
+   // There is no vectorized lgamma, so it is computed in a separate scalar loop.
+   for (std::size_t i = 0; i < batches.nEvents; ++i) {
+      const double x_i = noRounding ? x[i] : std::floor(x[i]);
+      batches.output[i] = std::lgamma(x_i + 1.);
+   }
+
+   forEachEvent<Vec_t>(batches.nEvents, [&](auto tag, std::size_t i) {
+      using V = decltype(tag);
+      const V xRaw = load<V>(x, i);
+      const V x_i = noRounding ? xRaw : Simd::floor(xRaw);
+      const V mu = load<V>(mean, i);
+      const V logPoisson = x_i * Simd::log(mu) - mu - Simd::load<V>(batches.output + i);
+      V out = Simd::exp(logPoisson);
+
+      // Cosmetics
+      out = Simd::select(x_i == V(0.0), V(1.0) / Simd::exp(mu), out);
+      out = Simd::select(x_i < V(0.0), V(0.0), out);
+      if (protectNegative)
+         out = Simd::select(mu < V(0.0), V(1.E-3), out);
+
+      Simd::store(batches.output + i, out);
+      return true;
+   });
+}
+
+template <class Vec_t>
+void computeVoigtian(Batches &batches)
+{
+   Batch X = batches.args[0];
+   Batch M = batches.args[1];
+   Batch W = batches.args[2];
+   Batch S = batches.args[3];
+   const double invSqrt2 = 0.707106781186547524400844362105;
+
+   forEachEvent<Vec_t>(batches.nEvents, [&](auto tag, std::size_t i) {
+      using V = decltype(tag);
+      const V w = load<V>(W, i);
+      const V s = load<V>(S, i);
+      const V dx = load<V>(X, i) - load<V>(M, i);
+      const V arg = dx * dx;
+
+      // Limits of a pure Gaussian or Breit-Wigner
+      V out = Simd::select(s == V(0.0), V(1.0) / (arg + V(0.25) * w * w), Simd::exp(V(-0.5) * arg / (s * s)));
+      out = Simd::select((s == V(0.0)) & (w == V(0.0)), V(1.0), out);
+
+      const auto isVoigt = (s != V(0.0)) & (w != V(0.0));
+      if (!Simd::any(isVoigt)) {
+         Simd::store(batches.output + i, out);
+         return true;
+      }
+
+      // The width enters only through its absolute value, so Im(z) >= 0.
+      const V c = Simd::abs(V(invSqrt2) / s);
+      const V zre = c * dx;
+      const V zim = V(0.5) * c * Simd::abs(w);
+      Simd::store(batches.output + i, Simd::select(isVoigt, c * Simd::faddeevaRealUpper(zre, zim), out));
+
+      if (Simd::any(isVoigt & Simd::faddeevaNearRealAxis(zim))) {
+         // Very close to the real axis, the Faddeeva function has to be
+         // evaluated with the scalar implementation.
+         for (std::size_t j = i; j < i + nLanes<V>(); ++j) {
+            const double cj = std::abs(invSqrt2 / S[j]);
+            const double zimj = 0.5 * cj * std::abs(W[j]);
+            if (S[j] != 0.0 && W[j] != 0.0 && Simd::faddeevaNearRealAxis(zimj)) {
+               const std::complex<double> z(cj * (X[j] - M[j]), zimj);
+               batches.output[j] = cj * RooHeterogeneousMath::faddeeva(z).real();
+            }
+         }
+      }
+      return true;
+   });
+}
+
+} // namespace
+
+#endif // ROOBATCHCOMPUTE_EXPLICIT_SIMD
+
+std::vector<void (*)(Batches &)> getFunctions();
+
+/// Replace the compute functions for which there is an explicitly vectorized
+/// version in the function table returned by getFunctions(). Does nothing if
+/// the library is not compiled for an architecture with explicit SIMD support.
+void replaceWithSIMDFunctions(std::vector<void (*)(Batches &)> &functions)
+{
+#ifdef ROOBATCHCOMPUTE_EXPLICIT_SIMD
+   functions[Bernstein] = computeBernstein<Simd::Vec>;
+   functions[CBShape] = computeCBShape<Simd::Vec>;
+   functions[Exponential] = computeExponential<Simd::Vec>;
+   functions[ExponentialNeg] = computeExponentialNeg<Simd::Vec>;
+   functions[Gaussian] = computeGaussian<Simd::Vec>;
+   functions[GaussModelExpBasis] = computeGaussModelExpBasis<Simd::Vec>;
+   functions[Johnson] = computeJohnson<Simd::Vec>;
+   functions[Poisson] = computePoisson<Simd::Vec>;
+   functions[Voigtian] = computeVoigtian<Simd::Vec>;
+#else
+   (void)functions;
+#endif
+}
+
+/// Returns the compute functions for the evaluation in single precision. The
+/// functions without a single precision implementation are the same as in
+/// getFunctions(). The Poisson distribution is always evaluated in double
+/// precision, because the subtraction of the log-gamma function suffers from
+/// catastrophic cancellation for large counts. The functions that need erfc()
+/// or the Faddeeva function are also only implemented in double precision.
+std::vector<void (*)(Batches &)> getSinglePrecisionFunctions()
+{
+   std::vector<void (*)(Batches &)> functions = getFunctions();
+#ifdef ROOBATCHCOMPUTE_EXPLICIT_SIMD
+   functions[Bernstein] = computeBernstein<Simd::VecF>;
+   functions[CBShape] = computeCBShape<Simd::VecF>;
+   functions[Exponential] = computeExponential<Simd::VecF>;
+   functions[ExponentialNeg] = computeExponentialNeg<Simd::VecF>;
+   functions[Gaussian] = computeGaussian<Simd::VecF>;
+   functions[Johnson] = computeJohnson<Simd::VecF>;
+#endif
+   return functions;
+}
+
+} // End namespace RF_ARCH
+} // End namespace RooBatchCompute
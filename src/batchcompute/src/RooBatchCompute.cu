@@ -97,6 +97,7 @@ public:
 
    Architecture architecture() const override { return Architecture::CUDA; }
    std::string architectureName() const override { return "cuda"; }
+   bool hasSinglePrecisionFunctions() const override { return false; }
 
    /** Compute multiple values using cuda kernels.
    This method creates a Batches object and passes it to the correct compute function.
@@ -20,6 +20,7 @@ This file contains the code for cpu computations using the RooBatchCompute libra
 
 #include "RooBatchCompute.h"
 #include "RooNaNPacker.h"
+#include "RooSIMD.h"
 #include "Batches.h"
 
 #include <ROOT/RConfig.hxx>
@@ -77,12 +78,14 @@ inline void advance(Batches &batches, std::size_t nEvents)
 } // namespace
 
 std::vector<void (*)(Batches &)> getFunctions();
+std::vector<void (*)(Batches &)> getSinglePrecisionFunctions();
 
 /// This class overrides some RooBatchComputeInterface functions, for the
 /// purpose of providing a CPU specific implementation of the library.
 class RooBatchComputeClass : public RooBatchComputeInterface {
 public:
-   RooBatchComputeClass() : _computeFunctions(getFunctions())
+   RooBatchComputeClass()
+      : _computeFunctions(getFunctions()), _computeFunctionsSinglePrecision(getSinglePrecisionFunctions())
    {
       // Set the dispatch pointer to this instance of the library upon loading
       dispatchCPU = this;
@@ -96,6 +99,10 @@ public:
       std::transform(out.begin(), out.end(), out.begin(), [](unsigned char c) { return std::tolower(c); });
       return out;
    };
+   bool hasSinglePrecisionFunctions() const override
+   {
+      return _computeFunctionsSinglePrecision != _computeFunctions;
+   }
 
    void compute(Config const &, Computer computer, std::span<double> output, VarSpan vars, ArgSpan extraArgs) override;
    double reduceSum(Config const &, InputArr input, size_t n) override;
@@ -119,57 +126,104 @@ public:
    bool cudaStreamIsActive(CudaInterface::CudaStream *) const override { throw std::bad_function_call(); }
 
 private:
+   using ComputeFunction = void (*)(Batches &);
+
+   void computeRange(ComputeFunction function, std::span<double> output, VarSpan vars, ArgSpan extraArgs,
+                     std::size_t begin, std::size_t end) const;
 #ifdef ROOBATCHCOMPUTE_USE_IMT
-   void computeIMT(Computer computer, std::span<double> output, VarSpan vars, ArgSpan extraArgs);
+   void computeIMT(ComputeFunction function, std::span<double> output, VarSpan vars, ArgSpan extraArgs);
 #endif
 
-   const std::vector<void (*)(Batches &)> _computeFunctions;
+   const std::vector<ComputeFunction> _computeFunctions;
+   const std::vector<ComputeFunction> _computeFunctionsSinglePrecision;
 };
 
-#ifdef ROOBATCHCOMPUTE_USE_IMT
-void RooBatchComputeClass::computeIMT(Computer computer, std::span<double> output, VarSpan vars, ArgSpan extraArgs)
+namespace {
+
+/// Minimal number of events for which the evaluation of a given compute
+/// function is split over several threads. Below this threshold, the cost of
+/// scheduling the tasks is not amortized. The functions are grouped by their
+/// cost per event: trivial arithmetic is memory-bandwidth bound and only
+/// profits from threading for large arrays, while functions that call erf,
+/// lgamma or the Faddeeva function already profit for medium sized arrays.
+std::size_t minEventsForIMT(Computer computer)
 {
-   std::size_t nEvents = output.size();
+   switch (computer) {
+   case AddPdf:
+   case DeltaFunction:
+   case Identity:
+   case NegativeLogarithms:
+   case NormalizedPdf:
+   case ProdPdf:
+   case Ratio: return 1 << 18;
+   case Bukin:
+   case CBShape:
+   case ChiSquare:
+   case DstD0BG:
+   case Gamma:
+   case GaussModelExpBasis:
+   case Johnson:
+   case Landau:
+   case Novosibirsk:
+   case Poisson:
+   case Voigtian: return 1 << 13;
+   default: return 1 << 16;
+   }
+}
 
-   if (nEvents == 0)
-      return;
-   ROOT::Internal::TExecutor ex;
-   std::size_t nThreads = ex.GetPoolSize();
+/// Number of events in the blocks that are reduced independently in
+/// reduceNLL(). This number must not depend on the number of threads, such
+/// that the result is bit-wise identical no matter how many threads are used.
+constexpr std::size_t nllBlockSize = 1 << 16;
 
-   std::size_t nEventsPerThread = nEvents / nThreads + (nEvents % nThreads > 0);
+} // namespace
 
-   // Reset the number of threads to the number we actually need given nEventsPerThread
-   nThreads = nEvents / nEventsPerThread + (nEvents % nEventsPerThread > 0);
+/// Evaluate the events in the range [begin, end) in chunks of bufferSize.
+void RooBatchComputeClass::computeRange(ComputeFunction function, std::span<double> output, VarSpan vars,
+                                        ArgSpan extraArgs, std::size_t begin, std::size_t end) const
+{
+   Batches batches;
+   std::vector<Batch> arrays(vars.size());
+   fillBatches(batches, output.data(), output.size(), vars.size(), extraArgs);
+   fillArrays(arrays, vars, output.size());
+   batches.args = arrays.data();
+   advance(batches, begin);
 
-   auto task = [&](std::size_t idx) -> int {
-      // Fill a std::vector<Batches> with the same object and with ~nEvents/nThreads
-      // Then advance every object but the first to split the work between threads
-      Batches batches;
-      std::vector<Batch> arrays(vars.size());
-      fillBatches(batches, output.data(), nEventsPerThread, vars.size(), extraArgs);
-      fillArrays(arrays, vars, nEvents);
-      batches.args = arrays.data();
-      advance(batches, batches.nEvents * idx);
-
-      // Set the number of events of the last Batches object as the remaining events
-      if (idx == nThreads - 1) {
-         batches.nEvents = nEvents - idx * batches.nEvents;
-      }
+   std::size_t events = end - begin;
+   batches.nEvents = bufferSize;
+   while (events > bufferSize) {
+      function(batches);
+      advance(batches, bufferSize);
+      events -= bufferSize;
+   }
+   batches.nEvents = events;
+   function(batches);
+}
 
-      std::size_t events = batches.nEvents;
-      batches.nEvents = bufferSize;
-      while (events > bufferSize) {
-         _computeFunctions[computer](batches);
-         advance(batches, bufferSize);
-         events -= bufferSize;
-      }
-      batches.nEvents = events;
-      _computeFunctions[computer](batches);
+#ifdef ROOBATCHCOMPUTE_USE_IMT
+/// Split the events in one contiguous range per thread and evaluate the ranges
+/// in parallel. The range boundaries are multiples of bufferSize, such that
+/// every thread runs over the same full-size chunks as the serial evaluation.
+void RooBatchComputeClass::computeIMT(ComputeFunction function, std::span<double> output, VarSpan vars,
+                                      ArgSpan extraArgs)
+{
+   const std::size_t nEvents = output.size();
+   const std::size_t nChunks = nEvents / bufferSize + (nEvents % bufferSize > 0);
+
+   ROOT::Internal::TExecutor ex;
+   const std::size_t nThreads = std::min<std::size_t>(ex.GetPoolSize(), nChunks);
+   const std::size_t nChunksPerThread = nChunks / nThreads + (nChunks % nThreads > 0);
+   const std::size_t nEventsPerThread = nChunksPerThread * bufferSize;
+   const std::size_t nTasks = nEvents / nEventsPerThread + (nEvents % nEventsPerThread > 0);
+
+   auto task = [&](std::size_t idx) -> int {
+      const std::size_t begin = idx * nEventsPerThread;
+      computeRange(function, output, vars, extraArgs, begin, std::min(begin + nEventsPerThread, nEvents));
       return 0;
    };
 
-   std::vector<std::size_t> indices(nThreads);
-   for (unsigned int i = 1; i < nThreads; i++) {
+   std::vector<std::size_t> indices(nTasks);
+   for (std::size_t i = 1; i < nTasks; i++) {
       indices[i] = i;
    }
    ex.Map(task, indices);
@@ -178,67 +232,46 @@ void RooBatchComputeClass::computeIMT(Computer computer, std::span<double> outpu
 
 /** Compute multiple values using optimized functions.
 This method creates a Batches object and passes it to the correct compute function.
-In case Implicit Multithreading is enabled, the events to be processed are equally
-divided among the tasks to be generated and computed in parallel.
+In case Implicit Multithreading is enabled and the number of events is large
+enough for the given compute function, the events are divided in contiguous
+ranges that are computed in parallel.
+\param cfg The configuration. If single precision is requested, the compute
+functions that have a single precision implementation use it.
 \param computer An enum specifying the compute function to be used.
 \param output The array where the computation results are stored.
 \param vars A std::span containing pointers to the variables involved in the computation.
 \param extraArgs An optional std::span containing extra double values that may participate in the computation. **/
-void RooBatchComputeClass::compute(Config const &, Computer computer, std::span<double> output, VarSpan vars,
+void RooBatchComputeClass::compute(Config const &cfg, Computer computer, std::span<double> output, VarSpan vars,
                                    ArgSpan extraArgs)
 {
-   // In the original implementation of this library, the evaluation was done
-   // multi-threaded in implicit multi-threading was enabled in ROOT with
-   // ROOT::EnableImplicitMT().
-   //
-   // However, this multithreaded mode was not carefully validated and is
-   // therefore not production ready. One would first have to study the
-   // overhead for different numbers of cores, number of events, and model
-   // complexity. The, we should only consider implicit multithreading here if
-   // there is no performance penalty for any scenario, to not surprise the
-   // users with unexpected slowdows!
+   ComputeFunction function =
+      cfg.useSinglePrecision() ? _computeFunctionsSinglePrecision[computer] : _computeFunctions[computer];
+
+   // If implicit multi-threading is enabled in ROOT with
+   // ROOT::EnableImplicitMT(), the evaluation is split over the threads of
+   // the ROOT thread pool. To not slow down the evaluation for small arrays
+   // and cheap functions, this is only done above a threshold on the number
+   // of events that depends on the computational cost of the function.
    //
-   // Note that the priority of investigating this is not high, because RooFit
-   // R & D efforts currently go in the direction of parallelization at the
-   // level of the gradient components, or achieving single-threaded speedup
-   // with automatic differentiation. Furthermore, the single-threaded
-   // performance of the new CPU evaluation backend with the RooBatchCompute
-   // library, is generally much faster than the legacy evaluation backend
-   // already, even if the latter uses multi-threading.
+   // The results are identical to the single-threaded evaluation, because
+   // the compute functions are element-wise.
 #ifdef ROOBATCHCOMPUTE_USE_IMT
-   if (ROOT::IsImplicitMTEnabled()) {
-      computeIMT(computer, output, vars, extraArgs);
+   if (ROOT::IsImplicitMTEnabled() && output.size() >= minEventsForIMT(computer)) {
+      computeIMT(function, output, vars, extraArgs);
+      return;
    }
 #endif
 
-   std::size_t nEvents = output.size();
-
-   // Fill a std::vector<Batches> with the same object and with ~nEvents/nThreads
-   // Then advance every object but the first to split the work between threads
-   Batches batches;
-   std::vector<Batch> arrays(vars.size());
-   fillBatches(batches, output.data(), nEvents, vars.size(), extraArgs);
-   fillArrays(arrays, vars, nEvents);
-   batches.args = arrays.data();
-
-   std::size_t events = batches.nEvents;
-   batches.nEvents = bufferSize;
-   while (events > bufferSize) {
-      _computeFunctions[computer](batches);
-      advance(batches, bufferSize);
-      events -= bufferSize;
-   }
-   batches.nEvents = events;
-   _computeFunctions[computer](batches);
+   computeRange(function, output, vars, extraArgs, 0, output.size());
 }
 
 namespace {
 
-inline std::pair<double, double> getLog(double prob, ReduceNLLOutput &out)
+inline std::pair<double, double> getLog(double prob, double logProb, ReduceNLLOutput &out)
 {
    if (prob <= 0.0) {
       out.nNonPositiveValues++;
-      return {std::log(prob), -prob};
+      return {logProb, -prob};
    }
 
    if (std::isinf(prob)) {
@@ -250,7 +283,20 @@ inline std::pair<double, double> getLog(double prob, ReduceNLLOutput &out)
       return {prob, RooNaNPacker::unpackNaN(prob)};
    }
 
-   return {std::log(prob), 0.0};
+   return {logProb, 0.0};
+}
+
+/// Compute the logarithms of `n` values, using the vectorized implementation
+/// if the library is compiled for an architecture that supports it.
+inline void computeLogs(double const *input, double *output, std::size_t n)
+{
+#ifdef ROOBATCHCOMPUTE_EXPLICIT_SIMD
+   Simd::log(input, output, n);
+#else
+   for (std::size_t i = 0; i < n; ++i) {
+      output[i] = std::log(input[i]);
+   }
+#endif
 }
 
 } // namespace
@@ -260,31 +306,110 @@ double RooBatchComputeClass::reduceSum(Config const &, InputArr input, size_t n)
    return ROOT::Math::KahanSum<double, 4u>::Accumulate(input, input + n).Sum();
 }
 
-ReduceNLLOutput RooBatchComputeClass::reduceNLL(Config const &, std::span<const double> probas,
-                                                std::span<const double> weights, std::span<const double> offsetProbas)
-{
-   ReduceNLLOutput out;
-
-   double badness = 0.0;
+namespace {
 
+/// Partial result of the NLL reduction over one block of events.
+struct NLLBlockOutput {
    ROOT::Math::KahanSum<double> nllSum;
+   double badness = 0.0;
+   ReduceNLLOutput counts;
+};
 
-   for (std::size_t i = 0; i < weights.size(); ++i) {
+NLLBlockOutput reduceNLLBlock(std::span<const double> probas, std::span<const double> weights,
+                              std::span<const double> offsetProbas, std::size_t begin, std::size_t end)
+{
+   NLLBlockOutput out;
 
-      if (0. == weights[i])
-         continue;
+   // The logarithms are computed for chunks of bufferSize events in separate
+   // loops, such that they can be vectorized.
+   double logProbas[bufferSize];
+   double logOffsetProbas[bufferSize];
 
-      std::pair<double, double> logOut = getLog(probas.size() == 1 ? probas[0] : probas[i], out);
-      double term = logOut.first;
-      badness += logOut.second;
+   const bool isScalarProba = probas.size() == 1;
+   if (isScalarProba) {
+      computeLogs(probas.data(), logProbas, 1);
+   }
 
+   for (std::size_t chunkBegin = begin; chunkBegin < end; chunkBegin += bufferSize) {
+      const std::size_t chunkSize = std::min(bufferSize, end - chunkBegin);
+      if (!isScalarProba) {
+         computeLogs(probas.data() + chunkBegin, logProbas, chunkSize);
+      }
       if (!offsetProbas.empty()) {
-         term -= std::log(offsetProbas[i]);
+         computeLogs(offsetProbas.data() + chunkBegin, logOffsetProbas, chunkSize);
+      }
+
+      for (std::size_t j = 0; j < chunkSize; ++j) {
+         const std::size_t i = chunkBegin + j;
+
+         if (0. == weights[i])
+            continue;
+
+         std::pair<double, double> logOut = isScalarProba ? getLog(probas[0], logProbas[0], out.counts)
+                                                          : getLog(probas[i], logProbas[j], out.counts);
+         double term = logOut.first;
+         out.badness += logOut.second;
+
+         if (!offsetProbas.empty()) {
+            term -= logOffsetProbas[j];
+         }
+
+         term *= -weights[i];
+
+         out.nllSum.Add(term);
+      }
+   }
+
+   return out;
+}
+
+} // namespace
+
+/// Reduce the NLL with Kahan summation. The events are reduced in blocks of
+/// fixed size, which are evaluated in parallel if implicit multi-threading is
+/// enabled. The partial sums are combined in block order, which makes the
+/// result independent of the number of threads.
+ReduceNLLOutput RooBatchComputeClass::reduceNLL(Config const &, std::span<const double> probas,
+                                                std::span<const double> weights, std::span<const double> offsetProbas)
+{
+   const std::size_t nEvents = weights.size();
+   const std::size_t nBlocks = nEvents / nllBlockSize + (nEvents % nllBlockSize > 0);
+
+   auto reduceBlock = [&](std::size_t idx) {
+      const std::size_t begin = idx * nllBlockSize;
+      return reduceNLLBlock(probas, weights, offsetProbas, begin, std::min(begin + nllBlockSize, nEvents));
+   };
+
+   std::vector<NLLBlockOutput> blocks;
+#ifdef ROOBATCHCOMPUTE_USE_IMT
+   if (ROOT::IsImplicitMTEnabled() && nBlocks > 1) {
+      std::vector<std::size_t> indices(nBlocks);
+      for (std::size_t i = 1; i < nBlocks; i++) {
+         indices[i] = i;
+      }
+      ROOT::Internal::TExecutor ex;
+      blocks = ex.Map(reduceBlock, indices);
+   }
+#endif
+   if (blocks.empty()) {
+      blocks.reserve(nBlocks);
+      for (std::size_t i = 0; i < nBlocks; i++) {
+         blocks.emplace_back(reduceBlock(i));
       }
+   }
 
-      term *= -weights[i];
+   ReduceNLLOutput out;
+
+   double badness = 0.0;
+
+   ROOT::Math::KahanSum<double> nllSum;
 
-      nllSum.Add(term);
+   for (NLLBlockOutput const &block : blocks) {
+      nllSum += block.nllSum;
+      badness += block.badness;
+      out.nInfiniteValues += block.counts.nInfiniteValues;
+      out.nNonPositiveValues += block.counts.nNonPositiveValues;
+      out.nNaNValues += block.counts.nNaNValues;
    }
 
    out.nllSum = nllSum.Sum();
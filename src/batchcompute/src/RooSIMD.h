@@ -0,0 +1,1185 @@
+/*
+ * Project: RooFit
+ *
+ * Copyright (c) 2024, CERN
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted according to the terms
+ * listed in LICENSE (http://roofit.sourceforge.net/license.txt)
+ */
+
+/**
+\file RooSIMD.h
+\ingroup roofit_dev_docs_batchcompute
+
+Thin wrappers around the AVX2 and AVX-512 intrinsics, together with
+vectorized implementations of exp(), log(), sincos(), erf(), erfc() and of the
+Faddeeva function, for the explicitly vectorized compute functions. Which instruction set is used depends on the flags that
+the RooBatchCompute library for a given architecture is compiled with, so the
+usual runtime selection of the library also selects the SIMD implementation.
+
+There are vector types for double and single precision. The single precision
+vectors are loaded from and stored to double arrays, converting the values
+on the fly, such that they can be used with the usual buffers.
+
+All functions are also overloaded for plain doubles and floats, such that the
+same templated code can process the remaining events that don't fill a full
+vector. The math functions use the polynomial approximations from the Cephes
+library, in the same way for vectors and scalars, such that the result for a
+given event doesn't depend on its position in the batch. Only exp() and log()
+are also implemented in single precision.
+**/
+
+#ifndef ROOFIT_BATCHCOMPUTE_ROOSIMD_H
+#define ROOFIT_BATCHCOMPUTE_ROOSIMD_H
+
+#if !defined(__CUDACC__) && (defined(__AVX512F__) || defined(__AVX2__))
+#define ROOBATCHCOMPUTE_EXPLICIT_SIMD
+#include <immintrin.h>
+#endif
+
+#include <RooHeterogeneousMath.h>
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+#ifndef RF_ARCH
+#error "RF_ARCH should always be defined"
+#endif
+
+namespace RooBatchCompute {
+namespace RF_ARCH {
+namespace Simd {
+
+// Scalar versions of the primitives.
+
+template <class V>
+V load(double const *ptr);
+
+template <>
+inline double load<double>(double const *ptr)
+{
+   return *ptr;
+}
+
+inline void store(double *ptr, double x)
+{
+   *ptr = x;
+}
+
+inline double select(bool mask, double a, double b)
+{
+   return mask ? a : b;
+}
+
+/// Whether the mask is true for any element.
+inline bool any(bool mask)
+{
+   return mask;
+}
+
+inline double sqrt(double x)
+{
+   return std::sqrt(x);
+}
+
+inline double abs(double x)
+{
+   return std::abs(x);
+}
+
+inline double floor(double x)
+{
+   return std::floor(x);
+}
+
+/// Round to the nearest integer, with ties to even like the SIMD rounding.
+inline double round(double x)
+{
+   return std::nearbyint(x);
+}
+
+inline bool isnan(double x)
+{
+   return std::isnan(x);
+}
+
+/// Returns 2^n for an integer-valued n in [-1022, 1023].
+inline double pow2n(double n)
+{
+   return std::ldexp(1.0, static_cast<int>(n));
+}
+
+/// Splits a positive normal number into a mantissa in [0.5, 1) and the exponent.
+inline double frexp(double x, double &e)
+{
+   int iExp = 0;
+   const double m = std::frexp(x, &iExp);
+   e = iExp;
+   return m;
+}
+
+template <>
+inline float load<float>(double const *ptr)
+{
+   return static_cast<float>(*ptr);
+}
+
+inline void store(double *ptr, float x)
+{
+   *ptr = x;
+}
+
+inline float select(bool mask, float a, float b)
+{
+   return mask ? a : b;
+}
+
+inline float sqrt(float x)
+{
+   return std::sqrt(x);
+}
+
+inline float abs(float x)
+{
+   return std::abs(x);
+}
+
+inline float floor(float x)
+{
+   return std::floor(x);
+}
+
+inline float round(float x)
+{
+   return std::nearbyint(x);
+}
+
+inline bool isnan(float x)
+{
+   return std::isnan(x);
+}
+
+inline float pow2n(float n)
+{
+   return std::ldexp(1.0f, static_cast<int>(n));
+}
+
+inline float frexp(float x, float &e)
+{
+   int iExp = 0;
+   const float m = std::frexp(x, &iExp);
+   e = static_cast<float>(iExp);
+   return m;
+}
+
+/// The scalar type of the elements of a vector type.
+template <class V>
+struct Scalar {
+   using type = V;
+};
+
+#ifdef ROOBATCHCOMPUTE_EXPLICIT_SIMD
+
+#ifdef __AVX512F__
+
+struct Mask {
+   __mmask8 m;
+};
+
+struct Vec {
+   static constexpr std::size_t size = 8;
+   Vec() = default;
+   Vec(__m512d x) : v{x} {}
+   Vec(double x) : v{_mm512_set1_pd(x)} {}
+   __m512d v;
+};
+
+template <>
+inline Vec load<Vec>(double const *ptr)
+{
+   return _mm512_loadu_pd(ptr);
+}
+
+inline void store(double *ptr, Vec x)
+{
+   _mm512_storeu_pd(ptr, x.v);
+}
+
+inline Vec operator+(Vec a, Vec b)
+{
+   return _mm512_add_pd(a.v, b.v);
+}
+inline Vec operator-(Vec a, Vec b)
+{
+   return _mm512_sub_pd(a.v, b.v);
+}
+inline Vec operator*(Vec a, Vec b)
+{
+   return _mm512_mul_pd(a.v, b.v);
+}
+inline Vec operator/(Vec a, Vec b)
+{
+   return _mm512_div_pd(a.v, b.v);
+}
+inline Vec operator-(Vec a)
+{
+   return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(a.v), _mm512_set1_epi64(0x8000000000000000)));
+}
+
+inline Mask operator<(Vec a, Vec b)
+{
+   return {_mm512_cmp_pd_mask(a.v, b.v, _CMP_LT_OQ)};
+}
+inline Mask operator<=(Vec a, Vec b)
+{
+   return {_mm512_cmp_pd_mask(a.v, b.v, _CMP_LE_OQ)};
+}
+inline Mask operator>(Vec a, Vec b)
+{
+   return {_mm512_cmp_pd_mask(a.v, b.v, _CMP_GT_OQ)};
+}
+inline Mask operator>=(Vec a, Vec b)
+{
+   return {_mm512_cmp_pd_mask(a.v, b.v, _CMP_GE_OQ)};
+}
+inline Mask operator==(Vec a, Vec b)
+{
+   return {_mm512_cmp_pd_mask(a.v, b.v, _CMP_EQ_OQ)};
+}
+inline Mask operator!=(Vec a, Vec b)
+{
+   return {_mm512_cmp_pd_mask(a.v, b.v, _CMP_NEQ_UQ)};
+}
+
+inline Mask operator&(Mask a, Mask b)
+{
+   return {static_cast<__mmask8>(a.m & b.m)};
+}
+inline Mask operator|(Mask a, Mask b)
+{
+   return {static_cast<__mmask8>(a.m | b.m)};
+}
+inline Mask operator!(Mask a)
+{
+   return {static_cast<__mmask8>(~a.m)};
+}
+
+inline Vec select(Mask mask, Vec a, Vec b)
+{
+   return _mm512_mask_blend_pd(mask.m, b.v, a.v);
+}
+
+inline bool any(Mask mask)
+{
+   return mask.m != 0;
+}
+
+inline Vec sqrt(Vec x)
+{
+   return _mm512_sqrt_pd(x.v);
+}
+
+inline Vec abs(Vec x)
+{
+   return _mm512_abs_pd(x.v);
+}
+
+inline Vec floor(Vec x)
+{
+   return _mm512_roundscale_pd(x.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+}
+
+inline Vec round(Vec x)
+{
+   return _mm512_roundscale_pd(x.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
+
+inline Mask isnan(Vec x)
+{
+   return {_mm512_cmp_pd_mask(x.v, x.v, _CMP_UNORD_Q)};
+}
+
+inline Vec pow2n(Vec n)
+{
+   return _mm512_scalef_pd(_mm512_set1_pd(1.0), n.v);
+}
+
+inline Vec frexp(Vec x, Vec &e)
+{
+   e = _mm512_add_pd(_mm512_getexp_pd(x.v), _mm512_set1_pd(1.0));
+   return _mm512_getmant_pd(x.v, _MM_MANT_NORM_p5_1, _MM_MANT_SIGN_zero);
+}
+
+struct MaskF {
+   __mmask16 m;
+};
+
+struct VecF {
+   static constexpr std::size_t size = 16;
+   VecF() = default;
+   VecF(__m512 x) : v{x} {}
+   VecF(float x) : v{_mm512_set1_ps(x)} {}
+   __m512 v;
+};
+
+template <>
+inline VecF load<VecF>(double const *ptr)
+{
+   const __m256 lo = _mm512_cvtpd_ps(_mm512_loadu_pd(ptr));
+   const __m256 hi = _mm512_cvtpd_ps(_mm512_loadu_pd(ptr + 8));
+   return _mm512_castpd_ps(
+      _mm512_insertf64x4(_mm512_castpd256_pd512(_mm256_castps_pd(lo)), _mm256_castps_pd(hi), 1));
+}
+
+inline void store(double *ptr, VecF x)
+{
+   const __m256 hi = _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(x.v), 1));
+   _mm512_storeu_pd(ptr, _mm512_cvtps_pd(_mm512_castps512_ps256(x.v)));
+   _mm512_storeu_pd(ptr + 8, _mm512_cvtps_pd(hi));
+}
+
+inline VecF operator+(VecF a, VecF b)
+{
+   return _mm512_add_ps(a.v, b.v);
+}
+inline VecF operator-(VecF a, VecF b)
+{
+   return _mm512_sub_ps(a.v, b.v);
+}
+inline VecF operator*(VecF a, VecF b)
+{
+   return _mm512_mul_ps(a.v, b.v);
+}
+inline VecF operator/(VecF a, VecF b)
+{
+   return _mm512_div_ps(a.v, b.v);
+}
+inline VecF operator-(VecF a)
+{
+   return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a.v), _mm512_set1_epi32(0x80000000)));
+}
+
+inline MaskF operator<(VecF a, VecF b)
+{
+   return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ)};
+}
+inline MaskF operator<=(VecF a, VecF b)
+{
+   return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_LE_OQ)};
+}
+inline MaskF operator>(VecF a, VecF b)
+{
+   return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ)};
+}
+inline MaskF operator>=(VecF a, VecF b)
+{
+   return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_GE_OQ)};
+}
+inline MaskF operator==(VecF a, VecF b)
+{
+   return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_EQ_OQ)};
+}
+inline MaskF operator!=(VecF a, VecF b)
+{
+   return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_NEQ_UQ)};
+}
+
+inline MaskF operator&(MaskF a, MaskF b)
+{
+   return {static_cast<__mmask16>(a.m & b.m)};
+}
+inline MaskF operator|(MaskF a, MaskF b)
+{
+   return {static_cast<__mmask16>(a.m | b.m)};
+}
+inline MaskF operator!(MaskF a)
+{
+   return {static_cast<__mmask16>(~a.m)};
+}
+
+inline VecF select(MaskF mask, VecF a, VecF b)
+{
+   return _mm512_mask_blend_ps(mask.m, b.v, a.v);
+}
+
+inline bool any(MaskF mask)
+{
+   return mask.m != 0;
+}
+
+inline VecF sqrt(VecF x)
+{
+   return _mm512_sqrt_ps(x.v);
+}
+
+inline VecF abs(VecF x)
+{
+   return _mm512_abs_ps(x.v);
+}
+
+inline VecF floor(VecF x)
+{
+   return _mm512_roundscale_ps(x.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+}
+
+inline VecF round(VecF x)
+{
+   return _mm512_roundscale_ps(x.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
+
+inline MaskF isnan(VecF x)
+{
+   return {_mm512_cmp_ps_mask(x.v, x.v, _CMP_UNORD_Q)};
+}
+
+inline VecF pow2n(VecF n)
+{
+   return _mm512_scalef_ps(_mm512_set1_ps(1.0f), n.v);
+}
+
+inline VecF frexp(VecF x, VecF &e)
+{
+   e = _mm512_add_ps(_mm512_getexp_ps(x.v), _mm512_set1_ps(1.0f));
+   return _mm512_getmant_ps(x.v, _MM_MANT_NORM_p5_1, _MM_MANT_SIGN_zero);
+}
+
+#else // AVX2
+
+struct Mask {
+   __m256d m;
+};
+
+struct Vec {
+   static constexpr std::size_t size = 4;
+   Vec() = default;
+   Vec(__m256d x) : v{x} {}
+   Vec(double x) : v{_mm256_set1_pd(x)} {}
+   __m256d v;
+};
+
+template <>
+inline Vec load<Vec>(double const *ptr)
+{
+   return _mm256_loadu_pd(ptr);
+}
+
+inline void store(double *ptr, Vec x)
+{
+   _mm256_storeu_pd(ptr, x.v);
+}
+
+inline Vec operator+(Vec a, Vec b)
+{
+   return _mm256_add_pd(a.v, b.v);
+}
+inline Vec operator-(Vec a, Vec b)
+{
+   return _mm256_sub_pd(a.v, b.v);
+}
+inline Vec operator*(Vec a, Vec b)
+{
+   return _mm256_mul_pd(a.v, b.v);
+}
+inline Vec operator/(Vec a, Vec b)
+{
+   return _mm256_div_pd(a.v, b.v);
+}
+inline Vec operator-(Vec a)
+{
+   return _mm256_xor_pd(a.v, _mm256_set1_pd(-0.0));
+}
+
+inline Mask operator<(Vec a, Vec b)
+{
+   return {_mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ)};
+}
+inline Mask operator<=(Vec a, Vec b)
+{
+   return {_mm256_cmp_pd(a.v, b.v, _CMP_LE_OQ)};
+}
+inline Mask operator>(Vec a, Vec b)
+{
+   return {_mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ)};
+}
+inline Mask operator>=(Vec a, Vec b)
+{
+   return {_mm256_cmp_pd(a.v, b.v, _CMP_GE_OQ)};
+}
+inline Mask operator==(Vec a, Vec b)
+{
+   return {_mm256_cmp_pd(a.v, b.v, _CMP_EQ_OQ)};
+}
+inline Mask operator!=(Vec a, Vec b)
+{
+   return {_mm256_cmp_pd(a.v, b.v, _CMP_NEQ_UQ)};
+}
+
+inline Mask operator&(Mask a, Mask b)
+{
+   return {_mm256_and_pd(a.m, b.m)};
+}
+inline Mask operator|(Mask a, Mask b)
+{
+   return {_mm256_or_pd(a.m, b.m)};
+}
+inline Mask operator!(Mask a)
+{
+   return {_mm256_xor_pd(a.m, _mm256_castsi256_pd(_mm256_set1_epi64x(-1)))};
+}
+
+inline Vec select(Mask mask, Vec a, Vec b)
+{
+   return _mm256_blendv_pd(b.v, a.v, mask.m);
+}
+
+inline bool any(Mask mask)
+{
+   return _mm256_movemask_pd(mask.m) != 0;
+}
+
+inline Vec sqrt(Vec x)
+{
+   return _mm256_sqrt_pd(x.v);
+}
+
+inline Vec abs(Vec x)
+{
+   return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x.v);
+}
+
+inline Vec floor(Vec x)
+{
+   return _mm256_floor_pd(x.v);
+}
+
+inline Vec round(Vec x)
+{
+   return _mm256_round_pd(x.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
+
+inline Mask isnan(Vec x)
+{
+   return {_mm256_cmp_pd(x.v, x.v, _CMP_UNORD_Q)};
+}
+
+inline Vec pow2n(Vec n)
+{
+   // Adding 2^52 + 2^51 moves the integer value of n to the lowest mantissa
+   // bits, from where it is shifted to the exponent bits.
+   const __m256d magic = _mm256_set1_pd(6755399441055744.0);
+   const __m256i ni = _mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(n.v, magic)), _mm256_castpd_si256(magic));
+   return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(ni, _mm256_set1_epi64x(1023)), 52));
+}
+
+inline Vec frexp(Vec x, Vec &e)
+{
+   const __m256i bits = _mm256_castpd_si256(x.v);
+   // Convert the biased exponent to double by putting it into the mantissa of 2^52.
+   const __m256d twoPow52 = _mm256_set1_pd(4503599627370496.0);
+   const __m256i expBits = _mm256_or_si256(_mm256_srli_epi64(bits, 52), _mm256_castpd_si256(twoPow52));
+   e = _mm256_sub_pd(_mm256_castsi256_pd(expBits), _mm256_set1_pd(4503599627370496.0 + 1022.0));
+   const __m256i mantBits = _mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFF)),
+                                            _mm256_set1_epi64x(0x3FE0000000000000));
+   return _mm256_castsi256_pd(mantBits);
+}
+
+struct MaskF {
+   __m256 m;
+};
+
+struct VecF {
+   static constexpr std::size_t size = 8;
+   VecF() = default;
+   VecF(__m256 x) : v{x} {}
+   VecF(float x) : v{_mm256_set1_ps(x)} {}
+   __m256 v;
+};
+
+template <>
+inline VecF load<VecF>(double const *ptr)
+{
+   const __m128 lo = _mm256_cvtpd_ps(_mm256_loadu_pd(ptr));
+   const __m128 hi = _mm256_cvtpd_ps(_mm256_loadu_pd(ptr + 4));
+   return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+inline void store(double *ptr, VecF x)
+{
+   _mm256_storeu_pd(ptr, _mm256_cvtps_pd(_mm256_castps256_ps128(x.v)));
+   _mm256_storeu_pd(ptr + 4, _mm256_cvtps_pd(_mm256_extractf128_ps(x.v, 1)));
+}
+
+inline VecF operator+(VecF a, VecF b)
+{
+   return _mm256_add_ps(a.v, b.v);
+}
+inline VecF operator-(VecF a, VecF b)
+{
+   return _mm256_sub_ps(a.v, b.v);
+}
+inline VecF operator*(VecF a, VecF b)
+{
+   return _mm256_mul_ps(a.v, b.v);
+}
+inline VecF operator/(VecF a, VecF b)
+{
+   return _mm256_div_ps(a.v, b.v);
+}
+inline VecF operator-(VecF a)
+{
+   return _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f));
+}
+
+inline MaskF operator<(VecF a, VecF b)
+{
+   return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)};
+}
+inline MaskF operator<=(VecF a, VecF b)
+{
+   return {_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)};
+}
+inline MaskF operator>(VecF a, VecF b)
+{
+   return {_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)};
+}
+inline MaskF operator>=(VecF a, VecF b)
+{
+   return {_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)};
+}
+inline MaskF operator==(VecF a, VecF b)
+{
+   return {_mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ)};
+}
+inline MaskF operator!=(VecF a, VecF b)
+{
+   return {_mm256_cmp_ps(a.v, b.v, _CMP_NEQ_UQ)};
+}
+
+inline MaskF operator&(MaskF a, MaskF b)
+{
+   return {_mm256_and_ps(a.m, b.m)};
+}
+inline MaskF operator|(MaskF a, MaskF b)
+{
+   return {_mm256_or_ps(a.m, b.m)};
+}
+inline MaskF operator!(MaskF a)
+{
+   return {_mm256_xor_ps(a.m, _mm256_castsi256_ps(_mm256_set1_epi32(-1)))};
+}
+
+inline VecF select(MaskF mask, VecF a, VecF b)
+{
+   return _mm256_blendv_ps(b.v, a.v, mask.m);
+}
+
+inline bool any(MaskF mask)
+{
+   return _mm256_movemask_ps(mask.m) != 0;
+}
+
+inline VecF sqrt(VecF x)
+{
+   return _mm256_sqrt_ps(x.v);
+}
+
+inline VecF abs(VecF x)
+{
+   return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x.v);
+}
+
+inline VecF floor(VecF x)
+{
+   return _mm256_floor_ps(x.v);
+}
+
+inline VecF round(VecF x)
+{
+   return _mm256_round_ps(x.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
+
+inline MaskF isnan(VecF x)
+{
+   return {_mm256_cmp_ps(x.v, x.v, _CMP_UNORD_Q)};
+}
+
+inline VecF pow2n(VecF n)
+{
+   // Same trick as for doubles, with 2^23 + 2^22.
+   const __m256 magic = _mm256_set1_ps(12582912.0f);
+   const __m256i ni = _mm256_sub_epi32(_mm256_castps_si256(_mm256_add_ps(n.v, magic)), _mm256_castps_si256(magic));
+   return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(ni, _mm256_set1_epi32(127)), 23));
+}
+
+inline VecF frexp(VecF x, VecF &e)
+{
+   const __m256i bits = _mm256_castps_si256(x.v);
+   const __m256i biasedExp = _mm256_and_si256(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(0xFF));
+   e = _mm256_sub_ps(_mm256_cvtepi32_ps(biasedExp), _mm256_set1_ps(126.0f));
+   const __m256i mantBits =
+      _mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3F000000));
+   return _mm256_castsi256_ps(mantBits);
+}
+
+#endif // __AVX512F__
+
+template <>
+struct Scalar<Vec> {
+   using type = double;
+};
+
+template <>
+struct Scalar<VecF> {
+   using type = float;
+};
+
+#endif // ROOBATCHCOMPUTE_EXPLICIT_SIMD
+
+// Vectorized math functions, implemented for both scalars and vectors.
+
+template <class V>
+inline V expDouble(V x)
+{
+   constexpr double maxLog = 7.09782712893383996843e2;
+   constexpr double minLog = -7.45133219101941108420e2;
+
+   // Clamp to avoid integer overflow in the exponent computation. The lanes
+   // out of range are overwritten at the end.
+   const V xc = select(x > V(maxLog), V(maxLog), select(x < V(minLog), V(minLog), x));
+
+   // Express exp(x) as exp(r) * 2^n, with |r| < ln(2)/2.
+   const V n = round(xc * V(1.4426950408889634073599));
+   const V r = xc - n * V(6.93145751953125e-1) - n * V(1.42860682030941723212e-6);
+
+   // Pade approximation of exp(r).
+   const V rr = r * r;
+   const V p = r * ((V(1.26177193074810590878e-4) * rr + V(3.02994407707441961300e-2)) * rr +
+                    V(9.99999999999999999910e-1));
+   const V q = ((V(3.00198505138664455042e-6) * rr + V(2.52448340349684104192e-3)) * rr +
+                V(2.27265548208155028766e-1)) *
+                  rr +
+               V(2.00000000000000000009e0);
+   V out = V(1.0) + V(2.0) * p / (q - p);
+
+   // Multiply with 2^n in two steps, such that no step over- or underflows
+   // before the final result does.
+   const V n1 = floor(n * V(0.5));
+   out = out * pow2n(n1) * pow2n(n - n1);
+
+   out = select(x > V(maxLog), V(std::numeric_limits<double>::infinity()), out);
+   out = select(x < V(minLog), V(0.0), out);
+   return select(isnan(x), x, out);
+}
+
+template <class V>
+inline V logDouble(V x)
+{
+   constexpr double minNormal = std::numeric_limits<double>::min();
+
+   // Bring subnormal numbers into the normal range.
+   const auto isSubnormal = x < V(minNormal);
+   V e;
+   V m = frexp(select(isSubnormal, x * V(18014398509481984.0), x), e); // 2^54
+   e = select(isSubnormal, e - V(54.0), e);
+
+   // Express log(x) as log(1 + m) + e * log(2), with sqrt(1/2) - 1 < m < sqrt(2) - 1.
+   const auto isSmall = m < V(0.70710678118654752440);
+   e = select(isSmall, e - V(1.0), e);
+   m = select(isSmall, m + m - V(1.0), m - V(1.0));
+
+   // Rational approximation of log(1 + m).
+   const V z = m * m;
+   const V p = ((((V(1.01875663804580931796e-4) * m + V(4.97494994976747001425e-1)) * m +
+                  V(4.70579119878881725854e0)) *
+                    m +
+                 V(1.44989225341610930846e1)) *
+                   m +
+                V(1.79368678507819816313e1)) *
+                  m +
+               V(7.70838733755885391666e0);
+   const V q = ((((m + V(1.12873587189167450590e1)) * m + V(4.52279145837532221105e1)) * m +
+                 V(8.29875266912776603211e1)) *
+                   m +
+                V(7.11544750618563894466e1)) *
+                  m +
+               V(2.31251620126765340583e1);
+   V y = m * (z * p / q);
+   y = y - e * V(2.121944400546905827679e-4);
+   y = y - V(0.5) * z;
+   V out = m + y + e * V(0.693359375);
+
+   out = select(x == V(std::numeric_limits<double>::infinity()), x, out);
+   out = select(x == V(0.0), V(-std::numeric_limits<double>::infinity()), out);
+   out = select(x < V(0.0), V(std::numeric_limits<double>::quiet_NaN()), out);
+   return select(isnan(x), x, out);
+}
+
+// Range of the arguments for which the single precision exponential is a
+// normal number. Below, the result is subnormal and loses precision until it
+// is flushed to zero, and above it overflows.
+constexpr float minNormalLogFloat = -87.3365447505531f;
+constexpr float maxLogFloat = 88.72283905206835f;
+
+/// Check if the single precision exponential of any element of x is not a
+/// normal number, in which case the caller should compute it in double
+/// precision. Always false for double precision.
+template <class V>
+inline bool expOutOfFloatRange(V x)
+{
+   if constexpr (std::is_same<typename Scalar<V>::type, float>::value) {
+      return any((x < V(minNormalLogFloat)) | (x > V(maxLogFloat)));
+   } else {
+      return false;
+   }
+}
+
+/// Single precision exponential. The results for x < minNormalLogFloat are
+/// subnormal, and zero for x < -103.28. Use expOutOfFloatRange() to check if
+/// the double precision version should be used instead.
+template <class V>
+inline V expFloat(V x)
+{
+   constexpr float maxLog = maxLogFloat;
+   constexpr float minLog = -103.278929903431851103f;
+
+   const V xc = select(x > V(maxLog), V(maxLog), select(x < V(minLog), V(minLog), x));
+
+   const V n = round(xc * V(1.44269504088896341f));
+   const V r = xc - n * V(0.693359375f) + n * V(2.12194440e-4f);
+
+   // Polynomial approximation of exp(r).
+   const V rr = r * r;
+   const V p = ((((V(1.9875691500e-4f) * r + V(1.3981999507e-3f)) * r + V(8.3334519073e-3f)) * r +
+                 V(4.1665795894e-2f)) *
+                   r +
+                V(1.6666665459e-1f)) *
+                  r +
+               V(5.0000001201e-1f);
+   V out = p * rr + r + V(1.0f);
+
+   const V n1 = floor(n * V(0.5f));
+   out = out * pow2n(n1) * pow2n(n - n1);
+
+   out = select(x > V(maxLog), V(std::numeric_limits<float>::infinity()), out);
+   out = select(x < V(minLog), V(0.0f), out);
+   return select(isnan(x), x, out);
+}
+
+template <class V>
+inline V logFloat(V x)
+{
+   constexpr float minNormal = std::numeric_limits<float>::min();
+
+   const auto isSubnormal = x < V(minNormal);
+   V e;
+   V m = frexp(select(isSubnormal, x * V(33554432.0f), x), e); // 2^25
+   e = select(isSubnormal, e - V(25.0f), e);
+
+   const auto isSmall = m < V(0.707106781186547524f);
+   e = select(isSmall, e - V(1.0f), e);
+   m = select(isSmall, m + m - V(1.0f), m - V(1.0f));
+
+   // Polynomial approximation of log(1 + m).
+   const V z = m * m;
+   V y = ((((((((V(7.0376836292e-2f) * m - V(1.1514610310e-1f)) * m + V(1.1676998740e-1f)) * m -
+               V(1.2420140846e-1f)) *
+                 m +
+              V(1.4249322787e-1f)) *
+                m -
+             V(1.6668057665e-1f)) *
+               m +
+            V(2.0000714765e-1f)) *
+              m -
+           V(2.4999993993e-1f)) *
+             m +
+          V(3.3333331174e-1f)) *
+         m * z;
+   y = y - e * V(2.12194440e-4f);
+   y = y - V(0.5f) * z;
+   V out = m + y + e * V(0.693359375f);
+
+   out = select(x == V(std::numeric_limits<float>::infinity()), x, out);
+   out = select(x == V(0.0f), V(-std::numeric_limits<float>::infinity()), out);
+   out = select(x < V(0.0f), V(std::numeric_limits<float>::quiet_NaN()), out);
+   return select(isnan(x), x, out);
+}
+
+template <class V>
+inline V exp(V x)
+{
+   if constexpr (std::is_same<typename Scalar<V>::type, float>::value) {
+      return expFloat(x);
+   } else {
+      return expDouble(x);
+   }
+}
+
+template <class V>
+inline V log(V x)
+{
+   if constexpr (std::is_same<typename Scalar<V>::type, float>::value) {
+      return logFloat(x);
+   } else {
+      return logDouble(x);
+   }
+}
+
+/// Sine and cosine in double precision, with the polynomial approximations and
+/// the three-part reduction of the argument to [-pi/4, pi/4] from Cephes. The
+/// reduction is accurate for arguments up to about 1e8.
+template <class V>
+inline void sincos(V x, V &sinOut, V &cosOut)
+{
+   const V ax = abs(x);
+
+   // Index of the octant, rounded up to an even number, such that the
+   // reduced argument is in [-pi/4, pi/4].
+   V j = floor(ax * V(1.27323954473516268615)); // 4 / pi
+   j = j + (j - V(2.0) * floor(j * V(0.5)));
+   const V z = ((ax - j * V(7.85398125648498535156e-1)) - j * V(3.77489470793079817668e-8)) -
+               j * V(2.69515142907905952645e-15);
+
+   const V zz = z * z;
+   const V sinPoly = z + z * zz *
+                            (((((V(1.58962301576546568060e-10) * zz - V(2.50507477628578072866e-8)) * zz +
+                                V(2.75573136213857245213e-6)) *
+                                  zz -
+                               V(1.98412698295895385996e-4)) *
+                                 zz +
+                              V(8.33333333332211858878e-3)) *
+                                zz -
+                             V(1.66666666666666307295e-1));
+   const V cosPoly = V(1.0) - V(0.5) * zz +
+                     zz * zz *
+                        (((((V(-1.13585365213876817300e-11) * zz + V(2.08757008419747316778e-9)) * zz -
+                            V(2.75573141792967388112e-7)) *
+                              zz +
+                           V(2.48015872888517045348e-5)) *
+                             zz -
+                          V(1.38888888888730564116e-3)) *
+                            zz +
+                         V(4.16666666666665929218e-2));
+
+   // Octants 2 and 6 swap the polynomials, and the octants 2, 4 and 6 change
+   // the signs.
+   const V octant = j - V(8.0) * floor(j * V(0.125));
+   const auto swap = (octant == V(2.0)) | (octant == V(6.0));
+   V s = select(swap, cosPoly, sinPoly);
+   V c = select(swap, sinPoly, cosPoly);
+   s = select(octant >= V(4.0), -s, s);
+   c = select((octant == V(2.0)) | (octant == V(4.0)), -c, c);
+
+   sinOut = select(x < V(0.0), -s, s);
+   cosOut = c;
+}
+
+/// Computes exp(-x^2) without amplifying the rounding error of x^2 for large x,
+/// by splitting x into a part that can be squared exactly and a small remainder,
+/// like expx2() in Cephes.
+template <class V>
+inline V expMinusXSquared(V x)
+{
+   const V ax = abs(x);
+   const V hi = floor(ax * V(128.0) + V(0.5)) * V(1.0 / 128.0);
+   const V lo = ax - hi;
+   return exp(-(hi * hi)) * exp(-(V(2.0) * hi + lo) * lo);
+}
+
+/// Error function for |x| <= 1 in double precision, from Cephes.
+template <class V>
+inline V erfSmallArg(V x)
+{
+   const V z = x * x;
+   const V p = (((V(9.60497373987051638749e0) * z + V(9.00260197203842689217e1)) * z + V(2.23200534594684319226e3)) *
+                   z +
+                V(7.00332514112805075473e3)) *
+                  z +
+               V(5.55923013010394962768e4);
+   const V q = ((((z + V(3.35617141647503099647e1)) * z + V(5.21357949780152679795e2)) * z +
+                 V(4.59432382970980127987e3)) *
+                   z +
+                V(2.26290000613890934246e4)) *
+                  z +
+               V(4.92673942608635921086e4);
+   return x * p / q;
+}
+
+/// Scaled complementary error function exp(x^2) erfc(x) for x >= 1 in double
+/// precision, with the rational approximations from Cephes.
+template <class V>
+inline V erfcxLargeArg(V ax)
+{
+   // Approximations for 1 <= x < 8 and for x >= 8.
+   const V p = (((((((V(2.46196981473530512524e-10) * ax + V(5.64189564831068821977e-1)) * ax +
+                     V(7.46321056442269912687e0)) *
+                       ax +
+                    V(4.86371970985681366614e1)) *
+                      ax +
+                   V(1.96520832956077098242e2)) *
+                     ax +
+                  V(5.26445194995477358631e2)) *
+                    ax +
+                 V(9.34528527171957607540e2)) *
+                   ax +
+                V(1.02755188689515710272e3)) *
+                  ax +
+               V(5.57535335369399327526e2);
+   const V q = (((((((ax + V(1.32281951154744992508e1)) * ax + V(8.67072140885989742329e1)) * ax +
+                    V(3.54937778887819891062e2)) *
+                      ax +
+                   V(9.75708501743205489753e2)) *
+                     ax +
+                  V(1.82390916687909736289e3)) *
+                    ax +
+                 V(2.24633760818710981792e3)) *
+                   ax +
+                V(1.65666309194161350182e3)) *
+                  ax +
+               V(5.57535340817727675546e2);
+   const V r = ((((V(5.64189583547755073984e-1) * ax + V(1.27536670759978104416e0)) * ax +
+                  V(5.01905042251180477414e0)) *
+                    ax +
+                 V(6.16021097993053585195e0)) *
+                   ax +
+                V(7.40974269950448939160e0)) *
+                  ax +
+               V(2.97886665372100240670e0);
+   const V s = (((((ax + V(2.26052863220117276590e0)) * ax + V(9.39603524938001434673e0)) * ax +
+                  V(1.20489539808096656605e1)) *
+                    ax +
+                 V(1.70814450747565897222e1)) *
+                   ax +
+                V(9.60896809063285878198e0)) *
+                  ax +
+               V(3.36907645100081516050e0);
+
+   return select(ax < V(8.0), p / q, r / s);
+}
+
+/// Complementary error function in double precision, with the rational
+/// approximations from Cephes.
+template <class V>
+inline V erfc(V x)
+{
+   const V ax = abs(x);
+   V y = expMinusXSquared(ax) * erfcxLargeArg(ax);
+   // The result underflows for x > 27.3, where the splitting of x^2 doesn't
+   // work anymore for very large x.
+   y = select(ax > V(27.3), V(0.0), y);
+   y = select(x < V(0.0), V(2.0) - y, y);
+
+   const V out = select(ax < V(1.0), V(1.0) - erfSmallArg(x), y);
+   return select(isnan(x), x, out);
+}
+
+/// Error function in double precision, with the rational approximations from
+/// Cephes.
+template <class V>
+inline V erf(V x)
+{
+   const V out = select(abs(x) <= V(1.0), erfSmallArg(x), V(1.0) - erfc(x));
+   return select(isnan(x), x, out);
+}
+
+/// Whether the Faddeeva function is evaluated so close to the real axis that
+/// faddeevaRealUpper() can't be used, because the scalar implementation
+/// RooHeterogeneousMath::faddeeva() would use Taylor expansions around the
+/// singularities of the Fourier representation.
+template <class V>
+inline auto faddeevaNearRealAxis(V zim)
+{
+   return zim * zim < V(9.0 / 1000000.0);
+}
+
+/// Real part of the Faddeeva function w(z) for Im(z) >= 0 in double
+/// precision, which is what the Voigt profile needs. This is the same
+/// algorithm as RooHeterogeneousMath::faddeeva(), with the 24 term Fourier
+/// representation for |z| <= 12 and the continued fraction for larger |z|,
+/// except for the Taylor expansions close to the real axis, which have to be
+/// evaluated with the scalar implementation (see faddeevaNearRealAxis()).
+template <class V>
+inline V faddeevaRealUpper(V zre, V zim)
+{
+   constexpr double tm = 12.0;
+   const V znorm = zre * zre + zim * zim;
+   const auto useFraction = znorm > V(tm * tm);
+
+   V fraction = V(0.0);
+   if (any(useFraction)) {
+      const V z2re = (zre + zim) * (zre - zim);
+      const V z2im = V(2.0) * zre * zim;
+      V cfre = V(1.0);
+      V cfim = V(0.0);
+      V cfnorm = V(1.0);
+      for (unsigned k = 9; k; --k) {
+         cfre = V(k / 2.0) * cfre / cfnorm;
+         cfim = -V(k / 2.0) * cfim / cfnorm;
+         if (k & 1) {
+            cfre = cfre - z2re;
+            cfim = cfim - z2im;
+         } else {
+            cfre = cfre + V(1.0);
+         }
+         cfnorm = cfre * cfre + cfim * cfim;
+      }
+      fraction = (zim * cfre - zre * cfim) * V(5.64189583547756287e-01) / cfnorm;
+   }
+
+   V fourier = V(0.0);
+   if (any(!useFraction)) {
+      const V tmzre = V(tm) * zre;
+      const V tmzim = V(tm) * zim;
+      // exp(i tm z)
+      V sinTmzre;
+      V cosTmzre;
+      sincos(tmzre, sinTmzre, cosTmzre);
+      const V expTmzim = exp(-tmzim);
+      const V eitmzre = expTmzim * cosTmzre;
+      const V eitmzim = expTmzim * sinTmzre;
+      // 1 -/+ exp(i tm z), and tm z times these
+      const V numer0 = V(1.0) - eitmzre;
+      const V numer1 = -eitmzim;
+      const V numer2 = V(1.0) + eitmzre;
+      const V numer3 = eitmzim;
+      const V numertmz[4] = {tmzre * numer0 - tmzim * numer1, tmzre * numer1 + tmzim * numer0,
+                             tmzre * numer2 - tmzim * numer3, tmzre * numer3 + tmzim * numer2};
+      const V reimtmzm2 = V(-2.0) * tmzre * tmzim;
+      const V imtmz2 = tmzim * tmzim;
+      const V reimtmzm22 = reimtmzm2 * reimtmzm2;
+
+      V sumim = (V(-RooHeterogeneousMath::a24[0]) / znorm) * (numer1 * zre - numer0 * zim);
+      for (unsigned i = 0; i < 24; ++i) {
+         const unsigned j = (i << 1) & 2;
+         const V npi = V(RooHeterogeneousMath::npi24[i]);
+         const V wk = imtmz2 + (npi + tmzre) * (npi - tmzre);
+         const V f = V(2.0 * tm * RooHeterogeneousMath::a24[i]) / (wk * wk + reimtmzm22);
+         sumim = sumim - f * (numertmz[j + 1] * wk - numertmz[j] * reimtmzm2);
+      }
+      fourier = -sumim / V(3.54490770181103205e+00);
+   }
+
+   return select(useFraction, fraction, fourier);
+}
+
+/// Compute the logarithms of `n` values.
+inline void log(double const *input, double *output, std::size_t n)
+{
+   std::size_t i = 0;
+#ifdef ROOBATCHCOMPUTE_EXPLICIT_SIMD
+   for (; i + Vec::size <= n; i += Vec::size) {
+      store(output + i, log(load<Vec>(input + i)));
+   }
+#endif
+   for (; i < n; ++i) {
+      output[i] = log(input[i]);
+   }
+}
+
+} // namespace Simd
+} // namespace RF_ARCH
+} // namespace RooBatchCompute
+
+#endif // ROOFIT_BATCHCOMPUTE_ROOSIMD_H
@@ -0,0 +1,320 @@
+/*
+ * Project: RooFit
+ *
+ * Copyright (c) 2024, CERN
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted according to the terms
+ * listed in LICENSE (http://roofit.sourceforge.net/license.txt)
+ */
+
+// Tests for the vectorized math functions of RooSIMD.h. The test is compiled
+// once for every instruction set, like the RooBatchCompute libraries. It
+// checks that the scalar overloads agree with the standard library (or with
+// RooHeterogeneousMath for the Faddeeva function) over the whole range of
+// arguments, and that the vector implementations give exactly the same
+// results as the scalar overloads.
+
+#include "RooSIMD.h"
+
+#include <RooHeterogeneousMath.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Simd = RooBatchCompute::RF_ARCH::Simd;
+
+namespace {
+
+bool cpuSupportsArchitecture()
+{
+#if defined(__AVX512F__)
+   return __builtin_cpu_supports("avx512f");
+#elif defined(__AVX2__)
+   return __builtin_cpu_supports("avx2");
+#else
+   return true;
+#endif
+}
+
+/// Round the values to the given precision, such that the inputs of the
+/// single precision functions don't depend on the conversion.
+template <class T>
+std::vector<double> toPrecision(std::vector<double> values)
+{
+   for (double &val : values) {
+      val = static_cast<T>(val);
+   }
+   return values;
+}
+
+/// Arguments of the exponential from below the underflow to above the overflow
+/// threshold, including the special values.
+template <class T>
+std::vector<double> expInputs()
+{
+   const double lo = std::is_same<T, float>::value ? -110.0 : -760.0;
+   const double hi = std::is_same<T, float>::value ? 95.0 : 720.0;
+   const int n = 100000;
+
+   std::vector<double> values;
+   for (int i = 0; i <= n; ++i) {
+      values.push_back(lo + (hi - lo) * i / n);
+   }
+   for (double val : {0.0, -0.0, 1.0, -1.0, static_cast<double>(Simd::minNormalLogFloat),
+                      static_cast<double>(Simd::maxLogFloat)}) {
+      values.push_back(val);
+   }
+   values.push_back(std::numeric_limits<double>::infinity());
+   values.push_back(-std::numeric_limits<double>::infinity());
+   values.push_back(std::numeric_limits<double>::quiet_NaN());
+   return toPrecision<T>(values);
+}
+
+/// Arguments of the logarithm over the whole range of the positive numbers,
+/// including the subnormal numbers, and the special values.
+template <class T>
+std::vector<double> logInputs()
+{
+   using Limits = std::numeric_limits<T>;
+
+   std::vector<double> values;
+   for (int e = Limits::min_exponent - Limits::digits; e < Limits::max_exponent; ++e) {
+      for (double m = 1.0; m < 2.0; m += 0.0625) {
+         values.push_back(std::ldexp(m, e));
+      }
+   }
+   for (double val : {1.0, 0.0, -0.0, -1.0}) {
+      values.push_back(val);
+   }
+   values.push_back(Limits::denorm_min());
+   values.push_back(Limits::min());
+   values.push_back(Limits::max());
+   values.push_back(-Limits::min());
+   values.push_back(Limits::infinity());
+   values.push_back(-Limits::infinity());
+   values.push_back(Limits::quiet_NaN());
+   return toPrecision<T>(values);
+}
+
+/// Evenly spaced arguments in [lo, hi], including the special values.
+std::vector<double> linearInputs(double lo, double hi, int n)
+{
+   std::vector<double> values;
+   for (int i = 0; i <= n; ++i) {
+      values.push_back(lo + (hi - lo) * i / n);
+   }
+   for (double val : {0.0, -0.0, 1.0, -1.0, 8.0, -8.0, 27.3, 1e10, -1e10}) {
+      values.push_back(val);
+   }
+   values.push_back(std::numeric_limits<double>::infinity());
+   values.push_back(-std::numeric_limits<double>::infinity());
+   values.push_back(std::numeric_limits<double>::quiet_NaN());
+   return values;
+}
+
+/// Compare a scalar function of the given precision with the reference in
+/// double precision from the standard library. The relative tolerance is
+/// given in units of the machine epsilon. Results in the subnormal range have
+/// an absolute precision of a few times the smallest subnormal number.
+template <class T, class Func, class Ref>
+void checkScalar(std::string const &name, std::vector<double> const &inputs, Func func, Ref ref, double nEps)
+{
+   using Limits = std::numeric_limits<T>;
+   for (double x : inputs) {
+      const T out = func(static_cast<T>(x));
+      const double expected = ref(x);
+      SCOPED_TRACE(name + "(" + std::to_string(x) + ")");
+      if (std::isnan(expected)) {
+         EXPECT_TRUE(std::isnan(out)) << out;
+      } else if (std::isinf(expected)) {
+         EXPECT_EQ(out, static_cast<T>(expected));
+      } else if (std::abs(expected) >= Limits::max()) {
+         // The result overflows in the given precision.
+         EXPECT_GE(std::abs(out), Limits::max() * (1.0 - nEps * Limits::epsilon()));
+      } else if (std::abs(expected) < Limits::min()) {
+         EXPECT_NEAR(out, expected, 2.0 * Limits::denorm_min());
+      } else {
+         EXPECT_NEAR(out, expected, nEps * Limits::epsilon() * std::abs(expected));
+      }
+   }
+}
+
+#ifdef ROOBATCHCOMPUTE_EXPLICIT_SIMD
+
+/// Check that the vector function gives bitwise the same results as the
+/// scalar function for every element, also for the special values.
+template <class V, class T, class Func>
+void checkVector(std::string const &name, std::vector<double> inputs, Func func)
+{
+   // Fill up the last vector.
+   while (inputs.size() % V::size != 0) {
+      inputs.push_back(1.0);
+   }
+   std::vector<double> outputs(inputs.size());
+   for (std::size_t i = 0; i < inputs.size(); i += V::size) {
+      Simd::store(outputs.data() + i, func(Simd::load<V>(inputs.data() + i)));
+   }
+   for (std::size_t i = 0; i < inputs.size(); ++i) {
+      const T expected = func(static_cast<T>(inputs[i]));
+      SCOPED_TRACE(name + "(" + std::to_string(inputs[i]) + ")");
+      if (std::isnan(expected)) {
+         EXPECT_TRUE(std::isnan(outputs[i])) << outputs[i];
+      } else {
+         EXPECT_EQ(static_cast<T>(outputs[i]), expected);
+      }
+   }
+}
+
+#endif
+
+} // namespace
+
+TEST(RooSIMD, ExpDouble)
+{
+   checkScalar<double>("exp", expInputs<double>(), [](double x) { return Simd::exp(x); },
+                       [](double x) { return std::exp(x); }, 2.0);
+}
+
+TEST(RooSIMD, LogDouble)
+{
+   checkScalar<double>("log", logInputs<double>(), [](double x) { return Simd::log(x); },
+                       [](double x) { return std::log(x); }, 2.0);
+}
+
+TEST(RooSIMD, ExpFloat)
+{
+   checkScalar<float>("exp", expInputs<float>(), [](float x) { return Simd::exp(x); },
+                      [](double x) { return std::exp(x); }, 2.0);
+}
+
+TEST(RooSIMD, LogFloat)
+{
+   checkScalar<float>("log", logInputs<float>(), [](float x) { return Simd::log(x); },
+                      [](double x) { return std::log(x); }, 2.0);
+}
+
+TEST(RooSIMD, SinCos)
+{
+   // The sine and cosine are only used for arguments of moderate size.
+   std::vector<double> inputs = linearInputs(-200., 200., 100000);
+   inputs.resize(inputs.size() - 7);
+   auto sin = [](double x) {
+      double s, c;
+      Simd::sincos(x, s, c);
+      return s;
+   };
+   auto cos = [](double x) {
+      double s, c;
+      Simd::sincos(x, s, c);
+      return c;
+   };
+   // The results close to the zeros only have an absolute precision.
+   for (double x : inputs) {
+      EXPECT_NEAR(sin(x), std::sin(x), 2.0 * std::numeric_limits<double>::epsilon()) << "sin(" << x << ")";
+      EXPECT_NEAR(cos(x), std::cos(x), 2.0 * std::numeric_limits<double>::epsilon()) << "cos(" << x << ")";
+   }
+}
+
+TEST(RooSIMD, Erf)
+{
+   checkScalar<double>("erf", linearInputs(-30., 30., 100000), [](double x) { return Simd::erf(x); },
+                       [](double x) { return std::erf(x); }, 4.0);
+}
+
+TEST(RooSIMD, Erfc)
+{
+   checkScalar<double>("erfc", linearInputs(-30., 30., 100000), [](double x) { return Simd::erfc(x); },
+                       [](double x) { return std::erfc(x); }, 8.0);
+}
+
+TEST(RooSIMD, FaddeevaReal)
+{
+   // Compare with the scalar implementation in the upper half plane, away
+   // from the real axis where the scalar implementation uses Taylor
+   // expansions, and on both sides of the transition to the continued
+   // fraction at |z| = 12. The terms of the Fourier representation cancel for
+   // small results, so the tolerance is absolute, given that |w(z)| <= 1 in
+   // the upper half plane.
+   for (double zim : {0.003, 0.01, 0.1, 0.5, 1., 3., 10., 11.9, 12.1, 50.}) {
+      for (double zre = -30.; zre <= 30.; zre += 0.0123) {
+         if (Simd::faddeevaNearRealAxis(zim)) {
+            continue;
+         }
+         const double expected = RooHeterogeneousMath::faddeeva(std::complex<double>(zre, zim)).real();
+         EXPECT_NEAR(Simd::faddeevaRealUpper(zre, zim), expected, 1e-14)
+            << "w(" << zre << " + " << zim << "i)";
+      }
+   }
+}
+
+#ifdef ROOBATCHCOMPUTE_EXPLICIT_SIMD
+
+TEST(RooSIMD, VectorMatchesScalar)
+{
+   if (!cpuSupportsArchitecture()) {
+      GTEST_SKIP() << "The CPU doesn't support the instruction set of this test";
+   }
+
+   auto exp = [](auto x) { return Simd::exp(x); };
+   auto log = [](auto x) { return Simd::log(x); };
+
+   checkVector<Simd::Vec, double>("exp", expInputs<double>(), exp);
+   checkVector<Simd::Vec, double>("log", logInputs<double>(), log);
+   checkVector<Simd::VecF, float>("exp", expInputs<float>(), exp);
+   checkVector<Simd::VecF, float>("log", logInputs<float>(), log);
+
+   auto sin = [](auto x) {
+      decltype(x) s, c;
+      Simd::sincos(x, s, c);
+      return s;
+   };
+   auto cos = [](auto x) {
+      decltype(x) s, c;
+      Simd::sincos(x, s, c);
+      return c;
+   };
+   auto erf = [](auto x) { return Simd::erf(x); };
+   auto erfc = [](auto x) { return Simd::erfc(x); };
+   checkVector<Simd::Vec, double>("sin", linearInputs(-200., 200., 10000), sin);
+   checkVector<Simd::Vec, double>("cos", linearInputs(-200., 200., 10000), cos);
+   checkVector<Simd::Vec, double>("erf", linearInputs(-30., 30., 10000), erf);
+   checkVector<Simd::Vec, double>("erfc", linearInputs(-30., 30., 10000), erfc);
+
+   // The Faddeeva function is checked for a fixed imaginary part, with vectors
+   // that mix the Fourier representation and the continued fraction.
+   for (double zim : {0.01, 1., 11.9}) {
+      auto faddeeva = [zim](auto zre) { return Simd::faddeevaRealUpper(zre, decltype(zre)(zim)); };
+      checkVector<Simd::Vec, double>("faddeeva", linearInputs(-30., 30., 10000), faddeeva);
+   }
+}
+
+TEST(RooSIMD, VectorLogArray)
+{
+   if (!cpuSupportsArchitecture()) {
+      GTEST_SKIP() << "The CPU doesn't support the instruction set of this test";
+   }
+
+   // The array version processes the remainder that doesn't fill a vector
+   // with the scalar function, which has to give the same results.
+   std::vector<double> inputs = logInputs<double>();
+   inputs.resize(inputs.size() - inputs.size() % Simd::Vec::size + 3);
+   std::vector<double> outputs(inputs.size());
+   Simd::log(inputs.data(), outputs.data(), inputs.size());
+   for (std::size_t i = 0; i < inputs.size(); ++i) {
+      const double expected = Simd::log(inputs[i]);
+      if (std::isnan(expected)) {
+         EXPECT_TRUE(std::isnan(outputs[i])) << outputs[i];
+      } else {
+         EXPECT_EQ(outputs[i], expected) << "log(" << inputs[i] << ")";
+      }
+   }
+}
+
+#endif
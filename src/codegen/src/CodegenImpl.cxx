@@ -65,6 +65,8 @@
 
 #include <TInterpreter.h>
 
+#include <typeindex>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace RooFit::Experimental {
@@ -709,26 +711,54 @@ void codegenImpl(RooRatio &arg, CodegenContext &ctx)
 
 namespace {
 
+using CodegenIntegralImplFunc = std::string (*)(RooAbsReal &, int, const char *, CodegenContext &);
+
+template <class Arg_t>
+std::string callCodegenIntegralImpl(RooAbsReal &arg, int code, const char *rangeName, CodegenContext &ctx)
+{
+   return codegenIntegralImpl(static_cast<Arg_t &>(arg), code, rangeName, ctx);
+}
+
+template <class... Arg_ts>
+std::unordered_map<std::type_index, CodegenIntegralImplFunc> makeIntegralDispatchTable()
+{
+   return {{typeid(Arg_ts), &callCodegenIntegralImpl<Arg_ts>}...};
+}
+
 std::string codegenIntegral(RooAbsReal &arg, int code, const char *rangeName, CodegenContext &ctx)
 {
-   using Func = std::string (*)(RooAbsReal &, int, const char *, CodegenContext &);
+   // The classes with an integral implementation in this file are dispatched
+   // without the interpreter, unless the user has overridden them with a
+   // prioritized overload.
+   static const auto registered =
+      makeIntegralDispatchTable<RooBernstein, RooBifurGauss, RooCBShape, RooChebychev, RooEfficiency, RooExponential,
+                                RooGamma, RooGaussian, RooHistFunc, RooHistPdf, RooLandau, RooLognormal,
+                                RooMultiVarGaussian, RooPoisson, RooPolyVar, RooPolynomial, RooRealSumPdf, RooUniform>();
 
-   Func func;
+   CodegenIntegralImplFunc func;
 
    TClass *tclass = arg.IsA();
 
    // Cache the overload resolutions
-   static std::unordered_map<TClass *, Func> dispatchMap;
+   static std::unordered_map<TClass *, CodegenIntegralImplFunc> dispatchMap;
 
    auto found = dispatchMap.find(tclass);
 
+   auto foundRegistered = registered.end();
+   if (found == dispatchMap.end()) {
+      foundRegistered = registered.find(typeid(arg));
+   }
+
    if (found != dispatchMap.end()) {
       func = found->second;
+   } else if (foundRegistered != registered.end() && !hasPrioritizedOverload("codegenIntegralImpl", *tclass)) {
+      func = foundRegistered->second;
+      dispatchMap[tclass] = func;
    } else {
       // Can probably done with CppInterop in the future to avoid string manipulation.
       std::stringstream cmd;
       cmd << "&RooFit::Experimental::CodegenIntegralImplCaller<" << tclass->GetName() << ">::call;";
-      func = reinterpret_cast<Func>(gInterpreter->ProcessLine(cmd.str().c_str()));
+      func = reinterpret_cast<CodegenIntegralImplFunc>(gInterpreter->ProcessLine(cmd.str().c_str()));
       dispatchMap[tclass] = func;
    }
 
@@ -1070,4 +1100,35 @@ std::string codegenIntegralImpl(RooUniform &arg, int code, const char *rangeName
    return doubleToString(arg.analyticalIntegral(code, rangeName));
 }
 
+namespace {
+
+template <class Arg_t>
+void callCodegenImpl(RooAbsArg &arg, CodegenContext &ctx)
+{
+   codegenImpl(static_cast<Arg_t &>(arg), ctx);
+}
+
+template <class... Arg_ts>
+bool registerCodegenImpls()
+{
+   (registerCodegenImpl(typeid(Arg_ts), &callCodegenImpl<Arg_ts>), ...);
+   return true;
+}
+
+// Register the implementations for all classes in this file when the library
+// is loaded, so that codegen() doesn't need the interpreter to dispatch them.
+[[maybe_unused]] const bool codegenImplsRegistered =
+   registerCodegenImpls<RooFit::Detail::RooFixedProdPdf, RooFit::Detail::RooNLLVarNew,
+                        RooFit::Detail::RooNormalizedPdf, ParamHistFunc, PiecewiseInterpolation, RooAddPdf,
+                        RooAddition, RooBernstein, RooBifurGauss, RooCategory, RooCBShape, RooChebychev, RooConstVar,
+                        RooConstraintSum, RooEffProd, RooEfficiency, RooExponential, RooExtendPdf, RooFormulaVar,
+                        RooFunctor1DBinding, RooFunctor1DPdfBinding, RooFunctorBinding, RooFunctorPdfBinding,
+                        RooGamma, RooGaussian, RooGenericPdf, RooHistFunc, RooHistPdf, RooLandau, RooLognormal,
+                        RooMultiPdf, RooMultiVarGaussian, RooONNXFunc, RooParamHistFunc, RooPoisson, RooPolyVar,
+                        RooPolynomial, RooProduct, RooRatio, RooRealIntegral, RooRealSumFunc, RooRealSumPdf,
+                        RooRealVar, RooRecursiveFraction, RooStats::HistFactory::FlexibleInterpVar, RooUniform,
+                        RooWrapperPdf>();
+
+} // namespace
+
 } // namespace RooFit::Experimental
@@ -37,7 +37,7 @@ namespace HistFactory{
 
     void setInterpCode(RooAbsReal& param, int code);
     void setAllInterpCodes(int code);
-    void setGlobalBoundary(double boundary) {_interpBoundary = boundary;}
+    void setGlobalBoundary(double boundary) {_interpBoundary = boundary; _cacheParams.clear(); setValueDirty();}
     void setNominal(double newNominal);
     void setLow(RooAbsReal& param, double newLow);
     void setHigh(RooAbsReal& param, double newHigh);
@@ -73,6 +73,10 @@ namespace HistFactory{
   private:
 
     void setInterpCodeForParam(int iParam, int code);
+    double addContribution(std::size_t iParam, double paramVal, double total) const;
+
+    mutable std::vector<double> _cacheParams;  ///<! Parameter values of the cached contributions
+    mutable std::vector<double> _cacheContrib; ///<! Contributions of the parameters
 
     ClassDefOverride(RooStats::HistFactory::FlexibleInterpVar,2); // flexible interpolation
   };
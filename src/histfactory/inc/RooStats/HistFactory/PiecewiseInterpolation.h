@@ -106,6 +106,19 @@ protected:
 private:
 
   void setInterpCodeForParam(int iParam, int code);
+  void updateContributions(RooFit::EvalContext &ctx, std::size_t n) const;
+
+  // Contributions of the individual parameters in doEval(), together with
+  // the inputs they were computed for
+  mutable std::vector<double> _cacheParams;  ///<! Parameter values
+  mutable std::vector<int> _cacheCodes;      ///<! Interpolation codes
+  mutable std::vector<double> _cacheNominal; ///<! Nominal values
+  mutable std::vector<double> _cacheLow;     ///<! Low-side variations
+  mutable std::vector<double> _cacheHigh;    ///<! High-side variations
+  mutable std::vector<double> _cacheContrib; ///<! Contributions of the parameters
+  mutable std::vector<double> _cacheSum;     ///<! Sum of the nominal values and the contributions
+  mutable std::vector<std::size_t> _cacheVersions; ///<! Versions of the nominal values and variations in the context
+  mutable std::size_t _nIncrementalUpdates = 0;    ///<! Parameter updates since the sum was computed from scratch
 
   ClassDefOverride(PiecewiseInterpolation,4) // Sum of RooAbsReal objects
 };
@@ -25,6 +25,8 @@
 #include <Riostream.h>
 #include <TMath.h>
 
+#include <limits>
+
 
 using namespace RooStats;
 using namespace HistFactory;
@@ -131,6 +133,7 @@ void FlexibleInterpVar::setInterpCodeForParam(int iParam, int code)
 {
    if (Detail::setInterpolationCode(*this, "FlexibleInterpVar", _paramList[iParam], _interpCode, iParam, code,
                                     /*maxCode=*/5)) {
+      _cacheParams.clear();
       setValueDirty();
    }
 }
@@ -141,6 +144,7 @@ void FlexibleInterpVar::setNominal(double newNominal){
   coutW(InputArguments) << "FlexibleInterpVar::setNominal : nominal is now " << newNominal << std::endl ;
   _nominal = newNominal;
 
+  _cacheParams.clear();
   setValueDirty();
 }
 
@@ -157,6 +161,7 @@ void FlexibleInterpVar::setLow(RooAbsReal& param, double newLow){
     _low.at(index) = newLow;
   }
 
+  _cacheParams.clear();
   setValueDirty();
 }
 
@@ -173,6 +178,7 @@ void FlexibleInterpVar::setHigh(RooAbsReal& param, double newHigh){
     _high.at(index) = newHigh;
   }
 
+  _cacheParams.clear();
   setValueDirty();
 }
 
@@ -196,14 +202,8 @@ double FlexibleInterpVar::evaluate() const
 {
    double total(_nominal);
    for (std::size_t i = 0; i < _paramList.size(); ++i) {
-      int code = _interpCode[i];
-      // To get consistent codes with the PiecewiseInterpolation
-      if (code == 4) {
-         code = 5;
-      }
       double paramVal = static_cast<const RooAbsReal *>(&_paramList[i])->getVal();
-      total += RooFit::Detail::MathFuncs::flexibleInterpSingle(code, _low[i], _high[i], _interpBoundary, _nominal,
-                                                               paramVal, total);
+      total = addContribution(i, paramVal, total);
    }
 
    if (total <= 0) {
@@ -218,13 +218,7 @@ void FlexibleInterpVar::doEval(RooFit::EvalContext &ctx) const
    double total(_nominal);
 
    for (std::size_t i = 0; i < _paramList.size(); ++i) {
-      int code = _interpCode[i];
-      // To get consistent codes with the PiecewiseInterpolation
-      if (code == 4) {
-         code = 5;
-      }
-      total += RooFit::Detail::MathFuncs::flexibleInterpSingle(code, _low[i], _high[i], _interpBoundary, _nominal,
-                                                             ctx.at(&_paramList[i])[0], total);
+      total = addContribution(i, ctx.at(&_paramList[i])[0], total);
    }
 
    if (total <= 0) {
@@ -234,6 +228,39 @@ void FlexibleInterpVar::doEval(RooFit::EvalContext &ctx) const
    ctx.output()[0] = total;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Add the contribution of the parameter with index `iParam` to the
+/// accumulated value `total`. The contributions are cached, and only
+/// recomputed if the parameter value changed since the last call. For the
+/// multiplicative interpolation codes, the cached contribution is the relative
+/// change of the accumulated value, such that the result is exactly the same
+/// as if the contribution was recomputed.
+
+double FlexibleInterpVar::addContribution(std::size_t iParam, double paramVal, double total) const
+{
+   if (_cacheParams.size() != _paramList.size()) {
+      // NaN never compares equal, so all contributions get recomputed
+      _cacheParams.assign(_paramList.size(), std::numeric_limits<double>::quiet_NaN());
+      _cacheContrib.assign(_paramList.size(), 0.0);
+   }
+
+   int code = _interpCode[iParam];
+   // To get consistent codes with the PiecewiseInterpolation
+   if (code == 4) {
+      code = 5;
+   }
+   if (paramVal != _cacheParams[iParam]) {
+      _cacheParams[iParam] = paramVal;
+      _cacheContrib[iParam] = RooFit::Detail::MathFuncs::flexibleInterpSingle(
+         code, _low[iParam], _high[iParam], _interpBoundary, _nominal, paramVal, 1.0);
+   }
+
+   if (Detail::isMultiplicativeInterpCode(code)) {
+      return total + total * _cacheContrib[iParam];
+   }
+   return total + _cacheContrib[iParam];
+}
+
 void FlexibleInterpVar::printMultiline(std::ostream& os, Int_t contents,
                    bool verbose, TString indent) const
 {
@@ -44,6 +44,14 @@ inline bool setInterpolationCode(RooAbsReal const &self, const char *className,
    return true;
 }
 
+/// Whether the contribution of a parameter with the given code to
+/// RooFit::Detail::MathFuncs::flexibleInterpSingle() is proportional to the
+/// value that is accumulated before, i.e. the interpolation is multiplicative.
+inline bool isMultiplicativeInterpCode(int code)
+{
+   return code == 1 || code == 5 || code == 6;
+}
+
 } // namespace Detail
 } // namespace HistFactory
 } // namespace RooStats
@@ -222,10 +222,42 @@ inline double broadcast(std::span<const double> const &s, std::size_t i)
    return s.size() > 1 ? s[i] : s[0];
 }
 
+// Copy the first n values to the cache, broadcasting scalars, and return
+// whether any of them is different from the cached value.
+bool updateCache(std::span<const double> values, double *cache, std::size_t n)
+{
+   bool changed = false;
+   for (std::size_t j = 0; j < n; ++j) {
+      const double val = broadcast(values, j);
+      changed |= val != cache[j];
+      cache[j] = val;
+   }
+   return changed;
+}
+
+// Check with the version of the values in the context if an input might have
+// changed since the cache was filled, and update the cached version.
+bool inputMightHaveChanged(RooFit::EvalContext const &ctx, RooAbsArg const *arg, std::size_t &cachedVersion)
+{
+   const std::size_t version = ctx.valueVersion(arg);
+   if (version != 0 && version == cachedVersion) {
+      return false;
+   }
+   cachedVersion = version;
+   return true;
+}
+
 } // namespace
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Interpolate between input distributions for all values of the observable in `evalData`.
+///
+/// If all parameters are scalars, which is the case in a fit, the
+/// contributions of the individual parameters and their sum are cached. Only
+/// the contributions of the parameters that changed since the last call are
+/// recomputed and updated in the sum, which is usually a single parameter
+/// when the minimizer computes numerical derivatives. See
+/// updateContributions() for details.
 /// \param[in,out] ctx Struct holding spans pointing to input data. The results of this function will be stored here.
 void PiecewiseInterpolation::doEval(RooFit::EvalContext &ctx) const
 {
@@ -233,19 +265,27 @@ void PiecewiseInterpolation::doEval(RooFit::EvalContext &ctx) const
 
    auto nominal = ctx.at(_nominal);
 
-   for (std::size_t j = 0; j < sum.size(); ++j) {
-      sum[j] = broadcast(nominal, j);
-   }
-
-   for (unsigned int i = 0; i < _paramSet.size(); ++i) {
-      auto param = ctx.at(_paramSet.at(i));
-      auto low = ctx.at(_lowSet.at(i));
-      auto high = ctx.at(_highSet.at(i));
+   const bool scalarParams = std::all_of(_paramSet.begin(), _paramSet.end(),
+                                         [&](RooAbsArg *param) { return ctx.at(param).size() == 1; });
 
+   if (scalarParams) {
+      updateContributions(ctx, sum.size());
+      std::copy(_cacheSum.begin(), _cacheSum.end(), sum.begin());
+   } else {
       for (std::size_t j = 0; j < sum.size(); ++j) {
-         using RooFit::Detail::MathFuncs::flexibleInterpSingle;
-         sum[j] += flexibleInterpSingle(_interpCode[i], broadcast(low, j), broadcast(high, j), 1.0, broadcast(nominal, j),
-                                        broadcast(param, j), sum[j]);
+         sum[j] = broadcast(nominal, j);
+      }
+
+      for (unsigned int i = 0; i < _paramSet.size(); ++i) {
+         auto param = ctx.at(_paramSet.at(i));
+         auto low = ctx.at(_lowSet.at(i));
+         auto high = ctx.at(_highSet.at(i));
+
+         for (std::size_t j = 0; j < sum.size(); ++j) {
+            using RooFit::Detail::MathFuncs::flexibleInterpSingle;
+            sum[j] += flexibleInterpSingle(_interpCode[i], broadcast(low, j), broadcast(high, j), 1.0,
+                                           broadcast(nominal, j), broadcast(param, j), sum[j]);
+         }
       }
    }
 
@@ -257,6 +297,112 @@ void PiecewiseInterpolation::doEval(RooFit::EvalContext &ctx) const
    }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Recompute the cached contributions of the parameters for `n` output values
+/// if the parameter value, the interpolation code, the nominal value or the
+/// variations changed. For the additive interpolation codes, the contribution
+/// is the difference to the nominal value. For the multiplicative codes, it's
+/// the relative change of the value that is accumulated before.
+///
+/// The nominal values and variations are only compared with the cached values
+/// if the evaluation context doesn't know that they are unchanged. If all
+/// interpolation codes are additive, or all are multiplicative, the changed
+/// contributions are replaced in the cached sum, which costs one pass over the
+/// bins per changed parameter. Otherwise, or if the nominal values changed,
+/// the contributions are summed up again in the order of the parameters. This
+/// is also done after every `nParams` incremental updates, such that the
+/// rounding errors can't build up.
+
+void PiecewiseInterpolation::updateContributions(RooFit::EvalContext &ctx, std::size_t n) const
+{
+   using RooStats::HistFactory::Detail::isMultiplicativeInterpCode;
+
+   const std::size_t nParams = _paramSet.size();
+
+   bool sumAll = false;
+   if (_cacheNominal.size() != n || _cacheParams.size() != nParams) {
+      _cacheParams.assign(nParams, 0.0);
+      _cacheCodes.assign(nParams, -1);
+      _cacheVersions.assign(2 * nParams + 1, 0);
+      _cacheNominal.assign(n, 0.0);
+      _cacheLow.assign(nParams * n, 0.0);
+      _cacheHigh.assign(nParams * n, 0.0);
+      _cacheContrib.assign(nParams * n, 0.0);
+      _cacheSum.assign(n, 0.0);
+      sumAll = true;
+   }
+   const bool nominalChanged = (inputMightHaveChanged(ctx, &_nominal.arg(), _cacheVersions[0]) &&
+                                updateCache(ctx.at(_nominal), _cacheNominal.data(), n)) ||
+                               sumAll;
+   sumAll |= nominalChanged || _nIncrementalUpdates >= nParams;
+
+   const bool allAdditive =
+      std::none_of(_interpCode.begin(), _interpCode.end(), [](int code) { return isMultiplicativeInterpCode(code); });
+   const bool allMultiplicative =
+      std::all_of(_interpCode.begin(), _interpCode.end(), [](int code) { return isMultiplicativeInterpCode(code); });
+
+   for (std::size_t i = 0; i < nParams; ++i) {
+      const double param = ctx.at(_paramSet.at(i))[0];
+      double *low = _cacheLow.data() + i * n;
+      double *high = _cacheHigh.data() + i * n;
+
+      bool changed = inputMightHaveChanged(ctx, &_lowSet[i], _cacheVersions[2 * i + 1]) &&
+                     updateCache(ctx.at(_lowSet.at(i)), low, n);
+      changed |= inputMightHaveChanged(ctx, &_highSet[i], _cacheVersions[2 * i + 2]) &&
+                 updateCache(ctx.at(_highSet.at(i)), high, n);
+      changed |= nominalChanged || param != _cacheParams[i];
+      if (_interpCode[i] != _cacheCodes[i]) {
+         changed = true;
+         sumAll = true;
+      }
+      if (!changed) {
+         continue;
+      }
+
+      _cacheParams[i] = param;
+      _cacheCodes[i] = _interpCode[i];
+      double *contrib = _cacheContrib.data() + i * n;
+      for (std::size_t j = 0; j < n; ++j) {
+         // With an accumulated value of one, the result for the multiplicative
+         // codes is the relative change.
+         using RooFit::Detail::MathFuncs::flexibleInterpSingle;
+         const double newContrib =
+            flexibleInterpSingle(_interpCode[i], low[j], high[j], 1.0, _cacheNominal[j], param, 1.0);
+         if (sumAll) {
+            // nothing to update, the sum is computed from scratch below
+         } else if (allAdditive) {
+            _cacheSum[j] += newContrib - contrib[j];
+         } else if (allMultiplicative && 1.0 + contrib[j] != 0.0) {
+            _cacheSum[j] *= (1.0 + newContrib) / (1.0 + contrib[j]);
+         } else {
+            // A factor of zero can't be divided out.
+            sumAll = true;
+         }
+         contrib[j] = newContrib;
+      }
+      ++_nIncrementalUpdates;
+   }
+
+   if (!sumAll) {
+      return;
+   }
+
+   std::copy(_cacheNominal.begin(), _cacheNominal.end(), _cacheSum.begin());
+   for (std::size_t i = 0; i < nParams; ++i) {
+      const double *contrib = _cacheContrib.data() + i * n;
+      if (isMultiplicativeInterpCode(_interpCode[i])) {
+         for (std::size_t j = 0; j < n; ++j) {
+            _cacheSum[j] += _cacheSum[j] * contrib[j];
+         }
+      } else {
+         for (std::size_t j = 0; j < n; ++j) {
+            _cacheSum[j] += contrib[j];
+         }
+      }
+   }
+   _nIncrementalUpdates = 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 bool PiecewiseInterpolation::setBinIntegrator(RooArgSet& allVars)
@@ -3,10 +3,18 @@
 
 #include <RooStats/HistFactory/PiecewiseInterpolation.h>
 
+#include <RooDataHist.h>
+#include <RooFit/Evaluator.h>
+#include <RooHistFunc.h>
 #include <RooRealVar.h>
 
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
 /// Validate that the interpolation codes are "additive" or "multiplicative" as documented.
 TEST(PiecewiseInterpolation, AdditiveOrMultiplicative)
 {
@@ -120,3 +128,111 @@ TEST(PiecewiseInterpolation, ConstructWithPerParameterCodes)
 
    EXPECT_EQ(interpolation.interpolationCodes(), (std::vector<int>{0, 2}));
 }
+
+/// The Evaluator only recomputes the contributions of the parameters that
+/// changed, which has to give exactly the same result as the full computation.
+TEST(PiecewiseInterpolation, EvaluatorWithChangingParameters)
+{
+   RooRealVar nominal{"nominal", "nominal", 2.0};
+
+   RooArgList params;
+   RooArgList lows;
+   RooArgList highs;
+   std::vector<int> codes{0, 1, 2, 4, 5, 6};
+   for (std::size_t i = 0; i < codes.size(); ++i) {
+      std::string suffix = "_" + std::to_string(i);
+      params.addOwned(std::make_unique<RooRealVar>(("param" + suffix).c_str(), "", 0.1 * i, -3.0, 3.0));
+      lows.addOwned(std::make_unique<RooRealVar>(("low" + suffix).c_str(), "", 2.0 - 0.1 * (i + 1)));
+      highs.addOwned(std::make_unique<RooRealVar>(("high" + suffix).c_str(), "", 2.0 + 0.15 * (i + 1)));
+   }
+
+   PiecewiseInterpolation interpolation{"interpolation", "", nominal, lows, highs, params, codes};
+   RooFit::Evaluator evaluator{interpolation};
+
+   auto checkEqual = [&]() {
+      // The legacy evaluation computes all contributions.
+      interpolation.setValueDirty();
+      EXPECT_DOUBLE_EQ(evaluator.run()[0], interpolation.getVal());
+   };
+
+   checkEqual();
+   for (std::size_t i = 0; i < codes.size(); ++i) {
+      auto &param = static_cast<RooRealVar &>(params[i]);
+      for (double val : {-1.7, -0.4, 0.6, 1.3}) {
+         param.setVal(val);
+         checkEqual();
+      }
+   }
+
+   // Changing a variation or the nominal value also has to be picked up.
+   static_cast<RooRealVar &>(highs[2]).setVal(2.9);
+   checkEqual();
+   nominal.setVal(2.2);
+   checkEqual();
+}
+
+/// With histograms as nominal values and variations, the Evaluator updates
+/// the cached sum with the contributions of the changed parameters only if
+/// all interpolation codes are additive or all are multiplicative. The result
+/// still has to be the same as the full computation in every bin.
+TEST(PiecewiseInterpolation, EvaluatorWithHistogramNominal)
+{
+   constexpr int nBins = 10;
+   RooRealVar x{"x", "x", 0.0, 0.0, 10.0};
+   x.setBins(nBins);
+
+   std::vector<std::unique_ptr<RooDataHist>> dataHists;
+   auto makeHistFunc = [&](std::string const &name, double scale) {
+      dataHists.emplace_back(std::make_unique<RooDataHist>((name + "_hist").c_str(), "", x));
+      for (int i = 0; i < nBins; ++i) {
+         dataHists.back()->set(i, scale * (10.0 + i), 0.0);
+      }
+      return std::make_unique<RooHistFunc>(name.c_str(), "", RooArgSet{x}, *dataHists.back());
+   };
+
+   std::vector<double> xValues;
+   for (int i = 0; i < nBins; ++i) {
+      xValues.push_back(i + 0.5);
+   }
+
+   for (std::vector<int> codes : {std::vector<int>{0, 2, 4}, std::vector<int>{1, 5, 6}}) {
+      std::unique_ptr<RooHistFunc> nominal = makeHistFunc("nominal", 1.0);
+
+      RooArgList params;
+      RooArgList lows;
+      RooArgList highs;
+      for (std::size_t i = 0; i < codes.size(); ++i) {
+         std::string suffix = "_" + std::to_string(i);
+         params.addOwned(std::make_unique<RooRealVar>(("param" + suffix).c_str(), "", 0.0, -3.0, 3.0));
+         lows.addOwned(makeHistFunc("low" + suffix, 1.0 - 0.05 * (i + 1)));
+         highs.addOwned(makeHistFunc("high" + suffix, 1.0 + 0.1 * (i + 1)));
+      }
+
+      PiecewiseInterpolation interpolation{"interpolation", "", *nominal, lows, highs, params, codes};
+      RooFit::Evaluator evaluator{interpolation};
+      evaluator.setInput(x.GetName(), xValues, false);
+
+      auto checkEqual = [&]() {
+         std::span<const double> results = evaluator.run();
+         ASSERT_EQ(results.size(), xValues.size());
+         for (int i = 0; i < nBins; ++i) {
+            x.setVal(xValues[i]);
+            const double ref = interpolation.getVal();
+            EXPECT_NEAR(results[i], ref, 1e-12 * std::abs(ref));
+         }
+      };
+
+      checkEqual();
+      // Enough parameter changes to also trigger the regular recomputation of
+      // the sum from scratch.
+      for (int iter = 0; iter < 3; ++iter) {
+         for (std::size_t i = 0; i < codes.size(); ++i) {
+            auto &param = static_cast<RooRealVar &>(params[i]);
+            for (double val : {-1.7, -0.4, 0.6, 1.3}) {
+               param.setVal(val + 0.1 * iter);
+               checkEqual();
+            }
+         }
+      }
+   }
+}
@@ -24,6 +24,7 @@
 #include <stdexcept>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 namespace RooFit {
 namespace JSONIO {
@@ -40,11 +41,17 @@ class RooRealVar;
 class RooJSONFactoryWSTool {
 public:
    static constexpr bool useListsInsteadOfDicts = true;
+   static constexpr const char *base64ArrayEncoding = "base64-float64-le";
 
    struct Config {
       bool allowExportInvalidNames = true;
       bool allowSanitizeNames = true;
       bool importNoDomainParametersAsRooConstVars = true;
+      /// Arrays with at least this many elements, like the bin contents of
+      /// histograms, are exported as base64-encoded binary doubles instead of
+      /// a list of numbers. This is a ROOT extension of the HS3 standard, so it
+      /// is disabled by default (zero).
+      std::size_t base64ArrayThreshold = 0;
    };
 
    static Config &config();
@@ -143,6 +150,7 @@ public:
    static RooArgSet readAxes(const RooFit::Detail::JSONNode &node);
    static std::unique_ptr<RooDataHist>
    readBinnedData(const RooFit::Detail::JSONNode &n, const std::string &namecomp, RooArgSet const &vars);
+   static void readArray(const RooFit::Detail::JSONNode &n, const std::string &what, std::vector<double> &out);
 
    bool importJSON(std::string const &filename);
    bool importJSON(std::istream &os);
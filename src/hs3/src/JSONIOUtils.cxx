@@ -2,6 +2,9 @@
 
 #include <RooAbsBinning.h>
 
+#include <array>
+#include <cstdint>
+#include <cstring>
 #include <string>
 
 using RooFit::Detail::JSONNode;
@@ -100,3 +103,96 @@ void writeAxisBinning(JSONNode &node, const RooAbsBinning &binning)
       edges.append_child() << binning.binHigh(i);
    }
 }
+
+namespace {
+
+constexpr char base64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+} // namespace
+
+/// Encode an array of doubles as base64 string of the little-endian IEEE 754
+/// representation. This is much more compact than the decimal representation
+/// for large arrays, and the values are stored without loss of precision.
+std::string encodeBase64Doubles(std::size_t n, double const *values)
+{
+   std::vector<unsigned char> bytes(8 * n);
+   for (std::size_t i = 0; i < n; ++i) {
+      // Write the bytes explicitly from least to most significant, such that
+      // the encoded arrays can be read on any platform.
+      std::uint64_t bits = 0;
+      std::memcpy(&bits, values + i, 8);
+      for (std::size_t k = 0; k < 8; ++k) {
+         bytes[8 * i + k] = (bits >> (8 * k)) & 0xff;
+      }
+   }
+
+   std::string out;
+   out.reserve(4 * ((bytes.size() + 2) / 3));
+   std::size_t i = 0;
+   for (; i + 3 <= bytes.size(); i += 3) {
+      const std::uint32_t triple = (bytes[i] << 16) | (bytes[i + 1] << 8) | bytes[i + 2];
+      out += base64Alphabet[(triple >> 18) & 0x3f];
+      out += base64Alphabet[(triple >> 12) & 0x3f];
+      out += base64Alphabet[(triple >> 6) & 0x3f];
+      out += base64Alphabet[triple & 0x3f];
+   }
+   const std::size_t rest = bytes.size() - i;
+   if (rest > 0) {
+      const std::uint32_t triple = (bytes[i] << 16) | (rest == 2 ? bytes[i + 1] << 8 : 0);
+      out += base64Alphabet[(triple >> 18) & 0x3f];
+      out += base64Alphabet[(triple >> 12) & 0x3f];
+      out += rest == 2 ? base64Alphabet[(triple >> 6) & 0x3f] : '=';
+      out += '=';
+   }
+   return out;
+}
+
+/// Decode a string created with encodeBase64Doubles() into the output vector.
+/// Returns `false` if the string is not valid base64 or if the number of
+/// bytes is not a multiple of the size of a double.
+bool decodeBase64Doubles(std::string_view encoded, std::vector<double> &out)
+{
+   static const std::array<signed char, 256> lookup = [] {
+      std::array<signed char, 256> table;
+      table.fill(-1);
+      for (int i = 0; i < 64; ++i) {
+         table[static_cast<unsigned char>(base64Alphabet[i])] = i;
+      }
+      return table;
+   }();
+
+   while (!encoded.empty() && encoded.back() == '=') {
+      encoded.remove_suffix(1);
+   }
+   const std::size_t nBytes = encoded.size() * 3 / 4;
+   if (encoded.size() % 4 == 1 || nBytes % 8 != 0) {
+      return false;
+   }
+
+   std::vector<unsigned char> bytes;
+   bytes.reserve(nBytes + 2);
+   std::uint32_t buffer = 0;
+   int nBits = 0;
+   for (char c : encoded) {
+      const int value = lookup[static_cast<unsigned char>(c)];
+      if (value < 0) {
+         return false;
+      }
+      buffer = (buffer << 6) | value;
+      nBits += 6;
+      if (nBits >= 8) {
+         nBits -= 8;
+         bytes.push_back((buffer >> nBits) & 0xff);
+      }
+   }
+
+   out.resize(nBytes / 8);
+   for (std::size_t i = 0; i < out.size(); ++i) {
+      std::uint64_t bits = 0;
+      for (std::size_t k = 0; k < 8; ++k) {
+         bits |= static_cast<std::uint64_t>(bytes[8 * i + k]) << (8 * k);
+      }
+      std::memcpy(&out[i], &bits, 8);
+   }
+   return true;
+}
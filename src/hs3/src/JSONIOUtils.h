@@ -2,6 +2,7 @@
 #define JSONIOUtils_h
 
 #include <string_view>
+#include <vector>
 #include <RooFit/Detail/JSONInterface.h>
 
 class RooAbsBinning;
@@ -11,5 +12,7 @@ bool endsWith(std::string_view str, std::string_view suffix);
 std::string removeSuffix(std::string_view str, std::string_view suffix);
 std::unique_ptr<RooFit::Detail::JSONTree> varJSONString(const RooFit::Detail::JSONNode &treeRoot);
 void writeAxisBinning(RooFit::Detail::JSONNode &node, const RooAbsBinning &binning);
+std::string encodeBase64Doubles(std::size_t n, double const *values);
+bool decodeBase64Doubles(std::string_view encoded, std::vector<double> &out);
 
 #endif
@@ -1264,6 +1264,11 @@ void RooJSONFactoryWSTool::exportHisto(RooArgSet const &vars, std::size_t n, dou
  * This function exports an array of doubles, represented by the provided size and contents,
  * to a JSONNode. The array elements are added to the JSONNode as a sequence of values.
  *
+ * If the array has at least RooJSONFactoryWSTool::Config::base64ArrayThreshold elements,
+ * it is exported as a map instead, with the base64 encoding of the little-endian doubles:
+ * `{"encoding": "base64-float64-le", "data": "..."}`. This is much faster to read and
+ * write for large histograms, and readBinnedData() decodes it directly.
+ *
  * @param n The size of the array.
  * @param contents A pointer to the array containing the double values.
  * @param output The JSONNode to which the array will be exported.
@@ -1271,6 +1276,14 @@ void RooJSONFactoryWSTool::exportHisto(RooArgSet const &vars, std::size_t n, dou
  */
 void RooJSONFactoryWSTool::exportArray(std::size_t n, double const *contents, JSONNode &output)
 {
+   const std::size_t base64Threshold = config().base64ArrayThreshold;
+   if (base64Threshold > 0 && n >= base64Threshold) {
+      output.set_map();
+      output["encoding"] << base64ArrayEncoding;
+      output["data"] << encodeBase64Doubles(n, contents);
+      return;
+   }
+
    output.set_seq();
    for (std::size_t i = 0; i < n; ++i) {
       double w = contents[i];
@@ -1527,44 +1540,67 @@ RooJSONFactoryWSTool::readBinnedData(const JSONNode &n, const std::string &name,
    if (!n.has_child("contents"))
       RooJSONFactoryWSTool::error("no contents given");
 
-   JSONNode const &contents = n["contents"];
-
-   if (!contents.is_seq())
-      RooJSONFactoryWSTool::error("contents are not in list form");
+   std::vector<double> contentVals;
+   readArray(n["contents"], "contents", contentVals);
 
-   JSONNode const *errors = nullptr;
-   if (n.has_child("errors")) {
-      errors = &n["errors"];
-      if (!errors->is_seq())
-         RooJSONFactoryWSTool::error("errors are not in list form");
+   const bool hasErrors = n.has_child("errors");
+   std::vector<double> errorVals;
+   if (hasErrors) {
+      readArray(n["errors"], "errors", errorVals);
    }
 
    auto bins = generateBinIndices(vars);
-   if (contents.num_children() != bins.size()) {
+   if (contentVals.size() != bins.size()) {
       std::stringstream errMsg;
-      errMsg << "inconsistent bin numbers: contents=" << contents.num_children() << ", bins=" << bins.size();
+      errMsg << "inconsistent bin numbers: contents=" << contentVals.size() << ", bins=" << bins.size();
       RooJSONFactoryWSTool::error(errMsg.str());
    }
-   auto dh = std::make_unique<RooDataHist>(name, name, vars);
-   std::vector<double> contentVals;
-   contentVals.reserve(contents.num_children());
-   for (auto const &cont : contents.children()) {
-      contentVals.push_back(cont.val_double());
-   }
-   std::vector<double> errorVals;
-   if (errors) {
-      errorVals.reserve(errors->num_children());
-      for (auto const &err : errors->children()) {
-         errorVals.push_back(err.val_double());
-      }
+   if (hasErrors && errorVals.size() != bins.size()) {
+      std::stringstream errMsg;
+      errMsg << "inconsistent bin numbers: errors=" << errorVals.size() << ", bins=" << bins.size();
+      RooJSONFactoryWSTool::error(errMsg.str());
    }
+   auto dh = std::make_unique<RooDataHist>(name, name, vars);
    for (size_t ibin = 0; ibin < bins.size(); ++ibin) {
-      const double err = errors ? errorVals[ibin] : -1;
+      const double err = hasErrors ? errorVals[ibin] : -1;
       dh->set(ibin, contentVals[ibin], err);
    }
    return dh;
 }
 
+/**
+ * @brief Read an array of doubles that was exported with exportArray().
+ *
+ * The array can be given either as a list of numbers, or as a map with the
+ * base64-encoded binary doubles. In the latter case, the values are decoded
+ * directly into the output vector without creating a JSONNode per element.
+ *
+ * @param n The JSONNode with the array.
+ * @param what The name of the array, used in the error messages.
+ * @param out The vector to which the values are written.
+ */
+void RooJSONFactoryWSTool::readArray(const JSONNode &n, const std::string &what, std::vector<double> &out)
+{
+   out.clear();
+   if (n.is_seq()) {
+      out.reserve(n.num_children());
+      for (auto const &elem : n.children()) {
+         out.push_back(elem.val_double());
+      }
+      return;
+   }
+   if (!n.is_map() || !n.has_child("encoding") || !n.has_child("data")) {
+      RooJSONFactoryWSTool::error(what + " are not in list form");
+   }
+   const std::string encoding = n["encoding"].val();
+   if (encoding != base64ArrayEncoding) {
+      RooJSONFactoryWSTool::error("unknown encoding \"" + encoding + "\" of " + what);
+   }
+   if (!decodeBase64Doubles(n["data"].val(), out)) {
+      RooJSONFactoryWSTool::error("invalid base64 data in " + what);
+   }
+}
+
 // Import a single variable (RooRealVar or RooConstVar) from the JSON node `p` into the workspace.
 void RooJSONFactoryWSTool::importVariable(const JSONNode &p)
 {
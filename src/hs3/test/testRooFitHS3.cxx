@@ -1505,6 +1505,41 @@ TEST(RooFitHS3, WorkspaceOnlyDataset_RooDataHist)
    EXPECT_EQ(status, 0);
 }
 
+// -----------------------------------------------------------------------------
+// Large histograms can be exported with base64-encoded bin contents, which are
+// read back without loss of precision.
+// -----------------------------------------------------------------------------
+TEST(RooFitHS3, RooDataHistBase64Contents)
+{
+   RooWorkspace ws1{"ws_base64"};
+
+   RooRealVar x{"x", "x", 0.0, 1.0};
+   x.setBins(1000);
+   RooDataHist dh{"dh", "dh", RooArgList{x}};
+   for (int i = 0; i < dh.numEntries(); ++i) {
+      dh.set(i, 1.0 / (i + 3), -1.0);
+   }
+   ws1.import(dh, RooFit::Silence());
+
+   auto &config = RooJSONFactoryWSTool::config();
+   const std::size_t oldThreshold = config.base64ArrayThreshold;
+   config.base64ArrayThreshold = 100;
+   const std::string json = RooJSONFactoryWSTool{ws1}.exportJSONtoString();
+   config.base64ArrayThreshold = oldThreshold;
+
+   EXPECT_NE(json.find(RooJSONFactoryWSTool::base64ArrayEncoding), std::string::npos);
+
+   RooWorkspace ws2{"ws_base64_2"};
+   RooJSONFactoryWSTool{ws2}.importJSONfromString(json);
+
+   auto *dh2 = dynamic_cast<RooDataHist *>(ws2.data("dh"));
+   ASSERT_NE(dh2, nullptr);
+   ASSERT_EQ(dh2->numEntries(), dh.numEntries());
+   for (int i = 0; i < dh.numEntries(); ++i) {
+      EXPECT_EQ(dh2->weight(i), dh.weight(i));
+   }
+}
+
 // -----------------------------------------------------------------------------
 // Workspace with ONLY a function (no dataset, no pdfs).
 // -----------------------------------------------------------------------------
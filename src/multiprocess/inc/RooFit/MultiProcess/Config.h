@@ -26,6 +26,19 @@ public:
    static void setDefaultNWorkers(unsigned int N_workers);
    static unsigned int getDefaultNWorkers();
 
+   /// Sets the default number of workers for its lifetime and restores the
+   /// previous default when it goes out of scope.
+   class LocalDefaultNWorkers {
+   public:
+      explicit LocalDefaultNWorkers(unsigned int N_workers);
+      ~LocalDefaultNWorkers();
+      LocalDefaultNWorkers(const LocalDefaultNWorkers &) = delete;
+      LocalDefaultNWorkers &operator=(const LocalDefaultNWorkers &) = delete;
+
+   private:
+      unsigned int oldNWorkers_;
+   };
+
    static void setTimingAnalysis(bool timingAnalysis);
    static bool getTimingAnalysis();
 
@@ -47,6 +60,17 @@ public:
    private:
       static QueueType queueType_;
    };
+
+   struct Messenger {
+      enum class Transport {ZeroMQ, SharedMemory};
+      static bool setTransport(Transport transport);
+      static Transport getTransport();
+      static bool setSharedMemoryCapacity(std::size_t capacity);
+      static std::size_t getSharedMemoryCapacity();
+   private:
+      static Transport transport_;
+      static std::size_t sharedMemoryCapacity_;
+   };
 private:
    static unsigned int defaultNWorkers_;
    static bool timingAnalysis_;
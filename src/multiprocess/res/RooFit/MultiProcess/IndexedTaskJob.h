@@ -0,0 +1,62 @@
+/*
+ * Project: RooFit
+ *
+ * Copyright (c) 2024, CERN
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted according to the terms
+ * listed in LICENSE (http://roofit.sourceforge.net/license.txt)
+ */
+#ifndef ROOT_ROOFIT_MultiProcess_IndexedTaskJob
+#define ROOT_ROOFIT_MultiProcess_IndexedTaskJob
+
+#include "RooFit/MultiProcess/Job.h"
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace RooFit {
+namespace MultiProcess {
+
+class IndexedTaskJob : public Job {
+public:
+   /// Evaluates task `task`, fills `buffer` with the serialized result, and
+   /// returns whether the task succeeded.
+   using EvaluateTaskFn = std::function<bool(std::size_t task, std::vector<char> &buffer)>;
+
+   struct TaskResult {
+      bool valid = false;
+      std::vector<char> buffer;
+   };
+
+   explicit IndexedTaskJob(EvaluateTaskFn evaluateTask);
+
+   void run(std::size_t firstTask, std::size_t lastTask);
+   void run(std::vector<std::size_t> const &tasks);
+   std::map<std::size_t, TaskResult> &results() { return results_; }
+
+   // Job overrides:
+   void evaluate_task(std::size_t task) override;
+   void send_back_task_result_from_worker(std::size_t task) override;
+   bool receive_task_result_on_master(const zmq::message_t &message) override;
+
+   struct task_result_t {
+      std::size_t job_id; // job ID must always be the first part of any result message/type
+      std::size_t task;
+      bool valid;
+      std::size_t n_bytes;
+   };
+
+private:
+   EvaluateTaskFn evaluateTask_;
+   std::map<std::size_t, TaskResult> results_;
+   TaskResult workerResult_;
+   std::size_t n_tasks_at_workers_ = 0;
+};
+
+} // namespace MultiProcess
+} // namespace RooFit
+
+#endif // ROOT_ROOFIT_MultiProcess_IndexedTaskJob
@@ -15,6 +15,8 @@
 
 #include "RooFit/MultiProcess/Messenger_decl.h"
 
+#include <type_traits>
+
 #ifdef NDEBUG
 #undef NDEBUG
 #define turn_NDEBUG_back_on
@@ -23,6 +25,51 @@
 namespace RooFit {
 namespace MultiProcess {
 
+// -- TRANSPORT --
+
+template <typename value_t>
+value_t Messenger::receive_over_zmq(zmq::socket_t &socket, ZeroMQPoller &poller, bool *more)
+{
+   poller.ppoll(-1, &ppoll_sigmask);
+   return zmqSvc().receive<value_t>(socket, zmq::recv_flags::dontwait, more);
+}
+
+/// Send a message over the shared memory transport, encoded like for the
+/// ZeroMQ sockets.
+template <typename T>
+void Messenger::send_over_shm(SharedMemoryChannel &channel, const T &item, bool more)
+{
+   if constexpr (std::is_same<std::decay_t<T>, zmq::message_t>::value) {
+      channel.send(item.data(), item.size(), more);
+   } else {
+      auto msg = zmqSvc().encode(item);
+      channel.send(msg.data(), msg.size(), more);
+   }
+}
+
+/// Receive a message over the shared memory transport. The poller must
+/// contain the file descriptor of the channel, and is used to wait for the
+/// message like for the ZeroMQ sockets.
+template <typename value_t>
+value_t Messenger::receive_over_shm(SharedMemoryChannel &channel, ZeroMQPoller &poller, bool *more)
+{
+   zmq::message_t msg;
+   while (!channel.try_receive(msg, more)) {
+      poller.ppoll(-1, &ppoll_sigmask);
+   }
+   return decode_message<value_t>(std::move(msg));
+}
+
+template <typename value_t>
+value_t Messenger::decode_message(zmq::message_t &&msg)
+{
+   if constexpr (std::is_same<value_t, zmq::message_t>::value) {
+      return std::move(msg);
+   } else {
+      return zmqSvc().decode<value_t>(msg);
+   }
+}
+
 // -- WORKER - QUEUE COMMUNICATION --
 
 template <typename T, typename... Ts>
@@ -34,7 +81,11 @@ void Messenger::send_from_worker_to_queue(T item, Ts... items)
    debug_print(ss.str());
 #endif
 
-   zmqSvc().send(*this_worker_qw_push_, item, send_flag_);
+   if (shm_) {
+      send_over_shm(*shm_->worker_to_queue[worker_id_], item);
+   } else {
+      zmqSvc().send(*this_worker_qw_push_, item, send_flag_);
+   }
    //      if (sizeof...(items) > 0) {  // this will only work with if constexpr, c++17
    send_from_worker_to_queue(items...);
 }
@@ -42,8 +93,9 @@ void Messenger::send_from_worker_to_queue(T item, Ts... items)
 template <typename value_t>
 value_t Messenger::receive_from_worker_on_queue(std::size_t this_worker_id)
 {
-   qw_pull_poller_[this_worker_id].ppoll(-1, &ppoll_sigmask);
-   auto value = zmqSvc().receive<value_t>(*qw_pull_[this_worker_id], zmq::recv_flags::dontwait);
+   auto value = shm_ ? receive_over_shm<value_t>(*shm_->worker_to_queue[this_worker_id],
+                                                 qw_pull_poller_[this_worker_id])
+                     : receive_over_zmq<value_t>(*qw_pull_[this_worker_id], qw_pull_poller_[this_worker_id]);
 
 #ifndef NDEBUG
    std::stringstream ss;
@@ -63,7 +115,11 @@ void Messenger::send_from_queue_to_worker(std::size_t this_worker_id, T item, Ts
    debug_print(ss.str());
 #endif
 
-   zmqSvc().send(*qw_push_[this_worker_id], item, send_flag_);
+   if (shm_) {
+      send_over_shm(*shm_->queue_to_worker[this_worker_id], item);
+   } else {
+      zmqSvc().send(*qw_push_[this_worker_id], item, send_flag_);
+   }
    //      if (sizeof...(items) > 0) {  // this will only work with if constexpr, c++17
    send_from_queue_to_worker(this_worker_id, items...);
 }
@@ -71,8 +127,8 @@ void Messenger::send_from_queue_to_worker(std::size_t this_worker_id, T item, Ts
 template <typename value_t>
 value_t Messenger::receive_from_queue_on_worker()
 {
-   qw_pull_poller_[0].ppoll(-1, &ppoll_sigmask);
-   auto value = zmqSvc().receive<value_t>(*this_worker_qw_pull_, zmq::recv_flags::dontwait);
+   auto value = shm_ ? receive_over_shm<value_t>(*shm_->queue_to_worker[worker_id_], qw_pull_poller_[0])
+                     : receive_over_zmq<value_t>(*this_worker_qw_pull_, qw_pull_poller_[0]);
 
 #ifndef NDEBUG
    std::stringstream ss;
@@ -94,7 +150,11 @@ void Messenger::send_from_queue_to_master(T item, Ts... items)
    debug_print(ss.str());
 #endif
 
-   zmqSvc().send(*mq_push_, item, send_flag_);
+   if (shm_) {
+      send_over_shm(shm_->queue_to_master, item);
+   } else {
+      zmqSvc().send(*mq_push_, item, send_flag_);
+   }
    //      if (sizeof...(items) > 0) {  // this will only work with if constexpr, c++17
    send_from_queue_to_master(items...);
 }
@@ -102,8 +162,8 @@ void Messenger::send_from_queue_to_master(T item, Ts... items)
 template <typename value_t>
 value_t Messenger::receive_from_queue_on_master()
 {
-   mq_pull_poller_.ppoll(-1, &ppoll_sigmask);
-   auto value = zmqSvc().receive<value_t>(*mq_pull_, zmq::recv_flags::dontwait);
+   auto value = shm_ ? receive_over_shm<value_t>(shm_->queue_to_master, mq_pull_poller_)
+                     : receive_over_zmq<value_t>(*mq_pull_, mq_pull_poller_);
 
 #ifndef NDEBUG
    std::stringstream ss;
@@ -123,7 +183,11 @@ void Messenger::send_from_master_to_queue(T item, Ts... items)
    debug_print(ss.str());
 #endif
 
-   zmqSvc().send(*mq_push_, item, send_flag_);
+   if (shm_) {
+      send_over_shm(shm_->master_to_queue, item);
+   } else {
+      zmqSvc().send(*mq_push_, item, send_flag_);
+   }
    //      if (sizeof...(items) > 0) {  // this will only work with if constexpr, c++17
    send_from_master_to_queue(items...);
 }
@@ -131,8 +195,8 @@ void Messenger::send_from_master_to_queue(T item, Ts... items)
 template <typename value_t>
 value_t Messenger::receive_from_master_on_queue()
 {
-   mq_pull_poller_.ppoll(-1, &ppoll_sigmask);
-   auto value = zmqSvc().receive<value_t>(*mq_pull_, zmq::recv_flags::dontwait);
+   auto value = shm_ ? receive_over_shm<value_t>(shm_->master_to_queue, mq_pull_poller_)
+                     : receive_over_zmq<value_t>(*mq_pull_, mq_pull_poller_);
 
 #ifndef NDEBUG
    std::stringstream ss;
@@ -155,7 +219,13 @@ void Messenger::publish_from_master_to_workers(T &&item)
    debug_print(ss.str());
 #endif
 
-   zmqSvc().send(*mw_pub_, std::forward<T>(item), send_flag_);
+   if (shm_) {
+      for (auto &channel : shm_->master_to_worker) {
+         send_over_shm(*channel, item);
+      }
+   } else {
+      zmqSvc().send(*mw_pub_, std::forward<T>(item), send_flag_);
+   }
 }
 
 /// specialization that queues first parts of multipart messages
@@ -168,15 +238,21 @@ void Messenger::publish_from_master_to_workers(T &&item, T2 &&item2, Ts &&...ite
    debug_print(ss.str());
 #endif
 
-   zmqSvc().send(*mw_pub_, std::forward<T>(item), send_flag_ | zmq::send_flags::sndmore);
+   if (shm_) {
+      for (auto &channel : shm_->master_to_worker) {
+         send_over_shm(*channel, item, true);
+      }
+   } else {
+      zmqSvc().send(*mw_pub_, std::forward<T>(item), send_flag_ | zmq::send_flags::sndmore);
+   }
    publish_from_master_to_workers(std::forward<T2>(item2), std::forward<Ts>(items)...);
 }
 
 template <typename value_t>
 value_t Messenger::receive_from_master_on_worker(bool *more)
 {
-   mw_sub_poller_.ppoll(-1, &ppoll_sigmask);
-   auto value = zmqSvc().receive<value_t>(*mw_sub_, zmq::recv_flags::dontwait, more);
+   auto value = shm_ ? receive_over_shm<value_t>(*shm_->master_to_worker[worker_id_], mw_sub_poller_, more)
+                     : receive_over_zmq<value_t>(*mw_sub_, mw_sub_poller_, more);
 
 #ifndef NDEBUG
    std::stringstream ss;
@@ -197,7 +273,11 @@ void Messenger::send_from_worker_to_master(T &&item)
    debug_print(ss.str());
 #endif
 
-   zmqSvc().send(*wm_push_, std::forward<T>(item), send_flag_);
+   if (shm_) {
+      send_over_shm(*shm_->worker_to_master[worker_id_], item);
+   } else {
+      zmqSvc().send(*wm_push_, std::forward<T>(item), send_flag_);
+   }
 }
 
 /// specialization that queues first parts of multipart messages
@@ -210,7 +290,11 @@ void Messenger::send_from_worker_to_master(T &&item, T2 &&item2, Ts &&...items)
    debug_print(ss.str());
 #endif
 
-   zmqSvc().send(*wm_push_, std::forward<T>(item), send_flag_ | zmq::send_flags::sndmore);
+   if (shm_) {
+      send_over_shm(*shm_->worker_to_master[worker_id_], item, true);
+   } else {
+      zmqSvc().send(*wm_push_, std::forward<T>(item), send_flag_ | zmq::send_flags::sndmore);
+   }
    //      if (sizeof...(items) > 0) {  // this will only work with if constexpr, c++17
    send_from_worker_to_master(std::forward<T2>(item2), std::forward<Ts>(items)...);
 }
@@ -218,8 +302,8 @@ void Messenger::send_from_worker_to_master(T &&item, T2 &&item2, Ts &&...items)
 template <typename value_t>
 value_t Messenger::receive_from_worker_on_master(bool *more)
 {
-   wm_pull_poller_.ppoll(-1, &ppoll_sigmask);
-   auto value = zmqSvc().receive<value_t>(*wm_pull_, zmq::recv_flags::dontwait, more);
+   auto value = shm_ ? decode_message<value_t>(receive_from_workers_over_shm(more))
+                     : receive_over_zmq<value_t>(*wm_pull_, wm_pull_poller_, more);
 
 #ifndef NDEBUG
    std::stringstream ss;
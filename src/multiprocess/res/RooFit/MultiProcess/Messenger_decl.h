@@ -14,10 +14,12 @@
 #define ROOT_ROOFIT_MultiProcess_Messenger_decl
 
 #include "RooFit/MultiProcess/ProcessManager.h"
+#include "RooFit/MultiProcess/SharedMemoryChannel.h"
 #include "RooFit_ZMQ/ZeroMQSvc.h"
 #include "RooFit_ZMQ/ZeroMQPoller.h"
 
 #include <iosfwd>
+#include <memory> // unique_ptr
 #include <vector>
 #include <csignal> // sigprocmask, sigset_t, etc
 #include <string>
@@ -32,7 +34,8 @@ enum class X2X : int { ping = -1, pong = -2, initial_value = 0 };
 
 class Messenger {
 public:
-   explicit Messenger(const ProcessManager &process_manager);
+   explicit Messenger(const ProcessManager &process_manager,
+                      std::unique_ptr<SharedMemoryChannels> shared_memory_channels = nullptr);
    ~Messenger();
 
    void test_connections(const ProcessManager &process_manager);
@@ -115,6 +118,16 @@ private:
       socket->bind(bound_ipc_addresses_.back());
    }
 
+   template <typename value_t>
+   value_t receive_over_zmq(zmq::socket_t &socket, ZeroMQPoller &poller, bool *more = nullptr);
+   template <typename T>
+   void send_over_shm(SharedMemoryChannel &channel, const T &item, bool more = false);
+   template <typename value_t>
+   value_t receive_over_shm(SharedMemoryChannel &channel, ZeroMQPoller &poller, bool *more = nullptr);
+   zmq::message_t receive_from_workers_over_shm(bool *more);
+   template <typename value_t>
+   static value_t decode_message(zmq::message_t &&msg);
+
    // push
    std::vector<ZmqLingeringSocketPtr<>> qw_push_;
    ZmqLingeringSocketPtr<> this_worker_qw_push_;
@@ -147,6 +160,13 @@ private:
    zmq::send_flags send_flag_ = zmq::send_flags::none;
 
    std::vector<std::string> bound_ipc_addresses_;
+
+   // shared memory transport, used instead of the sockets if not nullptr
+   std::unique_ptr<SharedMemoryChannels> shm_;
+   std::size_t worker_id_ = 0;
+   // worker channel of the last message received on master, to receive the rest of multipart messages
+   std::size_t shm_wm_last_worker_ = 0;
+   bool shm_wm_more_ = false;
 };
 
 // Messages from master to queue
@@ -0,0 +1,77 @@
+/*
+ * Project: RooFit
+ *
+ * Copyright (c) 2024, CERN
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted according to the terms
+ * listed in LICENSE (http://roofit.sourceforge.net/license.txt)
+ */
+#ifndef ROOT_ROOFIT_MultiProcess_SharedMemoryChannel
+#define ROOT_ROOFIT_MultiProcess_SharedMemoryChannel
+
+#include <zmq.hpp>
+
+#include <sys/types.h> // pid_t
+
+#include <atomic>
+#include <cstddef> // std::size_t
+#include <cstdint>
+#include <memory> // unique_ptr
+#include <vector>
+
+namespace RooFit {
+namespace MultiProcess {
+
+class SharedMemoryChannel {
+public:
+   explicit SharedMemoryChannel(std::size_t capacity);
+   ~SharedMemoryChannel();
+
+   SharedMemoryChannel(const SharedMemoryChannel &) = delete;
+   SharedMemoryChannel &operator=(const SharedMemoryChannel &) = delete;
+
+   void attach_receiver();
+   void send(const void *data, std::size_t size, bool more);
+   bool try_receive(zmq::message_t &msg, bool *more = nullptr);
+
+   /// File descriptor that is readable as long as there are messages in the
+   /// channel, to be registered in a ZeroMQPoller.
+   int fd() const { return event_fd_; }
+
+private:
+   struct Header {
+      alignas(64) std::atomic<std::uint64_t> head; // read position, only written by the consumer
+      alignas(64) std::atomic<std::uint64_t> tail; // write position, only written by the producer
+      std::atomic<pid_t> receiver_pid;             // process of the consumer, zero until it is attached
+   };
+
+   std::size_t free_space() const;
+   void wait_for_space(std::size_t size) const;
+
+   std::size_t capacity_;
+   std::size_t mapping_size_;
+   Header *header_ = nullptr;
+   unsigned char *data_ = nullptr;
+   int event_fd_ = -1;
+};
+
+/// All the channels between the master, queue and worker processes. Each
+/// channel has exactly one sending and one receiving process. They have to be
+/// created before forking, so that all processes share the same memory and
+/// event file descriptors.
+struct SharedMemoryChannels {
+   SharedMemoryChannels(std::size_t N_workers, std::size_t capacity);
+
+   SharedMemoryChannel master_to_queue;
+   SharedMemoryChannel queue_to_master;
+   std::vector<std::unique_ptr<SharedMemoryChannel>> queue_to_worker;
+   std::vector<std::unique_ptr<SharedMemoryChannel>> worker_to_queue;
+   std::vector<std::unique_ptr<SharedMemoryChannel>> master_to_worker;
+   std::vector<std::unique_ptr<SharedMemoryChannel>> worker_to_master;
+};
+
+} // namespace MultiProcess
+} // namespace RooFit
+
+#endif // ROOT_ROOFIT_MultiProcess_SharedMemoryChannel
@@ -62,6 +62,16 @@ namespace MultiProcess {
  * can be set using either setTaskPriorities or suggestTaskOrder. If no priorities
  * are set, the Priority queue simply assumes equal priority for all tasks. The
  * resulting order then depends on the implementation of std::priority_queue.
+ *
+ * Under Config::Messenger, we can set the transport that is used for the
+ * communication between the master, queue and worker processes: ZeroMQ or
+ * SharedMemory. Like the queue type, it is used when a JobManager is spun up.
+ * The default is ZeroMQ, which sends all messages over IPC sockets. The
+ * SharedMemory transport passes the messages through ring buffers in shared
+ * memory instead. Its lower latency matters for jobs with many short tasks,
+ * like gradient-parallel fits. Each ring buffer has a fixed
+ * capacity, set with setSharedMemoryCapacity, that must be large enough for
+ * the largest message that is sent, e.g. the parameter updates.
  */
 
 void Config::setDefaultNWorkers(unsigned int N_workers)
@@ -94,6 +104,23 @@ unsigned int Config::getDefaultNWorkers()
    return defaultNWorkers_;
 }
 
+/// Like setDefaultNWorkers(), this has no effect if a JobManager is already
+/// instantiated. This allows library code to run its own jobs with a given
+/// number of workers without changing the global setting.
+Config::LocalDefaultNWorkers::LocalDefaultNWorkers(unsigned int N_workers) : oldNWorkers_(defaultNWorkers_)
+{
+   if (!JobManager::is_instantiated()) {
+      setDefaultNWorkers(N_workers);
+   }
+}
+
+/// The previous default is restored even if a JobManager is still alive,
+/// because the default is only read when the next JobManager is created.
+Config::LocalDefaultNWorkers::~LocalDefaultNWorkers()
+{
+   defaultNWorkers_ = oldNWorkers_;
+}
+
 bool Config::Queue::setQueueType(QueueType queueType)
 {
    if (JobManager::is_instantiated()) {
@@ -109,6 +136,43 @@ Config::Queue::QueueType Config::Queue::getQueueType()
    return queueType_;
 }
 
+bool Config::Messenger::setTransport(Transport transport)
+{
+   if (JobManager::is_instantiated()) {
+      printf("Warning: cannot set RooFit::MultiProcess messenger transport after JobManager has been instantiated!\n");
+      return false;
+   }
+#ifndef __linux__
+   if (transport == Transport::SharedMemory) {
+      printf("Warning: the RooFit::MultiProcess shared memory transport is only available on Linux!\n");
+      return false;
+   }
+#endif
+   transport_ = transport;
+   return true;
+}
+
+Config::Messenger::Transport Config::Messenger::getTransport()
+{
+   return transport_;
+}
+
+/// Set the capacity in bytes of each of the ring buffers of the SharedMemory transport.
+bool Config::Messenger::setSharedMemoryCapacity(std::size_t capacity)
+{
+   if (JobManager::is_instantiated()) {
+      printf("Warning: cannot set RooFit::MultiProcess shared memory capacity after JobManager has been instantiated!\n");
+      return false;
+   }
+   sharedMemoryCapacity_ = capacity;
+   return true;
+}
+
+std::size_t Config::Messenger::getSharedMemoryCapacity()
+{
+   return sharedMemoryCapacity_;
+}
+
 /// Set the priority for Job tasks in Priority queue mode.
 ///
 /// Only useful in Priority queue mode, in FIFO mode this doesn't do anything.
@@ -147,6 +211,8 @@ unsigned int Config::defaultNWorkers_ = std::thread::hardware_concurrency();
 std::size_t Config::LikelihoodJob::defaultNEventTasks = Config::LikelihoodJob::automaticNEventTasks;
 std::size_t Config::LikelihoodJob::defaultNComponentTasks = Config::LikelihoodJob::automaticNComponentTasks;
 Config::Queue::QueueType Config::Queue::queueType_ = Config::Queue::QueueType::FIFO;
+Config::Messenger::Transport Config::Messenger::transport_ = Config::Messenger::Transport::ZeroMQ;
+std::size_t Config::Messenger::sharedMemoryCapacity_ = 1 << 20;
 bool Config::timingAnalysis_ = false;
 
 } // namespace MultiProcess
@@ -0,0 +1,109 @@
+/*
+ * Project: RooFit
+ *
+ * Copyright (c) 2024, CERN
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted according to the terms
+ * listed in LICENSE (http://roofit.sourceforge.net/license.txt)
+ */
+
+#include "RooFit/MultiProcess/IndexedTaskJob.h"
+#include "RooFit/MultiProcess/JobManager.h"
+#include "RooFit/MultiProcess/Messenger.h"
+#include "RooFit/MultiProcess/ProcessManager.h"
+#include "RooFit/MultiProcess/Queue.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace RooFit {
+namespace MultiProcess {
+
+/** @class IndexedTaskJob
+ *
+ * @brief Job that evaluates independent tasks, which are only defined by their index
+ *
+ * The tasks are evaluated on the workers by a callback, which serializes the
+ * result of each task into a buffer of bytes. The buffers are sent back to the
+ * master and kept by task index, so the caller can merge the results in task
+ * order no matter which worker produced them. This covers jobs like toy
+ * studies, where every worker already has the full model from the time it was
+ * forked and only needs to know which toy to produce.
+ *
+ * The results of several calls to run() are accumulated, until the caller
+ * clears them.
+ */
+
+IndexedTaskJob::IndexedTaskJob(EvaluateTaskFn evaluateTask) : evaluateTask_(std::move(evaluateTask)) {}
+
+/// Queue the tasks in the range [firstTask, lastTask) and wait until all of
+/// them came back from the workers. The first call forks the worker processes.
+void IndexedTaskJob::run(std::size_t firstTask, std::size_t lastTask)
+{
+   if (lastTask <= firstTask || !get_manager()->process_manager().is_master())
+      return;
+
+   for (std::size_t task = firstTask; task < lastTask; ++task) {
+      get_manager()->queue()->add({id_, state_id_, task});
+   }
+   n_tasks_at_workers_ = lastTask - firstTask;
+
+   gather_worker_results();
+}
+
+/// Queue the given tasks and wait until all of them came back from the
+/// workers. The task indices must be unique.
+void IndexedTaskJob::run(std::vector<std::size_t> const &tasks)
+{
+   if (tasks.empty() || !get_manager()->process_manager().is_master())
+      return;
+
+   for (std::size_t task : tasks) {
+      get_manager()->queue()->add({id_, state_id_, task});
+   }
+   n_tasks_at_workers_ = tasks.size();
+
+   gather_worker_results();
+}
+
+void IndexedTaskJob::evaluate_task(std::size_t task)
+{
+   assert(get_manager()->process_manager().is_worker());
+
+   workerResult_.buffer.clear();
+   workerResult_.valid = evaluateTask_(task, workerResult_.buffer);
+}
+
+// --- RESULT LOGISTICS ---
+
+void IndexedTaskJob::send_back_task_result_from_worker(std::size_t task)
+{
+   task_result_t header{id_, task, workerResult_.valid, workerResult_.buffer.size()};
+   zmq::message_t message(sizeof(task_result_t) + workerResult_.buffer.size());
+   auto *data = static_cast<char *>(message.data());
+   std::memcpy(data, &header, sizeof(task_result_t));
+   if (!workerResult_.buffer.empty()) {
+      std::memcpy(data + sizeof(task_result_t), workerResult_.buffer.data(), workerResult_.buffer.size());
+   }
+   get_manager()->messenger().send_from_worker_to_master(std::move(message));
+}
+
+bool IndexedTaskJob::receive_task_result_on_master(const zmq::message_t &message)
+{
+   task_result_t header;
+   auto const *data = static_cast<const char *>(message.data());
+   std::memcpy(&header, data, sizeof(task_result_t));
+
+   TaskResult &result = results_[header.task];
+   result.valid = header.valid;
+   result.buffer.assign(data + sizeof(task_result_t), data + sizeof(task_result_t) + header.n_bytes);
+
+   --n_tasks_at_workers_;
+   return n_tasks_at_workers_ == 0;
+}
+
+// --- END OF RESULT LOGISTICS ---
+
+} // namespace MultiProcess
+} // namespace RooFit
@@ -14,6 +14,7 @@
 #include "RooFit/MultiProcess/JobManager.h"
 #include "RooFit/MultiProcess/ProcessManager.h"
 #include "RooFit/MultiProcess/Messenger.h"
+#include "RooFit/MultiProcess/SharedMemoryChannel.h"
 #include "RooFit/MultiProcess/Job.h"
 #include "RooFit/MultiProcess/Queue.h" // complete type for JobManager::queue()
 #include "FIFOQueue.h" // complete type for JobManager::queue()
@@ -78,8 +79,14 @@ JobManager::JobManager(std::size_t N_workers)
       break;
    }
    }
+   std::unique_ptr<SharedMemoryChannels> shared_memory_channels;
+   if (Config::Messenger::getTransport() == Config::Messenger::Transport::SharedMemory) {
+      // the channels must be created before forking, so that all processes share them
+      shared_memory_channels =
+         std::make_unique<SharedMemoryChannels>(N_workers, Config::Messenger::getSharedMemoryCapacity());
+   }
    process_manager_ptr_ = std::make_unique<ProcessManager>(N_workers);
-   messenger_ptr_ = std::make_unique<Messenger>(*process_manager_ptr_);
+   messenger_ptr_ = std::make_unique<Messenger>(*process_manager_ptr_, std::move(shared_memory_channels));
 }
 
 JobManager::~JobManager()
@@ -16,7 +16,8 @@
 
 #include <TSystem.h>
 
-#include <csignal> // sigprocmask etc
+#include <algorithm> // std::min
+#include <csignal>   // sigprocmask etc
 
 namespace RooFit {
 namespace MultiProcess {
@@ -55,15 +56,61 @@ void set_socket_immediate(ZmqLingeringSocketPtr<> &socket)
  *   is used to send back task results from workers to master in
  *   'JobManager::retrieve()'.
  *
+ * Alternatively, if shared memory channels are passed to the constructor, all
+ * messages are sent over these instead of over the sockets. This is selected
+ * with Config::Messenger::setTransport(). There is then a separate channel
+ * for each direction between each pair of processes, including one for each
+ * worker to receive the state updates from master. The message encoding and
+ * the polling work the same as for the sockets, so the Messenger users don't
+ * need to know which transport is used.
+ *
  * @param process_manager ProcessManager instance which manages the master,
  *                        queue and worker processes that we want to set up
  *                        communication for in this Messenger.
+ * @param shared_memory_channels Channels for the shared memory transport,
+ *                        which must have been created before forking. If
+ *                        nullptr, ZeroMQ sockets are used.
  */
 
-Messenger::Messenger(const ProcessManager &process_manager)
+Messenger::Messenger(const ProcessManager &process_manager,
+                     std::unique_ptr<SharedMemoryChannels> shared_memory_channels)
+   : shm_(std::move(shared_memory_channels))
 {
    sigemptyset(&ppoll_sigmask);
 
+   if (shm_) {
+      // Only the pollers are needed, to wait for the channels' file descriptors.
+      // Every process also registers as the receiver of its incoming channels,
+      // so that senders notice if it exits.
+      if (process_manager.is_master()) {
+         shm_->queue_to_master.attach_receiver();
+         mq_pull_poller_.register_socket(shm_->queue_to_master.fd(), zmq::event_flags::pollin);
+         for (auto &channel : shm_->worker_to_master) {
+            channel->attach_receiver();
+            wm_pull_poller_.register_socket(channel->fd(), zmq::event_flags::pollin);
+         }
+      } else if (process_manager.is_queue()) {
+         qw_pull_poller_.resize(process_manager.N_workers());
+         for (std::size_t ix = 0; ix < process_manager.N_workers(); ++ix) {
+            shm_->worker_to_queue[ix]->attach_receiver();
+            qw_pull_poller_[ix].register_socket(shm_->worker_to_queue[ix]->fd(), zmq::event_flags::pollin);
+         }
+         shm_->master_to_queue.attach_receiver();
+         mq_pull_poller_.register_socket(shm_->master_to_queue.fd(), zmq::event_flags::pollin);
+      } else if (process_manager.is_worker()) {
+         worker_id_ = process_manager.worker_id();
+         shm_->queue_to_worker[worker_id_]->attach_receiver();
+         shm_->master_to_worker[worker_id_]->attach_receiver();
+         qw_pull_poller_.resize(1);
+         qw_pull_poller_[0].register_socket(shm_->queue_to_worker[worker_id_]->fd(), zmq::event_flags::pollin);
+         mw_sub_poller_.register_socket(shm_->master_to_worker[worker_id_]->fd(), zmq::event_flags::pollin);
+      } else {
+         // should never get here
+         throw std::runtime_error("Messenger ctor: I'm neither master, nor queue, nor a worker");
+      }
+      return;
+   }
+
    auto makeAddrPrefix = [](pid_t pid) -> std::string {
       std::string tmpPath = gSystem->TempDirectory();
       return "ipc://" + tmpPath + "/roofit_" + std::to_string(pid) + "_roofitMP";
@@ -395,7 +442,11 @@ void Messenger::test_connections(const ProcessManager &process_manager)
             if (readable_socket.first == mq_index) {
                test_receive(X2X::pong, test_rcv_pipes::fromMonQ, -1);
                test_receive(X2X::ping, test_rcv_pipes::fromMonQ, -1);
-               poller.unregister_socket(*mq_pull_);
+               if (shm_) {
+                  poller.unregister_socket(shm_->master_to_queue.fd());
+               } else {
+                  poller.unregister_socket(*mq_pull_);
+               }
             } else { // from a worker socket
                // TODO: dangerous assumption for this_worker_id, may become invalid if we allow multiple queue_loops on
                // the same process!
@@ -405,7 +456,11 @@ void Messenger::test_connections(const ProcessManager &process_manager)
                test_receive(X2X::ping, test_rcv_pipes::fromWonQ, this_worker_id);
                test_send(X2X::pong, test_snd_pipes::Q2W, this_worker_id);
 
-               poller.unregister_socket(*qw_pull_[this_worker_id]);
+               if (shm_) {
+                  poller.unregister_socket(shm_->worker_to_queue[this_worker_id]->fd());
+               } else {
+                  poller.unregister_socket(*qw_pull_[this_worker_id]);
+               }
             }
          }
       }
@@ -431,6 +486,13 @@ void Messenger::test_connections(const ProcessManager &process_manager)
 std::pair<ZeroMQPoller, std::size_t> Messenger::create_queue_poller()
 {
    ZeroMQPoller poller;
+   if (shm_) {
+      std::size_t mq_index = poller.register_socket(shm_->master_to_queue.fd(), zmq::event_flags::pollin);
+      for (auto &channel : shm_->worker_to_queue) {
+         poller.register_socket(channel->fd(), zmq::event_flags::pollin);
+      }
+      return {std::move(poller), mq_index};
+   }
    std::size_t mq_index = poller.register_socket(*mq_pull_, zmq::event_flags::pollin);
    for (auto &s : qw_pull_) {
       poller.register_socket(*s, zmq::event_flags::pollin);
@@ -442,11 +504,57 @@ std::pair<ZeroMQPoller, std::size_t> Messenger::create_queue_poller()
 std::pair<ZeroMQPoller, std::size_t> Messenger::create_worker_poller()
 {
    ZeroMQPoller poller;
+   if (shm_) {
+      poller.register_socket(shm_->queue_to_worker[worker_id_]->fd(), zmq::event_flags::pollin);
+      std::size_t mw_sub_index =
+         poller.register_socket(shm_->master_to_worker[worker_id_]->fd(), zmq::event_flags::pollin);
+      return {std::move(poller), mw_sub_index};
+   }
    poller.register_socket(*this_worker_qw_pull_, zmq::event_flags::pollin);
    std::size_t mw_sub_index = poller.register_socket(*mw_sub_, zmq::event_flags::pollin);
    return {std::move(poller), mw_sub_index};
 }
 
+/// Receive the next message from any of the workers on master over the shared
+/// memory transport. The remaining parts of a multipart message are taken from
+/// the same worker, like they would be from the PULL socket. Otherwise, the
+/// workers are served in turns, starting after the one of the last message.
+zmq::message_t Messenger::receive_from_workers_over_shm(bool *more)
+{
+   auto &channels = shm_->worker_to_master;
+   zmq::message_t msg;
+   bool msg_more = false;
+
+   if (shm_wm_more_) {
+      ZeroMQPoller poller;
+      poller.register_socket(channels[shm_wm_last_worker_]->fd(), zmq::event_flags::pollin);
+      msg = receive_over_shm<zmq::message_t>(*channels[shm_wm_last_worker_], poller, &msg_more);
+   } else {
+      bool received = false;
+      while (!received) {
+         // the poller indices are the worker ids
+         auto poll_result = wm_pull_poller_.ppoll(-1, &ppoll_sigmask);
+         std::size_t first = channels.size();
+         for (auto &readable : poll_result) {
+            // index of the readable worker in the order of the turns
+            std::size_t turn = (readable.first + channels.size() - shm_wm_last_worker_ - 1) % channels.size();
+            first = std::min(first, turn);
+         }
+         if (first < channels.size()) {
+            std::size_t worker_id = (shm_wm_last_worker_ + 1 + first) % channels.size();
+            received = channels[worker_id]->try_receive(msg, &msg_more);
+            shm_wm_last_worker_ = worker_id;
+         }
+      }
+   }
+
+   shm_wm_more_ = msg_more;
+   if (more) {
+      *more = msg_more;
+   }
+   return msg;
+}
+
 // -- WORKER - QUEUE COMMUNICATION --
 
 void Messenger::send_from_worker_to_queue() {}
@@ -0,0 +1,259 @@
+/*
+ * Project: RooFit
+ *
+ * Copyright (c) 2024, CERN
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted according to the terms
+ * listed in LICENSE (http://roofit.sourceforge.net/license.txt)
+ */
+
+#include "RooFit/MultiProcess/SharedMemoryChannel.h"
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+#include <sys/mman.h>
+#include <signal.h> // kill
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring> // memcpy, strerror
+#include <fstream>
+#include <new>     // placement new
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace RooFit {
+namespace MultiProcess {
+
+namespace {
+
+// Messages are stored with an 8 byte header, followed by the message padded
+// to a multiple of 8 bytes. The highest bit of the header is the "more" flag
+// for multipart messages, the other bits are the message size.
+constexpr std::uint64_t more_bit = std::uint64_t(1) << 63;
+// Header that tells the receiver to continue at the beginning of the buffer.
+constexpr std::uint64_t wrap_marker = ~std::uint64_t(0);
+
+constexpr std::size_t header_size = sizeof(std::uint64_t);
+
+std::size_t padded(std::size_t size)
+{
+   return (size + 7) & ~std::size_t(7);
+}
+
+bool process_is_alive(pid_t pid)
+{
+   if (kill(pid, 0) < 0 && errno == ESRCH) {
+      return false;
+   }
+#ifdef __linux__
+   // A child process that has exited, but was not reaped yet by its parent,
+   // is still found by kill(), so also check that it's not a zombie. The state
+   // is the first field after the executable name, which is in parentheses.
+   std::ifstream stat_file("/proc/" + std::to_string(pid) + "/stat");
+   std::string stat;
+   if (std::getline(stat_file, stat)) {
+      const std::size_t name_end = stat.rfind(')');
+      if (name_end != std::string::npos && name_end + 2 < stat.size() && stat[name_end + 2] == 'Z') {
+         return false;
+      }
+   }
+#endif
+   return true;
+}
+
+} // namespace
+
+/** \class SharedMemoryChannel
+ *
+ * \brief Single producer, single consumer message channel over shared memory
+ *
+ * A lock-free ring buffer in an anonymous shared memory mapping, used by the
+ * Messenger as an alternative to the ZeroMQ sockets. The mapping is created
+ * in the constructor, so the channel has to be created before forking the
+ * processes that use it.
+ *
+ * To be able to wait for messages together with other channels or sockets in
+ * a ZeroMQPoller, every channel has an eventfd in semaphore mode, which is
+ * incremented for every message that is sent and decremented for every
+ * message that is received. It is therefore readable exactly when there are
+ * messages in the channel, like a ZeroMQ socket.
+ *
+ * If the ring buffer is full, send() waits until the receiver has made space,
+ * so the capacity must be large enough to hold the largest message. While
+ * waiting, send() checks that the receiving process, which registers itself
+ * with attach_receiver(), is still alive, and throws if it has exited.
+ *
+ * Because eventfd is Linux specific, the channel is only available on Linux.
+ *
+ * \param capacity Size of the ring buffer in bytes, rounded up to a multiple of 8.
+ */
+SharedMemoryChannel::SharedMemoryChannel(std::size_t capacity) : capacity_(padded(capacity))
+{
+   mapping_size_ = sizeof(Header) + capacity_;
+   void *mapping = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+   if (mapping == MAP_FAILED) {
+      throw std::runtime_error(std::string("SharedMemoryChannel: mmap failed: ") + std::strerror(errno));
+   }
+   header_ = new (mapping) Header;
+   header_->head.store(0);
+   header_->tail.store(0);
+   header_->receiver_pid.store(0);
+   data_ = static_cast<unsigned char *>(mapping) + sizeof(Header);
+
+#ifdef __linux__
+   event_fd_ = eventfd(0, EFD_SEMAPHORE | EFD_NONBLOCK);
+#else
+   errno = ENOSYS;
+#endif
+   if (event_fd_ < 0) {
+      munmap(mapping, mapping_size_);
+      throw std::runtime_error(std::string("SharedMemoryChannel: eventfd failed: ") + std::strerror(errno));
+   }
+}
+
+SharedMemoryChannel::~SharedMemoryChannel()
+{
+   close(event_fd_);
+   header_->~Header();
+   munmap(header_, mapping_size_);
+}
+
+std::size_t SharedMemoryChannel::free_space() const
+{
+   return capacity_ - (header_->tail.load(std::memory_order_relaxed) - header_->head.load(std::memory_order_acquire));
+}
+
+/// Register the calling process as the receiver of the channel, so that the
+/// sender can detect when it has exited. Has to be called by the receiving
+/// process after forking.
+void SharedMemoryChannel::attach_receiver()
+{
+   header_->receiver_pid.store(getpid(), std::memory_order_release);
+}
+
+/// Wait until the receiver has made space for `size` bytes. The waiting time
+/// is increased gradually, because the receiver can't notify the sender. To
+/// not wait forever for a receiver that has exited, its liveness is checked
+/// every hundred tries.
+void SharedMemoryChannel::wait_for_space(std::size_t size) const
+{
+   unsigned int n_tries = 0;
+   while (free_space() < size) {
+      if (++n_tries < 100) {
+         std::this_thread::yield();
+         continue;
+      }
+      if (n_tries % 100 == 0) {
+         const pid_t receiver_pid = header_->receiver_pid.load(std::memory_order_acquire);
+         if (receiver_pid != 0 && !process_is_alive(receiver_pid)) {
+            throw std::runtime_error("SharedMemoryChannel::send: the receiving process " +
+                                     std::to_string(receiver_pid) + " has exited, the message can't be delivered");
+         }
+      }
+      usleep(n_tries < 1000 ? 10 : 1000);
+   }
+}
+
+/// Copy a message into the channel and notify the receiver.
+///
+/// \param data Pointer to the message.
+/// \param size Size of the message in bytes.
+/// \param more Whether more parts of a multipart message follow.
+void SharedMemoryChannel::send(const void *data, std::size_t size, bool more)
+{
+   const std::size_t frame_size = header_size + padded(size);
+   if (frame_size > capacity_) {
+      throw std::length_error("SharedMemoryChannel::send: message of " + std::to_string(size) +
+                              " bytes doesn't fit in the channel, increase the capacity with "
+                              "Config::Messenger::setSharedMemoryCapacity()");
+   }
+
+   std::uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+   std::size_t offset = tail % capacity_;
+   if (capacity_ - offset < frame_size) {
+      // not enough space until the end of the buffer, continue at the beginning
+      wait_for_space(capacity_ - offset);
+      std::memcpy(data_ + offset, &wrap_marker, header_size);
+      tail += capacity_ - offset;
+      header_->tail.store(tail, std::memory_order_release);
+      offset = 0;
+   }
+
+   wait_for_space(frame_size);
+   const std::uint64_t header = size | (more ? more_bit : 0);
+   std::memcpy(data_ + offset, &header, header_size);
+   std::memcpy(data_ + offset + header_size, data, size);
+   header_->tail.store(tail + frame_size, std::memory_order_release);
+
+   const std::uint64_t one = 1;
+   while (write(event_fd_, &one, sizeof(one)) < 0) {
+      if (errno != EINTR) {
+         throw std::runtime_error(std::string("SharedMemoryChannel::send: eventfd write failed: ") +
+                                  std::strerror(errno));
+      }
+   }
+}
+
+/// Take the next message out of the channel, if there is one.
+///
+/// \param[out] msg The received message.
+/// \param[out] more If not nullptr, set to whether more parts of a multipart message follow.
+/// \return Whether a message was received. If not, wait for the file descriptor
+///         returned by fd() to become readable before trying again.
+bool SharedMemoryChannel::try_receive(zmq::message_t &msg, bool *more)
+{
+   // Every message comes with a count on the eventfd, which is only added
+   // after the message is in the buffer.
+   std::uint64_t count;
+   while (read(event_fd_, &count, sizeof(count)) < 0) {
+      if (errno == EAGAIN) {
+         return false;
+      }
+      if (errno != EINTR) {
+         throw std::runtime_error(std::string("SharedMemoryChannel::try_receive: eventfd read failed: ") +
+                                  std::strerror(errno));
+      }
+   }
+
+   std::uint64_t head = header_->head.load(std::memory_order_relaxed);
+   // synchronizes with the release store of the tail in send()
+   header_->tail.load(std::memory_order_acquire);
+   std::size_t offset = head % capacity_;
+   std::uint64_t header;
+   std::memcpy(&header, data_ + offset, header_size);
+   if (header == wrap_marker) {
+      head += capacity_ - offset;
+      offset = 0;
+      std::memcpy(&header, data_, header_size);
+   }
+
+   const std::size_t size = header & ~more_bit;
+   msg.rebuild(data_ + offset + header_size, size);
+   if (more) {
+      *more = (header & more_bit) != 0;
+   }
+   header_->head.store(head + header_size + padded(size), std::memory_order_release);
+   return true;
+}
+
+/// Create all channels for the given number of workers.
+///
+/// \param N_workers Number of worker processes.
+/// \param capacity Size of the ring buffer of each channel in bytes.
+SharedMemoryChannels::SharedMemoryChannels(std::size_t N_workers, std::size_t capacity)
+   : master_to_queue(capacity), queue_to_master(capacity)
+{
+   for (std::size_t ix = 0; ix < N_workers; ++ix) {
+      queue_to_worker.emplace_back(std::make_unique<SharedMemoryChannel>(capacity));
+      worker_to_queue.emplace_back(std::make_unique<SharedMemoryChannel>(capacity));
+      master_to_worker.emplace_back(std::make_unique<SharedMemoryChannel>(capacity));
+      worker_to_master.emplace_back(std::make_unique<SharedMemoryChannel>(capacity));
+   }
+}
+
+} // namespace MultiProcess
+} // namespace RooFit
@@ -13,9 +13,11 @@
  */
 
 #include <cmath>
+#include <cstring>
 #include <vector>
 
 #include "RooFit/MultiProcess/Job.h"
+#include "RooFit/MultiProcess/IndexedTaskJob.h"
 #include "RooFit/MultiProcess/types.h" // JobTask
 #include "RooFit/MultiProcess/Config.h"
 // needed to complete type returned from...
@@ -255,4 +257,31 @@ TEST_P(TestMPJob, singleJobUpdateState)
    EXPECT_EQ(Hex(y_parallel_after_change[3]), Hex(y_expected[3]));
 }
 
+TEST_P(TestMPJob, indexedTaskJob)
+{
+   // The generic job sends back one buffer per task, which has to end up at
+   // the index of the task, for ranges and for explicit lists of tasks.
+   RooFit::MultiProcess::Config::setDefaultNWorkers(GetParam());
+
+   RooFit::MultiProcess::IndexedTaskJob job{[](std::size_t task, std::vector<char> &buffer) {
+      const double value = std::pow(task, 2) + 3.;
+      buffer.resize(sizeof(double));
+      std::memcpy(buffer.data(), &value, sizeof(double));
+      return task % 3 != 2;
+   }};
+
+   job.run(0, 4);
+   job.run({10, 7});
+
+   ASSERT_EQ(job.results().size(), 6);
+   for (std::size_t task : {0, 1, 2, 3, 7, 10}) {
+      auto const &result = job.results()[task];
+      ASSERT_EQ(result.buffer.size(), sizeof(double)) << "task " << task;
+      double value = 0.;
+      std::memcpy(&value, result.buffer.data(), sizeof(double));
+      EXPECT_EQ(Hex(value), Hex(std::pow(task, 2) + 3.)) << "task " << task;
+      EXPECT_EQ(result.valid, task % 3 != 2) << "task " << task;
+   }
+}
+
 INSTANTIATE_TEST_SUITE_P(NumberOfWorkerProcesses, TestMPJob, ::testing::Values(1, 2, 3));
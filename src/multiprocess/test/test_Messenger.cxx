@@ -15,6 +15,8 @@
 
 #include "gtest/gtest.h"
 
+#include <numeric> // iota, accumulate
+
 void handle_sigchld(int signum)
 {
    printf("handled %s on PID %d\n", strsignal(signum), getpid());
@@ -56,6 +58,75 @@ TEST(TestMPMessenger, Connections)
    }
 }
 
+TEST(TestMPMessenger, SharedMemoryTransport)
+{
+   struct sigaction sa;
+   std::size_t N_workers = 4;
+   // the channels must exist before forking
+   auto channels = std::make_unique<RooFit::MultiProcess::SharedMemoryChannels>(N_workers, 1024);
+   RooFit::MultiProcess::ProcessManager pm(N_workers);
+   if (pm.is_master()) {
+      // on master, we have to handle SIGCHLD
+      memset(&sa, '\0', sizeof(sa));
+      sa.sa_handler = handle_sigchld;
+      if (sigaction(SIGCHLD, &sa, nullptr) < 0) {
+         std::perror("sigaction failed");
+         std::exit(1);
+      }
+   }
+   RooFit::MultiProcess::Messenger messenger(pm, std::move(channels));
+   if (pm.is_master()) {
+      // more SIGCHLD handling
+      sigset_t sigmask;
+      sigemptyset(&sigmask);
+      sigaddset(&sigmask, SIGCHLD);
+      int rc = sigprocmask(SIG_BLOCK, &sigmask, &messenger.ppoll_sigmask);
+      if (rc < 0) {
+         throw std::runtime_error("sigprocmask failed in TestMPMessenger.SharedMemoryTransport");
+      }
+   }
+   messenger.test_connections(pm);
+
+   // The messages of all rounds together are larger than the channel
+   // capacity, so the ring buffers have to wrap around.
+   std::vector<double> values(100);
+   std::iota(values.begin(), values.end(), 0.);
+   std::size_t N_rounds = 10;
+
+   if (pm.is_master()) {
+      for (std::size_t round = 0; round < N_rounds; ++round) {
+         zmq::message_t message(values.data(), values.size() * sizeof(double));
+         messenger.publish_from_master_to_workers(round, std::move(message));
+         double sum = 0;
+         for (std::size_t ix = 0; ix < N_workers; ++ix) {
+            sum += messenger.receive_from_worker_on_master<double>();
+         }
+         EXPECT_EQ(sum, N_workers * (round + 4950.));
+      }
+   } else if (pm.is_worker()) {
+      for (std::size_t round = 0; round < N_rounds; ++round) {
+         bool more = false;
+         EXPECT_EQ(messenger.receive_from_master_on_worker<std::size_t>(&more), round);
+         EXPECT_TRUE(more);
+         auto message = messenger.receive_from_master_on_worker<zmq::message_t>(&more);
+         EXPECT_FALSE(more);
+         auto data = static_cast<const double *>(message.data());
+         double sum = std::accumulate(data, data + message.size() / sizeof(double), double(round));
+         messenger.send_from_worker_to_master(sum);
+      }
+   }
+
+   if (pm.is_master()) {
+      // clean up signal management modifications
+      sigprocmask(SIG_SETMASK, &messenger.ppoll_sigmask, nullptr);
+      sa.sa_handler = SIG_DFL;
+      if (sigaction(SIGCHLD, &sa, nullptr) < 0) {
+         std::perror("sigaction failed");
+         std::exit(1);
+      }
+   }
+}
+
 TEST(TestMPMessenger, ConnectionsManualExit)
 {
    // the point of this test is to see whether clean-up of ZeroMQ resources is done properly without calling any
@@ -152,6 +223,33 @@ TEST(TestMPMessenger, SigStop)
    }
 }
 
+TEST(TestMPMessenger, SharedMemoryReceiverExited)
+{
+   // Sending into a full channel must not wait forever when the receiving
+   // process is gone.
+   RooFit::MultiProcess::SharedMemoryChannel channel(64);
+
+   pid_t child_pid = fork();
+   if (child_pid == 0) {
+      channel.attach_receiver();
+      _Exit(0);
+   }
+   ASSERT_GT(child_pid, 0);
+   // Check both a zombie receiver and one that has been reaped.
+   usleep(100000);
+
+   double value = 1.;
+   auto fill_channel = [&]() {
+      for (int i = 0; i < 100; ++i) {
+         channel.send(&value, sizeof(value), false);
+      }
+   };
+   EXPECT_THROW(fill_channel(), std::runtime_error);
+
+   waitpid(child_pid, nullptr, 0);
+   EXPECT_THROW(channel.send(&value, sizeof(value), false), std::runtime_error);
+}
+
 TEST(TestMPMessenger, DISABLED_StressSigStop)
 {
    // The SIGSTOP test failed spuriously on CI at some point. We suspected this was due to some
@@ -46,6 +46,7 @@ protected:
   double evaluate() const override ;
   void doEval(RooFit::EvalContext &) const override;
   inline bool canComputeBatchWithCuda() const override { return true; }
+  inline bool canComputeBatchConcurrently() const override { return true; }
 
 private:
 
@@ -26,6 +26,7 @@
 #include "TMatrixD.h"
 #include "TMatrixDSym.h"
 #include <map>
+#include <memory>
 #include <vector>
 #include <string>
 
@@ -107,6 +108,11 @@ protected:
   RooListProxy _rhoList;
 
   double evaluate() const override;
+  void doEval(RooFit::EvalContext &) const override;
+
+  struct KernelTable;
+  std::shared_ptr<const KernelTable> buildKernelTable(std::vector<std::vector<double>> const &weights) const;
+  KernelTable const &kernelTable() const;
 
   void createPdf(bool firstCall, RooDataSet const& data);
   void setOptions();
@@ -118,8 +124,6 @@ protected:
   void calculatePreNorm(BoxInfo *bi) const;
   void sortDataIndices(BoxInfo *bi = nullptr);
   void calculateBandWidth();
-  double gauss(std::vector<double> &x, std::vector<std::vector<double>> &weights) const;
-  void loopRange(std::vector<double> &x, std::vector<Int_t> &indices) const;
   void boxInfoInit(BoxInfo *bi, const char *rangeName, Int_t code) const;
   RooDataSet *createDatasetFromHist(const RooArgList &varList, const TH1 &hist) const;
   void updateRho() const;
@@ -195,6 +199,8 @@ protected:
 
   RooChangeTracker *_tracker{nullptr}; //
 
+  mutable std::shared_ptr<const KernelTable> _kernelTable; ///<! Kernels for the evaluation, built from *_weights
+
   ClassDefOverride(RooNDKeysPdf, 3) // General N-dimensional non-parametric kernel estimation p.d.f
 };
 
@@ -25,6 +25,13 @@ Cranmer KS, Kernel Estimation in High-Energy Physics.
 For multi-dimensional datasets, the kernels are modeled by multidimensional Gaussians. The kernels are
 constructed such that they reflect the correlation coefficients between the observables
 in the input dataset.
+
+For the evaluation, the kernels are stored in a flat structure-of-arrays layout, ordered by
+the leaves of a k-d tree over the kernel centers in the decorrelated frame. Only the kernels
+within nSigma bandwidths of the evaluated point are summed, and the tree allows to find them
+without looping over all kernels. If implicit multi-threading is enabled with
+ROOT::EnableImplicitMT(), the batched evaluation and the computation of the adaptive
+bandwidths are split over the threads of the ROOT thread pool.
 **/
 
 #include <iostream>
@@ -42,8 +49,93 @@ in the input dataset.
 
 #include "TError.h"
 
+#include <RooFit/EvalContext.h>
+
+#ifdef ROOFIT_USE_IMT
+#include <ROOT/TExecutor.hxx>
+#include <TROOT.h>
+#endif
+
+#include <cmath>
+#include <limits>
+
 using std::string, std::vector, std::pair, std::map;
 
+/// The kernels of a RooNDKeysPdf in a flat structure-of-arrays layout, in the
+/// order of the leaves of a k-d tree over the kernel centers in the
+/// decorrelated frame. The tree is used to find the kernels within the box of
+/// nSigma bandwidths around the evaluated point.
+struct RooNDKeysPdf::KernelTable {
+   struct Node {
+      std::size_t begin = 0;
+      std::size_t end = 0;
+      std::size_t left = 0; ///< Index of the left child, zero for leaves
+      std::size_t right = 0;
+   };
+
+   /// Scratch space for the evaluation, to be reused between points.
+   struct Scratch {
+      std::vector<double> xR;
+      std::vector<double> lo;
+      std::vector<double> hi;
+      std::vector<std::size_t> stack;
+   };
+
+   static constexpr std::size_t leafSize = 16;
+
+   std::size_t nDim = 0;
+   std::size_t nKernels = 0;
+   std::vector<double> rotation;      ///< Row-major rotation into the decorrelated frame, empty if not rotated
+   std::vector<double> halfWidth;     ///< Half width of the box of contributing kernels per dimension
+   std::vector<double> centers;       ///< Center of kernel i in dimension j at index j * nKernels + i
+   std::vector<double> invTwoWidthSq; ///< 1 / (2 w^2), with the same layout as the centers
+   std::vector<double> norm;          ///< Event weight divided by the normalization of the Gaussian
+   std::vector<Node> nodes;
+   std::vector<double> nodeLo; ///< Bounding box of node k in dimension j at index k * nDim + j
+   std::vector<double> nodeHi;
+
+   std::size_t buildNode(std::vector<std::size_t> &perm, std::vector<double> const &points, std::size_t begin,
+                         std::size_t end);
+   double sumRange(std::size_t begin, std::size_t end, double const *xR) const;
+   double sumLeaf(Node const &node, Scratch &scratch) const;
+   double operator()(double const *x, Scratch &scratch) const;
+};
+
+namespace {
+
+/// Call `fn(begin, end)` for contiguous ranges of the `n` points, which are
+/// processed on the threads of the ROOT thread pool if implicit
+/// multi-threading is enabled.
+template <class Fn>
+void forEachRange(std::size_t n, Fn &&fn)
+{
+#ifdef ROOFIT_USE_IMT
+   constexpr std::size_t minPointsPerTask = 64;
+   if (ROOT::IsImplicitMTEnabled() && n >= 2 * minPointsPerTask) {
+      ROOT::Internal::TExecutor ex;
+      // Use a few tasks per thread, because the cost per point depends on the
+      // local density of kernels.
+      const std::size_t nTasks = std::min<std::size_t>(4 * ex.GetPoolSize(), n / minPointsPerTask);
+      const std::size_t nPerTask = n / nTasks + (n % nTasks > 0);
+      std::vector<std::size_t> indices(nTasks);
+      for (std::size_t i = 0; i < nTasks; ++i) {
+         indices[i] = i;
+      }
+      ex.Map(
+         [&](std::size_t idx) -> int {
+            const std::size_t begin = idx * nPerTask;
+            fn(begin, std::min(begin + nPerTask, n));
+            return 0;
+         },
+         indices);
+      return;
+   }
+#endif
+   fn(std::size_t(0), n);
+}
+
+} // namespace
+
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Construct N-dimensional kernel estimation p.d.f. in observables 'varList'
@@ -800,10 +892,13 @@ void RooNDKeysPdf::calculatePreNorm(BoxInfo* bi) const
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// sort entries, as needed for loopRange()
+/// sort entries, as needed for the kernel table
 
 void RooNDKeysPdf::sortDataIndices(BoxInfo* bi)
 {
+  // the kernel table is built from the sorted indices
+  _kernelTable.reset();
+
   // will loop over all events by default
   if (!_sortInput) {
     _ibNoSort.clear();
@@ -845,6 +940,8 @@ void RooNDKeysPdf::calculateBandWidth()
 {
   cxcoutD(Eval) << "RooNDKeysPdf::calculateBandWidth()" << std::endl;
 
+  _kernelTable.reset();
+
   const bool adaptive = _options.Contains("a");
   if (_weights != &_weights1 || _weights != &_weights0) {
     _weights = adaptive ? &_weights1 : &_weights0;
@@ -894,149 +991,26 @@ void RooNDKeysPdf::calculateBandWidth()
            weights_new = &_weights0;
         }
 
-        for (Int_t i = 0; i < _nEvents; ++i) {
-           vector<double> &x = _dataPts[i];
-           double f = std::pow(gauss(x, *weights_prev) / _nEventsW, -1. / (2. * _d));
+        std::shared_ptr<const KernelTable> table = buildKernelTable(*weights_prev);
+
+        forEachRange(_nEvents, [&](std::size_t begin, std::size_t end) {
+           KernelTable::Scratch scratch;
+           for (std::size_t i = begin; i < end; ++i) {
+              double f = std::pow((*table)(_dataPts[i].data(), scratch) / _nEventsW, -1. / (2. * _d));
 
-           vector<double> &weight = (*weights_new)[i];
-           for (Int_t j = 0; j < _nDim; j++) {
-              double norm = (_n * (*_sigmaR)[j]) / sqrtSigmaAvgR;
-              weight[j] = norm * f / sqrt12; //  note additional factor of sqrt(12) compared with HEP-EX/0011057
+              vector<double> &weight = (*weights_new)[i];
+              for (Int_t j = 0; j < _nDim; j++) {
+                 double norm = (_n * (*_sigmaR)[j]) / sqrtSigmaAvgR;
+                 weight[j] = norm * f / sqrt12; //  note additional factor of sqrt(12) compared with HEP-EX/0011057
+              }
            }
-        }
+        });
      }
      // this is the latest updated weights set
      _weights = weights_new;
   }
 }
 
-////////////////////////////////////////////////////////////////////////////////
-/// loop over all closest point to x, as determined by loopRange()
-
-double RooNDKeysPdf::gauss(vector<double>& x, vector<vector<double> >& weights) const
-{
-  if(_nEvents==0) return 0.;
-
-  const double sqrt2pi = std::sqrt(TMath::TwoPi());
-
-  double z=0.;
-  std::vector<int> indices;
-
-  // determine input loop range for event x
-  if (_sortInput) {
-    if (_sortTVIdcs.empty())
-      const_cast<RooNDKeysPdf*>(this)->sortDataIndices();
-
-    loopRange(x, indices);
-  } else {
-    indices.reserve(_ibNoSort.size());
-    for (const auto& ibMapItr : _ibNoSort) {
-       indices.push_back(ibMapItr.first);
-    }
-  }
-
-  for (const auto& i : indices) {
-     double g(1.);
-
-     if (i >= (Int_t)_idx.size()) {
-        continue;
-     } //---> 1.myline
-
-     const vector<double> &point = _dataPts[i];
-     const vector<double> &weight = weights[_idx[i]];
-
-     for (Int_t j = 0; j < _nDim; j++) {
-        (*_dx)[j] = x[j] - point[j];
-     }
-
-     if (_nDim > 1 && _rotate) {
-        *_dx *= *_rotMat; // rotate to decorrelated frame!
-     }
-
-     for (Int_t j = 0; j < _nDim; j++) {
-        double r = (*_dx)[j]; // x[j] - point[j];
-        double c = 1. / (2. * weight[j] * weight[j]);
-
-        // std::cout << "j = " << j << " x[j] = " << point[j] << " w = " << weight[j] << std::endl;
-
-        g *= exp(-c * r * r);
-        g *= 1. / (sqrt2pi * weight[j]);
-     }
-     z += (g * _wMap.at(_idx[i]));
-  }
-  return z;
-}
-
-////////////////////////////////////////////////////////////////////////////////
-/// determine closest points to x, to loop over in evaluate()
-
-void RooNDKeysPdf::loopRange(vector<double>& x, std::vector<Int_t>& ibMap) const
-{
-   ibMap.clear();
-   TVectorD xRm(_nDim);
-   TVectorD xRp(_nDim);
-
-   for (Int_t j = 0; j < _nDim; j++) {
-      xRm[j] = xRp[j] = x[j];
-   }
-
-   if (_nDim > 1 && _rotate) {
-      xRm *= *_rotMat;
-      xRp *= *_rotMat;
-   }
-   for (Int_t j = 0; j < _nDim; j++) {
-      xRm[j] -= _nSigma * (_n * (*_sigmaR)[j]);
-      xRp[j] += _nSigma * (_n * (*_sigmaR)[j]);
-  }
-
-  std::vector<TVectorD> xvecRm(1,xRm);
-  std::vector<TVectorD> xvecRp(1,xRp);
-
-  // To remember the indices that were selected in the previous dimensions
-  std::vector<Int_t> ibMapRT;
-
-  for (Int_t j=0; j<_nDim; j++) {
-    ibMap.clear();
-    auto comp = [=](const itPair& a, const itPair& b) {
-      return (*a.second)[j] < (*b.second)[j];
-    };
-
-    // Figure out which elements are to be selected in the current dimension
-    auto lo = std::lower_bound(_sortTVIdcs[j].begin(), _sortTVIdcs[j].end(), itPair(0, xvecRm.begin()), comp);
-    auto hi = std::upper_bound(_sortTVIdcs[j].begin(), _sortTVIdcs[j].end(), itPair(0, xvecRp.begin()), comp);
-    auto it = lo;
-
-    if (j==0) {
-      // In the first dimension, we can skip straight to filling the remembered
-      // indices for the previous dimension, or in the 1-d case, just fill the
-      // output map.
-      auto& m = _nDim==1 ? ibMap : ibMapRT;
-      m.reserve(std::distance(lo, hi));
-      for (it=lo; it!=hi; ++it) {
-        m.push_back(it->first);
-      }
-      // Sort by indices so we can use binary search
-      std::sort(m.begin(), m.end());
-      continue;
-    }
-
-    // Iterate over elements in current dimension and add them to the list if
-    // they were also selected in the previous dimension.
-    for (it=lo; it!=hi; ++it) {
-      // Look up in ibMapRT with binary search
-      auto found = std::lower_bound(ibMapRT.begin(), ibMapRT.end(), it->first);
-      if (found != ibMapRT.end() && !(it->first < *found)) {
-          ibMap.push_back(it->first);
-      }
-    }
-    // Sort by indices so we can use binary search
-    std::sort(ibMap.begin(), ibMap.end());
-
-    ibMapRT.clear();
-    if (j!=_nDim-1) { ibMapRT = std::move(ibMap); }
-  }
-}
-
 ////////////////////////////////////////////////////////////////////////////////
 
 void RooNDKeysPdf::boxInfoInit(BoxInfo* bi, const char* rangeName, Int_t /*code*/) const
@@ -1089,7 +1063,8 @@ double RooNDKeysPdf::evaluate() const
      _x[j] = var->getVal(nset);
    }
 
-  double val = gauss(_x,*_weights);
+  KernelTable::Scratch scratch;
+  double val = kernelTable()(_x.data(), scratch);
   //cout<<"returning "<<val<< std::endl;
 
   if (val >= 1E-20) {
@@ -1099,6 +1074,290 @@ double RooNDKeysPdf::evaluate() const
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Evaluate the p.d.f. for all points in the batch, which are split over the
+/// threads of the ROOT thread pool if implicit multi-threading is enabled.
+
+void RooNDKeysPdf::doEval(RooFit::EvalContext &ctx) const
+{
+   if ( (_tracker && _tracker->hasChanged(true)) || (_weights != &_weights0 && _weights != &_weights1) ) {
+      updateRho(); // update internal rho parameters
+      // redetermine static and/or adaptive bandwidth
+      const_cast<RooNDKeysPdf*>(this)->calculateBandWidth();
+   }
+
+   std::span<double> output = ctx.output();
+   std::vector<std::span<const double>> xSpans(_nDim);
+   for (Int_t j = 0; j < _nDim; ++j) {
+      xSpans[j] = ctx.at(&_varList[j]);
+   }
+
+   KernelTable const &table = kernelTable();
+
+   forEachRange(output.size(), [&](std::size_t begin, std::size_t end) {
+      KernelTable::Scratch scratch;
+      std::vector<double> x(_nDim);
+      for (std::size_t i = begin; i < end; ++i) {
+         for (Int_t j = 0; j < _nDim; ++j) {
+            x[j] = xSpans[j].size() > 1 ? xSpans[j][i] : xSpans[j][0];
+         }
+         output[i] = std::max(table(x.data(), scratch), 1E-20);
+      }
+   });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the kernel table for the current weights, building it if needed.
+
+RooNDKeysPdf::KernelTable const &RooNDKeysPdf::kernelTable() const
+{
+   if (!_kernelTable) {
+      _kernelTable = buildKernelTable(*_weights);
+   }
+   return *_kernelTable;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Build the table of the kernels that are summed in the evaluation, with the
+/// given kernel widths.
+
+std::shared_ptr<const RooNDKeysPdf::KernelTable>
+RooNDKeysPdf::buildKernelTable(std::vector<std::vector<double>> const &weights) const
+{
+   // If the input is sorted, the kernels are the ones in the
+   // sorted index lists, which are restricted to the integration box after
+   // an analytical integral was computed.
+   std::vector<std::size_t> selected;
+   if (_sortInput) {
+      if (_sortTVIdcs.empty())
+         const_cast<RooNDKeysPdf*>(this)->sortDataIndices();
+      for (auto const &item : _sortTVIdcs[0]) {
+         selected.push_back(item.first);
+      }
+   } else {
+      for (auto const &item : _ibNoSort) {
+         selected.push_back(item.first);
+      }
+   }
+   selected.erase(std::remove_if(selected.begin(), selected.end(),
+                                 [&](std::size_t i) { return i >= _idx.size(); }),
+                  selected.end());
+
+   auto table = std::make_shared<KernelTable>();
+   const std::size_t nDim = _nDim;
+   const std::size_t nKernels = selected.size();
+   table->nDim = nDim;
+   table->nKernels = nKernels;
+
+   if (_nDim > 1 && _rotate) {
+      table->rotation.resize(nDim * nDim);
+      for (std::size_t k = 0; k < nDim; ++k) {
+         for (std::size_t l = 0; l < nDim; ++l) {
+            table->rotation[k * nDim + l] = (*_rotMat)(k, l);
+         }
+      }
+   }
+
+   // Without sorted input, all kernels are summed.
+   table->halfWidth.resize(nDim, std::numeric_limits<double>::infinity());
+   if (_sortInput) {
+      for (std::size_t j = 0; j < nDim; ++j) {
+         table->halfWidth[j] = _nSigma * (_n * (*_sigmaR)[j]);
+      }
+   }
+
+   // rotated kernel centers, point after point
+   std::vector<double> points(nKernels * nDim);
+   for (std::size_t k = 0; k < nKernels; ++k) {
+      TVectorD const &pointR = _dataPtsR[selected[k]];
+      for (std::size_t j = 0; j < nDim; ++j) {
+         points[k * nDim + j] = pointR[j];
+      }
+   }
+
+   std::vector<std::size_t> perm(nKernels);
+   for (std::size_t k = 0; k < nKernels; ++k) {
+      perm[k] = k;
+   }
+   if (nKernels > 0) {
+      table->buildNode(perm, points, 0, nKernels);
+   }
+
+   const double sqrt2pi = std::sqrt(TMath::TwoPi());
+   table->centers.resize(nDim * nKernels);
+   table->invTwoWidthSq.resize(nDim * nKernels);
+   table->norm.resize(nKernels);
+   for (std::size_t k = 0; k < nKernels; ++k) {
+      const std::size_t i = selected[perm[k]];
+      const vector<double> &weight = weights[_idx[i]];
+      double norm = _wMap.at(_idx[i]);
+      for (std::size_t j = 0; j < nDim; ++j) {
+         table->centers[j * nKernels + k] = points[perm[k] * nDim + j];
+         table->invTwoWidthSq[j * nKernels + k] = 1. / (2. * weight[j] * weight[j]);
+         norm /= sqrt2pi * weight[j];
+      }
+      table->norm[k] = norm;
+   }
+
+   return table;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Build the k-d tree node for the kernels `perm[begin]` to `perm[end - 1]`,
+/// splitting at the median of the dimension with the largest extent.
+
+std::size_t RooNDKeysPdf::KernelTable::buildNode(std::vector<std::size_t> &perm, std::vector<double> const &points,
+                                                 std::size_t begin, std::size_t end)
+{
+   const std::size_t iNode = nodes.size();
+   nodes.push_back({begin, end, 0, 0});
+   nodeLo.resize(nodeLo.size() + nDim, std::numeric_limits<double>::infinity());
+   nodeHi.resize(nodeHi.size() + nDim, -std::numeric_limits<double>::infinity());
+
+   double *lo = &nodeLo[iNode * nDim];
+   double *hi = &nodeHi[iNode * nDim];
+   for (std::size_t k = begin; k < end; ++k) {
+      for (std::size_t j = 0; j < nDim; ++j) {
+         lo[j] = std::min(lo[j], points[perm[k] * nDim + j]);
+         hi[j] = std::max(hi[j], points[perm[k] * nDim + j]);
+      }
+   }
+
+   if (end - begin <= leafSize) {
+      return iNode;
+   }
+
+   std::size_t splitDim = 0;
+   for (std::size_t j = 1; j < nDim; ++j) {
+      if (hi[j] - lo[j] > hi[splitDim] - lo[splitDim])
+         splitDim = j;
+   }
+
+   const std::size_t mid = begin + (end - begin) / 2;
+   std::nth_element(perm.begin() + begin, perm.begin() + mid, perm.begin() + end,
+                    [&](std::size_t a, std::size_t b) {
+                       return points[a * nDim + splitDim] < points[b * nDim + splitDim];
+                    });
+
+   // The vectors with the nodes are reallocated when building the children,
+   // so the children indices are assigned via the node index.
+   const std::size_t left = buildNode(perm, points, begin, mid);
+   const std::size_t right = buildNode(perm, points, mid, end);
+   nodes[iNode].left = left;
+   nodes[iNode].right = right;
+   return iNode;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Sum the kernels from `begin` to `end` at the rotated point `xR`, without
+/// checking if they are within the box around the point.
+
+double RooNDKeysPdf::KernelTable::sumRange(std::size_t begin, std::size_t end, double const *xR) const
+{
+   constexpr std::size_t blockSize = 64;
+   double args[blockSize];
+   double z = 0.;
+   for (std::size_t first = begin; first < end; first += blockSize) {
+      const std::size_t n = std::min(blockSize, end - first);
+      for (std::size_t k = 0; k < n; ++k) {
+         args[k] = 0.;
+      }
+      for (std::size_t j = 0; j < nDim; ++j) {
+         double const *c = &centers[j * nKernels + first];
+         double const *a = &invTwoWidthSq[j * nKernels + first];
+         const double x = xR[j];
+         for (std::size_t k = 0; k < n; ++k) {
+            const double r = x - c[k];
+            args[k] += a[k] * r * r;
+         }
+      }
+      double const *w = &norm[first];
+      for (std::size_t k = 0; k < n; ++k) {
+         z += w[k] * std::exp(-args[k]);
+      }
+   }
+   return z;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Sum the kernels of a leaf that are within the box around the point.
+
+double RooNDKeysPdf::KernelTable::sumLeaf(Node const &node, Scratch &scratch) const
+{
+   double z = 0.;
+   for (std::size_t k = node.begin; k < node.end; ++k) {
+      bool inBox = true;
+      double arg = 0.;
+      for (std::size_t j = 0; j < nDim && inBox; ++j) {
+         const double c = centers[j * nKernels + k];
+         inBox = c >= scratch.lo[j] && c <= scratch.hi[j];
+         const double r = scratch.xR[j] - c;
+         arg += invTwoWidthSq[j * nKernels + k] * r * r;
+      }
+      if (inBox) {
+         z += norm[k] * std::exp(-arg);
+      }
+   }
+   return z;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Sum the kernels within nSigma bandwidths around the point `x`, given in the
+/// original frame.
+
+double RooNDKeysPdf::KernelTable::operator()(double const *x, Scratch &scratch) const
+{
+   if (nKernels == 0)
+      return 0.;
+
+   scratch.xR.resize(nDim);
+   scratch.lo.resize(nDim);
+   scratch.hi.resize(nDim);
+   for (std::size_t k = 0; k < nDim; ++k) {
+      if (rotation.empty()) {
+         scratch.xR[k] = x[k];
+      } else {
+         double xRk = 0.;
+         for (std::size_t l = 0; l < nDim; ++l) {
+            xRk += rotation[k * nDim + l] * x[l];
+         }
+         scratch.xR[k] = xRk;
+      }
+      scratch.lo[k] = scratch.xR[k] - halfWidth[k];
+      scratch.hi[k] = scratch.xR[k] + halfWidth[k];
+   }
+
+   double z = 0.;
+   scratch.stack.clear();
+   scratch.stack.push_back(0);
+   while (!scratch.stack.empty()) {
+      const std::size_t iNode = scratch.stack.back();
+      scratch.stack.pop_back();
+      Node const &node = nodes[iNode];
+      double const *lo = &nodeLo[iNode * nDim];
+      double const *hi = &nodeHi[iNode * nDim];
+
+      bool overlaps = true;
+      bool contained = true;
+      for (std::size_t j = 0; j < nDim; ++j) {
+         overlaps = overlaps && hi[j] >= scratch.lo[j] && lo[j] <= scratch.hi[j];
+         contained = contained && lo[j] >= scratch.lo[j] && hi[j] <= scratch.hi[j];
+      }
+      if (!overlaps)
+         continue;
+
+      if (contained) {
+         z += sumRange(node.begin, node.end, scratch.xR.data());
+      } else if (node.left == 0) {
+         z += sumLeaf(node, scratch);
+      } else {
+         scratch.stack.push_back(node.right);
+         scratch.stack.push_back(node.left);
+      }
+   }
+   return z;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 Int_t RooNDKeysPdf::getAnalyticalIntegral(RooArgSet& allVars, RooArgSet& analVars, const char* rangeName) const
@@ -1,14 +1,24 @@
 // Tests for the RooKeysPdf and friends
 // Authors: Jonas Rembser, CERN  07/2022
 
+#include <RooFit/Detail/NormalizationHelpers.h>
+#include <RooFit/Evaluator.h>
 #include <RooGenericPdf.h>
+#include <RooHelpers.h>
 #include <RooKeysPdf.h>
 #include <RooNDKeysPdf.h>
 #include <RooPlot.h>
 #include <RooRealVar.h>
 
+#include <TMath.h>
+#include <TRandom3.h>
+#include <TVectorD.h>
+
 #include "gtest/gtest.h"
 
+#include <cmath>
+#include <vector>
+
 // Test the support of RooKeysPdf and RooNDKeysPdf for weighted datasets.
 TEST(RooKeysPdf, WeightedDataset)
 {
@@ -81,3 +91,164 @@ TEST(RooKeysPdf, GenerationWithProtoData)
    // If the dataset generation worked, the chi-square is not too terrible
    EXPECT_LE(frame->chiSquare(), 2.0);
 }
+
+// Check the kernel sum of RooNDKeysPdf against a direct sum over all events,
+// and the batched evaluation against the scalar evaluation.
+TEST(RooNDKeysPdf, KernelSumAndBatchedEvaluation)
+{
+   RooHelpers::LocalChangeMsgLevel changeMsgLevel{RooFit::WARNING};
+
+   RooRealVar x{"x", "x", 0, 10};
+   RooRealVar y{"y", "y", 0, 10};
+   RooArgSet vars{x, y};
+
+   TRandom3 rng{1337};
+   RooDataSet data{"data", "data", vars};
+   while (data.numEntries() < 500) {
+      x.setVal(rng.Gaus(5.0, 1.5));
+      y.setVal(0.5 * x.getVal() + rng.Gaus(2.0, 1.0));
+      if (x.inRange(nullptr) && y.inRange(nullptr)) {
+         data.add(vars);
+      }
+   }
+
+   // Static kernels without rotation. With nSigma = 100, all events
+   // contribute to the kernel sum.
+   RooNDKeysPdf pdfStatic{"pdfStatic", "pdfStatic", {x, y}, data, "", 1.0, 100.0, false};
+
+   const int nDim = 2;
+   const int nEvents = data.numEntries();
+   const double n = std::pow(4. / (nEvents * (nDim + 2.)), 1. / (nDim + 4.));
+   double sigma[nDim];
+   for (int j = 0; j < nDim; ++j) {
+      sigma[j] = n * data.sigma(static_cast<RooRealVar &>(vars[j]));
+   }
+
+   for (double xVal : {1.0, 4.0, 5.5, 8.0}) {
+      for (double yVal : {2.0, 4.5, 7.0}) {
+         double expected = 0.0;
+         for (int i = 0; i < nEvents; ++i) {
+            const RooArgSet *event = data.get(i);
+            const double dx = (xVal - event->getRealValue("x")) / sigma[0];
+            const double dy = (yVal - event->getRealValue("y")) / sigma[1];
+            expected += std::exp(-0.5 * (dx * dx + dy * dy)) / (TMath::TwoPi() * sigma[0] * sigma[1]);
+         }
+         x.setVal(xVal);
+         y.setVal(yVal);
+         EXPECT_NEAR(pdfStatic.getVal(), expected, 1e-10 * expected);
+      }
+   }
+
+   // Adaptive kernels with rotation, in the batched evaluation.
+   RooNDKeysPdf pdf{"pdf", "pdf", {x, y}, data, "a"};
+
+   RooDataSet queries{"queries", "queries", vars};
+   for (int i = 0; i < 200; ++i) {
+      x.setVal(rng.Uniform(0.0, 10.0));
+      y.setVal(rng.Uniform(0.0, 10.0));
+      queries.add(vars);
+   }
+
+   std::unique_ptr<RooAbsReal> compiled{RooFit::Detail::compileForNormSet(pdf, vars)};
+   RooFit::Evaluator evaluator{*compiled};
+   for (auto const &item : queries.getBatches(0, queries.numEntries())) {
+      evaluator.setInput(item.first->GetName(), item.second, false);
+   }
+   std::span<const double> values = evaluator.run();
+
+   ASSERT_EQ(values.size(), std::size_t(queries.numEntries()));
+   for (int i = 0; i < queries.numEntries(); ++i) {
+      x.setVal(queries.get(i)->getRealValue("x"));
+      y.setVal(queries.get(i)->getRealValue("y"));
+      const double expected = pdf.getVal(vars);
+      EXPECT_NEAR(values[i], expected, 1e-10 * expected);
+   }
+}
+
+namespace {
+
+// Gives access to the kernels of a RooNDKeysPdf, to compute the kernel sum
+// with a plain loop over all kernels in the nSigma box around the query point,
+// like the per-event evaluation that the kernel tree has replaced.
+class RooNDKeysPdfTestAccess : public RooNDKeysPdf {
+public:
+   using RooNDKeysPdf::RooNDKeysPdf;
+
+   double referenceKernelSum(std::vector<double> const &x) const
+   {
+      TVectorD xR(_nDim);
+      for (int j = 0; j < _nDim; ++j) {
+         xR[j] = x[j];
+      }
+      if (_nDim > 1 && _rotate) {
+         xR *= *_rotMat;
+      }
+
+      const double sqrt2pi = std::sqrt(TMath::TwoPi());
+      double z = 0.;
+      for (std::size_t i = 0; i < _dataPtsR.size() && i < _idx.size(); ++i) {
+         bool inBox = true;
+         for (int j = 0; j < _nDim; ++j) {
+            inBox &= std::abs(xR[j] - _dataPtsR[i][j]) <= _nSigma * (_n * (*_sigmaR)[j]);
+         }
+         if (!inBox) {
+            continue;
+         }
+
+         TVectorD dx(_nDim);
+         for (int j = 0; j < _nDim; ++j) {
+            dx[j] = x[j] - _dataPts[i][j];
+         }
+         if (_nDim > 1 && _rotate) {
+            dx *= *_rotMat;
+         }
+         const std::vector<double> &weight = (*_weights)[_idx[i]];
+         double g = 1.;
+         for (int j = 0; j < _nDim; ++j) {
+            g *= std::exp(-dx[j] * dx[j] / (2. * weight[j] * weight[j])) / (sqrt2pi * weight[j]);
+         }
+         z += g * _wMap.at(_idx[i]);
+      }
+      return z;
+   }
+};
+
+} // namespace
+
+// Check that the kernel tree sums the same kernels as a plain loop over the
+// kernels in the nSigma box, with the default nSigma such that the boxes
+// prune most kernels, with and without rotation and adaptive kernels.
+TEST(RooNDKeysPdf, KernelTreeMatchesNSigmaBox)
+{
+   RooHelpers::LocalChangeMsgLevel changeMsgLevel{RooFit::WARNING};
+
+   RooRealVar x{"x", "x", 0, 10};
+   RooRealVar y{"y", "y", 0, 10};
+   RooArgSet vars{x, y};
+
+   TRandom3 rng{1337};
+   RooDataSet data{"data", "data", vars};
+   while (data.numEntries() < 500) {
+      x.setVal(rng.Gaus(5.0, 1.5));
+      y.setVal(0.5 * x.getVal() + rng.Gaus(2.0, 1.0));
+      if (x.inRange(nullptr) && y.inRange(nullptr)) {
+         data.add(vars);
+      }
+   }
+
+   for (bool rotate : {false, true}) {
+      for (const char *options : {"", "a"}) {
+         RooNDKeysPdfTestAccess pdf{"pdf", "pdf", {x, y}, data, options, 1.0, 3.0, rotate};
+         // the query grid also covers the tails, where only few or no kernels are in the box
+         for (int ix = 0; ix <= 20; ++ix) {
+            for (int iy = 0; iy <= 20; ++iy) {
+               x.setVal(0.5 * ix);
+               y.setVal(0.5 * iy);
+               const double expected = pdf.referenceKernelSum({x.getVal(), y.getVal()});
+               EXPECT_NEAR(pdf.getVal(), expected, 1e-10 * expected)
+                  << "rotate=" << rotate << " options=\"" << options << "\" x=" << x.getVal() << " y=" << y.getVal();
+            }
+         }
+      }
+   }
+}
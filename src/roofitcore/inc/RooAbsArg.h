@@ -451,6 +451,7 @@ public:
    static void verboseDirty(bool flag);
    void printDirty(bool depth = true) const;
    static void setDirtyInhibit(bool flag);
+   static void setSkipDirtyClients(bool flag);
 
    void graphVizTree(const char *fileName, const char *delimiter = "\n", bool useTitle = false, bool useLatex = false);
    void graphVizTree(std::ostream &os, const char *delimiter = "\n", bool useTitle = false, bool useLatex = false);
@@ -512,6 +513,10 @@ public:
    };
 
    virtual bool canComputeBatchWithCuda() const { return false; }
+   /// Whether doEval() only writes to its own output buffer and doesn't touch
+   /// any mutable state, so that the RooFit::Evaluator can run it concurrently
+   /// with other nodes in the multi-threaded mode.
+   virtual bool canComputeBatchConcurrently() const { return false; }
    virtual bool isReducerNode() const { return false; }
 
    virtual void applyWeightSquared(bool flag);
@@ -544,6 +549,7 @@ protected:
 
    /// Force element to re-evaluate itself when a value is requested.
    void setValueDirty(const RooAbsArg *source);
+   void setValueDirty(const RooAbsArg *source, std::size_t epoch);
    /// Notify that a shape-like property (*e.g.* binning) has changed.
    void setShapeDirty(const RooAbsArg *source);
 
@@ -623,6 +629,7 @@ protected:
    // Debug stuff
    static bool _verboseDirty; // Static flag controlling verbose messaging for dirty state changes
    static bool _inhibitDirty; // Static flag controlling global inhibit of dirty state propagation
+   static bool _skipDirtyClients; // Static flag to stop the value dirty propagation at clients that are already dirty
    bool _deleteWatch = false; ///<! Delete watch flag
 
    bool inhibitDirty() const;
@@ -640,6 +647,7 @@ public:
 protected:
    mutable bool _valueDirty = true; // Flag set if value needs recalculating because input values modified
    mutable bool _shapeDirty = true; // Flag set if value needs recalculating because input shapes modified
+   std::size_t _valueDirtyEpoch = 0; ///<! Last value dirty propagation that visited this object
 
    mutable OperMode _operMode = Auto; // Dirty state propagation mode
    mutable bool _fast = false;        // Allow fast access mode in getVal() and proxies
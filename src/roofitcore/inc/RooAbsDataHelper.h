@@ -18,6 +18,7 @@
 #include <RooDataSet.h>
 #include <RooRealVar.h>
 
+#include <atomic>
 #include <vector>
 #include <mutex>
 #include <cstddef>
@@ -33,7 +34,10 @@ public:
    RooAbsDataFiller();
 
    /// Move constructor. It transfers ownership of the internal RooAbsData object.
-   RooAbsDataFiller(RooAbsDataFiller &&other) : _events{std::move(other._events)}, _eventSize{other._eventSize} {}
+   RooAbsDataFiller(RooAbsDataFiller &&other)
+      : _events{std::move(other._events)}, _slots{std::move(other._slots)}, _eventSize{other._eventSize}
+   {
+   }
    RooAbsDataFiller &operator=(RooAbsDataFiller &&) = delete;
 
    /// Copy is discouraged.
@@ -50,7 +54,7 @@ public:
    /// RDataFrame interface method.
    std::string GetActionName() { return "RooDataSetHelper"; }
 
-   void ExecImpl(std::size_t nValues, std::vector<double> &vector);
+   void ExecImpl(std::size_t nValues, unsigned int slot);
    void Finalize();
 
    virtual RooAbsData &GetAbsData() = 0;
@@ -58,17 +62,38 @@ public:
    std::vector<double> &events(std::size_t slot) { return _events[slot]; }
 
 protected:
+   /// Partial results of one data-processing slot, which are filled without
+   /// locking and merged into the dataset/hist at the end.
+   struct SlotData {
+      std::vector<double> accepted; // In-range events for a RooDataSet, in the same layout as the buffered events
+      std::vector<double> weights;  // Bin weights for a RooDataHist
+      std::vector<double> sumw2;    // Sums of squared weights for a RooDataHist
+      std::vector<double> column;   // Scratch space for the values of one variable
+      std::vector<int> bins;        // Scratch space for the bin numbers
+      std::vector<char> valid;      // Scratch space for the results of the range checks
+   };
+
    void FillAbsData(const std::vector<double> &events, unsigned int eventSize);
+   void ProcessEvents(std::vector<double> const &events, SlotData &slotData);
+   void FlushAccepted(SlotData &slotData);
+   void MergeHistograms();
+   void CountInvalid(std::size_t iVar, double value);
 
    std::mutex _mutexDataset;
-   std::size_t _numInvalid = 0;
+   std::mutex _mutexMessages;
+   std::atomic<std::size_t> _numInvalid{0};
 
    std::vector<std::vector<double>> _events; // One vector of values per data-processing slot
+   std::vector<SlotData> _slots;             // One set of partial results per data-processing slot
    std::size_t _eventSize;                   // Number of variables in dataset
    std::size_t _nValues;                     // Number of variables in dataframe
 
    bool _isWeighted = false;
    bool _isDataHist = false;
+   bool _columnar = false;         // If the events are processed column-wise in the slots
+   std::vector<double> _minVals;   // Lower range limits of the variables and the weight
+   std::vector<double> _maxVals;   // Upper range limits of the variables and the weight
+   std::vector<int> _binIdxMult;   // Multipliers to compute the bin index of a RooDataHist
 };
 
 } // namespace Detail
@@ -148,7 +173,7 @@ public:
       // (an instantiation that RDataFrame requires to be well-formed).
       (vector.push_back(static_cast<double>(values)), ...);
 
-      ExecImpl(sizeof...(values), vector);
+      ExecImpl(sizeof...(values), slot);
    }
 
    DataSet_t &GetAbsData() override { return *_dataset; }
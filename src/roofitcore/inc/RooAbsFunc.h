@@ -68,6 +68,14 @@ public:
 
   virtual std::list<double>* binBoundaries(Int_t) const { return nullptr; }
 
+  /// Optional interface to evaluate the function for several points at once, for example concurrently.
+  /// The coordinates of the points are given one point after the other in `xvectors`, and there is one
+  /// output value per point. Returns `false` if not supported or if evaluation errors occurred, in which
+  /// case the caller has to evaluate the points one by one with operator().
+  virtual bool evaluateMany(std::span<const double> /*xvectors*/, std::span<double> /*out*/) const {
+    return false;
+  }
+
   /// Interface for returning an optional hint for initial sampling points when constructing a curve
   /// projected on observable.
   virtual std::list<double>* plotSamplingHint(RooAbsRealLValue& /*obs*/, double /*xlo*/, double /*xhi*/) const {
@@ -0,0 +1,61 @@
+/*
+ * Project: RooFit
+ *
+ * Copyright (c) 2024, CERN
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted according to the terms
+ * listed in LICENSE (http://roofit.sourceforge.net/license.txt)
+ */
+
+#ifndef RooFit_RooCompiledFunction_h
+#define RooFit_RooCompiledFunction_h
+
+#include <RooAbsReal.h>
+#include <RooListProxy.h>
+
+#include <ROOT/RSpan.hxx>
+
+#include <string>
+#include <vector>
+
+namespace RooFit::Experimental {
+
+class RooCompiledFunction final : public RooAbsReal {
+public:
+   RooCompiledFunction(const char *name, const char *title, std::string const &libraryPath,
+                       RooArgSet const &parameters);
+
+   RooCompiledFunction(const RooCompiledFunction &other, const char *name = nullptr);
+
+   TObject *clone(const char *newname) const override { return new RooCompiledFunction(*this, newname); }
+
+   bool hasGradient() const override { return _grad != nullptr; }
+   void gradient(double *out) const override;
+
+   void setObservables(std::span<const double> observables);
+
+   std::string const &libraryPath() const { return _libraryPath; }
+
+protected:
+   double evaluate() const override;
+
+private:
+   using Func = double (*)(double *, double const *, double const *);
+   using Grad = void (*)(double *, double const *, double const *, double *);
+
+   void loadLibrary(RooArgSet const &parameters);
+   void updateVarBuffer() const;
+
+   std::string _libraryPath;
+   RooListProxy _params;
+   Func _func = nullptr;
+   Grad _grad = nullptr;
+   mutable std::vector<double> _varBuffer;
+   std::vector<double> _observables;
+   std::vector<double> _xlArr;
+};
+
+} // namespace RooFit::Experimental
+
+#endif
@@ -22,15 +22,24 @@ class RooAbsData ;
 class RooSuperCategory ;
 class Roo1DTable ;
 
+namespace RooFit {
+namespace Detail {
+class DataWeightedAverage;
+}
+}
+
 class RooDataProjBinding : public RooRealBinding {
 public:
   RooDataProjBinding(const RooAbsReal &real, const RooAbsData& data, const RooArgSet &vars, const RooArgSet* normSet=nullptr) ;
   ~RooDataProjBinding() override ;
 
   double operator()(const double xvector[]) const override;
+  bool evaluateMany(std::span<const double> xvectors, std::span<double> out) const override;
 
 protected:
 
+  RooFit::Detail::DataWeightedAverage *batchAverage() const;
+
   mutable bool _first   ;  ///< Bit indicating if operator() has been called yet
   const RooAbsReal* _real ;  ///< Real function to be projected
   const RooAbsData* _data ;  ///< Dataset used for projection
@@ -39,6 +48,9 @@ protected:
   std::unique_ptr<RooSuperCategory> _superCat; ///< Supercategory constructed from _data's category variables
   std::unique_ptr<Roo1DTable> _catTable;       ///< Supercategory table generated from _data
 
+  mutable std::unique_ptr<RooFit::Detail::DataWeightedAverage> _average; ///<! Batched evaluation of the projection
+  mutable bool _batchEvalFailed = false;                                 ///<! Whether the batched evaluation is not possible
+
   ClassDefOverride(RooDataProjBinding,0) // RealFunc/Dataset binding for data projection of a real function
 };
 
@@ -68,11 +68,15 @@ public:
 
    void setUseGeneratedFunctionCode(bool);
    void writeDebugMacro(std::string const &) const;
+   void exportCompiledCode(std::string const &directory, std::string const &name);
 
    std::unique_ptr<ChangeOperModeRAII> setOperModes(RooAbsArg::OperMode opMode);
 
    RooFit::Evaluator &evaluator() const { return *_evaluator; }
 
+   static void setCodegenCacheDirectory(std::string const &dir);
+   static std::string const &codegenCacheDirectory();
+
 protected:
    double evaluate() const override;
 
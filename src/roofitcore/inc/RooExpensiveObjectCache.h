@@ -20,6 +20,7 @@
 #include "RooArgSet.h"
 #include "TString.h"
 #include <map>
+#include <string>
 
 class RooExpensiveObjectCache : public TObject {
 public:
@@ -28,8 +29,12 @@ public:
   RooExpensiveObjectCache(const RooExpensiveObjectCache& other) : TObject(other) {}
   ~RooExpensiveObjectCache() override ;
 
-  bool registerObject(const char* ownerName, const char* objectName, TObject& cacheObject, const RooArgSet& params) ;
-  const TObject* retrieveObject(const char* name, TClass* tclass, const RooArgSet& params) ;
+  bool registerObject(const char* ownerName, const char* objectName, TObject& cacheObject, const RooArgSet& params,
+                      const RooAbsArg* owner=nullptr) ;
+  bool registerObject(const char* ownerName, const char* objectName, TObject& cacheObject, const RooArgSet& params,
+                      std::string const& ownerKey) ;
+  const TObject* retrieveObject(const char* name, TClass* tclass, const RooArgSet& params, const RooAbsArg* owner=nullptr) ;
+  const TObject* retrieveObject(const char* name, TClass* tclass, const RooArgSet& params, std::string const& ownerKey) ;
 
   const TObject* getObj(Int_t uniqueID) ;
   bool clearObj(Int_t uniqueID) ;
@@ -40,6 +45,23 @@ public:
 
   static RooExpensiveObjectCache& instance() ;
 
+  static void setPersistentDirectory(std::string const& dir) ;
+  static std::string const& persistentDirectory() ;
+  static bool persistentStorageActive() ;
+  static std::string ownerKey(const RooAbsArg& owner, const RooArgSet& params) ;
+  static std::string persistentKey(const char* objectName, TClass* tclass, const RooArgSet& params, std::string const& ownerKey) ;
+
+  /// Suspends the persistent storage in the current thread for the lifetime
+  /// of this object, for example during a minimization, where the parameter
+  /// values are never repeated and storing the objects would only cost time.
+  class SuspendPersistentStorage {
+  public:
+     SuspendPersistentStorage() ;
+     ~SuspendPersistentStorage() ;
+     SuspendPersistentStorage(SuspendPersistentStorage const&) = delete ;
+     SuspendPersistentStorage& operator=(SuspendPersistentStorage const&) = delete ;
+  };
+
   Int_t size() const { return _map.size() ; }
   bool empty() const { return _map.empty() ; }
 
@@ -48,10 +70,11 @@ public:
    class ExpensiveObject {
    public:
       ExpensiveObject() = default;
-      ExpensiveObject(Int_t uid, const char *ownerName, TObject &payload, RooArgSet const &params);
+      ExpensiveObject(Int_t uid, const char *ownerName, TObject &payload, RooArgSet const &params,
+                      std::string const &ownerKey = "");
       ExpensiveObject(Int_t uid, const ExpensiveObject &other);
       virtual ~ExpensiveObject();
-      bool matches(TClass *tc, const RooArgSet &params);
+      bool matches(TClass *tc, const RooArgSet &params, std::string const &ownerKey = "");
 
       Int_t uid() const { return _uid; }
       const TObject *payload() const { return _payload; }
@@ -67,12 +90,16 @@ public:
       std::map<TString, double> _realRefParams; ///< Names and values of real-valued reference parameters
       std::map<TString, Int_t> _catRefParams;   ///< Names and values of discrete-valued reference parameters
       TString _ownerName;                       ///< Name of RooAbsArg object that is associated to cache contents
+      TString _ownerKey;                        ///< Hash of the structure of the owner, see RooExpensiveObjectCache::ownerKey()
 
-      ClassDef(ExpensiveObject, 2); // Cache element containing expensive object and parameter values for which object is valid
+      ClassDef(ExpensiveObject, 3); // Cache element containing expensive object and parameter values for which object is valid
    };
 
 protected:
 
+  void installObject(const char* ownerName, const char* objectName, TObject& cacheObject, const RooArgSet& params,
+                     std::string const& ownerKey) ;
+
   Int_t _nextUID = 0;
 
   std::map<TString,ExpensiveObject*> _map ;
@@ -24,12 +24,15 @@
 #include <sstream>
 #include <string>
 #include <type_traits>
+#include <typeinfo>
 #include <unordered_map>
 #include <unordered_set>
 
 template <class T>
 class RooTemplateProxy;
 
+class TClass;
+
 namespace RooFit {
 namespace Experimental {
 
@@ -229,6 +232,12 @@ std::string CodegenContext::buildArgSpanImpl(std::span<const T> arr)
 
 void declareDispatcherCode(std::string const &funcName);
 
+bool hasPrioritizedOverload(std::string const &funcName, TClass const &tclass);
+
+using CodegenImplFunc = void (*)(RooAbsArg &, CodegenContext &);
+
+void registerCodegenImpl(std::type_info const &type, CodegenImplFunc func);
+
 void codegen(RooAbsArg &arg, CodegenContext &ctx);
 
 } // namespace Experimental
@@ -24,6 +24,10 @@
 
 #include <Math/Util.h>
 
+namespace RooBatchCompute {
+struct ReduceNLLOutput;
+}
+
 namespace RooFit {
 namespace Detail {
 
@@ -63,6 +67,11 @@ public:
    bool canComputeBatchWithCuda() const override { return _statistic == Statistic::NLL && !_binnedL; }
    bool isReducerNode() const override { return true; }
 
+   // For the block-wise evaluation of the unbinned likelihood in the RooFit::Evaluator
+   bool canReduceBlockwise() const { return _statistic == Statistic::NLL && !_binnedL; }
+   void accumulateNLL(RooFit::EvalContext &, RooBatchCompute::ReduceNLLOutput &nllOut) const;
+   void finalizeNLL(RooFit::EvalContext &, RooBatchCompute::ReduceNLLOutput const &nllOut) const;
+
    void setPrefix(std::string const &prefix);
 
    void applyWeightSquared(bool flag) override;
@@ -94,12 +94,22 @@ public:
          return;
       std::size_t idx = arg->dataToken();
       _ctx[idx] = span;
+      _versions[idx] = nextVersion();
    }
 
    void setConfig(RooAbsArg const *arg, RooBatchCompute::Config const &config);
 
    std::span<const double> at(RooAbsArg const *arg, RooAbsArg const *caller = nullptr);
 
+   /// Returns a number that changes every time new values are set for the
+   /// given argument, unique across all contexts. If it didn't change, the
+   /// values didn't change either. Returns zero if this is not known, in which
+   /// case the values need to be compared.
+   inline std::size_t valueVersion(RooAbsArg const *arg) const
+   {
+      return arg->hasDataToken() ? _versions[arg->dataToken()] : 0;
+   }
+
    template <class T>
    inline std::span<const double> at(RooTemplateProxy<T> const &proxy)
    {
@@ -117,9 +127,12 @@ public:
 private:
    friend class Evaluator;
 
+   static std::size_t nextVersion();
+
    OffsetMode _offsetMode = OffsetMode::WithoutOffset;
    std::span<double> _currentOutput;
    std::vector<std::span<const double>> _ctx;
+   std::vector<std::size_t> _versions;
    bool _enableVectorBuffers = false;
    std::vector<std::vector<double>> _buffers;
    std::size_t _bufferIdx = 0;
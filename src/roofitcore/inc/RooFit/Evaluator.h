@@ -19,6 +19,7 @@
 
 #include <RConfig.h>
 
+#include <atomic>
 #include <memory>
 
 class ChangeOperModeRAII;
@@ -31,6 +32,11 @@ class AbsBufferManager;
 namespace RooFit {
 
 struct NodeInfo;
+struct FusedGroup;
+
+namespace Detail {
+class WorkStealingPool;
+}
 
 class Evaluator {
 public:
@@ -46,14 +52,26 @@ public:
 
    std::unique_ptr<ChangeOperModeRAII> setOperModes(RooAbsArg::OperMode opMode);
 
+   void setUseSinglePrecision(bool flag);
+
+   static void setDefaultNThreads(unsigned int nThreads);
+   static unsigned int defaultNThreads();
+
+   static void setDefaultFusedEvaluation(bool flag);
+   static bool defaultFusedEvaluation();
+
 private:
+   void runParallel();
+   void buildFusedGroups();
+   void processFusedNode(NodeInfo &nodeInfo);
+   void computeFusedGroup(FusedGroup &group);
    void processVariable(NodeInfo &nodeInfo);
    void processCategory(NodeInfo &nodeInfo);
    void setClientsDirty(NodeInfo &nodeInfo);
    std::span<const double> getValHeterogeneous();
    void markGPUNodes();
    void assignToGPU(NodeInfo &info);
-   void computeCPUNode(const RooAbsArg *node, NodeInfo &info);
+   void computeCPUNode(const RooAbsArg *node, NodeInfo &info, RooFit::EvalContext &ctx);
    void setOperMode(RooAbsArg *arg, RooAbsArg::OperMode opMode);
    void syncDataTokens();
    void updateOutputSizes();
@@ -68,6 +86,15 @@ private:
    std::vector<NodeInfo> _nodes;                             // the ordered computation graph
    std::unordered_map<TNamed const *, NodeInfo *> _nodesMap; // for quick lookup of nodes
    std::unique_ptr<ChangeOperModeRAII> _operModeChanges;
+   std::unique_ptr<Detail::WorkStealingPool> _threadPool;
+   std::vector<RooFit::EvalContext> _threadEvalContexts; // one per additional thread
+   std::unique_ptr<std::atomic<int>[]> _remDirtyServers; // per node, for the multi-threaded scheduling
+   std::vector<NodeInfo *> _dirtyNodes;
+   bool _fusedEvaluation = false;
+   std::vector<FusedGroup> _fusedGroups;
+
+   static unsigned int _defaultNThreads;
+   static bool _defaultFusedEvaluation;
 };
 
 } // end namespace RooFit
@@ -257,7 +257,7 @@ RooCmdArg Optimize(Int_t flag = 2);
 
 class EvalBackend : public RooCmdArg {
 public:
-   enum class Value { Legacy, Cpu, Cuda, Codegen, CodegenNoGrad };
+   enum class Value { Legacy, Cpu, Cuda, Codegen, CodegenNoGrad, CpuFloat };
 
    EvalBackend(Value value);
 
@@ -268,6 +268,7 @@ public:
    static EvalBackend Cuda();
    static EvalBackend Codegen();
    static EvalBackend CodegenNoGrad();
+   static EvalBackend CpuFloat();
 
    Value value() const { return static_cast<Value>(getInt(0)); }
 
@@ -50,6 +50,7 @@ protected:
 
    // It doesn't make sense to use the GPU if the polynomial has no terms.
    inline bool canComputeBatchWithCuda() const override { return !_coefList.empty(); }
+   inline bool canComputeBatchConcurrently() const override { return !_coefList.empty(); }
 
 private:
    friend class RooPolynomial;
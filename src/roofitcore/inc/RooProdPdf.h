@@ -219,6 +219,7 @@ public:
    inline bool selfNormalized() const override { return true; }
 
    inline bool canComputeBatchWithCuda() const override { return true; }
+   inline bool canComputeBatchConcurrently() const override { return true; }
 
    void doEval(RooFit::EvalContext &ctx) const override;
 
@@ -19,6 +19,8 @@
 #include "Rtypes.h"
 #include "TRandom.h"
 
+#include <memory>
+
 class RooQuasiRandomGenerator;
 
 class RooRandom {
@@ -37,11 +39,33 @@ public:
   static bool quasi(UInt_t dimension, double vector[],
             RooQuasiRandomGenerator *generator= quasiGenerator());
 
+  static void setStreamSeed(ULong64_t seed);
+  static ULong64_t streamSeed();
+  static std::unique_ptr<TRandom> stream(ULong64_t index, UInt_t purpose = 0, ULong64_t seed = streamSeed());
+  static ULong64_t currentStreamId();
+
+  /// Replaces the random number generator returned by randomGenerator() in
+  /// the current thread with stream(index, purpose, seed) while it is alive.
+  class StreamScope {
+  public:
+    StreamScope(ULong64_t index, UInt_t purpose = 0, ULong64_t seed = streamSeed());
+    ~StreamScope();
+
+    StreamScope(const StreamScope &) = delete;
+    StreamScope &operator=(const StreamScope &) = delete;
+
+  private:
+    std::unique_ptr<TRandom> _stream;
+    TRandom *_previousStream = nullptr;
+    ULong64_t _previousStreamId = 0;
+  };
+
 private:
   RooRandom();
 
   static TRandom* _theGenerator; ///< random number generator
   static RooQuasiRandomGenerator* _theQuasiGenerator; ///< quasi random number sequence generator
+  static ULong64_t _streamSeed; ///< seed for the counter-based random number streams
 
   // free resources when library is unloaded
   struct Guard { ~Guard(); };
@@ -38,6 +38,7 @@ protected:
    double evaluate() const override;
    void doEval(RooFit::EvalContext &) const override;
    inline bool canComputeBatchWithCuda() const override { return true; }
+   inline bool canComputeBatchConcurrently() const override { return true; }
 
    RooRealProxy _numerator;
    RooRealProxy _denominator;
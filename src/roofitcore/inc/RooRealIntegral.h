@@ -140,6 +140,7 @@ protected:
   TNamed* _rangeName = nullptr;
 
   mutable std::unique_ptr<RooArgSet> _params; ///<! cache for set of parameters
+  mutable std::string _eocOwnerKey; ///<! structural key for the expensive object cache
 
   bool _cacheNum = false;           ///< Cache integral if numeric
   static Int_t _cacheAllNDim ; ///<! Cache all integrals with given numeric dimension
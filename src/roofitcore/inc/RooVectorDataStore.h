@@ -172,6 +172,8 @@ public:
 
   void loadValues(const RooAbsDataStore *tds, const RooFormulaVar* select=nullptr, const char* rangeName=nullptr, std::size_t nStart=0, std::size_t nStop = std::numeric_limits<std::size_t>::max()) override;
 
+  bool loadValuesFromTree(const TTree& t, const RooFormulaVar* select=nullptr);
+
   void dump() override;
 
   void setExternalWeightArray(const double* arrayWgt, const double* arrayWgtErrLo,
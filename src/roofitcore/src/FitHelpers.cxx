@@ -894,6 +894,9 @@ std::unique_ptr<RooAbsReal> createNLL(RooAbsPdf &pdf, RooAbsData &data, const Ro
       if (evalBackend == RooFit::EvalBackend::Value::CodegenNoGrad) {
          nllWrapper->setUseGeneratedFunctionCode(true);
       }
+      if (evalBackend == RooFit::EvalBackend::Value::CpuFloat) {
+         nllWrapper->evaluator().setUseSinglePrecision(true);
+      }
 
       nllWrapper->addOwnedComponents(std::move(nll));
       nllWrapper->addOwnedComponents(std::move(pdfClone));
@@ -1115,6 +1118,9 @@ std::unique_ptr<RooAbsReal> createChi2(RooAbsReal &real, RooDataHist &data, cons
       if (evalBackend == RooFit::EvalBackend::Value::CodegenNoGrad) {
          wrapper->setUseGeneratedFunctionCode(true);
       }
+      if (evalBackend == RooFit::EvalBackend::Value::CpuFloat) {
+         wrapper->evaluator().setUseSinglePrecision(true);
+      }
 
       RooAbsReal::setEvalErrorLoggingMode(RooAbsReal::PrintErrors);
       return wrapper;
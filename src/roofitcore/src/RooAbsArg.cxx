@@ -90,12 +90,14 @@ for single nodes.
 #include <TVirtualStreamerInfo.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <fstream>
 #include <sstream>
 
 bool RooAbsArg::_verboseDirty(false);
 bool RooAbsArg::_inhibitDirty(false);
+bool RooAbsArg::_skipDirtyClients(false);
 bool RooAbsArg::inhibitDirty() const
 {
    return _inhibitDirty && !_localNoInhibitDirty;
@@ -103,6 +105,11 @@ bool RooAbsArg::inhibitDirty() const
 
 namespace {
 
+// Counter of the value dirty propagations, to visit every client only once
+// per propagation. It is atomic, because independent graphs can be
+// invalidated concurrently, for example by RooFit::Detail::DataWeightedAverage.
+std::atomic<std::size_t> dirtyEpochCounter{0};
+
 auto &ioEvoList()
 {
    // temporary holding list for proxies needed in schema evolution
@@ -211,6 +218,19 @@ void RooAbsArg::setDirtyInhibit(bool flag)
    _inhibitDirty = flag;
 }
 
+/// Stop the propagation of the value dirty flag at clients that are already
+/// dirty, in addition to the clients that were already visited in the same
+/// propagation. This avoids traversing the whole graph above a variable every
+/// time it is changed, for example when many parameters of a large model are
+/// set one after the other. It is only correct if every object that is
+/// evaluated also evaluates all its value servers, because otherwise a server
+/// can stay dirty while its clients are clean. Therefore, it is off by default.
+
+void RooAbsArg::setSkipDirtyClients(bool flag)
+{
+   _skipDirtyClients = flag;
+}
+
 /// Activate verbose messaging related to dirty flag propagation
 
 void RooAbsArg::verboseDirty(bool flag)
@@ -789,6 +809,14 @@ bool RooAbsArg::observableOverlaps(const RooArgSet *nset, const RooAbsArg &testA
 /// state propagation mode, this call has no effect.
 
 void RooAbsArg::setValueDirty(const RooAbsArg *source)
+{
+   setValueDirty(source, ++dirtyEpochCounter);
+}
+
+/// Propagate the value dirty state as part of the propagation with the given
+/// epoch, in which every object is visited only once.
+
+void RooAbsArg::setValueDirty(const RooAbsArg *source, std::size_t epoch)
 {
    if (_operMode != Auto || _inhibitDirty)
       return;
@@ -808,7 +836,12 @@ void RooAbsArg::setValueDirty(const RooAbsArg *source)
                            << "): cyclical dependency detected, source = " << source->GetName() << std::endl;
       // assert(0) ;
       return;
+   } else if (_valueDirtyEpoch == epoch) {
+      // Already reached by another path in this propagation, which happens
+      // for every shared server in diamond-shaped graphs.
+      return;
    }
+   _valueDirtyEpoch = epoch;
 
    // Propagate dirty flag to all clients if this is a down->up transition
    if (_verboseDirty) {
@@ -820,7 +853,10 @@ void RooAbsArg::setValueDirty(const RooAbsArg *source)
    _valueDirty = true;
 
    for (auto client : _clientListValue) {
-      client->setValueDirty(source);
+      if (_skipDirtyClients && client->_valueDirty && client->isDerived()) {
+         continue;
+      }
+      client->setValueDirty(source, epoch);
    }
 }
 
@@ -129,10 +129,27 @@ RooAbsCachedPdf::PdfCacheElem* RooAbsCachedPdf::getCache(const RooArgSet* nset,
   // Create and fill cache
   cache = createCache(nset) ;
 
-  fillCacheObject(*cache) ;
+  // Check if we have contents registered already in the expensive object
+  // cache. It is only used with the persistent storage, to share the
+  // histograms between processes that build the same model.
+  if (RooExpensiveObjectCache::persistentStorageActive()) {
+    RooArgSet const& params = cache->paramTracker()->parameters() ;
+    const std::string ownerKey = RooExpensiveObjectCache::ownerKey(*this, params) ;
+    auto htmp = static_cast<RooDataHist const*>(expensiveObjectCache().retrieveObject(cache->hist()->GetName(),RooDataHist::Class(),
+                                                                                     params,ownerKey)) ;
+    if (htmp) {
+      cache->hist()->reset() ;
+      cache->hist()->add(*htmp) ;
+    } else {
+      fillCacheObject(*cache) ;
 
-  auto eoclone = new RooDataHist(*cache->hist()) ;
-  eoclone->removeSelfFromDir() ;
+      auto eoclone = new RooDataHist(*cache->hist()) ;
+      eoclone->removeSelfFromDir() ;
+      expensiveObjectCache().registerObject(GetName(),cache->hist()->GetName(),*eoclone,params,ownerKey) ;
+    }
+  } else {
+    fillCacheObject(*cache) ;
+  }
 
   // Store this cache configuration
   int code = _cacheMgr.setObj(nset,nullptr,(static_cast<RooAbsCacheElement*>(cache)),nullptr) ;
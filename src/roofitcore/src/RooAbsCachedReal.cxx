@@ -131,10 +131,27 @@ RooAbsCachedReal::FuncCacheElem* RooAbsCachedReal::getCache(const RooArgSet* nse
     arg->setOperMode(ADirty);
   }
 
-  fillCacheObject(*cache) ;
+  // Check if we have contents registered already in the expensive object
+  // cache. It is only used with the persistent storage, to share the
+  // histograms between processes that build the same model.
+  if (RooExpensiveObjectCache::persistentStorageActive()) {
+    RooArgSet const& params = cache->paramTracker()->parameters() ;
+    const std::string ownerKey = RooExpensiveObjectCache::ownerKey(*this, params) ;
+    auto htmp = static_cast<RooDataHist const*>(expensiveObjectCache().retrieveObject(cache->hist()->GetName(),RooDataHist::Class(),
+                                                                                     params,ownerKey)) ;
+    if (htmp) {
+      cache->hist()->reset() ;
+      cache->hist()->add(*htmp) ;
+    } else {
+      fillCacheObject(*cache) ;
 
-  RooDataHist* eoclone = new RooDataHist(*cache->hist()) ;
-  eoclone->removeSelfFromDir() ;
+      RooDataHist* eoclone = new RooDataHist(*cache->hist()) ;
+      eoclone->removeSelfFromDir() ;
+      expensiveObjectCache().registerObject(GetName(),cache->hist()->GetName(),*eoclone,params,ownerKey) ;
+    }
+  } else {
+    fillCacheObject(*cache) ;
+  }
 
   // Store this cache configuration
   Int_t code = _cacheMgr.setObj(nset,nullptr,((RooAbsCacheElement*)cache),nullptr) ;
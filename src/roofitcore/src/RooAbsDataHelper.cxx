@@ -12,14 +12,25 @@
 
 #include <RooAbsDataHelper.h>
 
+#include <RooBinning.h>
 #include <RooMsgService.h>
 #include <RooDataSet.h>
 #include <RooDataHist.h>
+#include <RooNumber.h>
+#include <RooUniformBinning.h>
 
 #include <TROOT.h>
 
+#include <limits>
 #include <stdexcept>
 
+namespace {
+
+// Number of buffered values after which the events of a slot are processed.
+constexpr std::size_t columnarBufferSize = 16384;
+
+} // namespace
+
 namespace RooFit {
 namespace Detail {
 
@@ -27,15 +38,66 @@ RooAbsDataFiller::RooAbsDataFiller()
 {
    const auto nSlots = ROOT::IsImplicitMTEnabled() ? ROOT::GetThreadPoolSize() : 1;
    _events.resize(nSlots);
+   _slots.resize(nSlots);
 }
 
+/// Prepare the filling. If all variables are real-valued, the events are
+/// processed column-wise by each data-processing slot without locking: the
+/// range checks are done in the slots, and for a RooDataHist each slot also
+/// computes the bin numbers and fills its own array of bin weights. These
+/// partial results are merged into the dataset/hist in Finalize(). The
+/// column-wise processing of a RooDataHist requires that the binnings are
+/// RooUniformBinning or RooBinning, because the bin numbers of other
+/// binnings can't be computed concurrently.
 void RooAbsDataFiller::Initialize()
 {
    RooAbsData &absData = GetAbsData();
+   const RooArgSet &argSet = *absData.get();
 
-   _eventSize = absData.get()->size();
+   _eventSize = argSet.size();
    _isWeighted = absData.isWeighted();
    _isDataHist = std::string{absData.ClassName()} != "RooDataSet";
+
+   auto addRange = [&](RooAbsRealLValue const *arg) {
+      const double inf = std::numeric_limits<double>::infinity();
+      _minVals.push_back(arg && !RooNumber::isInfinite(arg->getMin()) ? arg->getMin() : -inf);
+      _maxVals.push_back(arg && !RooNumber::isInfinite(arg->getMax()) ? arg->getMax() : inf);
+   };
+
+   _columnar = true;
+   _minVals.clear();
+   _maxVals.clear();
+   for (RooAbsArg *arg : argSet) {
+      auto *lvalue = dynamic_cast<RooAbsRealLValue *>(arg);
+      if (!lvalue) {
+         _columnar = false;
+         return;
+      }
+      addRange(lvalue);
+   }
+   // The weight is only range checked for a RooDataSet
+   addRange(!_isDataHist && _isWeighted ? static_cast<RooDataSet &>(absData).weightVar() : nullptr);
+
+   if (!_isDataHist)
+      return;
+
+   auto *hist = dynamic_cast<RooDataHist *>(&absData);
+   if (!hist) {
+      _columnar = false;
+      return;
+   }
+   auto const &binnings = hist->getBinnings();
+   _binIdxMult.assign(binnings.size(), 1);
+   for (std::size_t i = binnings.size(); i-- > 0;) {
+      RooAbsBinning const *binning = binnings[i].get();
+      if (!dynamic_cast<RooUniformBinning const *>(binning) && !dynamic_cast<RooBinning const *>(binning)) {
+         _columnar = false;
+         return;
+      }
+      if (i > 0) {
+         _binIdxMult[i - 1] = _binIdxMult[i] * binning->numBins();
+      }
+   }
 }
 
 /// Append all `events` to the internal RooDataSet or increment the bins of a RooDataHist at the given locations.
@@ -103,23 +165,161 @@ void RooAbsDataFiller::FillAbsData(const std::vector<double> &events, unsigned i
    }
 }
 
+/// Log that an event was skipped because the value of the variable with index
+/// `iVar` is out of range. Can be called concurrently from different slots.
+void RooAbsDataFiller::CountInvalid(std::size_t iVar, double value)
+{
+   const std::size_t numInvalid = ++_numInvalid;
+   if (numInvalid > 5)
+      return;
+
+   const std::lock_guard<std::mutex> guard(_mutexMessages);
+   RooAbsData &absData = GetAbsData();
+   const auto prefix = std::string(absData.ClassName()) + "Helper::FillAbsData(" + absData.GetName() + ") ";
+   if (numInvalid < 5) {
+      RooAbsArg const *arg =
+         iVar < _eventSize ? (*absData.get())[iVar] : static_cast<RooDataSet &>(absData).weightVar();
+      oocoutI(nullptr, DataHandling) << prefix << "Skipping event because " << arg->GetName()
+                                     << " cannot accommodate the value " << value << "\n";
+   } else {
+      oocoutI(nullptr, DataHandling) << prefix << "Skipping ...\n";
+   }
+}
+
+/// Process the buffered `events` of a slot into its partial results. For a
+/// RooDataSet, the events that are in range are collected, and for a
+/// RooDataHist, their weights are added to the bin weights of the slot.
+/// Doesn't modify the dataset/hist, so it can be called concurrently for
+/// different slots.
+void RooAbsDataFiller::ProcessEvents(std::vector<double> const &events, SlotData &slotData)
+{
+   if (events.empty())
+      return;
+
+   const std::size_t nEvents = events.size() / _nValues;
+   const bool hasWeight = _nValues > _eventSize;
+
+   // Discard entries outside the variable definition range, like in FillAbsData()
+   std::vector<char> &valid = slotData.valid;
+   valid.assign(nEvents, 1);
+   for (std::size_t i = 0; i < nEvents; ++i) {
+      const double *event = events.data() + i * _nValues;
+      for (std::size_t j = 0; j < _nValues; ++j) {
+         if (event[j] > _maxVals[j] || event[j] < _minVals[j]) {
+            valid[i] = 0;
+            CountInvalid(j, event[j]);
+            break;
+         }
+      }
+   }
+
+   if (!_isDataHist) {
+      for (std::size_t i = 0; i < nEvents; ++i) {
+         if (valid[i]) {
+            slotData.accepted.insert(slotData.accepted.end(), events.begin() + i * _nValues,
+                                     events.begin() + (i + 1) * _nValues);
+         }
+      }
+      return;
+   }
+
+   auto &hist = static_cast<RooDataHist &>(GetAbsData());
+   if (slotData.weights.empty()) {
+      slotData.weights.assign(hist.numEntries(), 0.0);
+      slotData.sumw2.assign(hist.numEntries(), 0.0);
+   }
+
+   // Compute the bin numbers column by column
+   auto const &binnings = hist.getBinnings();
+   slotData.bins.assign(nEvents, 0);
+   slotData.column.resize(nEvents);
+   for (std::size_t j = 0; j < _eventSize; ++j) {
+      for (std::size_t i = 0; i < nEvents; ++i) {
+         slotData.column[i] = events[i * _nValues + j];
+      }
+      binnings[j]->binNumbers(slotData.column.data(), slotData.bins.data(), nEvents, _binIdxMult[j]);
+   }
+
+   for (std::size_t i = 0; i < nEvents; ++i) {
+      if (!valid[i])
+         continue;
+      const double weight = hasWeight ? events[i * _nValues + _eventSize] : 1.0;
+      slotData.weights[slotData.bins[i]] += weight;
+      slotData.sumw2[slotData.bins[i]] += weight * weight;
+   }
+}
+
+/// Append the in-range events that were collected by a slot to the
+/// RooDataSet. The caller has to hold the lock for the dataset.
+void RooAbsDataFiller::FlushAccepted(SlotData &slotData)
+{
+   RooAbsData &absData = GetAbsData();
+   const RooArgSet &argSet = *absData.get();
+   const bool hasWeight = _nValues > _eventSize;
+
+   std::vector<double> const &events = slotData.accepted;
+   for (std::size_t i = 0; i < events.size(); i += _nValues) {
+      for (std::size_t j = 0; j < _eventSize; ++j) {
+         static_cast<RooAbsRealLValue *>(argSet[j])->setVal(events[i + j]);
+      }
+      absData.add(argSet, hasWeight ? events[i + _eventSize] : 1.0);
+   }
+   slotData.accepted.clear();
+}
+
+/// Sum the bin weights of all slots and add them to the RooDataHist. The sums
+/// of squared weights are only tracked if there were weights different from
+/// one, like when filling the events one by one.
+void RooAbsDataFiller::MergeHistograms()
+{
+   auto &hist = static_cast<RooDataHist &>(GetAbsData());
+   const std::size_t nBins = hist.numEntries();
+
+   std::vector<double> weights(nBins, 0.0);
+   std::vector<double> sumw2(nBins, 0.0);
+   for (SlotData &slotData : _slots) {
+      if (slotData.weights.empty())
+         continue;
+      for (std::size_t bin = 0; bin < nBins; ++bin) {
+         weights[bin] += slotData.weights[bin];
+         sumw2[bin] += slotData.sumw2[bin];
+      }
+      slotData = SlotData{};
+   }
+
+   hist.addBinContents(weights, sumw2);
+}
+
 /// Empty all buffers into the dataset/hist to finish processing.
 void RooAbsDataFiller::Finalize()
 {
    RooAbsData &absData = GetAbsData();
 
-   for (auto &vector : _events) {
-      FillAbsData(vector, _nValues);
-      vector.clear();
+   if (_columnar) {
+      for (std::size_t slot = 0; slot < _events.size(); ++slot) {
+         ProcessEvents(_events[slot], _slots[slot]);
+         _events[slot].clear();
+         if (!_isDataHist) {
+            FlushAccepted(_slots[slot]);
+         }
+      }
+      if (_isDataHist) {
+         MergeHistograms();
+      }
+   } else {
+      for (auto &vector : _events) {
+         FillAbsData(vector, _nValues);
+         vector.clear();
+      }
    }
 
    if (_numInvalid > 0) {
       const auto prefix = std::string(absData.ClassName()) + "Helper::Finalize(" + absData.GetName() + ") ";
-      oocoutW(nullptr, DataHandling) << prefix << "Ignored " << _numInvalid << " out-of-range events\n";
+      oocoutW(nullptr, DataHandling) << prefix << "Ignored " << _numInvalid.load() << " out-of-range events\n";
    }
 }
 
-void RooAbsDataFiller::ExecImpl(std::size_t nValues, std::vector<double> &vector)
+void RooAbsDataFiller::ExecImpl(std::size_t nValues, unsigned int slot)
 {
    if (nValues != _eventSize && !(_isWeighted && nValues == _eventSize + 1)) {
       throw std::invalid_argument(
@@ -130,10 +330,27 @@ void RooAbsDataFiller::ExecImpl(std::size_t nValues, std::vector<double> &vector
 
    _nValues = nValues;
 
-   if (vector.size() > 1024 && _mutexDataset.try_lock()) {
-      const std::lock_guard<std::mutex> guard(_mutexDataset, std::adopt_lock_t());
-      FillAbsData(vector, _nValues);
+   std::vector<double> &vector = _events[slot];
+
+   if (!_columnar) {
+      if (vector.size() > 1024 && _mutexDataset.try_lock()) {
+         const std::lock_guard<std::mutex> guard(_mutexDataset, std::adopt_lock_t());
+         FillAbsData(vector, _nValues);
+         vector.clear();
+      }
+      return;
+   }
+
+   if (vector.size() > columnarBufferSize) {
+      SlotData &slotData = _slots[slot];
+      ProcessEvents(vector, slotData);
       vector.clear();
+      // The bin weights of a RooDataHist are merged at the end, but the events
+      // for a RooDataSet are appended whenever the dataset is not busy.
+      if (!_isDataHist && slotData.accepted.size() > columnarBufferSize && _mutexDataset.try_lock()) {
+         const std::lock_guard<std::mutex> guard(_mutexDataset, std::adopt_lock_t());
+         FlushAccepted(slotData);
+      }
    }
 }
 
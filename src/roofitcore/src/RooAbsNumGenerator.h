@@ -52,7 +52,7 @@ public:
   virtual const RooArgSet *generateEvent(UInt_t remaining, double& resampleRatio) = 0;
   virtual double getFuncMax() { return 0 ; }
 
-  void attachParameters(const RooArgSet& vars) ;
+  virtual void attachParameters(const RooArgSet& vars) ;
 
   // Advertisement of capabilities
   virtual bool canSampleCategories() const { return false ; }
@@ -866,6 +866,12 @@ double RooAbsPdf::extendedTerm(RooAbsData const& data, bool weightSquared, bool
  *                             this backend can't be used.
  *   <tr><td> **codegen_no_grad** <td> **Experimental** - Same as **codegen**, but doesn't generate and compile the gradient code and use the regular numerical differentiation instead.
  *                                     This is expected to be slower, but useful for debugging problems with the analytic gradient.
+ *   <tr><td> **cpu_float** <td> **Experimental** - Same as **cpu**, but with float arithmetic in selected kernels: the pdfs that have an explicitly vectorized
+ *                               implementation in the AVX2 and AVX-512 builds of the RooBatchCompute library do their arithmetic in single precision,
+ *                               which processes twice as many events per instruction. The data and the intermediate results are still stored in double precision,
+ *                               so the memory bandwidth is the same as for **cpu**, and the likelihood is still summed in double precision.
+ *                               With the generic, SSE4 and AVX builds, this backend is the same as **cpu**, and a warning is printed.
+ *                               Only use this if your fit tolerates a relative precision of about \f$10^{-6}\f$ for the single event probabilities.
  *   </table>
  * <tr><td> `SplitRange(bool flag)`         <td> Use separate fit ranges in a simultaneous fit. Actual range name for each subsample is assumed to
  *                                               be `rangeName_indexState`, where `indexState` is the state of the master index category of the simultaneous fit.
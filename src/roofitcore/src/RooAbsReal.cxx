@@ -50,8 +50,7 @@
 #include "RooDataSet.h"
 #include "RooDerivative.h"
 #include "RooFirstMoment.h"
-#include "RooFit/BatchModeDataHelpers.h"
-#include "RooFit/Evaluator.h"
+#include "RooFit/DataWeightedAverage.h"
 #include "RooFitResult.h"
 #include "RooFormulaVar.h"
 #include "RooFunctor.h"
@@ -95,6 +94,7 @@
 #include <TSystem.h> // To print stack traces when caching errors are detected
 #endif
 
+#include <atomic>
 #include <iomanip>
 #include <iostream>
 #include <limits>
@@ -108,58 +108,40 @@ namespace {
 class ScaledDataWeightedAverage : public RooAbsFunc {
 public:
    ScaledDataWeightedAverage(RooAbsReal const &arg, RooAbsData const &data, double scaleFactor, RooAbsRealLValue &var)
-      : RooAbsFunc{1}, _var{var}, _dataWeights{data.getWeightBatch(0, data.numEntries())}, _scaleFactor{scaleFactor}
+      : RooAbsFunc{1},
+        _var{var},
+        _average{std::make_unique<RooFit::Detail::DataWeightedAverage>(arg, data, *data.get(), RooArgSet{var})},
+        _scaleFactor{scaleFactor}
    {
-      _arg = RooFit::Detail::compileForNormSet(arg, *data.get());
-      _arg->recursiveRedirectServers(RooArgList{var});
-      _evaluator = std::make_unique<RooFit::Evaluator>(*_arg);
-      std::stack<std::vector<double>>{}.swap(_vectorBuffers);
-      auto dataSpans = RooFit::BatchModeDataHelpers::getDataSpans(data, "", nullptr, /*skipZeroWeights=*/false,
-                                                                   /*takeGlobalObservablesFromData=*/true,
-                                                                   _vectorBuffers);
-      for (auto const& item : dataSpans) {
-         _evaluator->setInput(item.first->GetName(), item.second, false);
-      }
    }
 
-   double operator()(const double xvector[]) const override
-   {
-      double oldVal = _var.getVal();
-      _var.setVal(xvector[0]);
+   double operator()(const double xvector[]) const override { return (*_average)(xvector) * _scaleFactor; }
 
-      double out = 0.0;
-      std::span<const double> pdfValues = _evaluator->run();
-      if (_dataWeights.empty()) {
-         out = std::accumulate(pdfValues.begin(), pdfValues.end(), 0.0) / pdfValues.size();
-      } else {
-         double weightsSum = 0.0;
-         for (std::size_t i = 0; i < pdfValues.size(); ++i) {
-            out += pdfValues[i] * _dataWeights[i];
-            weightsSum += _dataWeights[i];
-         }
-         out /= weightsSum;
+   bool evaluateMany(std::span<const double> xvectors, std::span<double> out) const override
+   {
+      if (!_average->evaluateMany(xvectors, out)) {
+         return false;
       }
-      out *= _scaleFactor;
-
-      _var.setVal(oldVal);
-      return out;
+      for (double &y : out) {
+         y *= _scaleFactor;
+      }
+      return true;
    }
+
    double getMinLimit(UInt_t /*dimension*/) const override { return _var.getMin(); }
    double getMaxLimit(UInt_t /*dimension*/) const override { return _var.getMax(); }
 
 private:
    RooAbsRealLValue &_var;
-   std::unique_ptr<RooAbsReal> _arg;
-   std::span<const double> _dataWeights;
+   std::unique_ptr<RooFit::Detail::DataWeightedAverage> _average;
    double _scaleFactor;
-   std::unique_ptr<RooFit::Evaluator> _evaluator;
-   std::stack<std::vector<double>> _vectorBuffers;
 };
 
 struct EvalErrorData {
    using ErrorList = std::map<const RooAbsArg *, std::pair<std::string, std::list<RooAbsReal::EvalError>>>;
    RooAbsReal::ErrorLoggingMode mode = RooAbsReal::PrintErrors;
-   int count = 0;
+   // Atomic, because the errors can be counted from several threads.
+   std::atomic<int> count = 0;
    ErrorList errorList;
 };
 
@@ -26,6 +26,17 @@ the accept/reject sampling technique on any positively valued function.
 The RooAcceptReject generator is used by the various generator context
 classes to take care of generation of observables for which p.d.fs
 do not define internal methods
+
+If only real valued observables are generated, the trial events are
+generated in batches. The function values for all events in a batch are
+computed in one go with the RooFit::Evaluator, such that the vectorized
+RooBatchCompute kernels are used for the p.d.f.s that support them. The
+random numbers are drawn in the same order as for the generation of single
+events, so the sequence of trial events is not changed by the batching. If the
+function can't be evaluated with the RooFit::Evaluator, the events are
+generated one by one. The number of trial events per batch is set with the
+`batchSize` parameter in the "RooAcceptReject" section of the RooNumGenConfig.
+A batch size of one disables the batched evaluation.
 **/
 
 #include "Riostream.h"
@@ -42,12 +53,15 @@ do not define internal methods
 #include "RooRealBinding.h"
 #include "RooNumGenFactory.h"
 #include "RooNumGenConfig.h"
+#include "RooFit/Detail/NormalizationHelpers.h"
 
 #include "TFoam.h"
 #include "TNamed.h"
 
+#include <algorithm>
 #include <cassert>
-
+#include <cmath>
+#include <stdexcept>
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Register RooIntegrator1D, is parameters and capabilities with RooNumIntFactory
@@ -58,9 +72,10 @@ void RooAcceptReject::registerSampler(RooNumGenFactory& fact)
   RooRealVar nTrial1D("nTrial1D","Number of trial samples for 1-dim generation",1000,0,1e9) ;
   RooRealVar nTrial2D("nTrial2D","Number of trial samples for 2-dim generation",100000,0,1e9) ;
   RooRealVar nTrial3D("nTrial3D","Number of trial samples for N-dim generation",10000000,0,1e9) ;
+  RooRealVar batchSize("batchSize","Number of trial samples that are evaluated together",4096,1,1e9) ;
 
   RooAcceptReject* proto = new RooAcceptReject ;
-  fact.storeProtoSampler(proto,RooArgSet(nTrial0D,nTrial1D,nTrial2D,nTrial3D)) ;
+  fact.storeProtoSampler(proto,RooArgSet(nTrial0D,nTrial1D,nTrial2D,nTrial3D,batchSize)) ;
 }
 
 
@@ -79,6 +94,7 @@ RooAcceptReject::RooAcceptReject(const RooAbsReal &func, const RooArgSet &genVar
   _minTrialsArray[1] = static_cast<Int_t>(config.getConfigSection("RooAcceptReject").getRealValue("nTrial1D")) ;
   _minTrialsArray[2] = static_cast<Int_t>(config.getConfigSection("RooAcceptReject").getRealValue("nTrial2D")) ;
   _minTrialsArray[3] = static_cast<Int_t>(config.getConfigSection("RooAcceptReject").getRealValue("nTrial3D")) ;
+  _batchSize = std::max(1, static_cast<Int_t>(config.getConfigSection("RooAcceptReject").getRealValue("batchSize", _batchSize))) ;
 
   for (auto * cat : static_range_cast<RooAbsCategory*>(_catVars)) {
     _catSampleMult *=  cat->numTypes() ;
@@ -141,6 +157,26 @@ RooAcceptReject::RooAcceptReject(const RooAbsReal &func, const RooArgSet &genVar
   _funcSum= 0;
   _totalEvents= 0;
   _eventsUsed= 0;
+  _streamId = RooRandom::currentStreamId();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Discard the cached trial events and the estimates of the maximum and the
+/// integral if they were made with another RooRandom stream. Like this, the
+/// events generated with a RooRandom::StreamScope only depend on the stream,
+/// and not on what was generated with this generator before.
+
+void RooAcceptReject::resetIfStreamChanged()
+{
+  if (RooRandom::currentStreamId() == _streamId) return;
+
+  _streamId = RooRandom::currentStreamId();
+  _cache->reset();
+  _maxFuncVal= 0;
+  _funcSum= 0;
+  _totalEvents= 0;
+  _eventsUsed= 0;
 }
 
 
@@ -155,6 +191,8 @@ const RooArgSet *RooAcceptReject::generateEvent(UInt_t remaining, double& resamp
   const RooArgSet *event= _cache->get();
   if(event->size() == 1) return event;
 
+  resetIfStreamChanged();
+
   if (!_funcMaxVal) {
     // Generation with empirical maximum determination
 
@@ -162,7 +200,7 @@ const RooArgSet *RooAcceptReject::generateEvent(UInt_t remaining, double& resamp
     // maximum function value
 
     while(_totalEvents < _minTrials) {
-      addEventToCache();
+      addEventsToCache(std::min<std::size_t>(_minTrials - _totalEvents, _batchSize));
 
       // Limit cache size to 1M events
       if (_cache->numEntries()>1000000) {
@@ -198,8 +236,10 @@ const RooArgSet *RooAcceptReject::generateEvent(UInt_t remaining, double& resamp
       Long64_t extra= 1 + (Long64_t)(1.05*remaining/eff);
       oocxcoutD(nullptr, Generation) << "RooAcceptReject::generateEvent: adding " << extra << " events to the cache, eff = " << eff << std::endl;
       double oldMax(_maxFuncVal);
-      while(extra--) {
-   addEventToCache();
+      while(extra > 0) {
+   const std::size_t nBatch = std::min<std::size_t>(extra, _batchSize);
+   addEventsToCache(nBatch);
+   extra -= nBatch;
    if((_maxFuncVal > oldMax)) {
      oocxcoutD(nullptr, Generation) << "RooAcceptReject::generateEvent: estimated function maximum increased from "
                << oldMax << " to " << _maxFuncVal << std::endl;
@@ -277,7 +317,100 @@ void RooAcceptReject::addEventToCache()
   for(auto * real : static_range_cast<RooRealVar*>(_realVars)) real->randomize();
 
   // calculate and store our function value at this new point
-  double val= _funcClone->getVal();
+  storeEventInCache(_funcClone->getVal());
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Add nEvents trial events to our cache. The function values are computed
+/// in batches with the RooFit::Evaluator if possible, otherwise the events
+/// are added one by one with addEventToCache().
+
+void RooAcceptReject::addEventsToCache(std::size_t nEvents)
+{
+  RooFit::Evaluator *evaluator = nEvents > 1 ? batchEvaluator() : nullptr;
+  if (!evaluator) {
+    for (std::size_t i = 0; i < nEvents; ++i) addEventToCache();
+    return;
+  }
+
+  const std::size_t nReal = _realVars.size();
+  std::vector<RooRealVar *> realVars;
+  std::vector<double> mins;
+  std::vector<double> widths;
+  for (auto * real : static_range_cast<RooRealVar*>(_realVars)) {
+    realVars.push_back(real);
+    mins.push_back(real->getMin());
+    widths.push_back(real->getMax() - real->getMin());
+  }
+
+  _batchBuffer.resize(nReal * nEvents);
+
+  // Draw the random numbers event by event, like in addEventToCache(), such
+  // that the sequence of trial events is the same. The values of each
+  // variable are stored contiguously to be used as the evaluator input.
+  for (std::size_t i = 0; i < nEvents; ++i) {
+    for (std::size_t k = 0; k < nReal; ++k) {
+      _batchBuffer[k * nEvents + i] = mins[k] + RooRandom::uniform() * widths[k];
+    }
+  }
+
+  for (std::size_t k = 0; k < nReal; ++k) {
+    evaluator->setInput(realVars[k]->GetName(), {_batchBuffer.data() + k * nEvents, nEvents}, false);
+  }
+  std::span<const double> values = evaluator->run();
+
+  for (std::size_t i = 0; i < nEvents; ++i) {
+    for (std::size_t k = 0; k < nReal; ++k) {
+      realVars[k]->setVal(_batchBuffer[k * nEvents + i]);
+    }
+    // The output is a scalar if the function doesn't depend on the generated
+    // variables. NaN values are treated as zero, like in RooAbsPdf::getVal().
+    const double val = values[values.size() == 1 ? 0 : i];
+    storeEventInCache(std::isnan(val) ? 0.0 : val);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the evaluator for the batched computation of the function values,
+/// creating it if necessary. Returns a nullptr if the events have to be
+/// generated one by one, which is the case if categories are generated or if
+/// the function doesn't support the evaluation with the RooFit::Evaluator.
+
+RooFit::Evaluator *RooAcceptReject::batchEvaluator()
+{
+  if (_evaluator || _batchEvalFailed) return _evaluator.get();
+
+  if (!_catVars.empty() || _realVars.empty()) {
+    _batchEvalFailed = true;
+    return nullptr;
+  }
+
+  try {
+    // Compiling for an empty normalization set results in the unnormalized
+    // function values, like _funcClone->getVal() without normalization set.
+    _batchFunc = RooFit::Detail::compileForNormSet(*_funcClone, RooArgSet{});
+    _evaluator = std::make_unique<RooFit::Evaluator>(*_batchFunc);
+  } catch (std::exception const &error) {
+    oocxcoutD(nullptr, Generation) << "RooAcceptReject::batchEvaluator(" << _funcClone->GetName()
+                                   << "): generating events one by one, because the function can't be "
+                                   << "evaluated in batches: " << error.what() << std::endl;
+    _evaluator.reset();
+    _batchFunc.reset();
+    _batchEvalFailed = true;
+  }
+
+  return _evaluator.get();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Store the current trial event with function value val in our cache and
+/// update our estimates of the function maximum value and integral.
+
+void RooAcceptReject::storeEventInCache(double val)
+{
   _funcValPtr->setVal(val);
 
   // Update the estimated integral and maximum value. Increase our
@@ -302,9 +435,11 @@ double RooAcceptReject::getFuncMax()
   // of samples. The actual number depends on the number of dimensions in which
   // the sampling occurs
 
+  resetIfStreamChanged();
+
   // Generate the minimum required number of samples for a reliable maximum estimate
   while(_totalEvents < _minTrials) {
-    addEventToCache();
+    addEventsToCache(std::min<std::size_t>(_minTrials - _totalEvents, _batchSize));
 
     // Limit cache size to 1M events
     if (_cache->numEntries()>1000000) {
@@ -317,6 +452,17 @@ double RooAcceptReject::getFuncMax()
   return _maxFuncVal ;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Reattach original parameters to function clone. The evaluator for the
+/// batched evaluation is recreated, because it refers to the old parameters.
+
+void RooAcceptReject::attachParameters(const RooArgSet& vars)
+{
+  RooAbsNumGenerator::attachParameters(vars);
+  _evaluator.reset();
+  _batchFunc.reset();
+}
+
 std::string const& RooAcceptReject::generatorName() const {
    static const std::string name = "RooAcceptReject";
    return name;
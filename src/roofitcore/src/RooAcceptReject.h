@@ -22,6 +22,11 @@
 #include "RooPrintable.h"
 #include "RooArgSet.h"
 
+#include <RooFit/Evaluator.h>
+
+#include <memory>
+#include <vector>
+
 class RooAbsReal;
 class RooRealVar;
 class RooDataSet;
@@ -42,6 +47,8 @@ public:
   const RooArgSet *generateEvent(UInt_t remaining, double& resampleRatio) override;
   double getFuncMax() override ;
 
+  void attachParameters(const RooArgSet& vars) override ;
+
 
   // Advertisement of capabilities
   bool canSampleConditional() const override { return true ; }
@@ -55,6 +62,10 @@ protected:
   static void registerSampler(RooNumGenFactory& fact) ;
 
   void addEventToCache();
+  void addEventsToCache(std::size_t nEvents);
+  void storeEventInCache(double val);
+  void resetIfStreamChanged();
+  RooFit::Evaluator *batchEvaluator();
   const RooArgSet *nextAcceptedEvent();
 
   double _maxFuncVal, _funcSum; ///< Maximum function value found, and sum of all samples made
@@ -65,6 +76,13 @@ protected:
   UInt_t _eventsUsed;           ///< Accepted number of function samples
 
   UInt_t _minTrialsArray[4];    ///< Minimum number of trials samples for 1,2,3 dimensional problems
+
+  std::unique_ptr<RooAbsReal> _batchFunc;          ///< Compiled clone of the function for the batched evaluation
+  std::unique_ptr<RooFit::Evaluator> _evaluator;   ///< Evaluator for the function values of a batch of trial events
+  std::vector<double> _batchBuffer;                ///< Values of the real variables for a batch of trial events
+  std::size_t _batchSize = 4096;                   ///< Number of trial events that are evaluated together
+  bool _batchEvalFailed = false;                   ///< If the function can't be evaluated in batches
+  ULong64_t _streamId = 0;                         ///< RooRandom stream that was used to fill the cache
 };
 
 #endif
@@ -0,0 +1,156 @@
+/*
+ * Project: RooFit
+ *
+ * Copyright (c) 2024, CERN
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted according to the terms
+ * listed in LICENSE (http://roofit.sourceforge.net/license.txt)
+ */
+
+/**
+\class RooFit::Experimental::RooCompiledFunction
+\ingroup Roofitcore
+
+A function that is evaluated by a shared library that was compiled from the
+code exported with RooEvaluatorWrapper::exportCompiledCode(). This makes it
+possible to generate the code for a likelihood once, compile it ahead of time
+with the exported CMake project, and use it in production jobs without
+interpreting the code or differentiating it with Clad.
+
+The name of the RooCompiledFunction has to be the name that was used for the
+export, because the entry points in the library are prefixed with it. The
+parameters are matched by name to the parameters of the exported function,
+and the auxiliary constants are taken from the library. The observables are
+read from the data file `<name>_observables.bin`, which has to be in the
+same directory as the library. The exported CMake project copies it there.
+**/
+
+#include <RooCompiledFunction.h>
+
+#include <RooAbsCategory.h>
+#include <RooMsgService.h>
+
+#include <TSystem.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace RooFit::Experimental {
+
+/// Load the compiled function from a shared library.
+/// \param[in] name The name of the function, which has to be the name that
+///            was passed to RooEvaluatorWrapper::exportCompiledCode().
+/// \param[in] title The title of the function.
+/// \param[in] libraryPath The path of the compiled library.
+/// \param[in] parameters The parameters of the function. They need to contain
+///            all parameters of the exported function, matched by name.
+RooCompiledFunction::RooCompiledFunction(const char *name, const char *title, std::string const &libraryPath,
+                                         RooArgSet const &parameters)
+   : RooAbsReal{name, title}, _libraryPath{libraryPath}, _params{"!params", "List of parameters", this}
+{
+   loadLibrary(parameters);
+}
+
+RooCompiledFunction::RooCompiledFunction(const RooCompiledFunction &other, const char *name)
+   : RooAbsReal(other, name),
+     _libraryPath{other._libraryPath},
+     _params{"!params", this, other._params},
+     _func{other._func},
+     _grad{other._grad},
+     _varBuffer{other._varBuffer},
+     _observables{other._observables},
+     _xlArr{other._xlArr}
+{
+}
+
+void RooCompiledFunction::loadLibrary(RooArgSet const &parameters)
+{
+   auto error = [&](std::string const &msg) {
+      std::stringstream errorMsg;
+      errorMsg << "RooCompiledFunction::loadLibrary(" << GetName() << ") " << msg;
+      coutE(InputArguments) << errorMsg.str() << std::endl;
+      throw std::runtime_error(errorMsg.str());
+   };
+
+   if (gSystem->Load(_libraryPath.c_str()) < 0) {
+      error("can't load the library " + _libraryPath);
+   }
+
+   const std::string prefix = GetName();
+   auto symbol = [&](std::string const &suffix) {
+      return gSystem->DynFindSymbol(_libraryPath.c_str(), (prefix + suffix).c_str());
+   };
+
+   using SizeFunc = std::size_t (*)();
+   using ArrayFunc = double const *(*)();
+   using NameFunc = const char *(*)(std::size_t);
+
+   auto nParams = reinterpret_cast<SizeFunc>(symbol("_nParams"));
+   auto paramName = reinterpret_cast<NameFunc>(symbol("_paramName"));
+   auto nXlArr = reinterpret_cast<SizeFunc>(symbol("_nXlArr"));
+   auto xlArr = reinterpret_cast<ArrayFunc>(symbol("_xlArr"));
+   _func = reinterpret_cast<Func>(symbol("_func"));
+   // The gradient is optional, because the code can be exported without Clad.
+   _grad = reinterpret_cast<Grad>(symbol("_grad"));
+
+   if (!_func || !nParams || !paramName || !nXlArr || !xlArr) {
+      error("the library " + _libraryPath + " doesn't contain a function exported with the name " + prefix);
+   }
+
+   for (std::size_t i = 0; i < nParams(); ++i) {
+      RooAbsArg *param = parameters.find(paramName(i));
+      if (!param) {
+         error(std::string{"the parameter "} + paramName(i) + " is missing");
+      }
+      _params.add(*param);
+   }
+   _varBuffer.resize(_params.size());
+   _xlArr.assign(xlArr(), xlArr() + nXlArr());
+
+   const std::string observablesPath =
+      std::string{gSystem->GetDirName(_libraryPath.c_str()).Data()} + "/" + prefix + "_observables.bin";
+   std::ifstream observablesFile{observablesPath, std::ios::binary | std::ios::ate};
+   if (!observablesFile) {
+      error("can't open the observables file " + observablesPath);
+   }
+   _observables.resize(observablesFile.tellg() / sizeof(double));
+   observablesFile.seekg(0);
+   observablesFile.read(reinterpret_cast<char *>(_observables.data()), _observables.size() * sizeof(double));
+}
+
+/// Replace the observables that were read from the exported data file, for
+/// example to evaluate the likelihood for another dataset. The array needs to
+/// have the same layout as the exported observables, which is documented in
+/// the exported source file: the offset and size of every observable,
+/// followed by the values of all observables.
+void RooCompiledFunction::setObservables(std::span<const double> observables)
+{
+   _observables.assign(observables.begin(), observables.end());
+   setValueDirty();
+}
+
+void RooCompiledFunction::updateVarBuffer() const
+{
+   std::transform(_params.begin(), _params.end(), _varBuffer.begin(), [](RooAbsArg *obj) {
+      return obj->isCategory() ? static_cast<RooAbsCategory *>(obj)->getCurrentIndex()
+                               : static_cast<RooAbsReal *>(obj)->getVal();
+   });
+}
+
+double RooCompiledFunction::evaluate() const
+{
+   updateVarBuffer();
+   return _func(_varBuffer.data(), _observables.data(), _xlArr.data());
+}
+
+void RooCompiledFunction::gradient(double *out) const
+{
+   updateVarBuffer();
+   std::fill(out, out + _params.size(), 0.0);
+   _grad(_varBuffer.data(), _observables.data(), _xlArr.data(), out);
+}
+
+} // namespace RooFit::Experimental
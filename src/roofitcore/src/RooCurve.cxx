@@ -55,6 +55,7 @@ To retrieve a RooCurve from a RooPlot, use RooPlot::getCurve().
 #include <iomanip>
 #include <deque>
 #include <algorithm>
+#include <cmath>
 
 using std::ostream, std::list, std::vector, std::min;
 
@@ -317,10 +318,17 @@ void RooCurve::addPoints(const RooAbsFunc &func, double xlo, double xhi,
     std::copy(samplingHint->begin(), samplingHint->end(), std::back_inserter(xval));
   }
 
-  for (unsigned int step=0; step < xval.size(); ++step) {
-    double xx = xval[step];
-    if (step == static_cast<unsigned int>(minPoints-1))
-      xx -= 1e-9 * dx;
+  // The function might support evaluating all initial points at once, for
+  // example concurrently. Evaluation errors are not logged in that case, so
+  // if there was any error or any of the values is not finite, the points are
+  // evaluated again one by one to report the errors and to apply eeVal.
+  std::vector<double> xeval(xval);
+  xeval.back() -= 1e-9 * dx;
+  const bool evaluatedAll = func.getDimension() == 1 && func.evaluateMany(xeval, yval) &&
+                            std::all_of(yval.begin(), yval.end(), [](double y) { return std::isfinite(y); });
+
+  for (unsigned int step=0; !evaluatedAll && step < xeval.size(); ++step) {
+    double xx = xeval[step];
 
     yval[step]= func(&xx);
     if (_showProgress) {
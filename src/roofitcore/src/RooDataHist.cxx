@@ -75,6 +75,8 @@ See RooAbsDataHelper, rf408_RDataFrameToRooFit.C
 #include "TMath.h"
 #include "Math/Util.h"
 
+#include <algorithm>
+
 using std::string, std::ostream;
 
 
@@ -1726,6 +1728,36 @@ void RooDataHist::add(const RooArgSet& row, double wgt, double sumw2)
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Increment the contents of all bins at once.
+///
+/// \param[in] weights Increment of the weight of each bin.
+/// \param[in] sumw2 Increment of the sum of squared weights of each bin. If it
+/// differs from the weight increment in any bin for the first time, a vector
+/// for the squared weights will be allocated, like in add().
+void RooDataHist::addBinContents(std::span<const double> weights, std::span<const double> sumw2)
+{
+  checkInit() ;
+
+  assert(weights.size() == static_cast<std::size_t>(_arrSize) && sumw2.size() == weights.size());
+
+  if (!_sumw2 && !std::equal(weights.begin(), weights.end(), sumw2.begin())) {
+    _sumw2 = new double[_arrSize];
+    std::copy(_wgt, _wgt+_arrSize, _sumw2);
+
+    registerWeightArraysToDataStore();
+  }
+
+  for (std::size_t i = 0; i < weights.size(); ++i) {
+    _wgt[i] += weights[i];
+    if (_sumw2) _sumw2[i] += sumw2[i];
+  }
+
+  _cache_sum_valid = false;
+}
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Set a bin content.
 /// \param[in] row Coordinates of the bin to be set.
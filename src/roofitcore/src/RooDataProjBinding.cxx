@@ -27,19 +27,29 @@ If the dataset only contains category variables, the summation is optimized
 performing a weighted sum over the states of a RooSuperCategory that is
 constructed from all the categories in the dataset
 
+Otherwise, the function is evaluated for all events in one pass of the
+RooFit::Evaluator, falling back to the evaluation event by event if the
+function can't be compiled for that. With more than one thread configured
+with RooFit::Evaluator::setDefaultNThreads(), several points can be projected
+concurrently with evaluateMany(), which is used by RooCurve for the initial
+sampling points.
+
 **/
 
 #include "RooDataProjBinding.h"
 #include "RooAbsReal.h"
+#include "RooAbsRealLValue.h"
 #include "RooAbsData.h"
 #include "Roo1DTable.h"
 #include "RooSuperCategory.h"
 #include "RooCategory.h"
 #include "RooAbsPdf.h"
 #include "RooMsgService.h"
+#include "RooFit/DataWeightedAverage.h"
 
 #include <iostream>
 #include <cassert>
+#include <stdexcept>
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -110,6 +120,10 @@ double RooDataProjBinding::operator()(const double xvector[]) const
       }
     }
 
+    if (RooFit::Detail::DataWeightedAverage *average = batchAverage()) {
+      return (*average)(xvector) ;
+    }
+
 //     _real->Print("v") ;
 //     ((RooAbsReal*)_real)->printCompactTree() ;
 
@@ -136,3 +150,44 @@ double RooDataProjBinding::operator()(const double xvector[]) const
   if (wgtSum==0) return 0 ;
   return result / wgtSum ;
 }
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Evaluate the data-projected values for several points concurrently, if
+/// the projection over real-valued observables can be done with the
+/// RooFit::Evaluator and more than one thread is configured with
+/// RooFit::Evaluator::setDefaultNThreads(). Evaluation errors are only
+/// counted in that case, and if there are any, false is returned such that
+/// the points are evaluated again one by one.
+
+bool RooDataProjBinding::evaluateMany(std::span<const double> xvectors, std::span<double> out) const
+{
+  if (_catTable) return false ;
+
+  RooFit::Detail::DataWeightedAverage *average = batchAverage() ;
+  return average && average->evaluateMany(xvectors, out) ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the helper for the batched evaluation of the projection, which is
+/// created on the first call. Returns a nullptr if the function can't be
+/// compiled for the evaluation with the RooFit::Evaluator.
+
+RooFit::Detail::DataWeightedAverage *RooDataProjBinding::batchAverage() const
+{
+  if (!_average && !_batchEvalFailed) {
+    RooArgSet vars ;
+    for (RooAbsRealLValue *var : _vars) {
+      vars.add(*var) ;
+    }
+    try {
+      _average = std::make_unique<RooFit::Detail::DataWeightedAverage>(*_real, *_data, _nset ? *_nset : RooArgSet{}, vars) ;
+    } catch (std::exception const &err) {
+      oocxcoutD(_real,Eval) << "RooDataProjBinding::batchAverage(" << _real->GetName()
+                            << ") batched evaluation not possible, projecting event by event: " << err.what() << std::endl ;
+      _batchEvalFailed = true ;
+    }
+  }
+  return _average.get() ;
+}
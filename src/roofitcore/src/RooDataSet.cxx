@@ -511,9 +511,11 @@ RooDataSet::RooDataSet(RooStringView name, RooStringView title, const RooArgSet&
          cutVar = cutVarTmp.get();
       }
 
+      auto vstore = dynamic_cast<RooVectorDataStore *>(_dstore.get());
       if (tstore) {
          tstore->loadValues(impTree, cutVar, cutRange);
-      } else {
+      } else if (!vstore || !vstore->loadValuesFromTree(*impTree, cutVar)) {
+         // Import the tree event by event if the columnar import is not supported
          RooTreeDataStore tmpstore(name, title, _vars, wgtVarName);
          tmpstore.loadValues(impTree, cutVar, cutRange);
          _dstore->append(tmpstore);
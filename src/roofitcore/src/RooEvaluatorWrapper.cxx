@@ -33,8 +33,17 @@ Wraps a RooFit::Evaluator that evaluates a RooAbsReal back into a RooAbsReal.
 #include "RooFitImplHelpers.h"
 
 #include <TInterpreter.h>
+#include <TMD5.h>
+#include <TROOT.h>
+#include <TSystem.h>
+#include <TUUID.h>
 
+#include <cctype>
+#include <cmath>
 #include <fstream>
+#include <iomanip>
+#include <regex>
+#include <set>
 
 namespace {
 
@@ -231,7 +240,10 @@ public:
    void createGradient();
    void createHessian();
 
-   void writeDebugMacro(std::string const &) const;
+   void writeToCache();
+   void exportCode(std::string const &directory, std::string const &name);
+
+   void writeDebugMacro(std::string const &);
 
    std::vector<std::string> const &collectedFunctions() { return _collectedFunctions; }
 
@@ -249,6 +261,14 @@ private:
 
    void buildFuncAndGradFunctors();
 
+   void declareFunction();
+   void declareGradientRequest();
+   std::string gradientCode();
+   bool writeCompilableCode(std::ostream &os, std::string const &symbolPrefix, bool withGradient);
+   bool loadFromCache();
+   std::string cachedLibraryPath(bool withGradient) const;
+   std::string renameFunctions(std::string code, std::string const &prefix) const;
+
    using Func = double (*)(double *, double const *, double const *);
    using Grad = void (*)(double *, double const *, double const *, double *);
    using Hessian = void (*)(double *, double const *, double const *, double *);
@@ -263,8 +283,16 @@ private:
    mutable std::vector<double> _varBuffer;
    std::vector<double> _observables;
    std::unordered_map<RooFit::Detail::DataKey, std::size_t> _obsInfos;
+   std::vector<std::string> _obsNames;
    std::vector<double> _xlArr;
    std::vector<std::string> _collectedFunctions;
+   std::string _code;            // the generated code, declared lazily if the function comes from the cache
+   bool _isDeclared = false;     // whether the code was declared to the interpreter
+   std::string _cacheKey;        // content hash of the code, empty if the cache is not used
+   bool _isCached = false;       // whether the function was loaded from the cache or written to it
+   bool _isCachedWithGradient = false;
+   Grad _cachedGrad = nullptr;
+   std::string _gradRequestName;
 };
 
 namespace {
@@ -307,6 +335,106 @@ auto getDependsOnData(RooAbsReal &obj, RooArgSet const &dataObs)
    return dependsOnData;
 }
 
+std::string &codegenCacheDirectoryRef()
+{
+   static std::string dir = gSystem->Getenv("ROOFIT_CODEGEN_CACHE_DIR") ? gSystem->Getenv("ROOFIT_CODEGEN_CACHE_DIR") : "";
+   return dir;
+}
+
+std::string md5Hash(std::string const &str)
+{
+   TMD5 md5;
+   md5.Update(reinterpret_cast<const UChar_t *>(str.data()), str.size());
+   md5.Final();
+   return md5.AsString();
+}
+
+bool isIdentifierChar(char c)
+{
+   return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+// Replaces the name of a generated function in the code, also where it is
+// used as the prefix of the names of its derivatives like "<name>_grad_0".
+// Since the names of the generated functions end with a number, a name that
+// is followed by a digit is a different function.
+void replaceFunctionName(std::string &str, std::string const &from, std::string const &to)
+{
+   std::size_t pos = 0;
+   while ((pos = str.find(from, pos)) != std::string::npos) {
+      const std::size_t end = pos + from.size();
+      const bool startsIdentifier = pos == 0 || !isIdentifierChar(str[pos - 1]);
+      const bool endsName = end == str.size() || !std::isalnum(static_cast<unsigned char>(str[end]));
+      if (startsIdentifier && endsName) {
+         str.replace(pos, from.size(), to);
+         pos += to.size();
+      } else {
+         pos = end;
+      }
+   }
+}
+
+// Returns the code of a function that is declared to the interpreter,
+// enclosed in the namespaces of its qualified name.
+std::string getDeclaredFunctionCode(std::string const &qualifiedName)
+{
+   std::unique_ptr<TInterpreterValue> v = gInterpreter->MakeInterpreterValue();
+   gInterpreter->Evaluate(qualifiedName.c_str(), *v);
+   std::string code = v->ToString();
+   for (int i = 0; i < 2; ++i) {
+      code = code.erase(0, code.find("\n") + 1);
+   }
+   std::string name = qualifiedName;
+   std::size_t pos = 0;
+   while ((pos = name.find("::")) != std::string::npos) {
+      code = "namespace " + name.substr(0, pos) + " {\n" + code + "\n}\n";
+      name = name.substr(pos + 2);
+   }
+   return code;
+}
+
+// Collects the code of the pullback functions that Clad generated for the
+// functions called in the given code, with the dependencies first. The
+// custom derivatives in the clad namespace come from the included headers.
+void collectPullbacks(std::string const &code, std::set<std::string> &seen, std::string &out)
+{
+   static const std::regex pullbackRegex{"\\b((?:[A-Za-z_]\\w*::)*[A-Za-z_]\\w*_pullback)\\b"};
+   for (auto it = std::sregex_iterator(code.begin(), code.end(), pullbackRegex); it != std::sregex_iterator(); ++it) {
+      std::string name = (*it)[1];
+      if (name.rfind("clad::", 0) == 0 || !seen.insert(name).second) {
+         continue;
+      }
+      std::string pullbackCode = getDeclaredFunctionCode(name);
+      collectPullbacks(pullbackCode, seen, out);
+      out += pullbackCode + "\n";
+   }
+}
+
+// Compiles a source file to a shared library with the same compiler command
+// that ACLiC uses, but without generating a dictionary.
+bool compileSharedLibrary(std::string const &sourceFile, std::string const &libFile)
+{
+   const std::string stem = sourceFile.substr(0, sourceFile.rfind('.'));
+   TString includePath = gSystem->GetIncludePath();
+   includePath += " ";
+   includePath += gInterpreter->GetIncludePath();
+
+   TString cmd = gSystem->GetMakeSharedLib();
+   cmd.ReplaceAll("$SourceFiles", sourceFile.c_str());
+   cmd.ReplaceAll("$ObjectFiles", (stem + "." + gSystem->GetObjExt()).c_str());
+   cmd.ReplaceAll("$SharedLib", libFile.c_str());
+   cmd.ReplaceAll("$LibName", gSystem->BaseName(stem.c_str()));
+   cmd.ReplaceAll("$BuildDir", gSystem->GetDirName(sourceFile.c_str()));
+   cmd.ReplaceAll("$IncludePath", includePath);
+   cmd.ReplaceAll("$Opt", gSystem->GetFlagsOpt());
+   cmd.ReplaceAll("$LinkedLibs", gSystem->GetLinkedLibs());
+   cmd.ReplaceAll("$DepLibs", "");
+
+   const bool success = gSystem->Exec(cmd.Data()) == 0;
+   gSystem->Unlink((stem + "." + gSystem->GetObjExt()).c_str());
+   return success;
+}
+
 } // namespace
 
 RooFuncWrapper::RooFuncWrapper(RooAbsReal &obj, const RooAbsData *data, RooSimultaneous const *simPdf,
@@ -347,15 +475,38 @@ RooFuncWrapper::RooFuncWrapper(RooAbsReal &obj, const RooAbsData *data, RooSimul
       ctx.addVecObs(obsName, item.second);
    }
 
-   // Declare the function and create its derivative.
+   _funcName = ctx.buildFunction(obj, dependsOnData);
+   _code = ctx.collectedCode();
+   _xlArr = ctx.xlArr();
+   _collectedFunctions = ctx.collectedFunctions();
+
+   // If a cache directory is set, try to load the compiled function from
+   // there. Otherwise, declare the function to the interpreter.
+   if (!RooEvaluatorWrapper::codegenCacheDirectory().empty()) {
+      _cacheKey = md5Hash(renameFunctions(_code, "roo_codegen_cached_f") + "\n// ROOT " + gROOT->GetVersion() + " " + gROOT->GetGitCommit());
+      if (loadFromCache())
+         return;
+   }
+
+   declareFunction();
+}
+
+/// Declare the generated code to the interpreter and get the pointer to the
+/// function. This is deferred if the function was loaded from the cache,
+/// until the code is needed to generate derivatives.
+void RooFuncWrapper::declareFunction()
+{
+   if (_isDeclared)
+      return;
+   _isDeclared = true;
+
    auto print = [](std::string const &msg) { oocoutI(nullptr, Fitting) << msg << std::endl; };
    ROOT::Math::Util::TimingScope timingScope(print, "Function JIT time:");
-   _funcName = ctx.buildFunction(obj, dependsOnData);
 
    // Make sure the codegen implementations are known to the interpreter
    gInterpreter->Declare("#include <RooFit/CodegenImpl.h>\n");
 
-   if (!gInterpreter->Declare(ctx.collectedCode().c_str())) {
+   if (!gInterpreter->Declare(_code.c_str())) {
       std::stringstream errorMsg;
       std::string debugFileName = "_codegen_" + _funcName + ".cxx";
       errorMsg << "Function " << _funcName << " could not be compiled. See above for details. Full code dumped to file "
@@ -363,16 +514,284 @@ RooFuncWrapper::RooFuncWrapper(RooAbsReal &obj, const RooAbsData *data, RooSimul
       {
          std::ofstream outFile;
          outFile.open(debugFileName.c_str());
-         outFile << ctx.collectedCode();
+         outFile << _code;
       }
       oocoutE(nullptr, InputArguments) << errorMsg.str() << std::endl;
       throw std::runtime_error(errorMsg.str().c_str());
    }
 
-   _func = reinterpret_cast<Func>(gInterpreter->ProcessLine((_funcName + ";").c_str()));
+   if (!_isCached) {
+      _func = reinterpret_cast<Func>(gInterpreter->ProcessLine((_funcName + ";").c_str()));
+   }
+}
+
+/// Replace the names of the generated functions, which depend on a global
+/// counter, with the given prefix followed by the index of the function.
+std::string RooFuncWrapper::renameFunctions(std::string code, std::string const &prefix) const
+{
+   std::set<std::string> seen;
+   std::size_t iFunc = 0;
+   for (std::string const &name : _collectedFunctions) {
+      if (seen.insert(name).second) {
+         replaceFunctionName(code, name, prefix + std::to_string(iFunc++));
+      }
+   }
+   return code;
+}
 
-   _xlArr = ctx.xlArr();
-   _collectedFunctions = ctx.collectedFunctions();
+std::string RooFuncWrapper::cachedLibraryPath(bool withGradient) const
+{
+   return RooEvaluatorWrapper::codegenCacheDirectory() + "/roo_codegen_" + _cacheKey + (withGradient ? "_grad" : "") +
+          "." + gSystem->GetSoExt();
+}
+
+/// Try to load the compiled function, and preferably also its gradient, from
+/// a shared library in the cache directory.
+bool RooFuncWrapper::loadFromCache()
+{
+   const std::string symbolPrefix = "roo_codegen_" + _cacheKey;
+   for (bool withGradient : {true, false}) {
+      const std::string libPath = cachedLibraryPath(withGradient);
+      if (gSystem->AccessPathName(libPath.c_str()) || gSystem->Load(libPath.c_str()) < 0)
+         continue;
+      auto func = reinterpret_cast<Func>(gSystem->DynFindSymbol(libPath.c_str(), (symbolPrefix + "_func").c_str()));
+      auto grad = withGradient
+                     ? reinterpret_cast<Grad>(gSystem->DynFindSymbol(libPath.c_str(), (symbolPrefix + "_grad").c_str()))
+                     : nullptr;
+      if (!func || (withGradient && !grad))
+         continue;
+
+      _func = func;
+      _cachedGrad = grad;
+      _isCached = true;
+      _isCachedWithGradient = withGradient;
+      oocoutI(nullptr, Fitting) << "RooFuncWrapper: loaded the generated code from the cache library " << libPath
+                                << std::endl;
+      return true;
+   }
+   return false;
+}
+
+/// Compile the generated function, and its gradient if it was already
+/// created, to a shared library in the cache directory, such that later
+/// processes don't have to interpret and differentiate the same code again.
+/// Failing to write the cache is not an error, it only results in a warning.
+void RooFuncWrapper::writeToCache()
+{
+   if (_cacheKey.empty() || (_isCached && (_isCachedWithGradient || !_hasGradient)))
+      return;
+
+   std::string const &cacheDir = RooEvaluatorWrapper::codegenCacheDirectory();
+
+   std::stringstream source;
+   source << "// Generated by RooFit for the codegen cache. Do not edit.\n";
+   if (!writeCompilableCode(source, "roo_codegen_" + _cacheKey, _hasGradient)) {
+      oocoutW(nullptr, Fitting) << "RooFuncWrapper: could not get the gradient code, not writing to the cache"
+                                << std::endl;
+      return;
+   }
+
+   // Compile to temporary files with a unique name and rename them at the
+   // end, so concurrent jobs never load a partially written file. The process
+   // ID alone is not unique if the cache directory is shared between hosts.
+   const std::string libPath = cachedLibraryPath(_hasGradient);
+   const std::string stem = libPath.substr(0, libPath.rfind('.'));
+   const std::string tmpStem = stem + "_tmp_" + TUUID().AsString();
+   const std::string tmpSource = tmpStem + ".cxx";
+   const std::string tmpLib = tmpStem + "." + gSystem->GetSoExt();
+
+   gSystem->mkdir(cacheDir.c_str(), true);
+   {
+      std::ofstream outFile{tmpSource};
+      outFile << source.str();
+   }
+
+   auto print = [](std::string const &msg) { oocoutI(nullptr, Fitting) << msg << std::endl; };
+   bool success = false;
+   {
+      ROOT::Math::Util::TimingScope timingScope(print, "Codegen cache compilation time:");
+      success = compileSharedLibrary(tmpSource, tmpLib);
+   }
+   if (!success || gSystem->Rename(tmpLib.c_str(), libPath.c_str()) != 0) {
+      oocoutW(nullptr, Fitting) << "RooFuncWrapper: could not compile the generated code for the cache, see "
+                                << tmpSource << std::endl;
+      gSystem->Unlink(tmpLib.c_str());
+      return;
+   }
+   gSystem->Rename(tmpSource.c_str(), (stem + ".cxx").c_str());
+
+   _isCached = true;
+   _isCachedWithGradient = _hasGradient;
+   oocoutI(nullptr, Fitting) << "RooFuncWrapper: wrote the generated code to the cache library " << libPath
+                             << std::endl;
+}
+
+/// Write the generated code, together with the gradient code from Clad if
+/// requested, as a self-contained C++ source that can be compiled without
+/// the interpreter. The generated functions are renamed with the given
+/// prefix, and the entry points are declared `extern "C"` with the names
+/// `<symbolPrefix>_func` and `<symbolPrefix>_grad`.
+bool RooFuncWrapper::writeCompilableCode(std::ostream &os, std::string const &symbolPrefix, bool withGradient)
+{
+   const std::string funcPrefix = symbolPrefix + "_f";
+   const std::string mainName = renameFunctions(_funcName, funcPrefix);
+
+   std::string gradCode;
+   if (withGradient) {
+      gradCode = gradientCode();
+      if (gradCode.empty())
+         return false;
+   }
+
+   os << "#include <RooFit/Detail/MathFuncs.h>\n";
+   if (withGradient) {
+      os << "#include <Math/CladDerivator.h>\n";
+   }
+   os << "#include <cstddef>\n#include <limits>\n\n" << renameFunctions(_code, funcPrefix) << "\n";
+
+   if (withGradient) {
+      std::string pullbacks;
+      std::set<std::string> seen;
+      collectPullbacks(gradCode, seen, pullbacks);
+      os << renameFunctions(pullbacks, funcPrefix) << "\n" << renameFunctions(gradCode, funcPrefix) << "\n";
+   }
+
+   os << "extern \"C\" double " << symbolPrefix
+      << "_func(double *params, double const *obs, double const *xlArr)\n{\n   return " << mainName
+      << "(params, obs, xlArr);\n}\n";
+   if (withGradient) {
+      os << "extern \"C\" void " << symbolPrefix
+         << "_grad(double *params, double const *obs, double const *xlArr, double *out)\n{\n   " << mainName
+         << "_grad_0(params, obs, xlArr, out);\n}\n";
+   }
+   return true;
+}
+
+/// Export the generated code for ahead-of-time compilation. The directory
+/// will contain the source file `<name>.cxx` and a `CMakeLists.txt` to build
+/// it as the shared library `<name>`, which can be loaded with the
+/// RooCompiledFunction. Next to the function and its gradient, the source
+/// contains the parameter names and the auxiliary constants. The observables
+/// are written to the data file `<name>_observables.bin`, which the CMake
+/// project copies next to the library. The RooFit headers that the code
+/// depends on are copied to the `include` subdirectory, so that the project
+/// only needs an installed ROOT with the MathCore library.
+void RooFuncWrapper::exportCode(std::string const &directory, std::string const &name)
+{
+#ifdef ROOFIT_CLAD
+   const bool withGradient = true;
+#else
+   const bool withGradient = false;
+#endif
+
+   std::stringstream source;
+   source << "// Generated by RooFit with RooEvaluatorWrapper::exportCompiledCode(). Do not edit.\n//\n"
+          << "// Parameters, in the order of the params array:\n";
+   for (std::size_t i = 0; i < _params.size(); ++i) {
+      source << "//   " << i << ": " << _params[i].GetName() << "\n";
+   }
+   source << "// Observables, stored in " << name
+          << "_observables.bin with their offset and size at the beginning of the obs array:\n";
+   for (std::size_t i = 0; i < _obsNames.size(); ++i) {
+      source << "//   " << i << ": " << _obsNames[i] << "\n";
+   }
+   source << "\n";
+
+   if (!writeCompilableCode(source, name, withGradient)) {
+      std::stringstream errorMsg;
+      errorMsg << "RooFuncWrapper::exportCode(): the gradient code could not be generated";
+      oocoutE(nullptr, InputArguments) << errorMsg.str() << std::endl;
+      throw std::runtime_error(errorMsg.str());
+   }
+
+   auto writeArray = [&](std::string const &arrName, std::span<const double> vec) {
+      // Zero-sized arrays are not allowed, so there is always one element.
+      source << "const double " << arrName << "[] = {";
+      for (std::size_t i = 0; i < std::max(vec.size(), std::size_t(1)); ++i) {
+         const double val = i < vec.size() ? vec[i] : 0.0;
+         source << (i % 10 == 0 ? "\n   " : " ");
+         if (std::isnan(val)) {
+            source << "std::numeric_limits<double>::quiet_NaN()";
+         } else if (std::isinf(val)) {
+            source << (val < 0 ? "-" : "") << "std::numeric_limits<double>::infinity()";
+         } else {
+            source << std::setprecision(17) << val;
+         }
+         source << ",";
+      }
+      source << "\n};\n";
+   };
+
+   source << "\nnamespace {\n\n// clang-format off\nconst char *paramNames[] = {";
+   for (std::size_t i = 0; i < _params.size(); ++i) {
+      source << "\n   \"" << _params[i].GetName() << "\",";
+   }
+   source << "\n   nullptr\n};\n";
+   writeArray("xlArr", _xlArr);
+   source << "// clang-format on\n\n} // namespace\n\n";
+
+   source << "extern \"C\" std::size_t " << name << "_nParams()\n{\n   return " << _params.size() << ";\n}\n"
+          << "extern \"C\" const char *" << name << "_paramName(std::size_t i)\n{\n   return paramNames[i];\n}\n"
+          << "extern \"C\" std::size_t " << name << "_nXlArr()\n{\n   return " << _xlArr.size() << ";\n}\n"
+          << "extern \"C\" double const *" << name << "_xlArr()\n{\n   return xlArr;\n}\n";
+
+   // Find the directory of a header in the include path of the interpreter.
+   auto findIncludeDir = [](std::string const &header) {
+      std::stringstream includePath{gInterpreter->GetIncludePath()};
+      std::string token;
+      while (includePath >> token) {
+         std::string dir = token.substr(token.rfind("-I", 0) == 0 ? 2 : 0);
+         dir.erase(std::remove(dir.begin(), dir.end(), '"'), dir.end());
+         if (!gSystem->AccessPathName((dir + "/" + header).c_str())) {
+            return dir;
+         }
+      }
+      return std::string{};
+   };
+
+   // The generated code includes the RooFit math functions, which are not
+   // part of the ROOT installation that the project is built against.
+   // Copy the header into the exported directory.
+   const std::string mathFuncsHeader = "RooFit/Detail/MathFuncs.h";
+   const std::string mathFuncsDir = findIncludeDir(mathFuncsHeader);
+   std::ifstream mathFuncsIn{mathFuncsDir + "/" + mathFuncsHeader};
+   if (mathFuncsDir.empty() || !mathFuncsIn) {
+      std::stringstream errorMsg;
+      errorMsg << "RooFuncWrapper::exportCode(): the header " << mathFuncsHeader
+               << " was not found in the include path of the interpreter";
+      oocoutE(nullptr, InputArguments) << errorMsg.str() << std::endl;
+      throw std::runtime_error(errorMsg.str());
+   }
+
+   // The gradient code needs the Clad headers, which are not in the ROOT
+   // include directory. Take the directory that the interpreter is using.
+   const std::string cladIncludeDir = withGradient ? findIncludeDir("clad/Differentiator/Differentiator.h") : "";
+
+   std::stringstream cmake;
+   cmake << "# Generated by RooFit with RooEvaluatorWrapper::exportCompiledCode().\n"
+         << "cmake_minimum_required(VERSION 3.16)\n"
+         << "project(" << name << " LANGUAGES CXX)\n\n"
+         << "find_package(ROOT REQUIRED COMPONENTS MathCore)\n\n"
+         << "add_library(" << name << " SHARED " << name << ".cxx)\n"
+         << "target_compile_features(" << name << " PRIVATE cxx_std_17)\n"
+         << "target_include_directories(" << name << " PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/include)\n"
+         << "target_link_libraries(" << name << " PRIVATE ROOT::MathCore)\n\n"
+         << "# The RooCompiledFunction reads the observables from the data file next to the library.\n"
+         << "set_target_properties(" << name << " PROPERTIES LIBRARY_OUTPUT_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR})\n"
+         << "configure_file(" << name << "_observables.bin ${CMAKE_CURRENT_BINARY_DIR}/" << name
+         << "_observables.bin COPYONLY)\n";
+   if (withGradient) {
+      cmake << "\nset(CLAD_INCLUDE_DIR \"" << cladIncludeDir << "\" CACHE PATH \"Directory with the Clad headers\")\n"
+            << "target_include_directories(" << name << " PRIVATE ${CLAD_INCLUDE_DIR})\n";
+   }
+
+   const std::string headerDir = directory + "/include/RooFit/Detail";
+   gSystem->mkdir(headerDir.c_str(), true);
+   std::ofstream{directory + "/include/" + mathFuncsHeader} << mathFuncsIn.rdbuf();
+   std::ofstream{directory + "/" + name + ".cxx"} << source.str();
+   std::ofstream{directory + "/CMakeLists.txt"} << cmake.str();
+   std::ofstream{directory + "/" + name + "_observables.bin", std::ios::binary}.write(
+      reinterpret_cast<const char *>(_observables.data()), _observables.size() * sizeof(double));
 }
 
 void RooFuncWrapper::loadData(RooAbsData const &data, RooSimultaneous const *simPdf, std::string const &rangeName,
@@ -384,12 +803,14 @@ void RooFuncWrapper::loadData(RooAbsData const &data, RooSimultaneous const *sim
       RooFit::BatchModeDataHelpers::getDataSpans(data, rangeName, simPdf, skipZeroWeights, false, vectorBuffers);
 
    _observables.clear();
+   _obsNames.clear();
    // The first elements contain the sizes of the packed observable arrays
    std::size_t total = 0;
    _observables.reserve(2 * spans.size());
    std::size_t idx = 0;
    for (auto const &item : spans) {
       _obsInfos.emplace(item.first, idx);
+      _obsNames.emplace_back(item.first->GetName());
       _observables.push_back(total + 2 * spans.size());
       _observables.push_back(item.second.size());
       total += item.second.size();
@@ -408,8 +829,44 @@ void RooFuncWrapper::loadData(RooAbsData const &data, RooSimultaneous const *sim
 
 void RooFuncWrapper::createGradient()
 {
+   if (_cachedGrad) {
+      _grad = _cachedGrad;
+      _hasGradient = true;
+      return;
+   }
 #ifdef ROOFIT_CLAD
-   std::string gradName = _funcName + "_grad_0";
+   declareGradientRequest();
+
+   auto print = [](std::string const &msg) { oocoutI(nullptr, Fitting) << msg << std::endl; };
+
+   // Clad provides different overloads for the gradient, and we need to
+   // resolve to the one that we want. Without the static_cast, getting the
+   // function pointer would be ambiguous.
+   std::stringstream ss;
+   ROOT::Math::Util::TimingScope timingScope(print, "Gradient IR to machine code time:");
+   ss << "static_cast<void (*)(double *, double const *, double const *, double *)>(" << _funcName << "_grad_0);";
+   _grad = reinterpret_cast<Grad>(gInterpreter->ProcessLine(ss.str().c_str()));
+   _hasGradient = true;
+#else
+   _hasGradient = false;
+   std::stringstream errorMsg;
+   errorMsg << "Function could not be differentiated since ROOT was built without Clad support.";
+   oocoutE(nullptr, InputArguments) << errorMsg.str() << std::endl;
+   throw std::runtime_error(errorMsg.str().c_str());
+#endif
+}
+
+/// Declare the function that requests the gradient from Clad. The request
+/// function returns the code of the gradient, which is needed to compile it
+/// without the interpreter.
+void RooFuncWrapper::declareGradientRequest()
+{
+#ifdef ROOFIT_CLAD
+   if (!_gradRequestName.empty())
+      return;
+
+   declareFunction();
+
    std::string requestName = _funcName + "_req";
 
    // Calculate gradient
@@ -418,8 +875,8 @@ void RooFuncWrapper::createGradient()
    // clang-format off
    std::stringstream requestFuncStrm;
    requestFuncStrm << "#pragma clad ON\n"
-                      "void " << requestName << "() {\n"
-                      "  clad::gradient(" << _funcName << ", \"params\");\n"
+                      "const char *" << requestName << "() {\n"
+                      "  return clad::gradient(" << _funcName << ", \"params\").getCode();\n"
                       "}\n"
                       "#pragma clad OFF";
    // clang-format on
@@ -436,27 +893,28 @@ void RooFuncWrapper::createGradient()
       oocoutE(nullptr, InputArguments) << errorMsg.str() << std::endl;
       throw std::runtime_error(errorMsg.str().c_str());
    }
+   _gradRequestName = requestName;
+#endif
+}
 
-   // Clad provides different overloads for the gradient, and we need to
-   // resolve to the one that we want. Without the static_cast, getting the
-   // function pointer would be ambiguous.
-   std::stringstream ss;
-   ROOT::Math::Util::TimingScope timingScope(print, "Gradient IR to machine code time:");
-   ss << "static_cast<void (*)(double *, double const *, double const *, double *)>(" << gradName << ");";
-   _grad = reinterpret_cast<Grad>(gInterpreter->ProcessLine(ss.str().c_str()));
-   _hasGradient = true;
+/// Get the code of the gradient that was generated by Clad, or an empty
+/// string if ROOT was built without Clad support.
+std::string RooFuncWrapper::gradientCode()
+{
+#ifdef ROOFIT_CLAD
+   declareGradientRequest();
+   auto code = reinterpret_cast<const char *>(gInterpreter->ProcessLine((_gradRequestName + "();").c_str()));
+   return code ? code : "";
 #else
-   _hasGradient = false;
-   std::stringstream errorMsg;
-   errorMsg << "Function could not be differentiated since ROOT was built without Clad support.";
-   oocoutE(nullptr, InputArguments) << errorMsg.str() << std::endl;
-   throw std::runtime_error(errorMsg.str().c_str());
+   return "";
 #endif
 }
 
 void RooFuncWrapper::createHessian()
 {
 #ifdef ROOFIT_CLAD
+   declareFunction();
+
    std::string hessianName = _funcName + "_hessian_0";
    std::string requestName = _funcName + "_hessian_req";
 
@@ -513,8 +971,10 @@ void RooFuncWrapper::updateGradientVarBuffer() const
 }
 
 /// @brief Dumps a macro "filename.C" that can be used to test and debug the generated code and gradient.
-void RooFuncWrapper::writeDebugMacro(std::string const &filename) const
+void RooFuncWrapper::writeDebugMacro(std::string const &filename)
 {
+   declareFunction();
+
    std::stringstream allCode;
    std::set<std::string> seenFunctions;
 
@@ -791,8 +1251,10 @@ void RooEvaluatorWrapper::generateGradient()
 {
    if (!_funcWrapper)
       createFuncWrapper();
-   if (!_funcWrapper->hasGradient())
+   if (!_funcWrapper->hasGradient()) {
       _funcWrapper->createGradient();
+      _funcWrapper->writeToCache();
+   }
 }
 
 void RooEvaluatorWrapper::generateHessian()
@@ -806,8 +1268,48 @@ void RooEvaluatorWrapper::generateHessian()
 void RooEvaluatorWrapper::setUseGeneratedFunctionCode(bool flag)
 {
    _useGeneratedFunctionCode = flag;
-   if (!_funcWrapper && _useGeneratedFunctionCode)
+   if (!_funcWrapper && _useGeneratedFunctionCode) {
+      createFuncWrapper();
+      _funcWrapper->writeToCache();
+   }
+}
+
+/// Export the generated code of the likelihood, together with its gradient
+/// if ROOT was built with Clad support, as a self-contained C++ source file
+/// and a CMake project to compile it to a shared library. The library can be
+/// loaded with the RooFit::Experimental::RooCompiledFunction, which doesn't
+/// need the interpreter. The parameter names are part of the exported code,
+/// and the observables are written to a separate data file that is copied
+/// next to the compiled library.
+/// \param[in] directory The output directory, which is created if needed.
+/// \param[in] name The name of the library, which is also used as the prefix
+///            of the exported symbols. Needs to be a valid C++ identifier.
+void RooEvaluatorWrapper::exportCompiledCode(std::string const &directory, std::string const &name)
+{
+   if (!_funcWrapper)
       createFuncWrapper();
+   _funcWrapper->exportCode(directory, name);
+}
+
+/// Set the directory where the code that is generated for the "codegen"
+/// backends is cached as compiled shared libraries. The libraries are keyed
+/// by a hash of the generated code, so later processes that create the same
+/// model load the compiled function and gradient from there, instead of
+/// interpreting the code and differentiating it with Clad again. Only the
+/// values of the parameters and observables may change between processes,
+/// since they are not part of the generated code. The cache is disabled if
+/// the directory is empty, which is the default unless the environment
+/// variable `ROOFIT_CODEGEN_CACHE_DIR` is set.
+void RooEvaluatorWrapper::setCodegenCacheDirectory(std::string const &dir)
+{
+   codegenCacheDirectoryRef() = dir;
+}
+
+/// Get the directory where the generated code is cached.
+/// \see setCodegenCacheDirectory()
+std::string const &RooEvaluatorWrapper::codegenCacheDirectory()
+{
+   return codegenCacheDirectoryRef();
 }
 
 void RooEvaluatorWrapper::gradient(double *out) const
@@ -24,16 +24,184 @@ for objects that are expensive to calculate. Owners of such objects
 can registers these here with associated parameter values for which
 the object is valid, so that other instances can, at a later moment
 retrieve these precalculated objects.
+
+Optionally, the objects can also be stored on disk, such that they are reused
+by later processes that build the same model, for example in repeated batch
+jobs. This is enabled with setPersistentDirectory(), or by setting the
+environment variable `ROOFIT_EXPENSIVE_OBJECT_CACHE_DIR`. Each object is
+stored in its own ROOT file, named after a hash of the object name and class,
+the values of the parameters, and the structure of the owning object, see
+ownerKey(). Only objects registered with an owner are stored on disk. The files
+are written under a unique temporary name and then renamed, so several
+processes can read and write the same directory concurrently.
+
+The producers of cache objects in RooFit, like RooAbsCachedPdf, RooAbsCachedReal
+and RooRealIntegral with setCacheNumeric(), only use this cache if the persistent
+storage is active, see persistentStorageActive(). The RooMinimizer suspends the
+persistent storage with a SuspendPersistentStorage object, since the parameter
+values during a minimization are never repeated.
 **/
 
 #include "RooExpensiveObjectCache.h"
 
 #include "TClass.h"
 #include "RooAbsReal.h"
-#include "RooAbsCategory.h"
+#include "RooAbsCategoryLValue.h"
+#include "RooAbsRealLValue.h"
+#include "RooAbsBinning.h"
 #include "RooArgSet.h"
+#include "RooHistFunc.h"
+#include "RooHistPdf.h"
+#include "RooDataHist.h"
 #include "RooMsgService.h"
+
+#include "TDirectory.h"
+#include "TFile.h"
+#include "TMD5.h"
+#include "TObjString.h"
+#include "TSystem.h"
+#include "TUUID.h"
+
+#include <algorithm>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+std::string &persistentDirectoryRef()
+{
+   static std::string dir = gSystem->Getenv("ROOFIT_EXPENSIVE_OBJECT_CACHE_DIR") ? gSystem->Getenv("ROOFIT_EXPENSIVE_OBJECT_CACHE_DIR") : "";
+   return dir;
+}
+
+int &suspendCountRef()
+{
+   thread_local int count = 0;
+   return count;
+}
+
+class Hasher {
+public:
+   void add(std::string const &s)
+   {
+      add(s.size());
+      _md5.Update(reinterpret_cast<const UChar_t *>(s.data()), s.size());
+   }
+   void add(double x) { _md5.Update(reinterpret_cast<const UChar_t *>(&x), sizeof(double)); }
+   void add(std::size_t n) { _md5.Update(reinterpret_cast<const UChar_t *>(&n), sizeof(std::size_t)); }
+   void add(int i) { _md5.Update(reinterpret_cast<const UChar_t *>(&i), sizeof(int)); }
+
+   std::string digest()
+   {
+      _md5.Final();
+      return _md5.AsString();
+   }
+
+private:
+   TMD5 _md5;
+};
+
+template <class Coll_t>
+std::vector<RooAbsArg *> sortedByName(Coll_t const &coll)
+{
+   std::vector<RooAbsArg *> out(coll.begin(), coll.end());
+   std::sort(out.begin(), out.end(),
+             [](RooAbsArg *a, RooAbsArg *b) { return std::string{a->GetName()} < std::string{b->GetName()}; });
+   return out;
+}
+
+void addValue(Hasher &hasher, RooAbsArg const &arg)
+{
+   if (auto cat = dynamic_cast<RooAbsCategory const *>(&arg)) {
+      hasher.add(cat->getCurrentIndex());
+   } else if (auto real = dynamic_cast<RooAbsReal const *>(&arg)) {
+      hasher.add(real->getVal());
+   }
+}
+
+/// Add the properties of a fundamental node that is not a parameter. Variables
+/// are observables, for which only the ranges and binnings matter, and not
+/// the current values. Of all other nodes, like constants, the value is used.
+void addNonParameter(Hasher &hasher, RooAbsArg const &arg)
+{
+   if (auto var = dynamic_cast<RooAbsRealLValue const *>(&arg)) {
+      for (const char *binningName : {static_cast<const char *>(nullptr), "cache"}) {
+         RooAbsBinning const &binning = var->getBinning(binningName, false);
+         hasher.add(binning.lowBound());
+         hasher.add(binning.highBound());
+         hasher.add(binning.numBins());
+      }
+   } else if (auto cat = dynamic_cast<RooAbsCategoryLValue const *>(&arg)) {
+      for (auto const &item : *cat) {
+         hasher.add(item.first);
+         hasher.add(item.second);
+      }
+   } else {
+      addValue(hasher, arg);
+   }
+}
+
+std::string filePath(std::string const &dir, std::string const &key)
+{
+   // spread the files over subdirectories to keep the directories small
+   return dir + "/" + key.substr(0, 2) + "/" + key + ".root";
+}
+
+/// Load the payload and the owner name that were stored with the given key.
+std::unique_ptr<TObject> loadPersistent(std::string const &key, std::string &ownerName)
+{
+   const std::string path = filePath(persistentDirectoryRef(), key);
+   if (gSystem->AccessPathName(path.c_str())) {
+      return nullptr; // no such file
+   }
+   TDirectory::TContext ctx{nullptr};
+   std::unique_ptr<TFile> file{TFile::Open(path.c_str(), "READ")};
+   if (!file || file->IsZombie()) {
+      return nullptr;
+   }
+   std::unique_ptr<TObject> obj{file->Get<TObject>("payload")};
+   if (obj) {
+      // Objects like histograms are attached to the file they are read from.
+      if (auto autoAdd = obj->IsA()->GetDirectoryAutoAdd()) {
+         autoAdd(obj.get(), nullptr);
+      }
+      if (auto owner = file->Get<TObjString>("ownerName")) {
+         ownerName = owner->GetString().Data();
+         delete owner;
+      }
+   }
+   return obj;
+}
+
+/// Store the payload with the given key. The file is first written under a
+/// unique temporary name and then renamed, so that other processes never see
+/// partially written files. If several processes store the same key, the last
+/// one wins, which is fine because the objects are equivalent.
+void storePersistent(std::string const &key, TObject const &payload, const char *ownerName)
+{
+   const std::string &dir = persistentDirectoryRef();
+   const std::string path = filePath(dir, key);
+   gSystem->mkdir((dir + "/" + key.substr(0, 2)).c_str(), true);
+
+   const std::string tmpPath = path + "." + TUUID().AsString() + ".tmp";
+   {
+      TDirectory::TContext ctx{nullptr};
+      std::unique_ptr<TFile> file{TFile::Open(tmpPath.c_str(), "RECREATE")};
+      if (!file || file->IsZombie()) {
+         return;
+      }
+      file->WriteTObject(&payload, "payload");
+      TObjString owner{ownerName ? ownerName : ""};
+      file->WriteTObject(&owner, "ownerName");
+   }
+   if (gSystem->Rename(tmpPath.c_str(), path.c_str()) != 0) {
+      gSystem->Unlink(tmpPath.c_str());
+   }
+}
+
+} // namespace
 
 
 
@@ -60,13 +228,163 @@ RooExpensiveObjectCache& RooExpensiveObjectCache::instance()
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Set the directory for the persistent storage of the cache objects, which
+/// is shared by all cache instances. An empty string disables the persistent
+/// storage. The default is taken from the environment variable
+/// `ROOFIT_EXPENSIVE_OBJECT_CACHE_DIR`.
+
+void RooExpensiveObjectCache::setPersistentDirectory(std::string const& dir)
+{
+  persistentDirectoryRef() = dir ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the directory for the persistent storage of the cache objects, or
+/// an empty string if the persistent storage is disabled.
+
+std::string const& RooExpensiveObjectCache::persistentDirectory()
+{
+  return persistentDirectoryRef() ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return true if the persistent storage is enabled with setPersistentDirectory()
+/// and not suspended in the current thread with a SuspendPersistentStorage object.
+
+bool RooExpensiveObjectCache::persistentStorageActive()
+{
+  return !persistentDirectoryRef().empty() && suspendCountRef() == 0 ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+RooExpensiveObjectCache::SuspendPersistentStorage::SuspendPersistentStorage()
+{
+  ++suspendCountRef() ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+RooExpensiveObjectCache::SuspendPersistentStorage::~SuspendPersistentStorage()
+{
+  --suspendCountRef() ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return a hash of the structure of the owner of a cache object: the class,
+/// name, servers and meta arguments of every node in its computation graph,
+/// the values of all fundamental nodes that are not in params, except for the
+/// observables of which only the ranges and binnings are used, and the contents
+/// of histogram functions and pdfs.
+///
+/// Computing the key requires a walk over the whole computation graph, so
+/// owners that look up objects often should compute it once and pass it to
+/// registerObject() and retrieveObject().
+
+std::string RooExpensiveObjectCache::ownerKey(const RooAbsArg& owner, const RooArgSet& params)
+{
+  Hasher hasher ;
+  RooArgSet nodes ;
+  owner.treeNodeServerList(&nodes) ;
+  for (RooAbsArg* node : sortedByName(nodes)) {
+    hasher.add(std::string{node->ClassName()}) ;
+    hasher.add(std::string{node->GetName()}) ;
+    for (RooAbsArg* server : sortedByName(node->servers())) {
+      hasher.add(std::string{server->GetName()}) ;
+    }
+    // Arguments that are not servers, like the expression of a formula
+    std::stringstream metaArgs ;
+    node->printMetaArgs(metaArgs) ;
+    hasher.add(metaArgs.str()) ;
+    if (node->isFundamental() && !params.find(*node)) {
+      addNonParameter(hasher, *node) ;
+    }
+    RooDataHist const* hist = nullptr ;
+    if (auto histFunc = dynamic_cast<RooHistFunc const*>(node)) {
+      hist = &histFunc->dataHist() ;
+    } else if (auto histPdf = dynamic_cast<RooHistPdf const*>(node)) {
+      hist = &histPdf->dataHist() ;
+    }
+    if (hist) {
+      hasher.add(std::size_t(hist->numEntries())) ;
+      for (Int_t i = 0 ; i < hist->numEntries() ; ++i) {
+        hasher.add(hist->weight(i)) ;
+      }
+    }
+  }
+
+  return hasher.digest() ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the key under which an object is stored on disk, which is a hash of
+/// the name of the object and its class, the names and values of the parameters,
+/// and the key of the owner from ownerKey().
+
+std::string RooExpensiveObjectCache::persistentKey(const char* objectName, TClass* tclass, const RooArgSet& params,
+                                                   std::string const& ownerKey)
+{
+  Hasher hasher ;
+  hasher.add(std::string{objectName}) ;
+  hasher.add(std::string{tclass ? tclass->GetName() : ""}) ;
+
+  for (RooAbsArg* par : sortedByName(params)) {
+    hasher.add(std::string{par->GetName()}) ;
+    addValue(hasher, *par) ;
+  }
+
+  hasher.add(ownerKey) ;
+
+  return hasher.digest() ;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Register object associated with given name and given associated parameters with given values in cache.
 /// The cache will take _ownership_of_object_ and is indexed under the given name (which does not
 /// need to be the name of cacheObject and with given set of dependent parameters with validity for the
 /// current values of those parameters. It can be retrieved later by callin retrieveObject()
+///
+/// If the owner is given, the object is only retrieved for an owner with the same structure, see ownerKey().
+/// If in addition the persistent storage is active, the object is also written to disk. Without the
+/// structure of the owner in the key, the object could be reused by a different model with the same
+/// parameter names and values.
+
+bool RooExpensiveObjectCache::registerObject(const char* ownerName, const char* objectName, TObject& cacheObject, const RooArgSet& params,
+                                             const RooAbsArg* owner)
+{
+  return registerObject(ownerName, objectName, cacheObject, params, owner ? ownerKey(*owner, params) : std::string{}) ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Register object with the precomputed key of the owner from ownerKey().
+
+bool RooExpensiveObjectCache::registerObject(const char* ownerName, const char* objectName, TObject& cacheObject, const RooArgSet& params,
+                                             std::string const& ownerKey)
+{
+  installObject(ownerName, objectName, cacheObject, params, ownerKey) ;
+
+  if (persistentStorageActive() && !ownerKey.empty()) {
+    storePersistent(persistentKey(objectName, cacheObject.IsA(), params, ownerKey), cacheObject, ownerName) ;
+  }
+
+  return false ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Install the object in the in-memory cache, replacing any previous object with the same name.
 
-bool RooExpensiveObjectCache::registerObject(const char* ownerName, const char* objectName, TObject& cacheObject, const RooArgSet& params)
+void RooExpensiveObjectCache::installObject(const char* ownerName, const char* objectName, TObject& cacheObject, const RooArgSet& params,
+                                            std::string const& ownerKey)
 {
   // Delete any previous object
   ExpensiveObject* eo = _map[objectName] ;
@@ -76,9 +394,7 @@ bool RooExpensiveObjectCache::registerObject(const char* ownerName, const char*
     delete eo ;
   }
   // Install new object
-  _map[objectName] = new ExpensiveObject(olduid!=-1?olduid:_nextUID++, ownerName,cacheObject,params) ;
-
-  return false ;
+  _map[objectName] = new ExpensiveObject(olduid!=-1?olduid:_nextUID++, ownerName,cacheObject,params,ownerKey) ;
 }
 
 
@@ -87,22 +403,48 @@ bool RooExpensiveObjectCache::registerObject(const char* ownerName, const char*
 /// Retrieve object from cache that was registered under given name with given parameters, _if_
 /// current parameter values match those that were stored in the registry for this object.
 /// The return object is owned by the cache instance.
+///
+/// If the owner is given, the object is only returned if it was registered with an owner of the same
+/// structure. If in addition the persistent storage is active, objects that are not in memory are
+/// looked up on disk.
+
+const TObject* RooExpensiveObjectCache::retrieveObject(const char* name, TClass* tc, const RooArgSet& params,
+                                                       const RooAbsArg* owner)
+{
+  return retrieveObject(name, tc, params, owner ? ownerKey(*owner, params) : std::string{}) ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Retrieve object with the precomputed key of the owner from ownerKey().
 
-const TObject* RooExpensiveObjectCache::retrieveObject(const char* name, TClass* tc, const RooArgSet& params)
+const TObject* RooExpensiveObjectCache::retrieveObject(const char* name, TClass* tc, const RooArgSet& params,
+                                                       std::string const& ownerKey)
 {
-  ExpensiveObject* eo = _map[name] ;
+  auto found = _map.find(name) ;
+  ExpensiveObject* eo = found != _map.end() ? found->second : nullptr ;
 
-  // If no cache element found, return 0 ;
-  if (!eo) {
+  // If parameters and owner structure also match, return payload ;
+  if (eo && eo->matches(tc,params,ownerKey)) {
+    return eo->payload() ;
+  }
+
+  if (!persistentStorageActive() || ownerKey.empty()) {
     return nullptr ;
   }
 
-  // If parameters also match, return payload ;
-  if (eo->matches(tc,params)) {
-    return eo->payload() ;
+  std::string ownerName ;
+  std::unique_ptr<TObject> obj = loadPersistent(persistentKey(name, tc, params, ownerKey), ownerName) ;
+  if (!obj || obj->IsA() != tc) {
+    return nullptr ;
   }
 
-  return nullptr ;
+  oocxcoutI(obj.get(),Caching) << "RooExpensiveObjectCache::retrieveObject() loaded cache object " << name
+                               << " from " << persistentDirectory() << std::endl ;
+
+  TObject* payload = obj.release() ;
+  installObject(ownerName.c_str(), name, *payload, params, ownerKey) ;
+  return payload ;
 }
 
 
@@ -174,8 +516,8 @@ void RooExpensiveObjectCache::clearAll()
 /// for all RooAbsReal and RooAbsCategory parameters in params.
 
 RooExpensiveObjectCache::ExpensiveObject::ExpensiveObject(Int_t uidIn, const char *inOwnerName, TObject &inPayload,
-                                                          RooArgSet const &params)
-   : _uid(uidIn), _payload(&inPayload), _ownerName(inOwnerName)
+                                                          RooArgSet const &params, std::string const &ownerKey)
+   : _uid(uidIn), _payload(&inPayload), _ownerName(inOwnerName), _ownerKey(ownerKey.c_str())
 {
 
   for(RooAbsArg * arg : params) {
@@ -203,7 +545,8 @@ RooExpensiveObjectCache::ExpensiveObject::ExpensiveObject(Int_t uidIn, const Exp
      _payload(other._payload->Clone()),
      _realRefParams(other._realRefParams),
      _catRefParams(other._catRefParams),
-     _ownerName(other._ownerName)
+     _ownerName(other._ownerName),
+     _ownerKey(other._ownerKey)
 {
 }
 
@@ -221,11 +564,11 @@ RooExpensiveObjectCache::ExpensiveObject::~ExpensiveObject()
 
 
 ////////////////////////////////////////////////////////////////////////////////
-/// Check object type ;
+/// Check object type, the structure of the owner and the parameter values ;
 
-bool RooExpensiveObjectCache::ExpensiveObject::matches(TClass* tc, const RooArgSet& params)
+bool RooExpensiveObjectCache::ExpensiveObject::matches(TClass* tc, const RooArgSet& params, std::string const& ownerKey)
 {
-  if (_payload->IsA() != tc) {
+  if (_payload->IsA() != tc || ownerKey != _ownerKey.Data()) {
     return false;
   }
 
@@ -16,14 +16,21 @@
 
 #include "RooFitImplHelpers.h"
 
+#include <TClass.h>
+#include <TFunction.h>
 #include <TInterpreter.h>
+#include <TList.h>
+#include <TMethodArg.h>
+#include <TSystem.h>
 
 #include <algorithm>
 #include <cctype>
 #include <charconv>
 #include <fstream>
 #include <type_traits>
+#include <typeindex>
 #include <unordered_map>
+#include <vector>
 
 namespace {
 
@@ -407,32 +414,132 @@ struct Caller_FUNC_NAME {
    gInterpreter->Declare(dispatcherCode.c_str());
 }
 
-void codegen(RooAbsArg &arg, CodegenContext &ctx)
+namespace {
+
+/// Return the classes for which the interpreter knows an overload of the given
+/// function with a Prio argument.
+std::vector<TClass *> prioritizedOverloadClasses(std::string const &funcName)
 {
-   static bool codeDeclared = false;
-   if (!codeDeclared) {
-      declareDispatcherCode("codegenImpl");
-      codeDeclared = true;
+   std::vector<TClass *> out;
+   TClass *ns = TClass::GetClass("RooFit::Experimental");
+   if (!ns) {
+      return out;
    }
+   for (auto *func : TRangeDynCast<TFunction>(ns->GetListOfMethods())) {
+      if (!func || funcName != func->GetName()) {
+         continue;
+      }
+      TList *args = func->GetListOfMethodArgs();
+      if (!args || args->GetSize() < 2) {
+         continue;
+      }
+      auto *firstArg = static_cast<TMethodArg *>(args->First());
+      auto *lastArg = static_cast<TMethodArg *>(args->Last());
+      if (std::string{lastArg->GetTypeName()}.find("Prio<") == std::string::npos) {
+         continue;
+      }
+      if (TClass *argClass = TClass::GetClass(firstArg->GetTypeName())) {
+         out.push_back(argClass);
+      }
+   }
+   return out;
+}
 
-   using Func = void (*)(RooAbsArg &, CodegenContext &);
+} // namespace
 
-   Func func;
+/// Check if the interpreter knows an overload of the given function with a
+/// Prio argument that takes the given class or one of its base classes. Such
+/// overloads are how users override the implementations of built-in classes,
+/// and only the overload resolution in the interpreter takes them into account.
+///
+/// Listing the functions of the namespace is expensive, so the classes with
+/// prioritized overloads are only collected again if the interpreter state has
+/// changed since the last check, i.e. if new code might have been declared.
+bool hasPrioritizedOverload(std::string const &funcName, TClass const &tclass)
+{
+   struct Overloads {
+      ULong64_t stateMarker = 0;
+      std::vector<TClass *> classes;
+   };
+   static std::unordered_map<std::string, Overloads> overloadsByFunc;
+
+   auto found = overloadsByFunc.find(funcName);
+   if (found == overloadsByFunc.end() || found->second.stateMarker != gInterpreter->GetInterpreterStateMarker()) {
+      Overloads &overloads = overloadsByFunc[funcName];
+      overloads.classes = prioritizedOverloadClasses(funcName);
+      // Looking up the functions can itself change the interpreter state
+      overloads.stateMarker = gInterpreter->GetInterpreterStateMarker();
+      found = overloadsByFunc.find(funcName);
+   }
+   return std::any_of(found->second.classes.begin(), found->second.classes.end(),
+                      [&](TClass *argClass) { return tclass.InheritsFrom(argClass); });
+}
+
+namespace {
+
+std::unordered_map<std::type_index, CodegenImplFunc> &codegenImplRegistry()
+{
+   static std::unordered_map<std::type_index, CodegenImplFunc> registry;
+   return registry;
+}
+
+} // namespace
+
+/// Register the compiled codegen implementation for a class, such that
+/// codegen() can dispatch to it without asking the interpreter to resolve the
+/// overload. The RooFitCodegen library registers the implementations of all
+/// classes that it knows when it is loaded.
+void registerCodegenImpl(std::type_info const &type, CodegenImplFunc func)
+{
+   codegenImplRegistry()[type] = func;
+}
+
+void codegen(RooAbsArg &arg, CodegenContext &ctx)
+{
+   auto &registry = codegenImplRegistry();
+
+   // The registry is filled when the RooFitCodegen library is loaded.
+   static bool codegenLibLoaded = false;
+   if (!codegenLibLoaded) {
+      if (registry.empty()) {
+         gSystem->Load("libRooFitCodegen");
+      }
+      codegenLibLoaded = true;
+   }
+
+   CodegenImplFunc func;
 
    TClass *tclass = arg.IsA();
 
    // Cache the overload resolutions
-   static std::unordered_map<TClass *, Func> dispatchMap;
+   static std::unordered_map<TClass *, CodegenImplFunc> dispatchMap;
 
    auto found = dispatchMap.find(tclass);
 
+   // Classes from the RooFit libraries are registered at compile time. Only
+   // the overloads for other classes, and for classes that the user has
+   // overridden with a prioritized overload, have to be resolved by the
+   // interpreter.
+   auto registered = registry.end();
+   if (found == dispatchMap.end()) {
+      registered = registry.find(typeid(arg));
+   }
+
    if (found != dispatchMap.end()) {
       func = found->second;
+   } else if (registered != registry.end() && !hasPrioritizedOverload("codegenImpl", *tclass)) {
+      func = registered->second;
+      dispatchMap[tclass] = func;
    } else {
+      static bool codeDeclared = false;
+      if (!codeDeclared) {
+         declareDispatcherCode("codegenImpl");
+         codeDeclared = true;
+      }
       // Can probably done with CppInterop in the future to avoid string manipulation.
       std::stringstream cmd;
       cmd << "&RooFit::Experimental::Caller_codegenImpl<" << tclass->GetName() << ">::call;";
-      func = reinterpret_cast<Func>(gInterpreter->ProcessLine(cmd.str().c_str()));
+      func = reinterpret_cast<CodegenImplFunc>(gInterpreter->ProcessLine(cmd.str().c_str()));
       dispatchMap[tclass] = func;
    }
 
@@ -0,0 +1,155 @@
+/*
+ * Project: RooFit
+ *
+ * Copyright (c) 2024, CERN
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted according to the terms
+ * listed in LICENSE (http://roofit.sourceforge.net/license.txt)
+ */
+
+#include "DataWeightedAverage.h"
+
+#include "BatchModeDataHelpers.h"
+#include "WorkStealingPool.h"
+
+#include <RooAbsData.h>
+#include <RooAbsReal.h>
+#include <RooAbsRealLValue.h>
+#include <RooFit/Detail/NormalizationHelpers.h>
+#include <RooFit/Evaluator.h>
+
+#include <algorithm>
+
+namespace RooFit {
+namespace Detail {
+
+/// Prepare the evaluation of the weighted average of `arg` over `data`.
+/// \param[in] arg The function to average.
+/// \param[in] data The dataset with the events to average over. The columns
+///            that have the same name as one of the `vars` are ignored.
+/// \param[in] normSet The normalization set for the function.
+/// \param[in] vars The variables that are set from the arguments of
+///            operator() and evaluateMany(), in this order.
+DataWeightedAverage::DataWeightedAverage(RooAbsReal const &arg, RooAbsData const &data, RooArgSet const &normSet,
+                                         RooArgSet const &vars)
+   : _arg{arg}, _normSet{normSet}, _vars{vars}, _weights{data.getWeightBatch(0, data.numEntries())}
+{
+   _dataSpans = RooFit::BatchModeDataHelpers::getDataSpans(data, "", nullptr, /*skipZeroWeights=*/false,
+                                                           /*takeGlobalObservablesFromData=*/true, _vectorBuffers);
+   _mainSlot = makeSlot();
+}
+
+DataWeightedAverage::~DataWeightedAverage() = default;
+
+/// Compile a copy of the function where the variables are replaced by
+/// clones, such that the slot can be evaluated independently of the others.
+std::unique_ptr<DataWeightedAverage::Slot> DataWeightedAverage::makeSlot() const
+{
+   auto slot = std::make_unique<Slot>();
+   _vars.snapshot(slot->ownedVars, false);
+   for (RooAbsArg *var : _vars) {
+      slot->vars.push_back(static_cast<RooAbsRealLValue *>(slot->ownedVars.find(*var)));
+   }
+
+   slot->func = RooFit::Detail::compileForNormSet(_arg, _normSet);
+   slot->func->recursiveRedirectServers(slot->ownedVars);
+   slot->evaluator = std::make_unique<RooFit::Evaluator>(*slot->func);
+   for (auto const &item : _dataSpans) {
+      if (!_vars.find(item.first->GetName())) {
+         slot->evaluator->setInput(item.first->GetName(), item.second, false);
+      }
+   }
+   return slot;
+}
+
+double DataWeightedAverage::average(Slot &slot, const double xvector[]) const
+{
+   for (std::size_t i = 0; i < slot.vars.size(); ++i) {
+      slot.vars[i]->setVal(xvector[i]);
+   }
+
+   std::span<const double> values = slot.evaluator->run();
+
+   // The function doesn't depend on the observables in the dataset.
+   if (values.size() == 1) {
+      return values[0];
+   }
+
+   double result = 0.0;
+   double weightsSum = 0.0;
+   if (_weights.empty()) {
+      for (double value : values) {
+         result += value;
+      }
+      weightsSum = values.size();
+   } else {
+      for (std::size_t i = 0; i < values.size(); ++i) {
+         const double weight = _weights[i];
+         if (weight != 0.0) {
+            result += weight * values[i];
+            weightsSum += weight;
+         }
+      }
+   }
+
+   return weightsSum == 0.0 ? 0.0 : result / weightsSum;
+}
+
+/// Return the weighted average for the given values of the variables.
+double DataWeightedAverage::operator()(const double xvector[])
+{
+   return average(*_mainSlot, xvector);
+}
+
+/// Compute the weighted average for several points concurrently, using
+/// Evaluator::defaultNThreads() threads. The values of the variables for all
+/// the points are given one point after the other in `xvectors`, and there
+/// has to be one output value per point. Because the error log is not
+/// thread safe, the evaluation errors are only counted, with the logging
+/// mode set to RooAbsReal::CountErrors.
+/// \return False without computing anything if only one thread is
+///         configured, and false if any evaluation error occurred. In both
+///         cases, the points should be evaluated one by one with operator(),
+///         to log the errors and to handle them for every point.
+bool DataWeightedAverage::evaluateMany(std::span<const double> xvectors, std::span<double> out)
+{
+   const std::size_t nVars = _vars.size();
+   const std::size_t nPoints = out.size();
+   const std::size_t nThreads = std::min<std::size_t>(RooFit::Evaluator::defaultNThreads(), nPoints);
+
+   if (nThreads <= 1) {
+      return false;
+   }
+
+   RooAbsReal::EvalErrorContext errorContext{RooAbsReal::CountErrors};
+   const int nErrorsBefore = RooAbsReal::numEvalErrors();
+
+   // The slots are created on this thread, because the compilation of the
+   // computation graph is not thread safe. Each of them evaluates the events
+   // on a single thread, as the points are already distributed over threads.
+   if (_threadSlots.size() < nThreads) {
+      const unsigned int oldNThreads = RooFit::Evaluator::defaultNThreads();
+      RooFit::Evaluator::setDefaultNThreads(1);
+      while (_threadSlots.size() < nThreads) {
+         _threadSlots.emplace_back(makeSlot());
+      }
+      RooFit::Evaluator::setDefaultNThreads(oldNThreads);
+   }
+   if (!_threadPool || _threadPool->nThreads() != nThreads) {
+      _threadPool = std::make_unique<WorkStealingPool>(nThreads);
+   }
+
+   auto pushInitialTasks = [&]() {
+      for (std::size_t i = 0; i < nPoints; ++i) {
+         _threadPool->push(i, i % nThreads, false);
+      }
+   };
+   _threadPool->run(nPoints, pushInitialTasks, [&](std::size_t task, std::size_t thread) {
+      out[task] = average(*_threadSlots[thread], xvectors.data() + task * nVars);
+   });
+   return RooAbsReal::numEvalErrors() == nErrorsBefore;
+}
+
+} // namespace Detail
+} // namespace RooFit
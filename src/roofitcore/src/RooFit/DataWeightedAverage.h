@@ -0,0 +1,81 @@
+/*
+ * Project: RooFit
+ *
+ * Copyright (c) 2024, CERN
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted according to the terms
+ * listed in LICENSE (http://roofit.sourceforge.net/license.txt)
+ */
+
+#ifndef RooFit_DataWeightedAverage_h
+#define RooFit_DataWeightedAverage_h
+
+#include <RooArgSet.h>
+#include <RooFit/EvalContext.h>
+
+#include <ROOT/RSpan.hxx>
+
+#include <map>
+#include <memory>
+#include <stack>
+#include <string>
+#include <vector>
+
+class RooAbsData;
+class RooAbsReal;
+class RooAbsRealLValue;
+
+namespace RooFit {
+
+class Evaluator;
+
+namespace Detail {
+
+class WorkStealingPool;
+
+/// Computes the weighted average of a function over the events of a dataset,
+/// as a function of some variables that are not taken from the data, like
+/// for the projections with RooFit::ProjWData() when plotting. All events are
+/// evaluated in one pass of a RooFit::Evaluator.
+///
+/// If Evaluator::defaultNThreads() is larger than one, several values of the
+/// variables can be evaluated concurrently with evaluateMany(). Every
+/// thread then gets its own compiled copy of the function with its own copy
+/// of the variables, so the memory for the intermediate results is needed
+/// once per thread.
+class DataWeightedAverage {
+public:
+   DataWeightedAverage(RooAbsReal const &arg, RooAbsData const &data, RooArgSet const &normSet,
+                       RooArgSet const &vars);
+   ~DataWeightedAverage();
+
+   double operator()(const double xvector[]);
+   bool evaluateMany(std::span<const double> xvectors, std::span<double> out);
+
+private:
+   struct Slot {
+      RooArgSet ownedVars;
+      std::vector<RooAbsRealLValue *> vars;
+      std::unique_ptr<RooAbsReal> func;
+      std::unique_ptr<RooFit::Evaluator> evaluator;
+   };
+
+   std::unique_ptr<Slot> makeSlot() const;
+   double average(Slot &slot, const double xvector[]) const;
+
+   RooAbsReal const &_arg;
+   RooArgSet _normSet;
+   RooArgSet _vars;
+   std::stack<std::vector<double>> _vectorBuffers;
+   std::map<RooFit::Detail::DataKey, std::span<const double>> _dataSpans;
+   std::span<const double> _weights;
+   std::unique_ptr<Slot> _mainSlot;
+   std::vector<std::unique_ptr<Slot>> _threadSlots;
+   std::unique_ptr<WorkStealingPool> _threadPool;
+};
+
+} // namespace Detail
+} // namespace RooFit
+
+#endif
@@ -17,6 +17,7 @@
 #include <RooRealVar.h>
 
 #include <algorithm>
+#include <atomic>
 #include <stdexcept>
 
 namespace {
@@ -83,6 +84,15 @@ void EvalContext::resize(std::size_t n)
 {
    _cfgs.resize(n);
    _ctx.resize(n);
+   _versions.resize(n, 0);
+}
+
+std::size_t EvalContext::nextVersion()
+{
+   // Shared by all contexts, such that the versions of the values set in
+   // different contexts never compare equal.
+   static std::atomic<std::size_t> counter{0};
+   return ++counter;
 }
 
 /// \brief Sets the output value with an offset.
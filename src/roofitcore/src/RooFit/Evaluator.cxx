@@ -33,6 +33,7 @@ RooAbsPdf::fitTo() is called and gets destroyed when the fitting ends.
 #include <RooAbsReal.h>
 #include <RooRealVar.h>
 #include <RooBatchCompute.h>
+#include <RooFit/Detail/RooNLLVarNew.h>
 #include <RooMsgService.h>
 #include <RooNameReg.h>
 #include <RooSimultaneous.h>
@@ -41,7 +42,9 @@ RooAbsPdf::fitTo() is called and gets destroyed when the fitting ends.
 
 #include "BatchModeDataHelpers.h"
 #include "RooFitImplHelpers.h"
+#include "WorkStealingPool.h"
 
+#include <algorithm>
 #include <chrono>
 #include <iomanip>
 #include <numeric>
@@ -59,6 +62,11 @@ void assignSpan(std::span<T> &to, std::span<T> const &from)
    to = from;
 }
 
+// Number of events that are evaluated at once in the fused evaluation. This
+// is a multiple of the RooBatchCompute::bufferSize, but larger than that to
+// amortize the fixed cost of calling doEval() on each node for each block.
+constexpr std::size_t fusedBlockSize = 16 * RooBatchCompute::bufferSize;
+
 void logArchitectureInfo(bool useGPU)
 {
    // We have to exit early if the message stream is not active. Otherwise it's
@@ -114,6 +122,8 @@ struct NodeInfo {
    bool hasLogged = false;
    bool computeInGPU = false;
    bool isValueServer = false; // if this node is a value server to the top node
+   bool isConcurrent = false;  // if this node can be evaluated concurrently to others in the multi-threaded mode
+   int fusedGroup = -1;        // index of the group in the fused evaluation, or -1 if not part of a group
    std::size_t outputSize = 1;
    std::size_t lastSetValCount = std::numeric_limits<std::size_t>::max();
    int lastCatVal = std::numeric_limits<int>::max();
@@ -142,6 +152,24 @@ struct NodeInfo {
    }
 };
 
+/// A group of vector-valued nodes with the same output size that are
+/// evaluated together block by block in the fused evaluation. Only the
+/// members that are used outside the group get a full-size output buffer,
+/// the intermediate results only exist for one block at a time. If the group
+/// feeds an unbinned likelihood, the likelihood is accumulated block by block
+/// as well, and the probabilities of the top pdf are never stored.
+struct FusedGroup {
+   std::vector<NodeInfo *> members; // in the order of the computation graph
+   std::vector<bool> isMaterialized;
+   std::vector<std::vector<double>> blockBuffers; // for the members that are not materialized
+   std::vector<NodeInfo *> inputs;                // vector-valued servers that are not in the group
+   NodeInfo *reducer = nullptr;                   // the RooNLLVarNew that reduces the group output, if any
+   bool isDirty = true;
+
+   /// The node at which the group is evaluated.
+   NodeInfo const *last() const { return reducer ? reducer : members.back(); }
+};
+
 /// Construct a new Evaluator. The constructor analyzes and saves metadata about the graph,
 /// useful for the evaluation of it that will be done later. In case the CUDA mode is selected,
 /// there's also some CUDA-related initialization.
@@ -231,6 +259,83 @@ Evaluator::Evaluator(const RooAbsReal &absReal, bool useGPU)
          _evalContextCUDA.setConfig(info.absArg, cfg);
       }
    }
+
+   if (!_useGPU && _defaultNThreads > 1) {
+      _threadPool = std::make_unique<Detail::WorkStealingPool>(_defaultNThreads);
+      _threadEvalContexts.resize(_defaultNThreads - 1);
+      _remDirtyServers = std::make_unique<std::atomic<int>[]>(_nodes.size());
+   }
+
+   _fusedEvaluation = !_useGPU && !_threadPool && _defaultFusedEvaluation;
+}
+
+/// Allow the RooBatchCompute library to evaluate the nodes on the CPU with
+/// single precision arithmetic, where it has an implementation for that. Only
+/// the arithmetic of the selected kernels of the AVX2 and AVX-512 libraries is
+/// done in single precision. The buffers between the nodes stay in double
+/// precision, so the memory bandwidth is not reduced, and the likelihood is
+/// still reduced in double precision with Kahan summation. If the loaded
+/// library has no single precision kernels, a warning is printed and the
+/// evaluation is the same as without this flag. The CUDA evaluation is not
+/// affected.
+void Evaluator::setUseSinglePrecision(bool flag)
+{
+   if (flag && !RooBatchCompute::cpuHasSinglePrecisionFunctions()) {
+      oocoutW(static_cast<RooAbsArg *>(nullptr), FastEvaluations)
+         << "The RooBatchCompute library for the " << RooBatchCompute::cpuArchitectureName()
+         << " architecture has no single precision kernels. All nodes are evaluated in double precision."
+         << std::endl;
+   }
+   for (NodeInfo &info : _nodes) {
+      RooBatchCompute::Config cfg = _evalContextCPU.config(info.absArg);
+      cfg.setUseSinglePrecision(flag);
+      _evalContextCPU.setConfig(info.absArg, cfg);
+   }
+}
+
+unsigned int Evaluator::_defaultNThreads = 1;
+bool Evaluator::_defaultFusedEvaluation = false;
+
+/// Set the number of threads that new Evaluator instances use on the CPU.
+/// With more than one thread, the nodes that need to be recomputed are
+/// scheduled according to their dependencies, such that independent parts of
+/// the computation graph are evaluated concurrently. This is useful for wide
+/// graphs, for example the channels of a RooSimultaneous. Only vector-valued
+/// nodes of classes that opted in with RooAbsArg::canComputeBatchConcurrently()
+/// are run on the additional threads, all other nodes are still evaluated on
+/// the calling thread. The default is one thread, i.e. the serial evaluation.
+void Evaluator::setDefaultNThreads(unsigned int nThreads)
+{
+   _defaultNThreads = nThreads;
+}
+
+/// Get the number of threads that new Evaluator instances use on the CPU.
+unsigned int Evaluator::defaultNThreads()
+{
+   return _defaultNThreads;
+}
+
+/// Enable or disable the fused evaluation for new Evaluator instances. In
+/// this mode, connected vector-valued nodes that are evaluated with the
+/// RooBatchCompute library are evaluated together for one block of events at
+/// a time, instead of each node computing all events before the next one
+/// starts. The intermediate results then stay in the cache, and only the
+/// outputs that are needed by other nodes are written to full-size buffers.
+/// An unbinned likelihood is also reduced block by block, so the
+/// probabilities of the top pdf are never stored in a full-size buffer.
+/// Because of the different order of the partial sums, the likelihood then
+/// agrees with the non-fused evaluation only up to the last few bits.
+/// This reduces the memory traffic for large datasets. It only applies to
+/// the serial evaluation on the CPU. The default is `false`.
+void Evaluator::setDefaultFusedEvaluation(bool flag)
+{
+   _defaultFusedEvaluation = flag;
+}
+
+/// Check if new Evaluator instances use the fused evaluation.
+bool Evaluator::defaultFusedEvaluation()
+{
+   return _defaultFusedEvaluation;
 }
 
 /// If there are servers with the same name that got de-duplicated in the
@@ -326,15 +431,129 @@ void Evaluator::updateOutputSizes()
    for (auto &info : _nodes) {
       info.outputSize = outputSizeMap.at(info.absArg);
       info.isDirty = true;
+      // Only classes that explicitly opted in are known to not touch any state
+      // outside of their own output buffer. All other nodes, including the
+      // ones that use the generic RooAbsReal::doEval() fallback, are evaluated
+      // on the calling thread.
+      info.isConcurrent = !info.isScalar() && !info.isCategory && info.absArg->canComputeBatchConcurrently();
    }
 
    if (_useGPU) {
       markGPUNodes();
    }
 
+   if (_fusedEvaluation) {
+      buildFusedGroups();
+   }
+
    _needToUpdateOutputSizes = false;
 }
 
+/// Find the groups of nodes for the fused evaluation. A node can be fused if
+/// it is evaluated with a RooBatchCompute kernel, which is element-wise, and
+/// all its vector-valued inputs have the same size as its output. Going
+/// through the nodes in the order of the computation graph, such nodes are
+/// collected in a group. Nodes in between that can't be fused are evaluated
+/// before the group, which is only possible if they don't depend on the group
+/// members. Otherwise, the group is closed. An unbinned likelihood that
+/// depends on the group is attached to it as the reducer, which closes the
+/// group as well.
+void Evaluator::buildFusedGroups()
+{
+   _fusedGroups.clear();
+   for (NodeInfo &info : _nodes) {
+      info.fusedGroup = -1;
+   }
+
+   auto canBeFused = [](NodeInfo const &info) {
+      if (info.isScalar() || info.isCategory || info.fromArrayInput || !info.absArg->canComputeBatchWithCuda()) {
+         return false;
+      }
+      for (NodeInfo const *serverInfo : info.serverInfos) {
+         if (!serverInfo->isScalar() && serverInfo->outputSize != info.outputSize) {
+            return false;
+         }
+      }
+      return true;
+   };
+
+   // The likelihood can be reduced block by block if all its vector-valued
+   // inputs are the group members or have the same size as the group.
+   auto canBeReducer = [](NodeInfo const &info, std::size_t groupSize) {
+      auto nll = dynamic_cast<RooFit::Detail::RooNLLVarNew const *>(info.absArg);
+      if (!nll || !nll->canReduceBlockwise()) {
+         return false;
+      }
+      for (NodeInfo const *serverInfo : info.serverInfos) {
+         const bool isWeight = serverInfo->absArg->namePtr() == nll->weightVar().namePtr() ||
+                               serverInfo->absArg->namePtr() == nll->weightSquaredVar().namePtr();
+         if ((isWeight || !serverInfo->isScalar()) && serverInfo->outputSize != groupSize) {
+            return false;
+         }
+      }
+      return true;
+   };
+
+   std::vector<NodeInfo *> current;
+   NodeInfo *reducer = nullptr;
+
+   auto closeGroup = [&]() {
+      if (current.size() == 1 && !reducer) {
+         current[0]->fusedGroup = -1;
+      }
+      if (current.size() > 1 || (!current.empty() && reducer)) {
+         const int iGroup = _fusedGroups.size();
+         FusedGroup &group = _fusedGroups.emplace_back();
+         group.members = current;
+         group.reducer = reducer;
+         for (NodeInfo *member : current) {
+            bool isMaterialized = member == &_nodes.back() || member->clientInfos.empty();
+            for (NodeInfo const *clientInfo : member->clientInfos) {
+               isMaterialized |= clientInfo->fusedGroup != iGroup;
+            }
+            group.isMaterialized.push_back(isMaterialized);
+            group.blockBuffers.emplace_back(isMaterialized ? 0 : fusedBlockSize);
+         }
+         if (reducer) {
+            current.push_back(reducer);
+         }
+         for (NodeInfo *node : current) {
+            for (NodeInfo *serverInfo : node->serverInfos) {
+               if (!serverInfo->isScalar() && serverInfo->fusedGroup != iGroup &&
+                   std::find(group.inputs.begin(), group.inputs.end(), serverInfo) == group.inputs.end()) {
+                  group.inputs.push_back(serverInfo);
+               }
+            }
+         }
+      }
+      current.clear();
+      reducer = nullptr;
+   };
+
+   for (NodeInfo &info : _nodes) {
+      const int iGroup = _fusedGroups.size();
+      if (canBeFused(info)) {
+         if (!current.empty() && current.front()->outputSize != info.outputSize) {
+            closeGroup();
+         }
+         info.fusedGroup = _fusedGroups.size();
+         current.push_back(&info);
+         continue;
+      }
+      for (NodeInfo const *serverInfo : info.serverInfos) {
+         if (serverInfo->fusedGroup == iGroup) {
+            if (canBeReducer(info, current.front()->outputSize)) {
+               info.fusedGroup = iGroup;
+               reducer = &info;
+            }
+            closeGroup();
+            break;
+         }
+      }
+   }
+   closeGroup();
+}
+
 Evaluator::~Evaluator()
 {
    for (auto &info : _nodes) {
@@ -344,7 +563,7 @@ Evaluator::~Evaluator()
    }
 }
 
-void Evaluator::computeCPUNode(const RooAbsArg *node, NodeInfo &info)
+void Evaluator::computeCPUNode(const RooAbsArg *node, NodeInfo &info, RooFit::EvalContext &ctx)
 {
    using namespace Detail;
 
@@ -371,10 +590,10 @@ void Evaluator::computeCPUNode(const RooAbsArg *node, NodeInfo &info)
       }
       buffer = info.buffer->hostWritePtr();
    }
-   assignSpan(_evalContextCPU._currentOutput, {buffer, nOut});
-   _evalContextCPU.set(node, {buffer, nOut});
+   assignSpan(ctx._currentOutput, {buffer, nOut});
+   ctx.set(node, {buffer, nOut});
    if (nOut > 1) {
-      _evalContextCPU.enableVectorBuffers(true);
+      ctx.enableVectorBuffers(true);
    }
    if (info.isCategory) {
       auto nodeAbsCategory = static_cast<RooAbsCategory const *>(node);
@@ -385,10 +604,10 @@ void Evaluator::computeCPUNode(const RooAbsArg *node, NodeInfo &info)
       }
    } else {
       auto nodeAbsReal = static_cast<RooAbsReal const *>(node);
-      nodeAbsReal->doEval(_evalContextCPU);
+      nodeAbsReal->doEval(ctx);
    }
-   _evalContextCPU.resetVectorBuffers();
-   _evalContextCPU.enableVectorBuffers(false);
+   ctx.resetVectorBuffers();
+   ctx.enableVectorBuffers(false);
    if (info.copyAfterEvaluation) {
       _evalContextCUDA.set(node, {info.buffer->deviceReadPtr(), nOut});
       if (info.event) {
@@ -408,7 +627,7 @@ void Evaluator::processVariable(NodeInfo &nodeInfo)
       for (NodeInfo *clientInfo : nodeInfo.clientInfos) {
          clientInfo->isDirty = true;
       }
-      computeCPUNode(node, nodeInfo);
+      computeCPUNode(node, nodeInfo, _evalContextCPU);
       nodeInfo.isDirty = false;
    }
 }
@@ -424,7 +643,7 @@ void Evaluator::processCategory(NodeInfo &nodeInfo)
       for (NodeInfo *clientInfo : nodeInfo.clientInfos) {
          clientInfo->isDirty = true;
       }
-      computeCPUNode(node, nodeInfo);
+      computeCPUNode(node, nodeInfo, _evalContextCPU);
       nodeInfo.isDirty = false;
    }
 }
@@ -450,16 +669,23 @@ std::span<const double> Evaluator::run()
       return getValHeterogeneous();
    }
 
+   if (_threadPool) {
+      runParallel();
+      return _evalContextCPU.at(&_topNode);
+   }
+
    for (auto &nodeInfo : _nodes) {
       if (!nodeInfo.fromArrayInput) {
          if (nodeInfo.isVariable) {
             processVariable(nodeInfo);
          } else if (nodeInfo.isCategory) {
             processCategory(nodeInfo);
+         } else if (nodeInfo.fusedGroup >= 0) {
+            processFusedNode(nodeInfo);
          } else {
             if (nodeInfo.isDirty) {
                setClientsDirty(nodeInfo);
-               computeCPUNode(nodeInfo.absArg, nodeInfo);
+               computeCPUNode(nodeInfo.absArg, nodeInfo, _evalContextCPU);
                nodeInfo.isDirty = false;
             }
          }
@@ -470,6 +696,173 @@ std::span<const double> Evaluator::run()
    return _evalContextCPU.at(&_topNode);
 }
 
+/// Process a node that is part of a group in the fused evaluation. The group
+/// is evaluated when its last member is reached, and all the members are
+/// recomputed if any of them is dirty, because the intermediate results are
+/// not kept.
+void Evaluator::processFusedNode(NodeInfo &nodeInfo)
+{
+   FusedGroup &group = _fusedGroups[nodeInfo.fusedGroup];
+   if (nodeInfo.isDirty) {
+      setClientsDirty(nodeInfo);
+      group.isDirty = true;
+      nodeInfo.isDirty = false;
+   }
+   if (&nodeInfo == group.last() && group.isDirty) {
+      computeFusedGroup(group);
+      group.isDirty = false;
+   }
+}
+
+/// Evaluate all members of a group in the fused evaluation for one block of
+/// events after the other.
+void Evaluator::computeFusedGroup(FusedGroup &group)
+{
+   RooFit::EvalContext &ctx = _evalContextCPU;
+
+   auto const *nll =
+      group.reducer ? static_cast<RooFit::Detail::RooNLLVarNew const *>(group.reducer->absArg) : nullptr;
+   RooBatchCompute::ReduceNLLOutput nllOut;
+
+   const std::size_t nEvents = group.members.front()->outputSize;
+
+   std::vector<std::span<const double>> inputSpans;
+   inputSpans.reserve(group.inputs.size());
+   for (NodeInfo const *input : group.inputs) {
+      inputSpans.push_back(ctx.at(input->absArg));
+   }
+
+   for (std::size_t i = 0; i < group.members.size(); ++i) {
+      NodeInfo &member = *group.members[i];
+      if (group.isMaterialized[i] && !member.buffer) {
+         member.buffer = _bufferManager->makeCpuBuffer(nEvents);
+      }
+   }
+
+   for (std::size_t begin = 0; begin < nEvents; begin += fusedBlockSize) {
+      const std::size_t nBlock = std::min(fusedBlockSize, nEvents - begin);
+
+      for (std::size_t i = 0; i < group.inputs.size(); ++i) {
+         ctx.set(group.inputs[i]->absArg, inputSpans[i].subspan(begin, nBlock));
+      }
+
+      for (std::size_t i = 0; i < group.members.size(); ++i) {
+         NodeInfo &member = *group.members[i];
+         double *buffer = group.isMaterialized[i] ? member.buffer->hostWritePtr() + begin : group.blockBuffers[i].data();
+         assignSpan(ctx._currentOutput, {buffer, nBlock});
+         ctx.set(member.absArg, {buffer, nBlock});
+         ctx.enableVectorBuffers(true);
+         static_cast<RooAbsReal const *>(member.absArg)->doEval(ctx);
+         ctx.resetVectorBuffers();
+         ctx.enableVectorBuffers(false);
+      }
+
+      if (nll) {
+         nll->accumulateNLL(ctx, nllOut);
+      }
+   }
+
+   // Point the context back to the full arrays of the inputs and outputs.
+   for (std::size_t i = 0; i < group.inputs.size(); ++i) {
+      ctx.set(group.inputs[i]->absArg, inputSpans[i]);
+   }
+   for (std::size_t i = 0; i < group.members.size(); ++i) {
+      if (group.isMaterialized[i]) {
+         NodeInfo &member = *group.members[i];
+         ctx.set(member.absArg, {member.buffer->hostReadPtr(), nEvents});
+      }
+   }
+
+   if (nll) {
+      NodeInfo &info = *group.reducer;
+      assignSpan(ctx._currentOutput, {&info.scalarBuffer, 1});
+      ctx.set(nll, {&info.scalarBuffer, 1});
+      nll->finalizeNLL(ctx, nllOut);
+   }
+}
+
+/// Multi-threaded evaluation of the computation graph on the CPU. The dirty
+/// nodes are scheduled as soon as all their dirty servers are computed, using
+/// a per-node counter of remaining servers like in the CUDA mode.
+void Evaluator::runParallel()
+{
+   // First pass on the calling thread: evaluate the variables and categories,
+   // propagate the dirty flags, and set up the output buffers of the nodes
+   // that need to be recomputed, because the buffer manager is not thread safe.
+   _dirtyNodes.clear();
+   for (auto &nodeInfo : _nodes) {
+      if (nodeInfo.fromArrayInput) {
+         continue;
+      }
+      if (nodeInfo.isVariable) {
+         processVariable(nodeInfo);
+      } else if (nodeInfo.isCategory) {
+         processCategory(nodeInfo);
+      } else if (nodeInfo.isDirty) {
+         setClientsDirty(nodeInfo);
+         double *buffer = &nodeInfo.scalarBuffer;
+         if (!nodeInfo.isScalar()) {
+            if (!nodeInfo.buffer) {
+               nodeInfo.buffer = _bufferManager->makeCpuBuffer(nodeInfo.outputSize);
+            }
+            buffer = nodeInfo.buffer->hostWritePtr();
+         }
+         _evalContextCPU.set(nodeInfo.absArg, {buffer, nodeInfo.outputSize});
+         _dirtyNodes.push_back(&nodeInfo);
+      }
+   }
+
+   if (_dirtyNodes.empty()) {
+      return;
+   }
+
+   auto isScheduled = [](NodeInfo const &info) {
+      return info.isDirty && !info.fromArrayInput && !info.isVariable && !info.isCategory;
+   };
+
+   for (NodeInfo *info : _dirtyNodes) {
+      int nDirtyServers = 0;
+      for (NodeInfo const *serverInfo : info->serverInfos) {
+         nDirtyServers += isScheduled(*serverInfo);
+      }
+      info->remServers = nDirtyServers;
+      _remDirtyServers[info->iNode].store(nDirtyServers);
+   }
+
+   // All output spans are known now, so each thread can work with its own
+   // copy of the evaluation context.
+   for (RooFit::EvalContext &ctx : _threadEvalContexts) {
+      ctx._ctx = _evalContextCPU._ctx;
+      ctx._versions = _evalContextCPU._versions;
+      ctx._cfgs = _evalContextCPU._cfgs;
+      ctx._offsetMode = _evalContextCPU._offsetMode;
+   }
+
+   auto pushInitialTasks = [&]() {
+      std::size_t iThread = 0;
+      for (NodeInfo *info : _dirtyNodes) {
+         if (info->remServers == 0) {
+            _threadPool->push(info->iNode, iThread, !info->isConcurrent);
+            iThread = (iThread + 1) % _threadPool->nThreads();
+         }
+      }
+   };
+
+   _threadPool->run(_dirtyNodes.size(), pushInitialTasks, [&](std::size_t iNode, std::size_t iThread) {
+      NodeInfo &info = _nodes[iNode];
+      computeCPUNode(info.absArg, info, iThread == 0 ? _evalContextCPU : _threadEvalContexts[iThread - 1]);
+      for (NodeInfo *clientInfo : info.clientInfos) {
+         if (isScheduled(*clientInfo) && --_remDirtyServers[clientInfo->iNode] == 0) {
+            _threadPool->push(clientInfo->iNode, iThread, !clientInfo->isConcurrent);
+         }
+      }
+   });
+
+   for (NodeInfo *info : _dirtyNodes) {
+      info->isDirty = false;
+   }
+}
+
 /// Returns the value of the top node in the computation graph
 std::span<const double> Evaluator::getValHeterogeneous()
 {
@@ -526,7 +919,7 @@ std::span<const double> Evaluator::getValHeterogeneous()
       info.remServers = -2; // so that it doesn't get picked again
 
       if (!info.fromArrayInput) {
-         computeCPUNode(node, info);
+         computeCPUNode(node, info, _evalContextCPU);
       }
 
       // Assign the clients that are computed on the GPU
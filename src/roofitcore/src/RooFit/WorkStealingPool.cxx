@@ -0,0 +1,140 @@
+/*
+ * Project: RooFit
+ *
+ * Copyright (c) 2024, CERN
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted according to the terms
+ * listed in LICENSE (http://roofit.sourceforge.net/license.txt)
+ */
+
+#include "WorkStealingPool.h"
+
+namespace RooFit {
+namespace Detail {
+
+/// Start the pool with `nThreads` threads in total, including the thread that
+/// calls run(). Hence, `nThreads - 1` threads are spawned.
+WorkStealingPool::WorkStealingPool(std::size_t nThreads)
+{
+   if (nThreads == 0)
+      nThreads = 1;
+   for (std::size_t i = 0; i < nThreads; ++i) {
+      _queues.emplace_back(std::make_unique<TaskQueue>());
+   }
+   _threads.reserve(nThreads - 1);
+   for (std::size_t i = 1; i < nThreads; ++i) {
+      _threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+   }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+   {
+      std::lock_guard<std::mutex> lock{_wakeMutex};
+      _stop = true;
+   }
+   _wakeCondition.notify_all();
+   for (std::thread &thread : _threads) {
+      thread.join();
+   }
+}
+
+/// Execute `nTasks` tasks and return when all of them are done. The initial
+/// tasks that have no dependencies are pushed by the `pushInitialTasks`
+/// callback, the remaining ones have to be pushed from the task function once
+/// they become ready.
+void WorkStealingPool::run(std::size_t nTasks, std::function<void()> const &pushInitialTasks, TaskFn fn)
+{
+   if (nTasks == 0)
+      return;
+
+   // The task function is only read by threads after they popped a task,
+   // which happens after the tasks are pushed below.
+   _fn = std::move(fn);
+   _remainingTasks.store(nTasks);
+   pushInitialTasks();
+
+   {
+      std::lock_guard<std::mutex> lock{_wakeMutex};
+      ++_generation;
+   }
+   _wakeCondition.notify_all();
+
+   executeTasks(0);
+
+   // Wait until no worker is still looking for tasks of this run.
+   std::unique_lock<std::mutex> lock{_wakeMutex};
+   _idleCondition.wait(lock, [&] { return _activeWorkers == 0; });
+}
+
+/// Push a ready task to the queue of the given thread. Tasks that have to be
+/// executed on the thread that called run() go to a separate queue that the
+/// other threads don't steal from.
+void WorkStealingPool::push(std::size_t task, std::size_t thread, bool onMainThread)
+{
+   TaskQueue &queue = onMainThread ? _mainThreadQueue : *_queues[thread];
+   std::lock_guard<std::mutex> lock{queue.mutex};
+   queue.tasks.push_back(task);
+}
+
+bool WorkStealingPool::tryPop(TaskQueue &queue, std::size_t &task, bool fromBack)
+{
+   std::lock_guard<std::mutex> lock{queue.mutex};
+   if (queue.tasks.empty())
+      return false;
+   if (fromBack) {
+      task = queue.tasks.back();
+      queue.tasks.pop_back();
+   } else {
+      task = queue.tasks.front();
+      queue.tasks.pop_front();
+   }
+   return true;
+}
+
+void WorkStealingPool::executeTasks(std::size_t thread)
+{
+   const std::size_t nQueues = _queues.size();
+   while (_remainingTasks.load() > 0) {
+      std::size_t task = 0;
+      // Own tasks are taken from the back (most recently readied, so its
+      // inputs are likely still in cache), stolen ones from the front.
+      bool found = (thread == 0 && tryPop(_mainThreadQueue, task, false)) || tryPop(*_queues[thread], task, true);
+      for (std::size_t i = 1; !found && i < nQueues; ++i) {
+         found = tryPop(*_queues[(thread + i) % nQueues], task, false);
+      }
+      if (!found) {
+         std::this_thread::yield();
+         continue;
+      }
+      _fn(task, thread);
+      --_remainingTasks;
+   }
+}
+
+void WorkStealingPool::workerLoop(std::size_t thread)
+{
+   std::size_t seenGeneration = 0;
+   while (true) {
+      {
+         std::unique_lock<std::mutex> lock{_wakeMutex};
+         _wakeCondition.wait(lock, [&] { return _stop || _generation != seenGeneration; });
+         if (_stop)
+            return;
+         seenGeneration = _generation;
+         ++_activeWorkers;
+      }
+
+      executeTasks(thread);
+
+      {
+         std::lock_guard<std::mutex> lock{_wakeMutex};
+         --_activeWorkers;
+      }
+      _idleCondition.notify_all();
+   }
+}
+
+} // namespace Detail
+} // namespace RooFit
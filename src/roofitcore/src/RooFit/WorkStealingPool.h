@@ -0,0 +1,80 @@
+/*
+ * Project: RooFit
+ *
+ * Copyright (c) 2024, CERN
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted according to the terms
+ * listed in LICENSE (http://roofit.sourceforge.net/license.txt)
+ */
+
+#ifndef RooFit_WorkStealingPool_h
+#define RooFit_WorkStealingPool_h
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace RooFit {
+namespace Detail {
+
+/// A small thread pool to execute a set of tasks with dependencies. Every
+/// thread has its own queue of ready tasks. A thread that runs out of work
+/// steals from the queues of the others. Tasks that become ready while
+/// executing a task go to the queue of the executing thread, such that chains
+/// of dependent tasks tend to stay on the same thread.
+///
+/// The thread calling run() participates as thread zero, and tasks can be
+/// pinned to it if they are not safe to execute concurrently.
+class WorkStealingPool {
+public:
+   /// Function that executes a task. It gets the task index and the index of
+   /// the executing thread, which is needed to push tasks that became ready.
+   using TaskFn = std::function<void(std::size_t task, std::size_t thread)>;
+
+   explicit WorkStealingPool(std::size_t nThreads);
+   ~WorkStealingPool();
+
+   WorkStealingPool(const WorkStealingPool &) = delete;
+   WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+   std::size_t nThreads() const { return _queues.size(); }
+
+   void run(std::size_t nTasks, std::function<void()> const &pushInitialTasks, TaskFn fn);
+   void push(std::size_t task, std::size_t thread, bool onMainThread);
+
+private:
+   struct TaskQueue {
+      std::mutex mutex;
+      std::deque<std::size_t> tasks;
+   };
+
+   bool tryPop(TaskQueue &queue, std::size_t &task, bool fromBack);
+   void executeTasks(std::size_t thread);
+   void workerLoop(std::size_t thread);
+
+   std::vector<std::unique_ptr<TaskQueue>> _queues;
+   TaskQueue _mainThreadQueue;
+   std::vector<std::thread> _threads;
+
+   TaskFn _fn;
+   std::atomic<std::size_t> _remainingTasks{0};
+
+   std::mutex _wakeMutex;
+   std::condition_variable _wakeCondition;
+   std::condition_variable _idleCondition;
+   std::size_t _generation = 0;
+   std::size_t _activeWorkers = 0;
+   bool _stop = false;
+};
+
+} // namespace Detail
+} // namespace RooFit
+
+#endif
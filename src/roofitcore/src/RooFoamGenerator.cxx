@@ -144,6 +144,9 @@ const RooArgSet *RooFoamGenerator::generateEvent(UInt_t /*remaining*/, double& /
   const RooArgSet *event= _cache->get();
   if(event->size() == 1) return event;
 
+  // The generator might have changed since the initialization, for example
+  // if a RooRandom::StreamScope is alive
+  _tfoam->SetPseRan(RooRandom::randomGenerator()) ;
   _tfoam->MakeEvent() ;
   _tfoam->GetMCvect(_vec.data()) ;
 
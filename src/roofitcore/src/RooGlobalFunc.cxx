@@ -585,8 +585,10 @@ EvalBackend::Value EvalBackend::toValue(std::string const &name)
       return Value::Codegen;
    if (lower == toName(Value::CodegenNoGrad))
       return Value::CodegenNoGrad;
+   if (lower == toName(Value::CpuFloat))
+      return Value::CpuFloat;
    throw std::runtime_error("Only supported string values for EvalBackend() are \"legacy\", \"cpu\", \"cuda\", "
-                            "\"codegen\", or \"codegen_no_grad\".");
+                            "\"codegen\", \"codegen_no_grad\", or \"cpu_float\".");
 }
 EvalBackend EvalBackend::Legacy()
 {
@@ -608,6 +610,10 @@ EvalBackend EvalBackend::CodegenNoGrad()
 {
    return EvalBackend(Value::CodegenNoGrad);
 }
+EvalBackend EvalBackend::CpuFloat()
+{
+   return EvalBackend(Value::CpuFloat);
+}
 std::string EvalBackend::name() const
 {
    return toName(value());
@@ -624,6 +630,8 @@ std::string EvalBackend::toName(EvalBackend::Value value)
       return "codegen";
    if (value == Value::CodegenNoGrad)
       return "codegen_no_grad";
+   if (value == Value::CpuFloat)
+      return "cpu_float";
    return "";
 }
 EvalBackend::Value &EvalBackend::defaultValue()
@@ -45,6 +45,7 @@ automatic PDF optimization.
 #include "RooArgSet.h"
 #include "RooCategory.h"
 #include "RooDataSet.h"
+#include "RooExpensiveObjectCache.h"
 #include "RooEvaluatorWrapper.h"
 #include "RooFit/TestStatistics/RooAbsL.h"
 #include "RooFit/TestStatistics/RooRealL.h"
@@ -369,6 +370,7 @@ int RooMinimizer::minimize(const char *type, const char *alg)
    profileStart();
    {
       auto ctx = makeEvalErrorContext();
+      RooExpensiveObjectCache::SuspendPersistentStorage suspendPersistentStorage;
 
       bool ret = fitFCN();
       determineStatus(ret);
@@ -400,6 +402,7 @@ int RooMinimizer::exec(std::string const &algoName, std::string const &statusNam
    profileStart();
    {
       auto ctx = makeEvalErrorContext();
+      RooExpensiveObjectCache::SuspendPersistentStorage suspendPersistentStorage;
 
       bool ret = false;
       if (algoName == "hesse") {
@@ -476,6 +479,7 @@ int RooMinimizer::minos(const RooArgSet &minosParamList)
       profileStart();
       {
          auto ctx = makeEvalErrorContext();
+         RooExpensiveObjectCache::SuspendPersistentStorage suspendPersistentStorage;
 
          // get list of parameters for Minos
          std::vector<unsigned int> paramInd;
@@ -695,6 +699,8 @@ RooPlot *RooMinimizer::contour(RooRealVar &var1, RooRealVar &var2, double n1, do
       return frame;
    }
 
+   RooExpensiveObjectCache::SuspendPersistentStorage suspendPersistentStorage;
+
    // remember our original value of ERRDEF
    double errdef = _minimizer->ErrorDef();
 
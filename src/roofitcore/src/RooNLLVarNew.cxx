@@ -366,9 +366,53 @@ void RooNLLVarNew::doEval(RooFit::EvalContext &ctx) const
       return doEvalBinnedL(ctx, ctx.at(&*_func), _weightSquared ? weightsSumW2 : weights);
    }
 
+   RooBatchCompute::ReduceNLLOutput nllOut;
+   accumulateNLL(ctx, nllOut);
+   finalizeNLL(ctx, nllOut);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reduce the unbinned NLL over the events in the current spans of the
+/// evaluation context and add the result to `nllOut`. With the block-wise
+/// evaluation in the RooFit::Evaluator, this is called for one block of
+/// events after the other, such that the full array of probabilities never
+/// needs to exist.
+void RooNLLVarNew::accumulateNLL(RooFit::EvalContext &ctx, RooBatchCompute::ReduceNLLOutput &nllOut) const
+{
    auto config = ctx.config(this);
 
-   auto probas = ctx.at(_func);
+   auto blockOut =
+      RooBatchCompute::reduceNLL(config, ctx.at(_func), ctx.at(_weightSquared ? _weightSquaredVar : _weightVar),
+                                 _doBinOffset ? ctx.at(*_offsetPdf) : std::span<const double>{});
+
+   nllOut.nInfiniteValues += blockOut.nInfiniteValues;
+   nllOut.nNonPositiveValues += blockOut.nNonPositiveValues;
+   nllOut.nNaNValues += blockOut.nNaNValues;
+
+   if (std::isnan(nllOut.nllSum) || std::isnan(blockOut.nllSum)) {
+      // Some events with evaluation errors. Accumulate the "badness" of errors.
+      const double badness = RooNaNPacker::unpackNaN(nllOut.nllSum) + RooNaNPacker::unpackNaN(blockOut.nllSum);
+      nllOut.nllSum = RooNaNPacker::packFloatIntoNaN(badness);
+      nllOut.nllSumCarry = 0.0;
+      return;
+   }
+
+   ROOT::Math::KahanSum<double> nllSum{nllOut.nllSum, nllOut.nllSumCarry};
+   nllSum += ROOT::Math::KahanSum<double>{blockOut.nllSum, blockOut.nllSumCarry};
+   nllOut.nllSum = nllSum.Sum();
+   nllOut.nllSumCarry = nllSum.Carry();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Report the evaluation errors, add the extended term, and set the output
+/// from the accumulated unbinned NLL. The weights in the evaluation context
+/// need to be the full arrays again at this point.
+void RooNLLVarNew::finalizeNLL(RooFit::EvalContext &ctx, RooBatchCompute::ReduceNLLOutput const &nllOut) const
+{
+   auto config = ctx.config(this);
+
+   std::span<const double> weights = ctx.at(_weightVar);
+   std::span<const double> weightsSumW2 = ctx.at(_weightSquaredVar);
 
    double sumWeight = RooBatchCompute::reduceSum(config, weights.data(), weights.size());
    double sumWeight2 = 0.;
@@ -376,9 +420,6 @@ void RooNLLVarNew::doEval(RooFit::EvalContext &ctx) const
       sumWeight2 = RooBatchCompute::reduceSum(config, weightsSumW2.data(), weightsSumW2.size());
    }
 
-   auto nllOut = RooBatchCompute::reduceNLL(config, probas, _weightSquared ? weightsSumW2 : weights,
-                                            _doBinOffset ? ctx.at(*_offsetPdf) : std::span<const double>{});
-
    if (nllOut.nInfiniteValues > 0) {
       oocoutW(&*_func, Eval) << "RooAbsPdf::getLogVal(" << _func->GetName()
                              << ") WARNING: top-level pdf has some infinite values" << std::endl;
@@ -390,14 +431,16 @@ void RooNLLVarNew::doEval(RooFit::EvalContext &ctx) const
       _func->logEvalError("getLogVal() top-level p.d.f evaluates to NaN");
    }
 
+   double nllSum = nllOut.nllSum;
+
    if (_expectedEvents) {
       // The unbinned NLL path is only reached for pdf inputs, so the cast is safe.
       auto &pdf = static_cast<RooAbsPdf &>(const_cast<RooAbsReal &>(*_func));
       std::span<const double> expected = ctx.at(*_expectedEvents);
-      nllOut.nllSum += pdf.extendedTerm(sumWeight, expected[0], _weightSquared ? sumWeight2 : 0.0, _doBinOffset);
+      nllSum += pdf.extendedTerm(sumWeight, expected[0], _weightSquared ? sumWeight2 : 0.0, _doBinOffset);
    }
 
-   finalizeResult(ctx, {nllOut.nllSum, nllOut.nllSumCarry}, sumWeight);
+   finalizeResult(ctx, {nllSum, nllOut.nllSumCarry}, sumWeight);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
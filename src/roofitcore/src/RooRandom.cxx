@@ -21,6 +21,27 @@
 
 This class provides a static interface for generating random numbers.
 By default a private copy of TRandom3 is used to generate all random numbers.
+
+### Random number streams for parallel toy studies
+The state of the default generator depends on everything that was generated
+before, so the toys of a study depend on the order in which they are
+generated. For toy studies that are run in parallel, RooRandom::stream()
+returns a counter-based generator (Philox4x32-10) that is uniquely defined
+by a toy index, a purpose and a seed. The numbers of different streams are
+statistically independent, and creating a stream is cheap.
+
+While a RooRandom::StreamScope is alive, randomGenerator() returns such a
+stream in the current thread. Everything in RooFit that generates random
+numbers through RooRandom, for example RooAbsPdf::generate() and the
+generator contexts and samplers it uses, then produces the same result for a
+given toy index, no matter in which thread or process the toy is generated:
+```{.cpp}
+for (std::size_t iToy = 0; iToy < nToys; ++iToy) {
+   RooRandom::StreamScope toyStream{iToy};
+   std::unique_ptr<RooDataSet> data{pdf.generate(x, 1000)};
+   // ...
+}
+```
 **/
 #include <cassert>
 
@@ -29,10 +50,124 @@ By default a private copy of TRandom3 is used to generate all random numbers.
 
 #include "TRandom3.h"
 
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+/// Counter-based random number generator implementing Philox4x32-10 from
+/// J. K. Salmon et al., "Parallel random numbers: as easy as 1, 2, 3",
+/// SC '11. The 128 bit counter is composed of the stream index and the
+/// number of generated blocks, and the 64 bit key is derived from the seed
+/// and the purpose of the stream.
+class PhiloxStream : public TRandom {
+public:
+   PhiloxStream(ULong64_t index, UInt_t purpose, ULong64_t seed) : _index{index}, _purpose{purpose} { setKey(seed); }
+
+   using TRandom::Rndm;
+   Double_t Rndm() override { return toDouble(next64()); }
+
+   void RndmArray(Int_t n, Float_t *array) override
+   {
+      for (Int_t i = 0; i < n; ++i) {
+         // use 24 bits, such that the result can't be rounded up to one
+         array[i] = static_cast<Float_t>(((nextWord() >> 8) + 0.5) * (1.0 / 16777216.0));
+      }
+   }
+
+   void RndmArray(Int_t n, Double_t *array) override
+   {
+      for (Int_t i = 0; i < n; ++i) {
+         array[i] = toDouble(next64());
+      }
+   }
+
+   /// Restart the stream with a different seed for the same index and purpose.
+   void SetSeed(ULong_t seed = 0) override { setKey(seed); }
+
+private:
+   static ULong64_t splitMix64(ULong64_t x)
+   {
+      x += 0x9E3779B97F4A7C15ULL;
+      x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+      return x ^ (x >> 31);
+   }
+
+   // Uniform number in (0,1) with 53 bits of precision
+   static Double_t toDouble(ULong64_t x) { return ((x >> 11) + 0.5) * (1.0 / 9007199254740992.0); }
+
+   void setKey(ULong64_t seed)
+   {
+      fSeed = static_cast<UInt_t>(seed);
+      const ULong64_t key = splitMix64(seed ^ splitMix64(_purpose));
+      _key[0] = static_cast<UInt_t>(key);
+      _key[1] = static_cast<UInt_t>(key >> 32);
+      _block = 0;
+      _iWord = 4;
+   }
+
+   ULong64_t next64()
+   {
+      const ULong64_t hi = nextWord();
+      return (hi << 32) | nextWord();
+   }
+
+   UInt_t nextWord()
+   {
+      if (_iWord == 4) {
+         generateBlock();
+         _iWord = 0;
+      }
+      return _words[_iWord++];
+   }
+
+   void generateBlock()
+   {
+      UInt_t ctr[4] = {static_cast<UInt_t>(_block), static_cast<UInt_t>(_block >> 32), static_cast<UInt_t>(_index),
+                       static_cast<UInt_t>(_index >> 32)};
+      UInt_t key[2] = {_key[0], _key[1]};
+      for (int round = 0; round < 10; ++round) {
+         const ULong64_t prod0 = 0xD2511F53ULL * ctr[0];
+         const ULong64_t prod1 = 0xCD9E8D57ULL * ctr[2];
+         const UInt_t hi0 = static_cast<UInt_t>(prod0 >> 32);
+         const UInt_t lo0 = static_cast<UInt_t>(prod0);
+         const UInt_t hi1 = static_cast<UInt_t>(prod1 >> 32);
+         const UInt_t lo1 = static_cast<UInt_t>(prod1);
+         ctr[0] = hi1 ^ ctr[1] ^ key[0];
+         ctr[1] = lo1;
+         ctr[2] = hi0 ^ ctr[3] ^ key[1];
+         ctr[3] = lo0;
+         key[0] += 0x9E3779B9U;
+         key[1] += 0xBB67AE85U;
+      }
+      std::copy(ctr, ctr + 4, _words);
+      ++_block;
+   }
+
+   ULong64_t _index = 0;
+   UInt_t _purpose = 0;
+   UInt_t _key[2] = {0, 0};
+   ULong64_t _block = 0;
+   UInt_t _words[4] = {0, 0, 0, 0};
+   int _iWord = 4;
+};
+
+thread_local TRandom *currentStream = nullptr;
+thread_local ULong64_t currentStreamIdValue = 0;
+
+std::atomic<ULong64_t> &nStreamScopes()
+{
+   static std::atomic<ULong64_t> counter{0};
+   return counter;
+}
+
+} // namespace
 
 
 TRandom* RooRandom::_theGenerator = nullptr;
 RooQuasiRandomGenerator* RooRandom::_theQuasiGenerator = nullptr;
+ULong64_t RooRandom::_streamSeed = 0;
 RooRandom::Guard RooRandom::guard;
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -43,9 +178,12 @@ RooRandom::Guard::~Guard()
 ////////////////////////////////////////////////////////////////////////////////
 /// Return a pointer to a singleton random-number generator
 /// implementation. Creates the object the first time it is called.
+/// If a StreamScope is alive in the current thread, its stream is returned
+/// instead.
 
 TRandom *RooRandom::randomGenerator()
 {
+  if (currentStream) return currentStream;
   if (!_theGenerator) _theGenerator= new TRandom3();
   return _theGenerator;
 }
@@ -60,6 +198,66 @@ void RooRandom::setRandomGenerator(TRandom* gen)
   _theGenerator = gen;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Set the default seed for the streams returned by stream(). Toy studies
+/// that use streams give different toys for different seeds.
+
+void RooRandom::setStreamSeed(ULong64_t seed)
+{
+  _streamSeed = seed;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the default seed for the streams returned by stream().
+
+ULong64_t RooRandom::streamSeed()
+{
+  return _streamSeed;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return a new counter-based random number generator for the toy with the
+/// given index. The sequence of numbers only depends on the arguments, so a
+/// toy can be generated reproducibly in any thread or process.
+/// \param[in] index The index of the toy.
+/// \param[in] purpose Different purposes give independent streams for the
+///            same toy, for example to generate the global observables
+///            independently of the observables.
+/// \param[in] seed The seed, by default the one set with setStreamSeed().
+
+std::unique_ptr<TRandom> RooRandom::stream(ULong64_t index, UInt_t purpose, ULong64_t seed)
+{
+  return std::make_unique<PhiloxStream>(index, purpose, seed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return an identifier of the StreamScope that is alive in the current
+/// thread, or zero if randomGenerator() returns the global generator. Every
+/// StreamScope gets a different identifier, which can be used to detect that
+/// state that was built with random numbers from another stream is stale.
+
+ULong64_t RooRandom::currentStreamId()
+{
+  return currentStreamIdValue;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Make randomGenerator() return stream(index, purpose, seed) in the current
+/// thread until the scope is destroyed. Scopes can be nested.
+
+RooRandom::StreamScope::StreamScope(ULong64_t index, UInt_t purpose, ULong64_t seed)
+   : _stream{stream(index, purpose, seed)}, _previousStream{currentStream}, _previousStreamId{currentStreamIdValue}
+{
+  currentStream = _stream.get();
+  currentStreamIdValue = ++nStreamScopes();
+}
+
+RooRandom::StreamScope::~StreamScope()
+{
+  currentStream = _previousStream;
+  currentStreamIdValue = _previousStreamId;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Return a pointer to a singleton quasi-random generator
 /// implementation. Creates the object the first time it is called.
@@ -792,7 +792,24 @@ double RooRealIntegral::getValV(const RooArgSet* nset) const
   }
 
   if (isValueOrShapeDirtyAndClear()) {
-    _value = traceEval(nset) ;
+
+    if (_cacheNum && !_intList.empty() && RooExpensiveObjectCache::persistentStorageActive()) {
+      // Numeric integrals can be shared between processes with the persistent
+      // expensive object cache. The structural part of the key is only
+      // computed once, because it requires a walk over the whole graph.
+      if (_eocOwnerKey.empty()) {
+        _eocOwnerKey = RooExpensiveObjectCache::ownerKey(*this, parameters()) ;
+      }
+      auto cacheVal = static_cast<RooDouble const*>(expensiveObjectCache().retrieveObject(GetName(),RooDouble::Class(),parameters(),_eocOwnerKey)) ;
+      if (cacheVal) {
+        _value = *cacheVal ;
+      } else {
+        _value = traceEval(nset) ;
+        expensiveObjectCache().registerObject(_function->GetName(),GetName(),*new RooDouble(_value),parameters(),_eocOwnerKey) ;
+      }
+    } else {
+      _value = traceEval(nset) ;
+    }
   }
 
   return _value ;
@@ -991,6 +1008,7 @@ bool RooRealIntegral::redirectServersHook(const RooAbsCollection& newServerList,
 
   // Delete parameters cache if we have one
   _params.reset();
+  _eocOwnerKey.clear();
 
   return RooAbsReal::redirectServersHook(newServerList, mustReplaceAll, nameChange, isRecursive);
 }
@@ -40,14 +40,69 @@ which returns spans pointing directly to the data.
 #include "RooCategory.h"
 #include "RooHistError.h"
 #include "RooFitImplHelpers.h"
+#include "RooNumber.h"
+#include "RooFit/Evaluator.h"
+#include "RooFit/Detail/NormalizationHelpers.h"
 
 #include "Math/Util.h"
 #include "ROOT/StringUtils.hxx"
+#include "TBranch.h"
 #include "TBuffer.h"
+#include "TLeaf.h"
+#include "TTree.h"
 
 #include <iomanip>
+#include <stdexcept>
+#include <unordered_map>
 using std::string, std::vector, std::list;
 
+namespace {
+
+// Number of TTree entries that are read from each branch before the values
+// are checked and appended to the data store in loadValuesFromTree().
+constexpr Long64_t treeImportChunkSize = 65536;
+
+template <class T>
+void readBranchValues(TBranch &branch, Long64_t first, Long64_t n, double *out)
+{
+  T value{};
+  branch.SetAddress(&value);
+  for (Long64_t i = 0; i < n; ++i) {
+    branch.GetEntry(first + i);
+    out[i] = static_cast<double>(value);
+  }
+  branch.ResetAddress();
+}
+
+using BranchReader = void (*)(TBranch &, Long64_t, Long64_t, double *);
+
+// Returns the function to read the values of a plain branch with a single
+// scalar leaf, or nullptr for any other kind of branch.
+BranchReader branchReader(TBranch &branch)
+{
+  if (branch.IsA() != TBranch::Class() || branch.GetListOfLeaves()->GetEntries() != 1) {
+    return nullptr;
+  }
+  auto leaf = static_cast<TLeaf *>(branch.GetListOfLeaves()->At(0));
+  Int_t dummy;
+  if (leaf->GetLeafCounter(dummy) || leaf->GetLenStatic() != 1) {
+    return nullptr;
+  }
+
+  static const std::unordered_map<std::string, BranchReader> readers{
+    {"Double_t", &readBranchValues<Double_t>},   {"Float_t", &readBranchValues<Float_t>},
+    {"Int_t", &readBranchValues<Int_t>},         {"UInt_t", &readBranchValues<UInt_t>},
+    {"Long64_t", &readBranchValues<Long64_t>},   {"ULong64_t", &readBranchValues<ULong64_t>},
+    {"Short_t", &readBranchValues<Short_t>},     {"UShort_t", &readBranchValues<UShort_t>},
+    {"Char_t", &readBranchValues<Char_t>},       {"UChar_t", &readBranchValues<UChar_t>},
+    {"Bool_t", &readBranchValues<Bool_t>}};
+
+  auto found = readers.find(leaf->GetTypeName());
+  return found != readers.end() ? found->second : nullptr;
+}
+
+} // namespace
+
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -576,6 +631,231 @@ void RooVectorDataStore::loadValues(const RooAbsDataStore *ads, const RooFormula
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Load the entries of the TTree `t` that pass the optional selection `select`
+/// into this data store, reading the tree column by column. The values of
+/// each branch are read for a block of entries at a time, such that the
+/// baskets are decompressed one after the other. The range checks and the
+/// selection are then done for the whole block, where the selection is
+/// evaluated with the RooFit::Evaluator, and the accepted values are appended
+/// directly to the data columns.
+///
+/// The events that are out of range are skipped with the same messages as in
+/// RooTreeDataStore::loadValues(const TTree*, const RooFormulaVar*, const char*, Int_t, Int_t).
+///
+/// Only data stores with real-valued columns without errors are supported,
+/// which have to be read from branches with a single scalar leaf of a
+/// fundamental type. Trees with friends or entry lists are not supported
+/// either. In these cases, the data store is left unchanged and `false` is
+/// returned, such that the caller can fall back to importing the tree event by
+/// event via a RooTreeDataStore.
+
+bool RooVectorDataStore::loadValuesFromTree(const TTree &t, const RooFormulaVar *select)
+{
+  if (!_realfStoreList.empty() || !_catStoreList.empty() || _realStoreList.size() != _varsww.size()) {
+    return false;
+  }
+
+  struct Column {
+    RealVector *realVec = nullptr;
+    RooAbsRealLValue *var = nullptr;
+    double min = 0.0;
+    double max = 0.0;
+    bool checkMin = true;
+    bool checkMax = true;
+    std::vector<double> values;
+  };
+
+  // The columns are ordered like the variables, such that the first variable
+  // that is out of range is reported like in the RooTreeDataStore.
+  std::vector<Column> columns;
+  Column *weightColumn = nullptr;
+  for (RooAbsArg *arg : _varsww) {
+    auto var = dynamic_cast<RooAbsRealLValue *>(arg);
+    if (!var || var->cleanBranchName() != var->GetName()) {
+      return false;
+    }
+    auto found = std::find_if(_realStoreList.begin(), _realStoreList.end(),
+                              [&](RealVector *realVec) { return realVec->_nativeReal == var; });
+    if (found == _realStoreList.end()) {
+      return false;
+    }
+    Column &column = columns.emplace_back();
+    column.realVec = *found;
+    column.var = var;
+    column.min = var->getMin();
+    column.max = var->getMax();
+    column.checkMin = !RooNumber::isInfinite(column.min);
+    column.checkMax = !RooNumber::isInfinite(column.max);
+  }
+  for (Column &column : columns) {
+    if (column.var == _wgtVar) {
+      weightColumn = &column;
+    }
+  }
+
+  // Make our local copy of the tree, so we can safely loop through it, like
+  // in RooTreeDataStore::loadValues().
+  auto deleter = [](TTree* tree){tree->SetDirectory(nullptr); delete tree;};
+  std::unique_ptr<TTree, decltype(deleter)> tClone(static_cast<TTree*>(t.Clone()), deleter);
+  tClone->SetDirectory(t.GetDirectory());
+
+  if (tClone->GetEntryList() || (tClone->GetListOfFriends() && tClone->GetListOfFriends()->GetSize() > 0)) {
+    return false;
+  }
+  for (Column const &column : columns) {
+    if (!tClone->GetBranch(column.var->GetName())) {
+      return false;
+    }
+  }
+
+  std::unique_ptr<RooAbsReal> selectFunc;
+  std::unique_ptr<RooFit::Evaluator> evaluator;
+  if (select) {
+    try {
+      // Compiling for an empty normalization set results in the plain values
+      // of the selection formula, like select->getVal().
+      selectFunc = RooFit::Detail::compileForNormSet<RooAbsReal>(*select, RooArgSet{});
+      evaluator = std::make_unique<RooFit::Evaluator>(*selectFunc);
+    } catch (std::exception const &error) {
+      cxcoutD(DataHandling) << "RooVectorDataStore::loadValuesFromTree(" << GetName()
+                            << ") importing the tree event by event, because the selection can't be "
+                            << "evaluated in batches: " << error.what() << std::endl;
+      return false;
+    }
+  }
+
+  // Remember the current state, to restore it if a tree in a chain turns out
+  // to be unsupported after some entries were already loaded.
+  const std::size_t sizeBefore = size();
+  const double sumWeightBefore = _sumWeight;
+  const double sumWeightCarryBefore = _sumWeightCarry;
+  auto rollback = [&]() {
+    for (Column &column : columns) {
+      column.realVec->_vec.resize(sizeBefore);
+    }
+    _sumWeight = sumWeightBefore;
+    _sumWeightCarry = sumWeightCarryBefore;
+    return false;
+  };
+
+  const Long64_t nEntries = tClone->GetEntries();
+  if (nEntries > 0 && sizeBefore + nEntries < static_cast<std::size_t>(std::numeric_limits<Int_t>::max())) {
+    reserve(sizeBefore + nEntries);
+  }
+
+  std::vector<char> accepted;
+  Int_t numInvalid = 0;
+
+  // Loop over the trees, which is a single iteration unless we read a TChain
+  Long64_t entry = 0;
+  Long64_t localEntry = 0;
+  while ((localEntry = tClone->LoadTree(entry)) >= 0) {
+    TTree *tree = tClone->GetTree();
+    const Long64_t treeEntries = tree->GetEntries();
+
+    std::vector<std::pair<TBranch *, BranchReader>> readers;
+    for (Column const &column : columns) {
+      TBranch *branch = tree->GetBranch(column.var->GetName());
+      BranchReader reader = branch ? branchReader(*branch) : nullptr;
+      if (!reader) {
+        return rollback();
+      }
+      readers.emplace_back(branch, reader);
+    }
+
+    for (Long64_t first = localEntry; first < treeEntries; first += treeImportChunkSize) {
+      const std::size_t n = std::min(treeImportChunkSize, treeEntries - first);
+      accepted.assign(n, 1);
+
+      for (std::size_t j = 0; j < columns.size(); ++j) {
+        Column &column = columns[j];
+        column.values.resize(n);
+        readers[j].second(*readers[j].first, first, n, column.values.data());
+
+        // Same logic as RooAbsRealLValue::inRange(), such that NaN values are
+        // accepted as well.
+        const double *values = column.values.data();
+        for (std::size_t i = 0; i < n; ++i) {
+          const bool aboveMax = column.checkMax && values[i] > column.max;
+          const bool belowMin = column.checkMin && values[i] < column.min;
+          accepted[i] &= !(aboveMax || belowMin);
+        }
+      }
+
+      std::size_t nValid = 0;
+      for (std::size_t i = 0; i < n; ++i) {
+        if (accepted[i]) {
+          ++nValid;
+          continue;
+        }
+        ++numInvalid;
+        if (numInvalid < 5) {
+          auto badColumn = std::find_if(columns.begin(), columns.end(), [&](Column const &column) {
+            return !column.var->inRange(column.values[i], nullptr);
+          });
+          coutI(DataHandling) << "RooVectorDataStore::loadValuesFromTree(" << GetName() << ") Skipping event #"
+                              << entry + (first - localEntry) + i << " because " << badColumn->var->GetName()
+                              << " cannot accommodate the value " << badColumn->values[i] << std::endl;
+        } else if (numInvalid == 5) {
+          coutI(DataHandling) << "RooVectorDataStore::loadValuesFromTree(" << GetName() << ") Skipping ..."
+                              << std::endl;
+        }
+      }
+
+      // Remove the events that are out of range before evaluating the selection.
+      if (nValid < n) {
+        for (Column &column : columns) {
+          std::size_t k = 0;
+          for (std::size_t i = 0; i < n; ++i) {
+            if (accepted[i]) column.values[k++] = column.values[i];
+          }
+          column.values.resize(nValid);
+        }
+      }
+      if (nValid == 0) continue;
+
+      accepted.assign(nValid, 1);
+      if (evaluator) {
+        for (Column const &column : columns) {
+          evaluator->setInput(column.var->GetName(), {column.values.data(), nValid}, false);
+        }
+        std::span<const double> selection = evaluator->run();
+        // The output is a scalar if the selection doesn't depend on the data.
+        for (std::size_t i = 0; i < nValid; ++i) {
+          accepted[i] = selection[selection.size() == 1 ? 0 : i] != 0;
+        }
+      }
+
+      for (Column &column : columns) {
+        std::vector<double> &vec = column.realVec->_vec;
+        for (std::size_t i = 0; i < nValid; ++i) {
+          if (accepted[i]) vec.push_back(column.values[i]);
+        }
+      }
+
+      // use Kahan's algorithm to sum up weights to avoid loss of precision
+      for (std::size_t i = 0; i < nValid; ++i) {
+        if (!accepted[i]) continue;
+        double y = (weightColumn ? weightColumn->values[i] : 1.) - _sumWeightCarry;
+        double tmp = _sumWeight + y;
+        _sumWeightCarry = (tmp - _sumWeight) - y;
+        _sumWeight = tmp;
+      }
+    }
+
+    entry += treeEntries - localEntry;
+  }
+
+  if (numInvalid>0) {
+    coutW(DataHandling) << "RooVectorDataStore::loadValuesFromTree(" << GetName() << ") Ignored " << numInvalid << " out-of-range events" << std::endl ;
+  }
+
+  return true;
+}
+
+
+
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -61,6 +61,7 @@ RooUnbinnedL::RooUnbinnedL(RooAbsPdf *pdf, RooAbsData *data, RooAbsL::Extended e
 
    if (evalBackend.value() != RooFit::EvalBackend::Value::Legacy) {
       evaluator_ = std::make_unique<RooFit::Evaluator>(*pdf_, evalBackend.value() == RooFit::EvalBackend::Value::Cuda);
+      evaluator_->setUseSinglePrecision(evalBackend.value() == RooFit::EvalBackend::Value::CpuFloat);
       std::stack<std::vector<double>>{}.swap(_vectorBuffers);
       auto dataSpans =
          RooFit::BatchModeDataHelpers::getDataSpans(*data, "", nullptr, /*skipZeroWeights=*/true,
@@ -158,6 +158,32 @@ TEST_F(LikelihoodJobTest, UnbinnedGaussian1DSelectedParameterValues)
 // This test was disabled because it was occasionally timing out on the CI.
 // Evaluating the same likelihood twice should not be a problem anymore, and if
 // it would be it would also manifest in other tests.
+#ifdef __linux__
+TEST_F(LikelihoodJobTest, UnbinnedGaussian1DSharedMemoryTransport)
+{
+   // The whole JobManager runs over the shared memory channels instead of
+   // ZeroMQ sockets, including the parameter updates for the second evaluation.
+   ASSERT_TRUE(RFMP::Config::Messenger::setTransport(RFMP::Config::Messenger::Transport::SharedMemory));
+
+   std::tie(nll, pdf, data, values) = generate_1D_gaussian_pdf_nll(w, 10000);
+   likelihood = RFTS::buildLikelihood(pdf, data.get());
+   // dummy offsets (normally they are shared with other objects):
+   SharedOffset offset;
+   auto nll_ts = RFTS::LikelihoodWrapper::create(RFTS::LikelihoodMode::multiprocess, likelihood, clean_flags, offset);
+
+   nll_ts->evaluate();
+   EXPECT_EQ(nll->getVal(), nll_ts->getResult().Sum());
+
+   w.var("mu")->setVal(1.5);
+   nll_ts->evaluate();
+   EXPECT_DOUBLE_EQ(nll->getVal(), nll_ts->getResult().Sum());
+
+   // the JobManager has to be gone to switch back to the default transport
+   nll_ts.reset();
+   EXPECT_TRUE(RFMP::Config::Messenger::setTransport(RFMP::Config::Messenger::Transport::ZeroMQ));
+}
+#endif // __linux__
+
 TEST_F(LikelihoodJobTest, DISABLED_UnbinnedGaussian1DTwice)
 {
    std::tie(nll, pdf, data, values) = generate_1D_gaussian_pdf_nll(w, 10000);
@@ -146,6 +146,77 @@ TEST(RooAbsDataHelper, RooDataHistWeighted)
    EXPECT_NEAR(rooDataHist->moment(y, 2.), 0.25, 1.E-2); // Variance is affected in a binned distribution
 }
 
+/// The bin weights are filled per slot and merged at the end, so this test
+/// verifies that the merged bin contents and squared weights are the same as
+/// when filling the RooDataHist event by event.
+TEST(RooAbsDataHelper, RooDataHistBinContents)
+{
+   auto dd = makeDataFrame();
+   RooArgSet vars = makeVariablesSet();
+
+   RooDataHist reference{"reference", "reference", vars};
+   RooDataHist referenceWeighted{"referenceWeighted", "referenceWeighted", vars};
+   for (std::size_t entry = 0; entry < nEvent; ++entry) {
+      vars.setRealValue("x", -5. + 10. * ((double)entry) / nEvent);
+      vars.setRealValue("y", 0. + 2. * ((double)entry) / nEvent);
+      reference.add(vars);
+      referenceWeighted.add(vars, 0.5);
+   }
+
+   auto rooDataHist = dd.Book<double, double>(RooDataHistHelper{"datahist", "datahist", vars}, {"x", "y"});
+   auto rooDataHistWeighted =
+      dd.Book<double, double, double>(RooDataHistHelper{"datahistWeighted", "datahistWeighted", vars}, {"x", "y", "w"});
+
+   // Without weights, the squared weights are not tracked separately
+   EXPECT_EQ(rooDataHist->sumW2Array(), nullptr);
+
+   for (int i = 0; i < reference.numEntries(); ++i) {
+      EXPECT_DOUBLE_EQ(rooDataHist->weight(i), reference.weight(i)) << "bin " << i;
+      EXPECT_NEAR(rooDataHistWeighted->weight(i), referenceWeighted.weight(i), 1.E-9) << "bin " << i;
+      EXPECT_NEAR(rooDataHistWeighted->weightSquared(i), referenceWeighted.weightSquared(i), 1.E-9) << "bin " << i;
+   }
+}
+
+/// Fill a RooDataHist with varying weights from several threads, such that
+/// every slot fills its own bin weights that are merged at the end. The merged
+/// weights and squared weights have to agree with the event-by-event filling,
+/// and the merging must not create asymmetric errors.
+TEST(RooAbsDataHelper, RooDataHistImplicitMT)
+{
+#ifdef R__USE_IMT
+   ROOT::EnableImplicitMT(4);
+#endif
+
+   auto weightOfEntry = [](ULong64_t entry) { return 0.1 + 0.3 * (entry % 7); };
+
+   ROOT::RDataFrame dd{nEvent};
+   auto ddWithCols = dd.Define("x", [](ULong64_t entry) { return -5. + 10. * ((double)entry) / nEvent; }, {"rdfentry_"})
+                        .Define("y", [](ULong64_t entry) { return 0. + 2. * ((double)entry) / nEvent; }, {"rdfentry_"})
+                        .Define("w", weightOfEntry, {"rdfentry_"});
+
+   RooArgSet vars = makeVariablesSet();
+   RooDataHist reference{"reference", "reference", vars};
+   for (std::size_t entry = 0; entry < nEvent; ++entry) {
+      vars.setRealValue("x", -5. + 10. * ((double)entry) / nEvent);
+      vars.setRealValue("y", 0. + 2. * ((double)entry) / nEvent);
+      reference.add(vars, weightOfEntry(entry));
+   }
+
+   auto rooDataHist =
+      ddWithCols.Book<double, double, double>(RooDataHistHelper{"datahist", "datahist", vars}, {"x", "y", "w"});
+
+   ASSERT_NE(rooDataHist->sumW2Array(), nullptr);
+   EXPECT_EQ(rooDataHist->wgtErrLoArray(), nullptr);
+   EXPECT_EQ(rooDataHist->wgtErrHiArray(), nullptr);
+
+   for (int i = 0; i < reference.numEntries(); ++i) {
+      EXPECT_NEAR(rooDataHist->weight(i), reference.weight(i), 1.E-9 * reference.weight(i)) << "bin " << i;
+      EXPECT_NEAR(rooDataHist->weightSquared(i), reference.weightSquared(i), 1.E-9 * reference.weightSquared(i))
+         << "bin " << i;
+   }
+   EXPECT_NEAR(rooDataHist->sumEntries(), reference.sumEntries(), 1.E-9 * reference.sumEntries());
+}
+
 /// This test verifies that out-of-range events are correctly skipped,
 /// consistent with the construction of a RooDataSet from a TTree.
 TEST(RooAbsDataHelper, SkipEventsOutOfRange)
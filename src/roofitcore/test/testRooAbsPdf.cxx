@@ -13,6 +13,7 @@
 #include <RooGaussian.h>
 #include <RooGenericPdf.h>
 #include <RooHelpers.h>
+#include <RooNumGenConfig.h>
 #include <RooParametricStepFunction.h>
 #include <RooProdPdf.h>
 #include <RooProduct.h>
@@ -520,6 +521,59 @@ TEST(RooAbsPdf, NormSetChange)
    EXPECT_NE(v1, v2);
 }
 
+// Verifies that the accept-reject generation, which evaluates the pdf for
+// batches of trial events, samples the right distribution.
+TEST(RooAbsPdf, AcceptRejectGeneration)
+{
+   RooRandom::randomGenerator()->SetSeed(1337ul);
+
+   RooRealVar x("x", "x", 0.0, 0.0, 1.0);
+   RooRealVar y("y", "y", 0.0, 0.0, 1.0);
+   // The RooGenericPdf has no internal generator, so accept-reject sampling is used
+   RooGenericPdf pdf("pdf", "x * x + y", {x, y});
+
+   const int nEvents = 20000;
+   std::unique_ptr<RooDataSet> data{pdf.generate({x, y}, nEvents)};
+   ASSERT_EQ(data->numEntries(), nEvents);
+
+   // The expected mean is 3/5 for both variables
+   EXPECT_NEAR(data->mean(x), 0.6, 0.01);
+   EXPECT_NEAR(data->mean(y), 0.6, 0.01);
+}
+
+// Check that evaluating the accept-reject trial events in batches with the
+// RooFit::Evaluator gives the same dataset as evaluating them one by one.
+TEST(RooAbsPdf, AcceptRejectBatchedMatchesScalar)
+{
+   RooHelpers::LocalChangeMsgLevel changeMsgLvl(RooFit::ERROR);
+
+   RooRealVar x("x", "x", 0.0, 0.0, 1.0);
+   RooRealVar y("y", "y", 0.0, 0.0, 1.0);
+   RooGenericPdf pdf("pdf", "x * x + y", {x, y});
+
+   auto generate = [&](double batchSize) {
+      RooNumGenConfig config{*RooAbsPdf::defaultGeneratorConfig()};
+      config.getConfigSection("RooAcceptReject").setRealValue("batchSize", batchSize);
+      pdf.setGeneratorConfig(config);
+      RooRandom::randomGenerator()->SetSeed(1337ul);
+      return std::unique_ptr<RooDataSet>{pdf.generate({x, y}, 5000)};
+   };
+
+   std::unique_ptr<RooDataSet> scalarData = generate(1);
+   std::unique_ptr<RooDataSet> batchedData = generate(4096);
+   pdf.setGeneratorConfig();
+
+   ASSERT_EQ(batchedData->numEntries(), scalarData->numEntries());
+   for (int i = 0; i < scalarData->numEntries(); ++i) {
+      const RooArgSet &scalarEvent = *scalarData->get(i);
+      const double scalarX = scalarEvent.getRealValue("x");
+      const double scalarY = scalarEvent.getRealValue("y");
+      const RooArgSet &batchedEvent = *batchedData->get(i);
+      EXPECT_EQ(batchedEvent.getRealValue("x"), scalarX) << "event " << i;
+      EXPECT_EQ(batchedEvent.getRealValue("y"), scalarY) << "event " << i;
+   }
+}
+
 INSTANTIATE_TEST_SUITE_P(RooAbsPdf, FitTest, testing::Values(ROOFIT_EVAL_BACKENDS),
                          [](testing::TestParamInfo<FitTest::ParamType> const &paramInfo) {
                             std::stringstream ss;
@@ -3,12 +3,15 @@
 //          Jonas Rembser, CERN 09/2022
 
 #include <RooAbsPdf.h>
+#include <RooAddition.h>
 #include <RooAddPdf.h>
 #include <RooBinning.h>
 #include <RooDataSet.h>
 #include <RooFitResult.h>
+#include <RooFormulaVar.h>
 #include <RooGlobalFunc.h>
 #include <RooHelpers.h>
+#include <RooRealProxy.h>
 #include <RooRealVar.h>
 #include <RooUniform.h>
 #include <RooWorkspace.h>
@@ -19,7 +22,9 @@
 
 #include <gtest/gtest.h>
 
+#include <cmath>
 #include <memory>
+#include <string>
 
 // ROOT-6882: Cannot read from ULong64_t branches.
 TEST(RooAbsReal, ReadFromTree)
@@ -130,3 +135,90 @@ TEST(RooAbsReal, YieldsHistogram)
    EXPECT_FLOAT_EQ(c1 * x.getBinWidth(1), c2 * x.getBinWidth(0)) << "relative yield is wrong";
    EXPECT_FLOAT_EQ(c1 + c2, totalYield) << "total yield is wrong";
 }
+
+// Check that the value dirty propagation through a diamond-shaped graph, where
+// every layer depends on all nodes of the previous layer, still invalidates
+// all nodes when every node is only visited once, both with and without
+// stopping the propagation at clients that are already dirty.
+TEST(RooAbsReal, DirtyPropagationDiamondGraph)
+{
+   RooRealVar a{"a", "a", 1.0, -10, 10};
+   RooRealVar b{"b", "b", 2.0, -10, 10};
+
+   constexpr int nLayers = 12;
+   constexpr int nNodes = 3;
+   RooArgList owned;
+   RooArgList layer{a, b};
+   for (int iLayer = 0; iLayer < nLayers; ++iLayer) {
+      RooArgList nextLayer;
+      for (int iNode = 0; iNode < nNodes; ++iNode) {
+         std::string name = "n_" + std::to_string(iLayer) + "_" + std::to_string(iNode);
+         auto node = std::make_unique<RooAddition>(name.c_str(), name.c_str(), layer);
+         nextLayer.add(*node);
+         owned.addOwned(std::move(node));
+      }
+      layer.removeAll();
+      layer.add(nextLayer);
+   }
+   RooAddition top{"top", "top", layer};
+
+   // Every layer multiplies the sum of the inputs by the number of nodes.
+   auto expected = [&]() { return (a.getVal() + b.getVal()) * std::pow(double(nNodes), nLayers); };
+
+   for (bool skipDirtyClients : {false, true}) {
+      RooAbsArg::setSkipDirtyClients(skipDirtyClients);
+      EXPECT_DOUBLE_EQ(top.getVal(), expected());
+      a.setVal(3.0);
+      EXPECT_DOUBLE_EQ(top.getVal(), expected());
+      // Change two variables before the next evaluation.
+      a.setVal(-1.0);
+      b.setVal(4.0);
+      EXPECT_DOUBLE_EQ(top.getVal(), expected());
+      a.setVal(1.0);
+      b.setVal(2.0);
+   }
+   RooAbsArg::setSkipDirtyClients(false);
+}
+
+namespace {
+
+// Function that depends only on the range of a variable, so it is only a
+// shape client of the variable.
+class RangeWidth : public RooAbsReal {
+public:
+   RangeWidth(const char *name, RooRealVar &x) : RooAbsReal{name, name}, _x{"x", "x", this, x, false, true} {}
+   RangeWidth(const RangeWidth &other, const char *name = nullptr) : RooAbsReal{other, name}, _x{"x", this, other._x}
+   {
+   }
+   TObject *clone(const char *newname) const override { return new RangeWidth{*this, newname}; }
+
+protected:
+   double evaluate() const override
+   {
+      auto const &x = static_cast<RooRealVar const &>(_x.arg());
+      return x.getMax() - x.getMin();
+   }
+
+private:
+   RooRealProxy _x;
+};
+
+} // namespace
+
+// A shape change has to reach the clients that were already visited by the
+// value dirty propagation of a previous setVal().
+TEST(RooAbsReal, DirtyPropagationAfterShapeChange)
+{
+   RooRealVar x{"x", "x", 0.0, -10, 10};
+   RangeWidth width{"width", x};
+   RooAddition sum{"sum", "sum", {x, width}};
+
+   EXPECT_DOUBLE_EQ(sum.getVal(), 20.0);
+   x.setVal(1.0);
+   EXPECT_DOUBLE_EQ(sum.getVal(), 21.0);
+   x.setMax(5.0);
+   EXPECT_DOUBLE_EQ(sum.getVal(), 16.0);
+   x.setVal(2.0);
+   x.setMin(-5.0);
+   EXPECT_DOUBLE_EQ(sum.getVal(), 12.0);
+}
@@ -2,11 +2,16 @@
 // Author: Jonas Rembser, CERN, May 2021
 
 #include "RooAbsPdf.h"
+#include "RooCachedPdf.h"
+#include "RooExpensiveObjectCache.h"
 #include "RooGenericPdf.h"
+#include "RooHelpers.h"
 #include "RooObjCacheManager.h"
 #include "RooRealVar.h"
 
 #include "TFile.h"
+#include "TH1D.h"
+#include "TSystem.h"
 
 #include "gtest/gtest.h"
 
@@ -101,3 +106,173 @@ TEST(RooCacheManager, TestAbsArgCacheListConsistency)
       EXPECT_EQ(pdf->numCaches(), 1);
    }
 }
+
+/// Check that objects in the RooExpensiveObjectCache are reused from the
+/// persistent storage by a new cache instance, and only if the parameters and
+/// the structure of the owner are the same.
+TEST(RooExpensiveObjectCache, PersistentStorage)
+{
+   const std::string dir = "testRooCacheManager_persistent";
+   gSystem->Exec(("rm -rf " + dir).c_str());
+   RooExpensiveObjectCache::setPersistentDirectory(dir);
+
+   RooRealVar x("x", "x", 0, -10, 10);
+   RooRealVar mu("mu", "mu", 1.0, -10, 10);
+   RooGenericPdf pdf("pdf", "pdf", "x - mu", {x, mu});
+   RooArgSet params{mu};
+
+   {
+      RooExpensiveObjectCache cache;
+      auto hist = new TH1D("hist", "hist", 10, -10, 10);
+      hist->SetDirectory(nullptr);
+      hist->Fill(1.0);
+      cache.registerObject("pdf", "pdf_hist", *hist, params, &pdf);
+   }
+
+   {
+      RooExpensiveObjectCache cache;
+      auto hist = static_cast<const TH1D *>(cache.retrieveObject("pdf_hist", TH1D::Class(), params, &pdf));
+      ASSERT_NE(hist, nullptr);
+      EXPECT_EQ(hist->GetEntries(), 1.0);
+      EXPECT_EQ(hist->GetDirectory(), nullptr);
+   }
+
+   {
+      // The values of the observables don't matter
+      RooExpensiveObjectCache cache;
+      x.setVal(5.0);
+      EXPECT_NE(cache.retrieveObject("pdf_hist", TH1D::Class(), params, &pdf), nullptr);
+      x.setVal(0.0);
+   }
+
+   {
+      // Objects without owner are not stored on disk
+      RooExpensiveObjectCache cache;
+      auto hist = new TH1D("hist2", "hist2", 10, -10, 10);
+      hist->SetDirectory(nullptr);
+      cache.registerObject("pdf", "pdf_hist2", *hist, params);
+   }
+   {
+      RooExpensiveObjectCache cache;
+      EXPECT_EQ(cache.retrieveObject("pdf_hist2", TH1D::Class(), params), nullptr);
+      EXPECT_EQ(cache.retrieveObject("pdf_hist2", TH1D::Class(), params, &pdf), nullptr);
+   }
+
+   {
+      // Different parameter values
+      RooExpensiveObjectCache cache;
+      mu.setVal(2.0);
+      EXPECT_EQ(cache.retrieveObject("pdf_hist", TH1D::Class(), params, &pdf), nullptr);
+      mu.setVal(1.0);
+   }
+
+   {
+      // Different structure of the owner
+      RooExpensiveObjectCache cache;
+      RooGenericPdf pdf2("pdf", "pdf", "x + mu", {x, mu});
+      EXPECT_EQ(cache.retrieveObject("pdf_hist", TH1D::Class(), params, &pdf2), nullptr);
+      RooRealVar y("y", "y", 0, -10, 10);
+      RooGenericPdf pdf3("pdf", "pdf", "y - mu", {y, mu});
+      EXPECT_EQ(cache.retrieveObject("pdf_hist", TH1D::Class(), params, &pdf3), nullptr);
+   }
+
+   RooExpensiveObjectCache::setPersistentDirectory("");
+   gSystem->Exec(("rm -rf " + dir).c_str());
+}
+
+/// Check that objects registered with an owner are only retrieved from memory
+/// for an owner with the same structure, even if the names and parameter values
+/// are the same.
+TEST(RooExpensiveObjectCache, OwnerStructureInMemory)
+{
+   RooRealVar x("x", "x", 0, -10, 10);
+   RooRealVar mu("mu", "mu", 1.0, -10, 10);
+   RooGenericPdf pdf1("pdf", "pdf", "x - mu", {x, mu});
+   RooGenericPdf pdf2("pdf", "pdf", "x + mu", {x, mu});
+   RooArgSet params{mu};
+
+   RooExpensiveObjectCache cache;
+   auto hist = new TH1D("hist", "hist", 10, -10, 10);
+   hist->SetDirectory(nullptr);
+   cache.registerObject("pdf", "pdf_hist", *hist, params, &pdf1);
+
+   EXPECT_EQ(cache.retrieveObject("pdf_hist", TH1D::Class(), params, &pdf1), hist);
+   EXPECT_EQ(cache.retrieveObject("pdf_hist", TH1D::Class(), params, &pdf2), nullptr);
+   EXPECT_EQ(cache.retrieveObject("pdf_hist", TH1D::Class(), params), nullptr);
+   EXPECT_EQ(cache.retrieveObject("pdf_hist", TH1D::Class(), params,
+                                  RooExpensiveObjectCache::ownerKey(pdf1, params)),
+             hist);
+}
+
+/// Check that the cache producers don't use the expensive object cache if the
+/// persistent storage is not enabled.
+TEST(RooExpensiveObjectCache, NotUsedWithoutPersistentStorage)
+{
+   RooExpensiveObjectCache::setPersistentDirectory("");
+
+   RooRealVar x("x", "x", 1.0, 0, 10);
+   RooRealVar c("c", "c", -0.5, -1, 0);
+   RooGenericPdf pdf("pdf", "pdf", "exp(c*x)", {x, c});
+
+   RooCachedPdf cached("cached", "cached", pdf);
+   cached.getVal(x);
+   EXPECT_TRUE(cached.expensiveObjectCache().empty());
+}
+
+/// Check that the cache histograms of a RooCachedPdf are reused from the
+/// persistent storage after the in-memory cache is cleared.
+TEST(RooExpensiveObjectCache, PersistentCachedPdf)
+{
+   const std::string dir = "testRooCacheManager_persistentCachedPdf";
+   gSystem->Exec(("rm -rf " + dir).c_str());
+   RooExpensiveObjectCache::setPersistentDirectory(dir);
+
+   RooRealVar x("x", "x", 1.0, 0, 10);
+   RooRealVar c("c", "c", -0.5, -1, 0);
+   RooGenericPdf pdf("pdf", "pdf", "exp(c*x)", {x, c});
+
+   double val1 = 0.0;
+   {
+      RooCachedPdf cached("cached", "cached", pdf);
+      val1 = cached.getVal(x);
+   }
+
+   RooExpensiveObjectCache::instance().clearAll();
+
+   {
+      RooHelpers::HijackMessageStream hijack(RooFit::INFO, RooFit::Caching);
+      RooCachedPdf cached("cached", "cached", pdf);
+      EXPECT_DOUBLE_EQ(cached.getVal(x), val1);
+      EXPECT_NE(hijack.str().find("loaded cache object"), std::string::npos) << hijack.str();
+   }
+
+   RooExpensiveObjectCache::instance().clearAll();
+
+   {
+      // The persistent storage is not used while it is suspended, like during
+      // minimizations
+      RooExpensiveObjectCache::SuspendPersistentStorage suspend;
+      EXPECT_FALSE(RooExpensiveObjectCache::persistentStorageActive());
+      RooHelpers::HijackMessageStream hijack(RooFit::INFO, RooFit::Caching);
+      RooCachedPdf cached("cached", "cached", pdf);
+      EXPECT_DOUBLE_EQ(cached.getVal(x), val1);
+      EXPECT_EQ(hijack.str().find("loaded cache object"), std::string::npos) << hijack.str();
+      EXPECT_TRUE(RooExpensiveObjectCache::instance().empty());
+   }
+   EXPECT_TRUE(RooExpensiveObjectCache::persistentStorageActive());
+
+   RooExpensiveObjectCache::instance().clearAll();
+
+   {
+      // Different parameter values: the histogram has to be filled again
+      RooHelpers::HijackMessageStream hijack(RooFit::INFO, RooFit::Caching);
+      c.setVal(-0.2);
+      RooCachedPdf cached("cached", "cached", pdf);
+      EXPECT_NE(cached.getVal(x), val1);
+      EXPECT_EQ(hijack.str().find("loaded cache object"), std::string::npos) << hijack.str();
+   }
+
+   RooExpensiveObjectCache::instance().clearAll();
+   RooExpensiveObjectCache::setPersistentDirectory("");
+   gSystem->Exec(("rm -rf " + dir).c_str());
+}
@@ -11,6 +11,11 @@
  */
 
 #include <RooCmdArg.h>
+#include <RooCurve.h>
+#include <RooDataProjBinding.h>
+#include <RooDataSet.h>
+#include <RooFit/Evaluator.h>
+#include <RooFormulaVar.h>
 #include <RooGenericPdf.h>
 #include <RooHelpers.h>
 #include <RooPlot.h>
@@ -46,3 +51,94 @@ TEST(RooPlot, Average)
       EXPECT_NEAR(avg, 0.5 * (xLast + xFirst), tol);
    }
 }
+
+// Check that the batched projection over a dataset gives the same result as
+// averaging over the events one by one, and that the curve for
+// RooFit::ProjWData() doesn't change if the initial sampling points are
+// evaluated concurrently.
+TEST(RooPlot, ProjWDataConcurrent)
+{
+   RooRealVar x("x", "x", -5, 5);
+   RooRealVar y("y", "y", -2, 2);
+   RooFormulaVar func("func", "func", "exp(-0.5*(x-y)*(x-y))", {x, y});
+
+   RooDataSet data{"data", "data", y};
+   for (int i = 0; i < 200; ++i) {
+      y.setVal(-2.0 + 0.02 * i);
+      data.add(y);
+   }
+
+   RooDataProjBinding binding{func, data, RooArgSet{x}};
+   for (double xVal : {-3.0, -0.5, 0.0, 1.7}) {
+      x.setVal(xVal);
+      double expected = 0.0;
+      for (int i = 0; i < data.numEntries(); ++i) {
+         y.setVal(data.get(i)->getRealValue("y"));
+         expected += func.getVal();
+      }
+      expected /= data.numEntries();
+      EXPECT_NEAR(binding(&xVal), expected, 1e-10);
+   }
+
+   auto makePlot = [&](unsigned int nThreads) {
+      RooFit::Evaluator::setDefaultNThreads(nThreads);
+      std::unique_ptr<RooPlot> frame{x.frame()};
+      func.plotOn(frame.get(), RooFit::ProjWData(y, data), RooFit::Name("curve"));
+      RooFit::Evaluator::setDefaultNThreads(1);
+      return frame;
+   };
+
+   std::unique_ptr<RooPlot> serialFrame = makePlot(1);
+   std::unique_ptr<RooPlot> concurrentFrame = makePlot(4);
+   RooCurve *serialCurve = serialFrame->getCurve("curve");
+   RooCurve *concurrentCurve = concurrentFrame->getCurve("curve");
+
+   ASSERT_EQ(serialCurve->GetN(), concurrentCurve->GetN());
+   for (int i = 0; i < serialCurve->GetN(); ++i) {
+      EXPECT_DOUBLE_EQ(serialCurve->GetPointX(i), concurrentCurve->GetPointX(i));
+      EXPECT_DOUBLE_EQ(serialCurve->GetPointY(i), concurrentCurve->GetPointY(i));
+   }
+}
+
+// Check that the initial sampling points are evaluated again one by one if
+// there were evaluation errors in the concurrent pass, even if the averaged
+// values are finite. Here, the pdf is negative for an event with zero weight,
+// which doesn't contribute to the average but still raises an error for every
+// point, such that all points are replaced by the error value.
+TEST(RooPlot, ProjWDataConcurrentEvalErrors)
+{
+   RooHelpers::LocalChangeMsgLevel chmsglvl{RooFit::ERROR, 0u, RooFit::NumericIntegration, true};
+
+   RooRealVar x("x", "x", -5, 5);
+   RooRealVar y("y", "y", -2, 2);
+   RooRealVar w("w", "w", 0, 1);
+   RooGenericPdf pdf("pdf", "pdf", "(1 + 0.1*x*x)*(y + 1.5)", {x, y});
+
+   RooDataSet data{"data", "data", RooArgSet{y, w}, RooFit::WeightVar(w)};
+   for (int i = 0; i < 100; ++i) {
+      y.setVal(0.02 * i);
+      data.add(y, 1.0);
+   }
+   y.setVal(-1.9);
+   data.add(y, 0.0);
+
+   auto makePlot = [&](unsigned int nThreads) {
+      RooFit::Evaluator::setDefaultNThreads(nThreads);
+      std::unique_ptr<RooPlot> frame{x.frame()};
+      pdf.plotOn(frame.get(), RooFit::ProjWData(y, data), RooFit::EvalErrorValue(-1.0),
+                 RooFit::PrintEvalErrors(-1), RooFit::Name("curve"));
+      RooFit::Evaluator::setDefaultNThreads(1);
+      return frame;
+   };
+
+   std::unique_ptr<RooPlot> serialFrame = makePlot(1);
+   std::unique_ptr<RooPlot> concurrentFrame = makePlot(4);
+   RooCurve *serialCurve = serialFrame->getCurve("curve");
+   RooCurve *concurrentCurve = concurrentFrame->getCurve("curve");
+
+   ASSERT_EQ(serialCurve->GetN(), concurrentCurve->GetN());
+   for (int i = 0; i < serialCurve->GetN(); ++i) {
+      EXPECT_DOUBLE_EQ(serialCurve->GetPointX(i), concurrentCurve->GetPointX(i));
+      EXPECT_DOUBLE_EQ(serialCurve->GetPointY(i), concurrentCurve->GetPointY(i));
+   }
+}
@@ -811,3 +811,28 @@ TEST(RooDataHist, SplitDataHistWithSumW2)
    EXPECT_DOUBLE_EQ(data2.weightSquared(), data1.weightSquared(1));
    EXPECT_DOUBLE_EQ(data2.weightError(), data1.weightError());
 }
+
+// Test that adding the contents of all bins at once keeps the existing weight
+// errors and only starts tracking the squared weights when they differ from
+// the weights.
+TEST(RooDataHist, AddBinContents)
+{
+   RooRealVar x{"x", "x", 0, 0, 3};
+   x.setBins(3);
+
+   RooDataHist hist{"hist", "hist", x};
+
+   hist.addBinContents(std::vector<double>{1., 2., 0.}, std::vector<double>{1., 2., 0.});
+   EXPECT_EQ(hist.sumW2Array(), nullptr);
+   EXPECT_DOUBLE_EQ(hist.weight(1), 2.);
+
+   hist.addBinContents(std::vector<double>{0.5, 0., 1.5}, std::vector<double>{0.25, 0., 1.25});
+   ASSERT_NE(hist.sumW2Array(), nullptr);
+   EXPECT_DOUBLE_EQ(hist.weight(0), 1.5);
+   EXPECT_DOUBLE_EQ(hist.weightSquared(0), 1.25);
+   EXPECT_DOUBLE_EQ(hist.weightSquared(1), 2.);
+   EXPECT_DOUBLE_EQ(hist.weightSquared(2), 1.25);
+   EXPECT_DOUBLE_EQ(hist.sumEntries(), 5.);
+   EXPECT_EQ(hist.wgtErrLoArray(), nullptr);
+   EXPECT_EQ(hist.wgtErrHiArray(), nullptr);
+}
@@ -23,6 +23,7 @@
 
 #include <fstream>
 #include <memory>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -280,6 +281,53 @@ TEST(RooDataSet, CrashAfterImportFromTree)
    EXPECT_EQ(static_cast<RooRealVar *>(dataset.get(1)->find("var"))->getVal(), 2.);
 }
 
+/// Importing a tree with branches of different types, out-of-range values, a
+/// weight and a selection, which is done column by column.
+TEST(RooDataSet, ImportFromTreeColumnwise)
+{
+   RooHelpers::HijackMessageStream hijack(RooFit::WARNING, RooFit::DataHandling);
+
+   TTree tree("tree", "tree");
+   double xVal;
+   float yVal;
+   int nVal;
+   double wVal;
+   tree.Branch("x", &xVal, "x/D");
+   tree.Branch("y", &yVal, "y/F");
+   tree.Branch("n", &nVal, "n/I");
+   tree.Branch("w", &wVal, "w/D");
+
+   std::vector<double> expectedX;
+   double expectedSumW = 0.0;
+   for (int i = 0; i < 1000; ++i) {
+      xVal = 0.01 * i - 1.0;
+      yVal = i % 7;
+      nVal = i % 5;
+      wVal = 0.5 + i % 3;
+      tree.Fill();
+      if (xVal >= -0.5 && xVal <= 5.0 && yVal <= 5.f && nVal != 2) {
+         expectedX.push_back(xVal);
+         expectedSumW += wVal;
+      }
+   }
+
+   RooRealVar x("x", "x", -0.5, 5.0);
+   RooRealVar y("y", "y", 0.0, 5.0);
+   RooRealVar n("n", "n", 0.0, 10.0);
+   RooRealVar w("w", "w", 0.0, 10.0);
+   RooDataSet data("data", "data", {x, y, n, w}, RooFit::Import(tree), RooFit::WeightVar(w), RooFit::Cut("n != 2"));
+
+   EXPECT_NE(hijack.str().find("out-of-range events"), std::string::npos) << hijack.str();
+
+   ASSERT_EQ(data.numEntries(), static_cast<int>(expectedX.size()));
+   EXPECT_NEAR(data.sumEntries(), expectedSumW, 1e-9);
+   for (std::size_t i = 0; i < expectedX.size(); ++i) {
+      const RooArgSet *row = data.get(i);
+      EXPECT_EQ(static_cast<RooRealVar *>(row->find("x"))->getVal(), expectedX[i]);
+      EXPECT_NE(static_cast<RooRealVar *>(row->find("n"))->getVal(), 2.0);
+   }
+}
+
 // root-project/root#6951: Broken weights after reducing RooDataSet created with RooAbsPdf::generate()
 TEST(RooDataSet, ReduceWithCompositeDataStore)
 {
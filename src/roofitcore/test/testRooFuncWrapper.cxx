@@ -15,10 +15,12 @@
 #include <RooBinWidthFunction.h>
 #include <RooCategory.h>
 #include <RooClassFactory.h>
+#include <RooCompiledFunction.h>
 #include <RooDataHist.h>
 #include <RooDataSet.h>
 #include <RooEvaluatorWrapper.h>
 #include <RooExponential.h>
+#include <RooFit/CodegenContext.h>
 #include <RooFitResult.h>
 #include <RooFunctor1DBinding.h>
 #include <RooFunctorBinding.h>
@@ -37,6 +39,7 @@
 
 #include <Math/Functor.h>
 #include <ROOT/StringUtils.hxx>
+#include <TInterpreter.h>
 #include <TMath.h>
 #include <TROOT.h>
 #include <TRandom3.h>
@@ -661,3 +664,157 @@ INSTANTIATE_TEST_SUITE_P(RooFuncWrapper, FactoryTest, testValues,
                          [](testing::TestParamInfo<FactoryTest::ParamType> const &paramInfo) {
                             return paramInfo.param._name;
                          });
+
+// Check that the generated code and its gradient are compiled to the cache
+// directory, and that a second likelihood for the same model is using the
+// cached library with identical results.
+TEST(RooFuncWrapper, CodegenCache)
+{
+   RooHelpers::LocalChangeMsgLevel changeMsgLvl(RooFit::WARNING);
+
+   const std::string cacheDir = std::string{gSystem->TempDirectory()} + "/roofit_codegen_cache_" +
+                                std::to_string(gSystem->GetPid());
+   const std::string oldCacheDir = RooFit::Experimental::RooEvaluatorWrapper::codegenCacheDirectory();
+   RooFit::Experimental::RooEvaluatorWrapper::setCodegenCacheDirectory(cacheDir);
+
+   RooWorkspace ws;
+   ws.factory("Gaussian::model(x[-10, 10], mu[0, -5, 5], sigma[2.0, 0.1, 10])");
+   RooRealVar &x = *ws.var("x");
+   RooAbsPdf &model = *ws.pdf("model");
+   std::unique_ptr<RooDataSet> data{model.generate(x, 100)};
+
+   auto createNLL = [&]() {
+      std::unique_ptr<RooAbsReal> nll{model.createNLL(*data, RooFit::EvalBackend::Codegen())};
+      static_cast<RooFit::Experimental::RooEvaluatorWrapper &>(*nll).setUseGeneratedFunctionCode(true);
+      return nll;
+   };
+
+   std::unique_ptr<RooAbsReal> nll1 = createNLL();
+
+   void *dir = gSystem->OpenDirectory(cacheDir.c_str());
+   ASSERT_NE(dir, nullptr);
+   bool foundGradLib = false;
+   while (const char *entry = gSystem->GetDirEntry(dir)) {
+      std::string name = entry;
+      foundGradLib |= name.find("_grad.") != std::string::npos && name.find(gSystem->GetSoExt()) != std::string::npos;
+   }
+   gSystem->FreeDirectory(dir);
+   EXPECT_TRUE(foundGradLib);
+
+   std::unique_ptr<RooAbsReal> nll2;
+   {
+      // The second likelihood has to load the cached library instead of
+      // compiling the code again.
+      RooHelpers::HijackMessageStream hijack(RooFit::INFO, RooFit::Fitting);
+      nll2 = createNLL();
+      EXPECT_NE(hijack.str().find("loaded the generated code from the cache library"), std::string::npos)
+         << hijack.str();
+      EXPECT_EQ(hijack.str().find("wrote the generated code to the cache library"), std::string::npos)
+         << hijack.str();
+   }
+
+   RooArgSet params;
+   nll1->getParameters(data->get(), params);
+   std::vector<double> grad1(params.size());
+   std::vector<double> grad2(params.size());
+   nll1->gradient(grad1.data());
+   nll2->gradient(grad2.data());
+
+   EXPECT_DOUBLE_EQ(nll1->getVal(), nll2->getVal());
+   for (std::size_t i = 0; i < params.size(); ++i) {
+      EXPECT_DOUBLE_EQ(grad1[i], grad2[i]);
+   }
+
+   RooFit::Experimental::RooEvaluatorWrapper::setCodegenCacheDirectory(oldCacheDir);
+   gSystem->Exec(("rm -rf " + cacheDir).c_str());
+}
+
+// Check that the code exported for ahead-of-time compilation can be compiled
+// and loaded without the interpreter, giving the same values and gradients.
+TEST(RooFuncWrapper, ExportCompiledCode)
+{
+   RooHelpers::LocalChangeMsgLevel changeMsgLvl(RooFit::WARNING);
+
+   RooWorkspace ws;
+   ws.factory("Gaussian::model(x[-10, 10], mu[0, -5, 5], sigma[2.0, 0.1, 10])");
+   RooRealVar &x = *ws.var("x");
+   RooAbsPdf &model = *ws.pdf("model");
+   std::unique_ptr<RooDataSet> data{model.generate(x, 100)};
+
+   std::unique_ptr<RooAbsReal> nll{model.createNLL(*data, RooFit::EvalBackend::Codegen())};
+   auto &wrapper = static_cast<RooFit::Experimental::RooEvaluatorWrapper &>(*nll);
+   wrapper.setUseGeneratedFunctionCode(true);
+
+   const std::string exportName = "roofit_exported_nll";
+   const std::string exportDir = std::string{gSystem->TempDirectory()} + "/roofit_export_" +
+                                 std::to_string(gSystem->GetPid());
+   wrapper.exportCompiledCode(exportDir, exportName);
+   EXPECT_FALSE(gSystem->AccessPathName((exportDir + "/CMakeLists.txt").c_str()));
+   EXPECT_FALSE(gSystem->AccessPathName((exportDir + "/include/RooFit/Detail/MathFuncs.h").c_str()));
+
+   // Configure and build the exported project against the ROOT installation
+   // that runs the test, without the RooFit include directories.
+   const std::string buildDir = exportDir + "/build";
+   const std::string configure = "cmake -S " + exportDir + " -B " + buildDir +
+                                 " -DCMAKE_BUILD_TYPE=Release -DCMAKE_PREFIX_PATH=" + gROOT->GetRootSys().Data();
+   ASSERT_EQ(gSystem->Exec(configure.c_str()), 0);
+   ASSERT_EQ(gSystem->Exec(("cmake --build " + buildDir).c_str()), 0);
+#ifdef R__MACOSX
+   const std::string libPath = buildDir + "/lib" + exportName + ".dylib";
+#else
+   const std::string libPath = buildDir + "/lib" + exportName + ".so";
+#endif
+   ASSERT_FALSE(gSystem->AccessPathName(libPath.c_str()));
+
+   RooArgSet params;
+   nll->getParameters(data->get(), params);
+   RooFit::Experimental::RooCompiledFunction compiled{exportName.c_str(), exportName.c_str(), libPath, params};
+
+   ws.var("mu")->setVal(0.5);
+   ws.var("sigma")->setVal(1.5);
+
+   EXPECT_NEAR(compiled.getVal(), nll->getVal(), 1e-10);
+
+   ASSERT_TRUE(compiled.hasGradient());
+   std::vector<double> gradRef(params.size());
+   std::vector<double> gradCompiled(params.size());
+   nll->gradient(gradRef.data());
+   compiled.gradient(gradCompiled.data());
+   for (std::size_t i = 0; i < params.size(); ++i) {
+      EXPECT_NEAR(gradCompiled[i], gradRef[i], 1e-10);
+   }
+
+   gSystem->Exec(("rm -rf " + exportDir).c_str());
+}
+
+// Check that a user-defined codegenImpl() overload with a higher priority than
+// the built-in implementation is used, even though the built-in classes are
+// dispatched without the interpreter. This test has to stay the last one that
+// generates code for a RooExponential, because the override stays declared.
+TEST(RooFuncWrapper, UserCodegenImplOverride)
+{
+   gInterpreter->Declare(R"(
+#include <RooExponential.h>
+#include <RooFit/CodegenImpl.h>
+
+namespace RooFit::Experimental {
+
+void codegenImpl(RooExponential &arg, CodegenContext &ctx, Prio<2>)
+{
+   ctx.addResult(&arg, "userExponentialOverride(" + ctx.getResult(arg.variable()) + ")");
+}
+
+} // namespace RooFit::Experimental
+)");
+
+   RooRealVar x{"x", "x", 1.0, 0.0, 10.0};
+   RooRealVar c{"c", "c", -0.5, -10.0, 0.0};
+   RooExponential expo{"expo", "expo", x, c};
+
+   RooFit::Experimental::CodegenContext ctx;
+   ctx.addResult(&x, "x");
+   ctx.addResult(&c, "c");
+   RooFit::Experimental::codegen(expo, ctx);
+
+   EXPECT_EQ(ctx.getResult(expo), "userExponentialOverride(x)");
+}
@@ -0,0 +1,71 @@
+// Tests for RooRandom
+
+#include <RooDataSet.h>
+#include <RooGenericPdf.h>
+#include <RooRandom.h>
+#include <RooRealVar.h>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::vector<double> drawNumbers(TRandom &generator, std::size_t n)
+{
+   std::vector<double> out(n);
+   for (double &val : out) {
+      val = generator.Rndm();
+   }
+   return out;
+}
+
+} // namespace
+
+// A stream only depends on the index, the purpose and the seed.
+TEST(RooRandom, StreamsAreReproducible)
+{
+   std::unique_ptr<TRandom> stream1 = RooRandom::stream(3, 0, 42);
+   std::unique_ptr<TRandom> stream2 = RooRandom::stream(3, 0, 42);
+   std::vector<double> numbers = drawNumbers(*stream1, 1000);
+   EXPECT_EQ(drawNumbers(*stream2, 1000), numbers);
+
+   for (double val : numbers) {
+      EXPECT_GT(val, 0.0);
+      EXPECT_LT(val, 1.0);
+   }
+
+   EXPECT_NE(drawNumbers(*RooRandom::stream(4, 0, 42), 1000), numbers);
+   EXPECT_NE(drawNumbers(*RooRandom::stream(3, 1, 42), 1000), numbers);
+   EXPECT_NE(drawNumbers(*RooRandom::stream(3, 0, 43), 1000), numbers);
+}
+
+// The toy that is generated in a StreamScope must neither depend on what was
+// generated before nor on the thread that generates it.
+TEST(RooRandom, StreamScopeMakesToysReproducible)
+{
+   RooRealVar x("x", "x", 0.0, 0.0, 1.0);
+   // The RooGenericPdf has no internal generator, so accept-reject sampling is used
+   RooGenericPdf pdf("pdf", "1.0 + x * x", {x});
+
+   auto generateToy = [&](std::size_t iToy) {
+      RooRandom::StreamScope toyStream{iToy};
+      return std::unique_ptr<RooDataSet>{pdf.generate(x, 100)};
+   };
+
+   std::unique_ptr<RooDataSet> toy1 = generateToy(1);
+
+   // generate some other toys in between to change the state of all generators
+   generateToy(2);
+   std::unique_ptr<RooDataSet>{pdf.generate(x, 100)};
+
+   std::unique_ptr<RooDataSet> toy1Again;
+   std::thread{[&]() { toy1Again = generateToy(1); }}.join();
+
+   ASSERT_EQ(toy1->numEntries(), toy1Again->numEntries());
+   for (int i = 0; i < toy1->numEntries(); ++i) {
+      EXPECT_EQ(toy1->get(i)->getRealValue("x"), toy1Again->get(i)->getRealValue("x")) << "event " << i;
+   }
+}
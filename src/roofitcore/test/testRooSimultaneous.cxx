@@ -9,6 +9,7 @@
 #include <RooConstVar.h>
 #include <RooDataSet.h>
 #include <RooExponential.h>
+#include <RooFit/Evaluator.h>
 #include <RooFitResult.h>
 #include <RooGaussian.h>
 #include <RooGenericPdf.h>
@@ -828,3 +829,49 @@ TEST(RooSimultaneous, AsymmetryPlot)
       EXPECT_NEAR(curve->interpolate(xv), analytic(xv), 1e-6) << "at x = " << xv;
    }
 }
+
+/// The multi-threaded scheduling of the Evaluator has to give the same
+/// likelihood values as the serial evaluation, also after parameter changes
+/// that only affect some of the channels.
+TEST(RooSimultaneous, MultiThreadedEvaluator)
+{
+   using namespace RooFit;
+
+   RooHelpers::LocalChangeMsgLevel changeMsgLvl(RooFit::WARNING);
+
+   constexpr int nChannels = 8;
+
+   RooWorkspace ws;
+   ws.factory("x[-10, 10]");
+   ws.factory("sigma[2.0, 0.1, 10.0]");
+   RooCategory indexCat("cat", "cat");
+   std::map<std::string, RooAbsPdf *> pdfMap;
+   std::map<std::string, std::unique_ptr<RooDataSet>> dataMap;
+   for (int i = 0; i < nChannels; ++i) {
+      std::string idx = std::to_string(i);
+      ws.factory("SUM::model_" + idx + "(f_" + idx + "[0.5, 0, 1] * Gaussian::gauss_" + idx + "(x, mu_" + idx +
+                 "[0, -5, 5], sigma), Exponential::expo_" + idx + "(x, c_" + idx + "[-0.1, -1, 0]))");
+      indexCat.defineType("ch" + idx);
+      pdfMap["ch" + idx] = ws.pdf("model_" + idx);
+      dataMap["ch" + idx] = std::unique_ptr<RooDataSet>{ws.pdf("model_" + idx)->generate(*ws.var("x"), 1000)};
+   }
+   RooSimultaneous simPdf("simPdf", "", pdfMap, indexCat);
+   RooDataSet combData("combData", "", *ws.var("x"), Index(indexCat), Import(dataMap));
+
+   std::unique_ptr<RooAbsReal> nllSerial{simPdf.createNLL(combData, EvalBackend::Cpu())};
+
+   const unsigned int defaultNThreads = RooFit::Evaluator::defaultNThreads();
+   RooFit::Evaluator::setDefaultNThreads(4);
+   std::unique_ptr<RooAbsReal> nllParallel{simPdf.createNLL(combData, EvalBackend::Cpu())};
+   RooFit::Evaluator::setDefaultNThreads(defaultNThreads);
+
+   EXPECT_DOUBLE_EQ(nllParallel->getVal(), nllSerial->getVal());
+
+   // change a parameter of a single channel
+   ws.var("mu_3")->setVal(0.5);
+   EXPECT_DOUBLE_EQ(nllParallel->getVal(), nllSerial->getVal());
+
+   // change a parameter shared by all channels
+   ws.var("sigma")->setVal(1.5);
+   EXPECT_DOUBLE_EQ(nllParallel->getVal(), nllSerial->getVal());
+}
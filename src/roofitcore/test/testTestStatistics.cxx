@@ -9,6 +9,7 @@
 #include <RooDataSet.h>
 #include <RooExtendPdf.h>
 #include <RooFitResult.h>
+#include <RooFit/Evaluator.h>
 #include <RooGlobalFunc.h>
 #include <RooHelpers.h>
 #include <RooHistFunc.h>
@@ -30,6 +31,7 @@
 
 #include <TH1D.h>
 #include <TMath.h>
+#include <TROOT.h>
 
 #include "gtest_wrapper.h"
 
@@ -1210,3 +1212,160 @@ TEST(RooNLLVar, RooExtendPdfRangedFit)
    EXPECT_NEAR(alpha1.getVal(), alpha2.getVal(), 1e-4);
    EXPECT_NEAR(alpha1.getVal(), -0.04, 5. * alpha1.getError());
 }
+
+#ifdef R__USE_IMT
+// With implicit multi-threading, the RooBatchCompute functions and the NLL
+// reduction are split over several threads for large datasets. The result has
+// to be bit-wise identical to the single-threaded evaluation.
+TEST(RooNLLVar, ImplicitMTBitwiseIdentical)
+{
+   RooHelpers::LocalChangeMsgLevel changeMsgLvl(RooFit::WARNING);
+
+   RooWorkspace ws;
+   ws.factory("Gaussian::sig(x[0, 10], mu[5, 0, 10], sigma[1, 0.1, 10])");
+   ws.factory("Exponential::bkg(x, c[-0.3, -10, 0])");
+   ws.factory("SUM::model(nsig[100000, 0, 1e6] * sig, nbkg[200000, 0, 1e6] * bkg)");
+
+   RooAbsPdf &model = *ws.pdf("model");
+   RooRealVar &x = *ws.var("x");
+
+   RooRandom::randomGenerator()->SetSeed(1337);
+   std::unique_ptr<RooDataSet> data{model.generate(x)};
+
+   auto evalNLL = [&]() {
+      std::unique_ptr<RooAbsReal> nll{model.createNLL(*data, RooFit::EvalBackend::Cpu())};
+      return nll->getVal();
+   };
+
+   const double nllSerial = evalNLL();
+
+   ROOT::EnableImplicitMT(2);
+   const double nllTwoThreads = evalNLL();
+   ROOT::DisableImplicitMT();
+
+   ROOT::EnableImplicitMT(4);
+   const double nllFourThreads = evalNLL();
+   ROOT::DisableImplicitMT();
+
+   EXPECT_EQ(nllTwoThreads, nllSerial);
+   EXPECT_EQ(nllFourThreads, nllSerial);
+}
+#endif
+
+// The fused evaluation of connected RooBatchCompute nodes block by block has
+// to give the same result as evaluating one node after the other. Only the
+// likelihood reduction is done in a different order, which is why the values
+// are not bit-wise identical.
+TEST(RooNLLVar, FusedEvaluation)
+{
+   using namespace RooFit;
+
+   RooHelpers::LocalChangeMsgLevel changeMsgLvl(RooFit::WARNING);
+
+   RooWorkspace ws;
+   ws.factory("Gaussian::sig(x[0, 10], mu[5, 0, 10], sigma[1, 0.1, 10])");
+   ws.factory("Exponential::bkg(x, c[-0.3, -10, 0])");
+   ws.factory("SUM::model(f[0.3, 0, 1] * sig, bkg)");
+
+   RooAbsPdf &model = *ws.pdf("model");
+   RooRealVar &x = *ws.var("x");
+
+   RooRandom::randomGenerator()->SetSeed(1337);
+   // Not a multiple of the block size, to also cover the last partial block
+   std::unique_ptr<RooDataSet> data{model.generate(x, 10007)};
+
+   std::unique_ptr<RooAbsReal> nll{model.createNLL(*data, EvalBackend::Cpu())};
+
+   const bool defaultFused = Evaluator::defaultFusedEvaluation();
+   Evaluator::setDefaultFusedEvaluation(true);
+   std::unique_ptr<RooAbsReal> nllFused{model.createNLL(*data, EvalBackend::Cpu())};
+   Evaluator::setDefaultFusedEvaluation(defaultFused);
+
+   EXPECT_NEAR(nllFused->getVal(), nll->getVal(), 1e-12 * std::abs(nll->getVal()));
+
+   // change a parameter that only affects one branch of the graph
+   ws.var("mu")->setVal(4.5);
+   EXPECT_NEAR(nllFused->getVal(), nll->getVal(), 1e-12 * std::abs(nll->getVal()));
+
+   ws.var("f")->setVal(0.6);
+   EXPECT_NEAR(nllFused->getVal(), nll->getVal(), 1e-12 * std::abs(nll->getVal()));
+
+   // extended likelihood, where the expected number of events is added to
+   // the block-wise reduced likelihood
+   ws.factory("SUM::modelExt(nsig[3000, 0, 20000] * sig, nbkg[7000, 0, 20000] * bkg)");
+   RooAbsPdf &modelExt = *ws.pdf("modelExt");
+   std::unique_ptr<RooAbsReal> nllExt{modelExt.createNLL(*data, EvalBackend::Cpu(), Extended(true))};
+   Evaluator::setDefaultFusedEvaluation(true);
+   std::unique_ptr<RooAbsReal> nllExtFused{modelExt.createNLL(*data, EvalBackend::Cpu(), Extended(true))};
+   Evaluator::setDefaultFusedEvaluation(defaultFused);
+
+   EXPECT_NEAR(nllExtFused->getVal(), nllExt->getVal(), 1e-12 * std::abs(nllExt->getVal()));
+}
+
+// Check that the "cpu_float" backend, which evaluates some pdfs with single
+// precision arithmetic, gives a likelihood that is compatible with the
+// regular "cpu" backend within the expected single precision accuracy.
+TEST(RooNLLVar, CpuFloatBackend)
+{
+   using namespace RooFit;
+
+   RooHelpers::LocalChangeMsgLevel changeMsgLvl(RooFit::WARNING);
+
+   RooWorkspace ws;
+   ws.factory("Gaussian::sig(x[0, 10], mu[5, 0, 10], sigma[1, 0.1, 10])");
+   ws.factory("Exponential::bkg(x, c[-0.3, -10, 0])");
+   ws.factory("SUM::model(f[0.3, 0, 1] * sig, bkg)");
+
+   RooAbsPdf &model = *ws.pdf("model");
+   RooRealVar &x = *ws.var("x");
+
+   RooRandom::randomGenerator()->SetSeed(1337);
+   std::unique_ptr<RooDataSet> data{model.generate(x, 10007)};
+
+   std::unique_ptr<RooAbsReal> nll{model.createNLL(*data, EvalBackend::Cpu())};
+   std::unique_ptr<RooAbsReal> nllFloat{model.createNLL(*data, EvalBackend::CpuFloat())};
+
+   EXPECT_EQ(EvalBackend("cpu_float").value(), EvalBackend::Value::CpuFloat);
+
+   EXPECT_NEAR(nllFloat->getVal(), nll->getVal(), 1e-5 * std::abs(nll->getVal()));
+
+   ws.var("mu")->setVal(4.5);
+   ws.var("c")->setVal(-0.5);
+   EXPECT_NEAR(nllFloat->getVal(), nll->getVal(), 1e-5 * std::abs(nll->getVal()));
+}
+
+// Check that the "cpu_float" backend gives the same likelihood as the "cpu"
+// backend for events in the far tails, where the pdf values are below the
+// single precision range.
+TEST(RooNLLVar, CpuFloatBackendFarTails)
+{
+   using namespace RooFit;
+
+   RooHelpers::LocalChangeMsgLevel changeMsgLvl(RooFit::WARNING);
+
+   RooWorkspace ws;
+   ws.factory("Gaussian::gauss(x[-20, 20], mu[0, -5, 5], sigma[1, 0.1, 10])");
+   ws.factory("Exponential::expo(y[0, 20], c[-12, -20, 0])");
+
+   RooRealVar &x = *ws.var("x");
+   RooRealVar &y = *ws.var("y");
+
+   // Fill enough events for full SIMD vectors and a remainder, with exponent
+   // arguments in the normal, subnormal and underflowing single precision
+   // ranges.
+   RooDataSet data{"data", "data", {x, y}};
+   for (int i = 0; i < 21; ++i) {
+      x.setVal((i % 2 == 0 ? 1.0 : -1.0) * (i % 7) * 2.7);
+      y.setVal(0.1 + (i % 6) * 2.0);
+      data.add({x, y});
+   }
+
+   for (const char *pdfName : {"gauss", "expo"}) {
+      RooAbsPdf &pdf = *ws.pdf(pdfName);
+      std::unique_ptr<RooAbsReal> nll{pdf.createNLL(data, EvalBackend::Cpu())};
+      std::unique_ptr<RooAbsReal> nllFloat{pdf.createNLL(data, EvalBackend::CpuFloat())};
+
+      ASSERT_TRUE(std::isfinite(nllFloat->getVal())) << pdfName;
+      EXPECT_NEAR(nllFloat->getVal(), nll->getVal(), 1e-5 * std::abs(nll->getVal())) << pdfName;
+   }
+}
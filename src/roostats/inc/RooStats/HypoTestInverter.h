@@ -22,6 +22,7 @@ class TGraphErrors;
 
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace RooStats {
 
@@ -146,6 +147,22 @@ public:
    /// set numerical error in test statistic evaluation (default is zero)
    void SetNumErr(double err) { fNumErr = err; }
 
+   /// Number of forked worker processes used to evaluate the points of a
+   /// fixed scan. With more than one worker, the points are distributed with
+   /// RooFit::MultiProcess and each point gets its own RooRandom stream, so
+   /// the result does not depend on the number of workers. Requires RooFit
+   /// to be built with `roofit_multiprocess=ON`, otherwise the points are run
+   /// serially.
+   void SetNWorkers(int nWorkers) { fNWorkers = nWorkers; }
+   int GetNWorkers() const { return fNWorkers; }
+
+   /// Evaluate also the points of serial fixed scans with one RooRandom
+   /// stream per point, like in the parallel scans, such that toy-based
+   /// serial and parallel scans give the same results. By default, serial
+   /// scans draw all toys from the global random generator.
+   void SetReproducibleScan(bool flag = true) { fReproducibleScan = flag; }
+   bool GetReproducibleScan() const { return fReproducibleScan; }
+
 protected:
 
    /// copy c-tor
@@ -159,6 +176,10 @@ protected:
    /// run the hybrid at a single point
    HypoTestResult * Eval( HypoTestCalculatorGeneric &hc, bool adaptive , double clsTarget) const;
 
+   std::unique_ptr<HypoTestResult> EvalOnePoint(double &rVal, bool adaptive, double clTarget) const;
+   void AddResult(double rVal, std::unique_ptr<HypoTestResult> result) const;
+   void RunFixedScanMultiProcess(std::vector<double> const &xValues) const;
+
    /// helper functions
    static RooRealVar * GetVariableToScan(const HypoTestCalculatorGeneric &hc);
    static void CheckInputModels(const HypoTestCalculatorGeneric &hc, const RooRealVar & scanVar);
@@ -194,6 +215,8 @@ private:
    double fXmin;
    double fXmax;
    double fNumErr;
+   int fNWorkers = 1; ///<! number of worker processes for the fixed scan
+   bool fReproducibleScan = false; ///<! use one RooRandom stream per point also in serial fixed scans
 
 protected:
 
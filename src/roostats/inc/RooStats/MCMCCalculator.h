@@ -97,6 +97,16 @@ namespace RooStats {
       virtual void SetNumBurnInSteps(Int_t numBurnInSteps)
       { fNumBurnInSteps = numBurnInSteps; }
 
+      /// set the number of independent chains with SetNumIters() steps each;
+      /// the burn-in steps are discarded from every chain before merging them
+      virtual void SetNumChains(Int_t numChains)
+      { fNumChains = numChains; }
+
+      /// set the number of worker processes to construct the chains in parallel
+      /// (requires RooFit built with MultiProcess support)
+      void SetNWorkers(int nWorkers) { fNWorkers = nWorkers; }
+      int GetNWorkers() const { return fNWorkers; }
+
       /// set the number of bins to create for each axis when constructing the interval
       virtual void SetNumBins(Int_t numBins) { fNumBins = numBins; }
       /// set which variables to put on each axis
@@ -177,6 +187,8 @@ namespace RooStats {
       Int_t fNumBurnInSteps = 0; ///< number of iterations to discard as burn-in, starting from the first
       Int_t fNumBins = 0;        ///< set the number of bins to create for each
                                  ///< axis when constructing the interval
+      Int_t fNumChains = 1;      ///< number of independent chains that are merged
+      int fNWorkers = 1;         ///<! number of worker processes for the chains
       RooArgList * fAxes;    ///< which variables to put on each axis
       bool fUseKeys = false; ///< whether to use kernel estimation to determine interval
       bool fUseSparseHist = false; ///< whether to use sparse histogram (if using hist at all)
@@ -201,7 +213,7 @@ namespace RooStats {
          }
       }
 
-      ClassDefOverride(MCMCCalculator,4) // Markov Chain Monte Carlo calculator for Bayesian credible intervals
+      ClassDefOverride(MCMCCalculator,5) // Markov Chain Monte Carlo calculator for Bayesian credible intervals
    };
 }
 
@@ -21,6 +21,8 @@
 #include "RooDataHist.h"
 #include "THnSparse.h"
 
+#include <vector>
+
 namespace RooStats {
 
    class MarkovChain : public TNamed {
@@ -39,6 +41,11 @@ namespace RooStats {
       virtual void AddWithBurnIn(MarkovChain& otherChain, Int_t burnIn = 0);
       /// add another markov chain
       virtual void Add(MarkovChain& otherChain, double discardEntries = 0.0);
+      /// add many entries at once, given as one column of values per chain
+      /// parameter, discarding the first burnIn entries
+      virtual void AddColumns(const std::vector<std::vector<double>>& paramValues,
+                              const std::vector<double>& nllValues, const std::vector<double>& weights,
+                              Int_t burnIn = 0);
       /// set which of your parameters this chain should store
       virtual void SetParameters(RooArgSet& parameters);
       /// get the number of steps in the chain
@@ -19,6 +19,8 @@
 #include "RooStats/ProposalFunction.h"
 #include "RooStats/MarkovChain.h"
 
+#include <vector>
+
 namespace RooStats {
 
    class MetropolisHastings :  public TObject {
@@ -53,9 +55,22 @@ namespace RooStats {
       virtual void SetNumIters(Int_t numIters)
       { fNumIters = numIters; }
       /// set the number of steps in the chain to discard as burn-in,
-      /// starting from the first
+      /// starting from the first. This is only done by ConstructChain() if
+      /// there are multiple chains, where it is applied to each chain before
+      /// they are merged.
       virtual void SetNumBurnInSteps(Int_t numBurnInSteps)
       { fNumBurnInSteps = numBurnInSteps; }
+      /// set the number of independent chains with numIters iterations each,
+      /// which are merged into the chain returned by ConstructChain()
+      virtual void SetNumChains(Int_t numChains)
+      { fNumChains = numChains; }
+      /// Number of forked worker processes to construct the chains in
+      /// parallel. Each chain gets its own deterministic random number
+      /// stream, so the result doesn't depend on the number of workers.
+      /// Requires RooFit to be built with `roofit_multiprocess=ON`,
+      /// otherwise the chains are constructed serially.
+      void SetNWorkers(int nWorkers) { fNWorkers = nWorkers; }
+      int GetNWorkers() const { return fNWorkers; }
       /// set the (likelihood) function
       virtual void SetFunction(RooAbsReal& function) { fFunction = &function; }
       /// set the sign of the function
@@ -73,12 +88,18 @@ namespace RooStats {
       Int_t fNumBurnInSteps = 0;             ///< number of iterations to discard as burn-in, starting from the first
       enum FunctionSign fSign = kSignUnset;  ///< whether the likelihood is negative (like NLL) or positive
       enum FunctionType fType = kTypeUnset;  ///< whether the likelihood is on a regular, log, (or other) scale
+      Int_t fNumChains = 1;                  ///< number of independent chains that are merged
+      int fNWorkers = 1;                     ///<! number of worker processes for the chains
 
       // whether we should take the step, based on the value of d, fSign, fType
       virtual bool ShouldTakeStep(double d);
       virtual double CalcNLL(double xL);
 
-      ClassDefOverride(MetropolisHastings,2) // Markov Chain Monte Carlo calculator for Bayesian credible intervals
+      bool RunChain(std::vector<std::vector<double>>& paramValues, std::vector<double>& nllValues,
+                    std::vector<double>& weights, bool verbose);
+      bool RunChainsMultiProcess(MarkovChain& chain, ULong64_t seedBase, std::size_t& numAccepted);
+
+      ClassDefOverride(MetropolisHastings,3) // Markov Chain Monte Carlo calculator for Bayesian credible intervals
    };
 }
 
@@ -60,7 +60,7 @@ namespace RooStats {
       /// propose a new point.
       virtual void AddMapping(RooRealVar& proposalParam, RooAbsReal& update);
 
-      virtual void Reset()
+      void Reset() override
       {
          fCache.reset();
          fCachePosition = 0;
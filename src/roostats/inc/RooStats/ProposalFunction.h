@@ -57,6 +57,10 @@ the proposal density to maintain detailed balance.
       /// point x2
       virtual double GetProposalDensity(RooArgSet& x1, RooArgSet& x2) = 0;
 
+      /// Reset any internal state, like cached proposals, such that the
+      /// proposals for a new chain don't depend on the previous chains
+      virtual void Reset() {}
+
       /// Check the parameters for which the ProposalFunction will
       /// propose values to make sure they are all RooRealVars
       /// Return true if all objects are RooRealVars, false otherwise
@@ -31,6 +31,11 @@ class ToyMCImportanceSampler: public ToyMCSampler {
       /// ToyMCSampler::GetSamplingDistributionsSingleWorker(paramPoint).
       RooDataSet* GetSamplingDistributionsSingleWorker(RooArgSet& paramPoint) override;
 
+      /// The importance sampling loop is always run serially.
+      RooDataSet* GetSamplingDistributions(RooArgSet& paramPoint) override {
+         return GetSamplingDistributionsSingleWorker(paramPoint);
+      }
+
       using ToyMCSampler::GenerateToyData;
       RooAbsData* GenerateToyData(RooArgSet& paramPoint, double& weight) const override;
       virtual RooAbsData* GenerateToyData(RooArgSet& paramPoint, double& weight, std::vector<double>& impNLLs, double& nullNLL) const;
@@ -50,6 +50,9 @@ class NuisanceParametersSampler {
 
       void NextPoint(RooArgSet& nuisPoint, double& weight);
 
+      /// Continue with the point at the given index (modulo the number of points).
+      void SetIndex(Int_t index) { fIndex = fNToys > 0 ? index % fNToys : 0; }
+
    protected:
       void Refresh();
 
@@ -78,6 +81,7 @@ class ToyMCSampler: public TestStatSampler {
       SamplingDistribution* GetSamplingDistribution(RooArgSet& paramPoint) override;
       virtual RooDataSet* GetSamplingDistributions(RooArgSet& paramPoint);
       virtual RooDataSet* GetSamplingDistributionsSingleWorker(RooArgSet& paramPoint);
+      virtual RooDataSet* GetSamplingDistributionsMultiProcess(RooArgSet& paramPoint);
 
       virtual SamplingDistribution* AppendSamplingDistribution(
          RooArgSet& allParameters,
@@ -135,6 +139,22 @@ class ToyMCSampler: public TestStatSampler {
          RooArgSet& /*nuisanceParameters*/
       ) override {}
 
+      /// Number of forked worker processes used to generate and evaluate the
+      /// toys. With more than one worker, the toys are distributed with
+      /// RooFit::MultiProcess and each toy gets its own deterministic seed, so
+      /// the result does not depend on the number of workers. Requires RooFit
+      /// to be built with `roofit_multiprocess=ON`, otherwise the toys are run
+      /// serially.
+      void SetNWorkers(int nWorkers) { fNWorkers = nWorkers; }
+      int GetNWorkers() const { return fNWorkers; }
+
+      /// Generate also the toys of serial runs with one RooRandom stream per
+      /// toy, like in the parallel runs, such that serial and parallel runs give
+      /// the same toys. By default, serial runs draw all toys from the global
+      /// random generator as in previous releases.
+      void SetReproducibleToys(bool flag = true) { fReproducibleToys = flag; }
+      bool GetReproducibleToys() const { return fReproducibleToys; }
+
       virtual Int_t GetNToys(void) { return fNToys; }
       virtual void SetNToys(const Int_t ntoy) { fNToys = ntoy; }
       /// Forces the generation of exactly `n` events even for extended PDFs. Set to 0 to
@@ -235,6 +255,13 @@ class ToyMCSampler: public TestStatSampler {
 
       const RooArgList* EvaluateAllTestStatistics(RooAbsData& data, const RooArgSet& poi, DetailedOutputAggregator& detOutAgg);
 
+      /// helper for GetSamplingDistributions: generates one toy and evaluates all test statistics on it
+      const RooArgList* EvaluateToy(Int_t iToy, RooArgSet& paramPoint, RooArgSet& allVars, const RooArgSet& saveAll,
+                                    double& weight, DetailedOutputAggregator& detOutAgg);
+
+      /// helper for GetSamplingDistributionsMultiProcess: positions the nuisance parameter sampler for one toy
+      void PrepareToy(Int_t iToy) const;
+
       /// helper for GenerateToyData
       std::unique_ptr<RooAbsData> Generate(RooAbsPdf &pdf, RooArgSet &observables, const RooAbsData *protoData=nullptr, int forceEvents=0) const;
 
@@ -274,6 +301,9 @@ class ToyMCSampler: public TestStatSampler {
 
       const RooAbsData *fProtoData = nullptr; ///< in dev
 
+      int fNWorkers = 1; ///< number of worker processes for the toys
+      bool fReproducibleToys = false; ///< use one RooRandom stream per toy also in serial runs
+
       mutable NuisanceParametersSampler *fNuisanceParametersSampler = nullptr; ///<!
 
       // objects below cache information and are mutable and non-persistent
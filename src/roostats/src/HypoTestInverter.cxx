@@ -61,9 +61,17 @@ call HypoTestInverter::UseCLs().
 #include "TCanvas.h"
 #include "TGraphErrors.h"
 
+#ifdef ROOFIT_MULTIPROCESS
+#include "RooFit/MultiProcess/Config.h"
+#include "RooFit/MultiProcess/IndexedTaskJob.h"
+#include "TBufferFile.h"
+#endif
+
 #include <cassert>
 #include <cmath>
+#include <limits>
 #include <memory>
+#include <optional>
 
 
 using namespace RooStats;
@@ -86,6 +94,30 @@ struct HypoTestWrapper {
 
 };
 
+namespace {
+
+// Runs the toys of a ToyMCSampler with a single worker during its lifetime,
+// and restores the number of workers afterwards, also in case of exceptions.
+class SingleWorkerToysRAII {
+public:
+   SingleWorkerToysRAII(ToyMCSampler *sampler) : _sampler{sampler}, _nWorkers{sampler ? sampler->GetNWorkers() : 1}
+   {
+      if (_sampler) _sampler->SetNWorkers(1);
+   }
+   ~SingleWorkerToysRAII()
+   {
+      if (_sampler) _sampler->SetNWorkers(_nWorkers);
+   }
+   SingleWorkerToysRAII(const SingleWorkerToysRAII &) = delete;
+   SingleWorkerToysRAII &operator=(const SingleWorkerToysRAII &) = delete;
+
+private:
+   ToyMCSampler *_sampler = nullptr;
+   int _nWorkers = 1;
+};
+
+} // namespace
+
 ////////////////////////////////////////////////////////////////////////////////
 /// get  the variable to scan
 /// try first with null model if not go to alternate model
@@ -395,6 +427,8 @@ HypoTestInverter & HypoTestInverter::operator= (const HypoTestInverter & rhs) {
    fXmin = rhs.fXmin;
    fXmax = rhs.fXmax;
    fNumErr = rhs.fNumErr;
+   fNWorkers = rhs.fNWorkers;
+   fReproducibleScan = rhs.fReproducibleScan;
 
    return *this;
 }
@@ -633,6 +667,7 @@ bool HypoTestInverter::RunFixedScan( int nBins, double xMin, double xMax, bool s
      return false;
    }
 
+   std::vector<double> xValues(nBins);
    double thisX = xMin;
    for (int i=0; i<nBins; i++) {
 
@@ -643,22 +678,119 @@ bool HypoTestInverter::RunFixedScan( int nBins, double xMin, double xMax, bool s
             thisX = xMin + i * (xMax - xMin) / (nBins - 1); // linear scan in x
       }
       }
+      xValues[i] = thisX;
+   }
+
+   if (fNWorkers > 1 && nBins > 1) {
+      RunFixedScanMultiProcess(xValues);
+      return true;
+   }
+
+   // If requested, seed each point like in the parallel scan, so the result
+   // of toy-based scans doesn't depend on the number of workers.
+   const ULong_t seedBase = fReproducibleScan ? RooRandom::integer(std::numeric_limits<UInt_t>::max()) : 0;
 
-      const bool status = RunOnePoint(thisX);
+   for (std::size_t i = 0; i < xValues.size(); ++i) {
+      const double x = xValues[i];
+      std::optional<RooRandom::StreamScope> pointStream;
+      if (fReproducibleScan) pointStream.emplace(i, 0, seedBase);
+      const bool status = RunOnePoint(x);
 
       // check if failed status
       if ( status==false ) {
-        oocoutW(nullptr,Eval) << "HypoTestInverter::RunFixedScan - The hypo test for point " << thisX << " failed. Skipping." << std::endl;
+        oocoutW(nullptr,Eval) << "HypoTestInverter::RunFixedScan - The hypo test for point " << x << " failed. Skipping." << std::endl;
       }
    }
 
    return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Run the points of a fixed scan in parallel on `fNWorkers` forked processes
+/// with RooFit::MultiProcess. Each worker runs the hypothesis test with its
+/// own copy of the calculator and the models, which it got when it was
+/// forked. Each point is evaluated with its own counter-based RooRandom
+/// stream, which is defined by the point index and a seed that is drawn from
+/// RooRandom when this function is called, like in the serial scan with
+/// SetReproducibleScan(). The results are sent back serialized and added to
+/// the HypoTestInverterResult in scan order, so the result does not depend on
+/// the number of workers.
+
+void HypoTestInverter::RunFixedScanMultiProcess(std::vector<double> const &xValues) const
+{
+#ifndef ROOFIT_MULTIPROCESS
+   oocoutW(nullptr, InputArguments)
+      << "HypoTestInverter: RooFit was built without MultiProcess support, running the scan with a single worker. "
+         "Please recompile with -Droofit_multiprocess=ON for parallel scans."
+      << std::endl;
+   const ULong_t seedBase = RooRandom::integer(std::numeric_limits<UInt_t>::max());
+   for (std::size_t i = 0; i < xValues.size(); ++i) {
+      RooRandom::StreamScope pointStream{i, 0, seedBase};
+      if (!RunOnePoint(xValues[i])) {
+         oocoutW(nullptr,Eval) << "HypoTestInverter::RunFixedScan - The hypo test for point " << xValues[i] << " failed. Skipping." << std::endl;
+      }
+   }
+#else
+   // The workers can't fork again, so the toys of each point are run serially.
+   SingleWorkerToysRAII singleWorkerToys{dynamic_cast<ToyMCSampler *>(fCalculator0->GetTestStatSampler())};
+
+   RooFit::MultiProcess::Config::LocalDefaultNWorkers localNWorkers{static_cast<unsigned int>(fNWorkers)};
+
+   const ULong_t seedBase = RooRandom::integer(std::numeric_limits<UInt_t>::max());
+
+   RooFit::MultiProcess::IndexedTaskJob job{[&](std::size_t iPoint, std::vector<char> &buffer) {
+      RooRandom::StreamScope pointStream{iPoint, 0, seedBase};
+      double rVal = xValues[iPoint];
+      std::unique_ptr<HypoTestResult> result = EvalOnePoint(rVal, false, -1);
+      if (!result) return false;
+      TBufferFile outBuffer{TBuffer::kWrite};
+      outBuffer.WriteObject(result.get());
+      buffer.assign(outBuffer.Buffer(), outBuffer.Buffer() + outBuffer.Length());
+      return true;
+   }};
+
+   job.run(0, xValues.size());
+
+   for (std::size_t i = 0; i < xValues.size(); ++i) {
+      auto &pointResult = job.results()[i];
+      std::unique_ptr<HypoTestResult> result;
+      if (pointResult.valid) {
+         TBufferFile inBuffer{TBuffer::kRead, static_cast<Int_t>(pointResult.buffer.size()), pointResult.buffer.data(),
+                              false};
+         result.reset(static_cast<HypoTestResult *>(inBuffer.ReadObject(HypoTestResult::Class())));
+      }
+      if (!result) {
+         oocoutW(nullptr,Eval) << "HypoTestInverter::RunFixedScan - The hypo test for point " << xValues[i] << " failed. Skipping." << std::endl;
+         continue;
+      }
+      // the toys were counted in the worker processes
+      if ((fCalcType == kFrequentist || fCalcType == kHybrid) && result->GetNullDistribution() &&
+          result->GetAltDistribution()) {
+         fTotalToysRun += (result->GetAltDistribution()->GetSize() + result->GetNullDistribution()->GetSize());
+      }
+      AddResult(xValues[i], std::move(result));
+   }
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// run only one point at the given POI value
 
 bool HypoTestInverter::RunOnePoint( double rVal, bool adaptive, double clTarget) const
+{
+   std::unique_ptr<HypoTestResult> result = EvalOnePoint(rVal, adaptive, clTarget);
+   if (!result) return false;
+
+   AddResult(rVal, std::move(result));
+   return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Run the hypothesis test at the given POI value, which is moved inside the
+/// range of the scanned variable if needed. Returns a null pointer if the
+/// test failed or gave an invalid result.
+
+std::unique_ptr<HypoTestResult> HypoTestInverter::EvalOnePoint(double &rVal, bool adaptive, double clTarget) const
 {
 
    CreateResults();
@@ -701,7 +833,7 @@ bool HypoTestInverter::RunOnePoint( double rVal, bool adaptive, double clTarget)
    if (!result) {
       oocoutE(nullptr,Eval) << "HypoTestInverter - Error running point " << fScannedVariable->GetName() << " = " <<
    fScannedVariable->getVal() << std::endl;
-      return false;
+      return nullptr;
    }
    // in case of a dummy result
    const double nullPV = result->NullPValue();
@@ -709,9 +841,22 @@ bool HypoTestInverter::RunOnePoint( double rVal, bool adaptive, double clTarget)
    if (!std::isfinite(nullPV) || nullPV < 0. || nullPV > 1. || !std::isfinite(altPV) || altPV < 0. || altPV > 1.) {
       oocoutW(nullptr,Eval) << "HypoTestInverter - Skipping invalid result for  point " << fScannedVariable->GetName() << " = " <<
          fScannedVariable->getVal() << ". null p-value=" << nullPV << ", alternate p-value=" << altPV << std::endl;
-      return false;
+      return nullptr;
    }
 
+   fScannedVariable->setVal(oldValue);
+
+   return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Add the result for the given POI value to the HypoTestInverterResult. If
+/// the last point has the same value, the results are merged.
+
+void HypoTestInverter::AddResult(double rVal, std::unique_ptr<HypoTestResult> result) const
+{
+   CreateResults();
+
    double lastXtested;
    if ( fResults->ArraySize()!=0 ) lastXtested = fResults->GetXValue(fResults->ArraySize()-1);
    else lastXtested = -999;
@@ -741,10 +886,6 @@ bool HypoTestInverter::RunOnePoint( double rVal, bool adaptive, double clTarget)
      fResults->fYObjects.Add(result.release());
 
    }
-
-   fScannedVariable->setVal(oldValue);
-
-   return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -182,6 +182,11 @@ MCMCInterval* MCMCCalculator::GetInterval() const
    if (!fChainParams.empty()) mh.SetChainParameters(fChainParams);
    mh.SetProposalFunction(*fPropFunc);
    mh.SetNumIters(fNumIters);
+   mh.SetNumChains(fNumChains);
+   mh.SetNWorkers(fNWorkers);
+   // with several chains, the burn-in steps are removed from each chain
+   if (fNumChains > 1)
+      mh.SetNumBurnInSteps(fNumBurnInSteps);
 
    MarkovChain* chain = mh.ConstructChain();
 
@@ -189,7 +194,7 @@ MCMCInterval* MCMCCalculator::GetInterval() const
    MCMCInterval* interval = new MCMCInterval(name, fPOI, *chain);
    if (fAxes != nullptr)
       interval->SetAxes(*fAxes);
-   if (fNumBurnInSteps > 0)
+   if (fNumBurnInSteps > 0 && fNumChains <= 1)
       interval->SetNumBurnInSteps(fNumBurnInSteps);
    interval->SetUseKeys(fUseKeys);
    interval->SetUseSparseHist(fUseSparseHist);
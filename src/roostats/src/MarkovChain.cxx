@@ -28,8 +28,11 @@ MarkovChain.
 #include "RooRealVar.h"
 #include "RooStats/RooStatsUtils.h"
 #include "RooDataHist.h"
+#include "RooVectorDataStore.h"
 #include "THnSparse.h"
 
+#include <algorithm>
+
 
 using namespace RooFit;
 using namespace RooStats;
@@ -116,6 +119,59 @@ void MarkovChain::Add(MarkovChain& otherChain, double discardEntries)
    }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Add many entries at once. The values are appended directly to the columns
+/// of the underlying dataset if it uses the vector storage, which is much
+/// faster than adding the entries one by one. The chain needs to be
+/// constructed with parameters, or SetParameters() needs to be called first.
+/// \param paramValues Values of the chain parameters, with one column per
+///        parameter in the order in which they were passed to SetParameters().
+/// \param nllValues NLL values of the entries.
+/// \param weights Weights of the entries.
+/// \param burnIn Number of entries at the beginning of the columns to discard.
+
+void MarkovChain::AddColumns(const std::vector<std::vector<double>>& paramValues,
+                             const std::vector<double>& nllValues, const std::vector<double>& weights, Int_t burnIn)
+{
+   const std::size_t nEntries = weights.size();
+   const std::size_t first = std::min(static_cast<std::size_t>(std::max(burnIn, 0)), nEntries);
+
+   // Find the column for each vector in the data store
+   auto *store = dynamic_cast<RooVectorDataStore *>(fChain->store());
+   std::vector<std::pair<RooVectorDataStore::RealVector *, const std::vector<double> *>> columns;
+   if (store && store->realfStoreList().empty() && store->catStoreList().empty()) {
+      for (auto *realVec : store->realStoreList()) {
+         const std::string name = realVec->bufArg()->GetName();
+         const Int_t iParam = fParameters->index(name.c_str());
+         if (name == NLL_NAME) {
+            columns.emplace_back(realVec, &nllValues);
+         } else if (name == WEIGHT_NAME) {
+            columns.emplace_back(realVec, &weights);
+         } else if (iParam >= 0) {
+            columns.emplace_back(realVec, &paramValues[iParam]);
+         }
+      }
+   }
+
+   if (columns.size() == fParameters->size() + 2) {
+      for (auto &column : columns) {
+         std::vector<double> &vec = column.first->data();
+         vec.insert(vec.end(), column.second->begin() + first, column.second->begin() + nEntries);
+      }
+      store->recomputeSumWeight();
+      return;
+   }
+
+   // Otherwise, fall back to adding the entries one by one
+   for (std::size_t i = first; i < nEntries; ++i) {
+      for (std::size_t iParam = 0; iParam < fParameters->size(); ++iParam) {
+         fDataEntry->setRealValue((*fParameters)[iParam]->GetName(), paramValues[iParam][i]);
+      }
+      fNLL->setVal(nllValues[i]);
+      fChain->addFast(*fDataEntry, weights[i]);
+   }
+}
+
 void MarkovChain::AddFast(RooArgSet& entry, double nllValue, double weight)
 {
    RooStats::SetParameters(&entry, fDataEntry);
@@ -38,6 +38,17 @@ a MarkovChain.
 Also note that in ConstructChain(), the values of the variables are randomized
 uniformly over their intervals before construction of the MarkovChain begins.
 
+With SetNumChains(), several independent chains of SetNumIters() steps each are
+constructed, and the first SetNumBurnInSteps() steps of every chain are
+discarded before the chains are merged into one MarkovChain. Each chain uses
+its own RooRandom stream, which is derived from the chain index and a seed
+drawn from RooRandom::randomGenerator(), so the chains are reproducible for a
+given seed. With SetNWorkers(), the chains are constructed in parallel on
+forked worker processes if RooFit was built with MultiProcess support. The
+proposal function is reset with ProposalFunction::Reset() before every
+chain, such that internal state like the cache of the PdfProposal doesn't
+depend on which chains were constructed before by the same process.
+
 */
 
 #include "RooStats/MetropolisHastings.h"
@@ -57,6 +68,15 @@ uniformly over their intervals before construction of the MarkovChain begins.
 #include "RooRandom.h"
 #include "TMath.h"
 
+#ifdef ROOFIT_MULTIPROCESS
+#include "RooFit/MultiProcess/Config.h"
+#include "RooFit/MultiProcess/IndexedTaskJob.h"
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
 
 using namespace RooFit;
 using namespace RooStats;
@@ -90,22 +110,10 @@ MarkovChain* MetropolisHastings::ConstructChain()
 
    if (fChainParams.empty()) fChainParams.add(fParameters);
 
-   RooArgSet x;
-   RooArgSet xPrime;
-   x.addClone(fParameters);
-   RandomizeCollection(x);
-   xPrime.addClone(fParameters);
-   RandomizeCollection(xPrime);
-
    MarkovChain* chain = new MarkovChain();
    // only the POI will be added to the chain
    chain->SetParameters(fChainParams);
 
-   Int_t weight = 0;
-   double xL = 0.0;
-   double xPrimeL = 0.0;
-   double a = 0.0;
-
    // ibucur: i think the user should have the possibility to display all the message
    //    levels should they want to; maybe a setPrintLevel would be appropriate
    //    (maybe for the other classes that use this approach as well)?
@@ -121,6 +129,93 @@ MarkovChain* MetropolisHastings::ConstructChain()
      RooAbsReal::clearEvalErrorLog();
    }
 
+   std::vector<std::vector<double>> paramValues;
+   std::vector<double> nllValues;
+   std::vector<double> weights;
+   std::size_t numAccepted = 0;
+   const Int_t numChains = std::max(fNumChains, 1);
+
+   if (numChains == 1) {
+      RunChain(paramValues, nllValues, weights, true);
+      numAccepted = weights.size();
+      chain->AddColumns(paramValues, nllValues, weights);
+   } else {
+      // Each chain gets its own counter-based random number stream, such that
+      // the result doesn't depend on whether the chains run in parallel.
+      const ULong64_t seedBase = RooRandom::integer(std::numeric_limits<UInt_t>::max());
+      if (fNWorkers > 1 && RunChainsMultiProcess(*chain, seedBase, numAccepted)) {
+         // the chains were merged already
+      } else {
+         for (Int_t iChain = 0; iChain < numChains; ++iChain) {
+            RooRandom::StreamScope chainStream{static_cast<ULong64_t>(iChain), 0, seedBase};
+            fPropFunc->Reset();
+            RunChain(paramValues, nllValues, weights, false);
+            numAccepted += weights.size();
+            chain->AddColumns(paramValues, nllValues, weights, fNumBurnInSteps);
+         }
+      }
+   }
+
+   RooMsgService::instance().setGlobalKillBelow(oldMsgLevel);
+
+   coutI(Eval) << "Proposal acceptance rate: " <<
+                   numAccepted/(Float_t)(fNumIters * numChains) * 100 << "%" << std::endl;
+   coutI(Eval) << "Number of steps in chain: " << chain->Size() << std::endl;
+
+   //TFile chainDataFile("chainData.root", "recreate");
+   //chain->GetDataSet()->Write();
+   //chainDataFile.Close();
+
+   return chain;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Run the Metropolis-Hastings algorithm for one chain, starting from a
+/// random point. The accepted points are stored as columns with the values of
+/// the chain parameters, the NLL values and the weights, which count how
+/// often the chain stayed at each point. Returns `false` if no good starting
+/// point was found.
+
+bool MetropolisHastings::RunChain(std::vector<std::vector<double>>& paramValues, std::vector<double>& nllValues,
+                                  std::vector<double>& weights, bool verbose)
+{
+   RooArgSet x;
+   RooArgSet xPrime;
+   x.addClone(fParameters);
+   RandomizeCollection(x);
+   xPrime.addClone(fParameters);
+   RandomizeCollection(xPrime);
+
+   // The values of the chain parameters are taken from x. Chain parameters
+   // that are not sampled keep their value.
+   std::vector<RooAbsReal const*> chainVars;
+   for (RooAbsArg *param : fChainParams) {
+      RooAbsArg *xParam = x.find(param->GetName());
+      chainVars.push_back(static_cast<RooAbsReal const*>(xParam ? xParam : param));
+   }
+
+   // Preallocate the columns for a typical acceptance rate
+   const std::size_t reserveSize = std::min<std::size_t>(fNumIters / 2 + 1, 1 << 20);
+   paramValues.assign(chainVars.size(), {});
+   for (auto &column : paramValues) column.reserve(reserveSize);
+   nllValues.clear();
+   nllValues.reserve(reserveSize);
+   weights.clear();
+   weights.reserve(reserveSize);
+
+   auto addPoint = [&](double nllValue, double weight) {
+      for (std::size_t k = 0; k < chainVars.size(); ++k) {
+         paramValues[k].push_back(chainVars[k]->getVal());
+      }
+      nllValues.push_back(nllValue);
+      weights.push_back(weight);
+   };
+
+   Int_t weight = 0;
+   double xL = 0.0;
+   double xPrimeL = 0.0;
+   double a = 0.0;
+
    bool hadEvalError = true;
 
    Int_t i = 0;
@@ -155,13 +250,14 @@ MarkovChain* MetropolisHastings::ConstructChain()
       ++i;
    }
 
+   const bool foundStartingPoint = !hadEvalError;
    if(hadEvalError) {
       coutE(Eval) << "Problem finding a good starting point in " <<
                      "MetropolisHastings::ConstructChain() " << std::endl;
    }
 
 
-   ooccoutP((TObject *)nullptr, Generation) << "Metropolis-Hastings progress: ";
+   if (verbose) ooccoutP((TObject *)nullptr, Generation) << "Metropolis-Hastings progress: ";
 
    // do main loop
    for (i = 0; i < fNumIters; i++) {
@@ -169,7 +265,7 @@ MarkovChain* MetropolisHastings::ConstructChain()
       hadEvalError = false;
 
       // print a dot every 1% of the chain construction
-      if (i % (fNumIters / 100) == 0) ooccoutP((TObject*)nullptr, Generation) << ".";
+      if (verbose && i % (fNumIters / 100) == 0) ooccoutP((TObject*)nullptr, Generation) << ".";
 
       fPropFunc->Propose(xPrime, x);
 
@@ -214,7 +310,7 @@ MarkovChain* MetropolisHastings::ConstructChain()
 
          // add the current point with the current weight
          if (weight != 0.0)
-            chain->Add(x, CalcNLL(xL), (double)weight);
+            addPoint(CalcNLL(xL), (double)weight);
 
          // reset the weight and go to xPrime
          weight = 1;
@@ -228,21 +324,104 @@ MarkovChain* MetropolisHastings::ConstructChain()
 
    // make sure to add the last point
    if (weight != 0.0)
-      chain->Add(x, CalcNLL(xL), (double)weight);
-   ooccoutP((TObject *)nullptr, Generation) << std::endl;
+      addPoint(CalcNLL(xL), (double)weight);
+   if (verbose) ooccoutP((TObject *)nullptr, Generation) << std::endl;
 
-   RooMsgService::instance().setGlobalKillBelow(oldMsgLevel);
+   return foundStartingPoint;
+}
 
-   Int_t numAccepted = chain->Size();
-   coutI(Eval) << "Proposal acceptance rate: " <<
-                   numAccepted/(Float_t)fNumIters * 100 << "%" << std::endl;
-   coutI(Eval) << "Number of steps in chain: " << numAccepted << std::endl;
+////////////////////////////////////////////////////////////////////////////////
+/// Construct the chains in parallel on `fNWorkers` forked processes with
+/// RooFit::MultiProcess, and merge them into `chain` in the order of the chain
+/// index after discarding the burn-in steps of each chain. Each chain is
+/// constructed with the counter-based RooRandom stream that is defined by the
+/// chain index and `seedBase`, like in the serial case. The accepted points
+/// are sent back to the master as columns of raw values. Returns `false`
+/// without doing anything if RooFit was built without MultiProcess support,
+/// and without changing `chain` if the result of any chain is missing.
+
+bool MetropolisHastings::RunChainsMultiProcess(MarkovChain& chain, ULong64_t seedBase, std::size_t& numAccepted)
+{
+#ifndef ROOFIT_MULTIPROCESS
+   (void)chain;
+   (void)seedBase;
+   (void)numAccepted;
+   coutW(InputArguments)
+      << "MetropolisHastings: RooFit was built without MultiProcess support, constructing the chains with a single "
+         "worker. Please recompile with -Droofit_multiprocess=ON for parallel chains."
+      << std::endl;
+   return false;
+#else
+   RooFit::MultiProcess::Config::LocalDefaultNWorkers localNWorkers{static_cast<unsigned int>(fNWorkers)};
+
+   // The chains are sent back as the number of points, followed by the
+   // columns with the parameter values, the NLL values and the weights.
+   const std::size_t nColumns = fChainParams.size() + 2;
+
+   RooFit::MultiProcess::IndexedTaskJob job{[&](std::size_t iChain, std::vector<char> &buffer) {
+      RooRandom::StreamScope chainStream{iChain, 0, seedBase};
+      fPropFunc->Reset();
+      std::vector<std::vector<double>> paramValues;
+      std::vector<double> nllValues;
+      std::vector<double> weights;
+      RunChain(paramValues, nllValues, weights, false);
+
+      const std::size_t nPoints = weights.size();
+      buffer.resize(sizeof(std::size_t) + nColumns * nPoints * sizeof(double));
+      char *out = buffer.data();
+      std::memcpy(out, &nPoints, sizeof(std::size_t));
+      out += sizeof(std::size_t);
+      paramValues.push_back(std::move(nllValues));
+      paramValues.push_back(std::move(weights));
+      for (auto const &column : paramValues) {
+         if (nPoints > 0) {
+            std::memcpy(out, column.data(), nPoints * sizeof(double));
+         }
+         out += nPoints * sizeof(double);
+      }
+      return true;
+   }};
+
+   const std::size_t numChains = std::max(fNumChains, 1);
+   job.run(0, numChains);
+
+   // Check all results before merging any chain, such that the chains can
+   // still be constructed serially if a result is missing or truncated.
+   std::vector<std::size_t> chainSizes(numChains);
+   for (std::size_t iChain = 0; iChain < numChains; ++iChain) {
+      auto const &buffer = job.results()[iChain].buffer;
+      if (buffer.size() >= sizeof(std::size_t)) {
+         std::memcpy(&chainSizes[iChain], buffer.data(), sizeof(std::size_t));
+      }
+      if (buffer.size() < sizeof(std::size_t) ||
+          buffer.size() != sizeof(std::size_t) + nColumns * chainSizes[iChain] * sizeof(double)) {
+         coutE(Eval) << "MetropolisHastings: the result of chain " << iChain
+                     << " is missing or incomplete, constructing the chains with a single worker." << std::endl;
+         return false;
+      }
+   }
 
-   //TFile chainDataFile("chainData.root", "recreate");
-   //chain->GetDataSet()->Write();
-   //chainDataFile.Close();
+   for (std::size_t iChain = 0; iChain < numChains; ++iChain) {
+      auto const &buffer = job.results()[iChain].buffer;
+      const std::size_t nPoints = chainSizes[iChain];
+      auto const *in = reinterpret_cast<const double *>(buffer.data() + sizeof(std::size_t));
 
-   return chain;
+      std::vector<std::vector<double>> columns(nColumns);
+      for (auto &column : columns) {
+         column.assign(in, in + nPoints);
+         in += nPoints;
+      }
+      std::vector<double> weights = std::move(columns.back());
+      columns.pop_back();
+      std::vector<double> nllValues = std::move(columns.back());
+      columns.pop_back();
+
+      numAccepted += nPoints;
+      chain.AddColumns(columns, nllValues, weights, fNumBurnInSteps);
+   }
+
+   return true;
+#endif
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -43,8 +43,19 @@ TestStatistic.
 #include "RooSimultaneous.h"
 #include "RooCategory.h"
 
+#ifdef ROOFIT_MULTIPROCESS
+#include "RooFit/MultiProcess/Config.h"
+#include "RooFit/MultiProcess/IndexedTaskJob.h"
+#include "RooFit/MultiProcess/JobManager.h"
+#endif
+
 #include "TMath.h"
 
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <optional>
+
 
 using namespace RooFit;
 using std::endl;
@@ -246,11 +257,49 @@ SamplingDistribution* ToyMCSampler::GetSamplingDistribution(RooArgSet& paramPoin
 RooDataSet* ToyMCSampler::GetSamplingDistributions(RooArgSet& paramPointIn)
 {
    // ======= S I N G L E   R U N ? =======
-   return GetSamplingDistributionsSingleWorker(paramPointIn);
+   if (fNWorkers <= 1) return GetSamplingDistributionsSingleWorker(paramPointIn);
+
+   return GetSamplingDistributionsMultiProcess(paramPointIn);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// This is the main function for serial runs.
+/// Generate toy number `iToy` at the given parameter point and evaluate all
+/// test statistics on it. The values of all variables are reset to `saveAll`
+/// before generating. Returns the current row of the detailed output.
+
+const RooArgList* ToyMCSampler::EvaluateToy(Int_t iToy, RooArgSet& paramPoint, RooArgSet& allVars, const RooArgSet& saveAll,
+                                            double& weight, DetailedOutputAggregator& detOutAgg)
+{
+   // set variables to requested parameter point
+   allVars.assign(saveAll); // important for example for SimpleLikelihoodRatioTestStat
+
+   std::unique_ptr<RooAbsData> toydata{GenerateToyData(paramPoint, weight)};
+   if (iToy == 0 && !fPdf->canBeExtended() && dynamic_cast<RooSimultaneous*>(fPdf)) {
+     const RooArgSet* toySet = toydata->get();
+     if (std::none_of(toySet->begin(), toySet->end(),
+                      [](const RooAbsArg *arg) { return dynamic_cast<const RooAbsCategory *>(arg) != nullptr; })) {
+        oocoutE(nullptr, Generation)
+           << "ToyMCSampler: Generated toy data didn't contain a category variable, although"
+              " a simultaneous PDF is in use. To generate events for a simultaneous PDF, all components need to be"
+              " extended. Otherwise, the number of events to generate per component cannot be determined."
+           << std::endl;
+     }
+   }
+
+   allVars.assign(*fParametersForTestStat);
+
+   const RooArgList* allTS = EvaluateAllTestStatistics(*toydata, *fParametersForTestStat, detOutAgg);
+   if (allTS->size() > fTestStatistics.size())
+     detOutAgg.AppendArgSet( fGlobalObservables, "globObs_" );
+
+   return allTS;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// This is the main function for serial runs. The toys are drawn from the
+/// global random generator, unless SetReproducibleToys() is enabled. Then every
+/// toy is generated with its own counter-based RooRandom stream like in the
+/// parallel runs, such that the result does not depend on the number of workers.
 
 RooDataSet* ToyMCSampler::GetSamplingDistributionsSingleWorker(RooArgSet& paramPointIn)
 {
@@ -273,6 +322,7 @@ RooDataSet* ToyMCSampler::GetSamplingDistributionsSingleWorker(RooArgSet& paramP
    std::unique_ptr<RooArgSet> allVars{fPdf->getVariables()};
    std::unique_ptr<RooArgSet> saveAll{allVars->snapshot()};
 
+   const ULong_t seedBase = fReproducibleToys ? RooRandom::integer(std::numeric_limits<UInt_t>::max()) : 0;
 
    DetailedOutputAggregator detOutAgg;
 
@@ -297,27 +347,12 @@ RooDataSet* ToyMCSampler::GetSamplingDistributionsSingleWorker(RooArgSet& paramP
       double valueFirst = -999.0;
       double weight = 1.0;
 
-      // set variables to requested parameter point
-      allVars->assign(*saveAll); // important for example for SimpleLikelihoodRatioTestStat
-
-      std::unique_ptr<RooAbsData> toydata{GenerateToyData(*paramPoint, weight)};
-      if (i == 0 && !fPdf->canBeExtended() && dynamic_cast<RooSimultaneous*>(fPdf)) {
-        const RooArgSet* toySet = toydata->get();
-        if (std::none_of(toySet->begin(), toySet->end(),
-                         [](const RooAbsArg *arg) { return dynamic_cast<const RooAbsCategory *>(arg) != nullptr; })) {
-           oocoutE(nullptr, Generation)
-              << "ToyMCSampler: Generated toy data didn't contain a category variable, although"
-                 " a simultaneous PDF is in use. To generate events for a simultaneous PDF, all components need to be"
-                 " extended. Otherwise, the number of events to generate per component cannot be determined."
-              << std::endl;
-        }
+      std::optional<RooRandom::StreamScope> toyStream;
+      if (fReproducibleToys) {
+         toyStream.emplace(static_cast<ULong64_t>(i), 0, seedBase);
+         PrepareToy(i);
       }
-
-      allVars->assign(*fParametersForTestStat);
-
-      const RooArgList* allTS = EvaluateAllTestStatistics(*toydata, *fParametersForTestStat, detOutAgg);
-      if (allTS->size() > fTestStatistics.size())
-        detOutAgg.AppendArgSet( fGlobalObservables, "globObs_" );
+      const RooArgList* allTS = EvaluateToy(i, *paramPoint, *allVars, *saveAll, weight, detOutAgg);
       if (RooRealVar* firstTS = dynamic_cast<RooRealVar*>(allTS->first()))
          valueFirst = firstTS->getVal();
 
@@ -338,8 +373,225 @@ RooDataSet* ToyMCSampler::GetSamplingDistributionsSingleWorker(RooArgSet& paramP
 
    // clean up
    allVars->assign(*saveAll);
+   if (fReproducibleToys) {
+      delete fNuisanceParametersSampler;
+      fNuisanceParametersSampler = nullptr;
+   }
+
+   return detOutAgg.GetAsDataSet(fSamplingDistName, fSamplingDistName);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reposition the nuisance parameter sampler for toy number `iToy`, such
+/// that the toy does not depend on which process generates it. Has to be
+/// called while the RooRandom::StreamScope of the toy is alive.
+
+void ToyMCSampler::PrepareToy(Int_t iToy) const
+{
+   if (!fPriorNuisance || !fNuisancePars) return;
+
+   if (fExpectedNuisancePar) {
+      // the expected points don't depend on the seed, so we only have to pick the right one
+      if (!fNuisanceParametersSampler) {
+         fNuisanceParametersSampler = new NuisanceParametersSampler(fPriorNuisance, fNuisancePars, fNToys, true);
+      }
+      fNuisanceParametersSampler->SetIndex(iToy);
+   } else {
+      // draw the nuisance parameter point for this toy from the stream of the toy
+      delete fNuisanceParametersSampler;
+      fNuisanceParametersSampler = new NuisanceParametersSampler(fPriorNuisance, fNuisancePars, 1, false);
+   }
+}
+
+namespace {
+
+// Each toy is transferred between the processes as its weight, followed by
+// the value, symmetric error and asymmetric errors of every column of the
+// detailed output.
+constexpr std::size_t nValuesPerColumn = 4;
+
+void packToy(double weight, const RooArgList &columns, std::vector<char> &buffer)
+{
+   std::vector<double> row{weight};
+   row.reserve(1 + nValuesPerColumn * columns.size());
+   for (RooAbsArg *arg : columns) {
+      if (auto *var = dynamic_cast<RooRealVar *>(arg)) {
+         // use the same sentinel values as removeError() and removeAsymError()
+         const double error = var->hasError() ? var->getError() : -1.;
+         const bool asym = var->hasAsymError();
+         row.insert(row.end(), {var->getVal(), error, asym ? var->getAsymErrorLo() : 1., asym ? var->getAsymErrorHi() : -1.});
+      } else if (auto *cat = dynamic_cast<RooAbsCategory *>(arg)) {
+         row.insert(row.end(), {static_cast<double>(cat->getCurrentIndex()), 0., 0., 0.});
+      } else {
+         double val = arg->InheritsFrom(RooAbsReal::Class()) ? static_cast<RooAbsReal *>(arg)->getVal() : 0.;
+         row.insert(row.end(), {val, 0., 0., 0.});
+      }
+   }
+   buffer.resize(row.size() * sizeof(double));
+   std::memcpy(buffer.data(), row.data(), buffer.size());
+}
+
+bool unpackToy(const std::vector<char> &buffer, RooArgList &columns, double &weight)
+{
+   std::vector<double> row(1 + nValuesPerColumn * columns.size());
+   if (buffer.size() != row.size() * sizeof(double)) return false;
+   std::memcpy(row.data(), buffer.data(), buffer.size());
+
+   weight = row[0];
+   for (std::size_t i = 0; i < columns.size(); ++i) {
+      const double *values = row.data() + 1 + nValuesPerColumn * i;
+      if (auto *var = dynamic_cast<RooRealVar *>(&columns[i])) {
+         var->setVal(values[0]);
+         var->setError(values[1]);
+         var->setAsymError(values[2], values[3]);
+      } else if (auto *cat = dynamic_cast<RooAbsCategoryLValue *>(&columns[i])) {
+         cat->setIndex(static_cast<int>(values[0]));
+      }
+   }
+   return true;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+/// This is the main function for parallel runs. The first toy is generated
+/// on the master process to set up the layout of the output, then the
+/// remaining toys are distributed to `fNWorkers` forked processes with
+/// RooFit::MultiProcess. Every toy is generated with its own counter-based
+/// RooRandom stream, which is defined by the toy index and a seed that is
+/// drawn from RooRandom when this function is called, exactly like in
+/// GetSamplingDistributionsSingleWorker() with SetReproducibleToys(). The results
+/// are merged back in toy order. The result is therefore independent of the number of workers. When adaptive sampling is
+/// used, the toys are dispatched in batches and the stopping condition is
+/// checked in toy order between the batches.
+
+RooDataSet* ToyMCSampler::GetSamplingDistributionsMultiProcess(RooArgSet& paramPointIn)
+{
+#ifndef ROOFIT_MULTIPROCESS
+   oocoutW(nullptr, InputArguments)
+      << "ToyMCSampler: RooFit was built without MultiProcess support, running the toys with a single worker. "
+         "Please recompile with -Droofit_multiprocess=ON for parallel toys."
+      << std::endl;
+   return GetSamplingDistributionsSingleWorker(paramPointIn);
+#else
+   ClearCache();
+
+   if (!CheckConfig()){
+      oocoutE(nullptr, InputArguments)
+         << "Bad COnfiguration in ToyMCSampler "
+         << std::endl;
+      return nullptr;
+   }
+
+   // The workers are forked when the first task is queued, so from then on
+   // they share the state of this process, including the nuisance parameter
+   // sampler and the generator caches. The global default is restored when
+   // the job is done.
+   RooFit::MultiProcess::Config::LocalDefaultNWorkers localNWorkers{static_cast<unsigned int>(fNWorkers)};
+
+   std::unique_ptr<RooArgSet> paramPoint{paramPointIn.snapshot()};
+   std::unique_ptr<RooArgSet> allVars{fPdf->getVariables()};
+   std::unique_ptr<RooArgSet> saveAll{allVars->snapshot()};
+
+   const ULong_t seedBase = fReproducibleToys ? RooRandom::integer(std::numeric_limits<UInt_t>::max()) : 0;
+
+   DetailedOutputAggregator detOutAgg;
+
+   double toysInTails = 0.0;
+
+   // Adds one evaluated toy to the output. Returns false if the loop would
+   // have stopped before this toy in a serial run.
+   auto commitToy = [&](Int_t i, const RooArgList &allTS, double weight) {
+      if (toysInTails >= fToysInTails && i + 1 > fNToys) return false;
+
+      double valueFirst = -999.0;
+      if (auto *firstTS = dynamic_cast<RooRealVar *>(allTS.first()))
+         valueFirst = firstTS->getVal();
+
+      // check for nan
+      if (valueFirst != valueFirst) {
+         oocoutW(nullptr, Generation) << "skip: " << valueFirst << ", " << weight << std::endl;
+         return true;
+      }
+
+      detOutAgg.AppendArgSet(&allTS);
+      detOutAgg.CommitSet(weight);
+
+      // adaptive sampling checks
+      if (valueFirst <= fAdaptiveLowLimit || valueFirst >= fAdaptiveHighLimit) {
+         if (weight >= 0.) toysInTails += weight;
+         else toysInTails += 1.;
+      }
+      return true;
+   };
+
+   if (fMaxToys < 1 || (toysInTails >= fToysInTails && fNToys < 1)) {
+      return detOutAgg.GetAsDataSet(fSamplingDistName, fSamplingDistName);
+   }
+
+   // the first toy is done on the master to find out the columns of the output
+   double weight = 1.0;
+   RooArgList columns;
+   {
+      RooRandom::StreamScope toyStream{0, 0, seedBase};
+      PrepareToy(0);
+      DetailedOutputAggregator firstAgg;
+      columns.addClone(*EvaluateToy(0, *paramPoint, *allVars, *saveAll, weight, firstAgg));
+   }
+   commitToy(0, columns, weight);
+
+   RooFit::MultiProcess::IndexedTaskJob job{[&](std::size_t iToy, std::vector<char> &buffer) {
+      RooRandom::StreamScope toyStream{iToy, 0, seedBase};
+      PrepareToy(iToy);
+      DetailedOutputAggregator toyAgg;
+      double toyWeight = 1.0;
+      const RooArgList *allTS = EvaluateToy(iToy, *paramPoint, *allVars, *saveAll, toyWeight, toyAgg);
+      packToy(toyWeight, *allTS, buffer);
+      return true;
+   }};
+
+   // without adaptive sampling, all toys can be sent off at once
+   const std::size_t batchSize = fToysInTails > 0. ? 4 * fNWorkers : std::numeric_limits<Int_t>::max();
+
+   bool done = false;
+   std::size_t nextToy = 1;
+   while (!done && nextToy < fMaxToys) {
+      std::size_t lastToy = std::max<std::size_t>(nextToy + batchSize, fNToys);
+      if (lastToy > fMaxToys) lastToy = static_cast<std::size_t>(std::ceil(fMaxToys));
+      if (fToysInTails <= 0. && lastToy > static_cast<std::size_t>(fNToys)) lastToy = fNToys;
+
+      job.run(nextToy, lastToy);
+
+      for (std::size_t i = nextToy; i < lastToy; ++i) {
+         double toyWeight = 1.0;
+         if (!unpackToy(job.results()[i].buffer, columns, toyWeight)) {
+            oocoutE(nullptr, Generation) << "ToyMCSampler: toy " << i
+                                         << " returned an unexpected number of test statistic values, skipping it"
+                                         << std::endl;
+            continue;
+         }
+         if (!commitToy(i, columns, toyWeight)) {
+            done = true;
+            break;
+         }
+      }
+      job.results().clear();
+
+      oocoutP(nullptr,Generation) << "generated toys: " << lastToy << " / " << fNToys;
+      if (fToysInTails) ooccoutP(nullptr,Generation) << " (tails: " << toysInTails << " / " << fToysInTails << ")" << std::endl;
+      else ooccoutP(nullptr,Generation) << std::endl;
+
+      nextToy = lastToy;
+      if (toysInTails >= fToysInTails && static_cast<Int_t>(nextToy) >= fNToys) done = true;
+   }
+
+   // clean up
+   allVars->assign(*saveAll);
+   delete fNuisanceParametersSampler;
+   fNuisanceParametersSampler = nullptr;
 
    return detOutAgg.GetAsDataSet(fSamplingDistName, fSamplingDistName);
+#endif
 }
 
 ////////////////////////////////////////////////////////////////////////////////
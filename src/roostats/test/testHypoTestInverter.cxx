@@ -0,0 +1,113 @@
+// Tests for the RooStats::HypoTestInverter
+
+#include "RooDataSet.h"
+#include "RooFit/MultiProcess/Config.h"
+#include "RooRandom.h"
+#include "RooRealVar.h"
+#include "RooWorkspace.h"
+#include "RooStats/AsymptoticCalculator.h"
+#include "RooStats/FrequentistCalculator.h"
+#include "RooStats/HypoTestInverter.h"
+#include "RooStats/HypoTestInverterResult.h"
+#include "RooStats/ModelConfig.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+enum class Calculator { Asymptotic, Frequentist };
+
+std::unique_ptr<RooStats::HypoTestInverterResult>
+runScan(RooWorkspace &ws, int nWorkers, Calculator calcType = Calculator::Asymptotic)
+{
+   RooRealVar &mu = *ws.var("mu");
+   mu.setVal(1.0);
+
+   RooStats::ModelConfig sbModel{"sbModel", &ws};
+   sbModel.SetPdf("model");
+   sbModel.SetObservables("n");
+   sbModel.SetParametersOfInterest("mu");
+   sbModel.SetSnapshot(RooArgSet{mu});
+
+   RooStats::ModelConfig bModel{"bModel", &ws};
+   bModel.SetPdf("model");
+   bModel.SetObservables("n");
+   bModel.SetParametersOfInterest("mu");
+   mu.setVal(0.0);
+   bModel.SetSnapshot(RooArgSet{mu});
+
+   std::unique_ptr<RooStats::HypoTestCalculatorGeneric> calc;
+   if (calcType == Calculator::Asymptotic) {
+      auto asymptCalc = std::make_unique<RooStats::AsymptoticCalculator>(*ws.data("data"), bModel, sbModel);
+      asymptCalc->SetOneSided(true);
+      calc = std::move(asymptCalc);
+   } else {
+      auto freqCalc = std::make_unique<RooStats::FrequentistCalculator>(*ws.data("data"), bModel, sbModel);
+      freqCalc->SetToys(40, 20);
+      calc = std::move(freqCalc);
+   }
+
+   RooStats::HypoTestInverter inverter{*calc};
+   inverter.UseCLs(true);
+   inverter.SetNWorkers(nWorkers);
+   inverter.SetReproducibleScan();
+   inverter.SetFixedScan(6, 0.0, 5.0);
+
+   RooRandom::randomGenerator()->SetSeed(1337);
+   return std::unique_ptr<RooStats::HypoTestInverterResult>{inverter.GetInterval()};
+}
+
+void createWorkspace(RooWorkspace &ws)
+{
+   ws.factory("Poisson::model(n[0, 100], expr::nExp('mu * s + b', mu[1, 0, 10], s[3.0], b[5.0]))");
+   RooDataSet data{"data", "data", RooArgSet{*ws.var("n")}};
+   ws.var("n")->setVal(6);
+   data.add(RooArgSet{*ws.var("n")});
+   ws.import(data);
+}
+
+} // namespace
+
+// The points of a fixed scan that are evaluated in parallel need to be added
+// in scan order, with the same results as in the serial scan.
+TEST(HypoTestInverter, ParallelFixedScan)
+{
+   RooWorkspace ws;
+   createWorkspace(ws);
+
+   std::unique_ptr<RooStats::HypoTestInverterResult> serial = runScan(ws, 1);
+   std::unique_ptr<RooStats::HypoTestInverterResult> parallel = runScan(ws, 3);
+
+   ASSERT_EQ(serial->ArraySize(), 6);
+   ASSERT_EQ(parallel->ArraySize(), serial->ArraySize());
+
+   for (int i = 0; i < serial->ArraySize(); ++i) {
+      EXPECT_DOUBLE_EQ(parallel->GetXValue(i), serial->GetXValue(i)) << "point " << i;
+      EXPECT_NEAR(parallel->CLs(i), serial->CLs(i), 1e-8) << "point " << i;
+   }
+}
+
+// With a reproducible scan, toy-based scans are seeded per point in both the
+// serial and the parallel scan, so the toys must not depend on the number of
+// workers. The global default number of workers must not change.
+TEST(HypoTestInverter, ParallelFixedScanWithToys)
+{
+   RooWorkspace ws;
+   createWorkspace(ws);
+
+   const unsigned int defaultNWorkers = RooFit::MultiProcess::Config::getDefaultNWorkers();
+
+   std::unique_ptr<RooStats::HypoTestInverterResult> serial = runScan(ws, 1, Calculator::Frequentist);
+   std::unique_ptr<RooStats::HypoTestInverterResult> parallel = runScan(ws, 3, Calculator::Frequentist);
+
+   EXPECT_EQ(RooFit::MultiProcess::Config::getDefaultNWorkers(), defaultNWorkers);
+
+   ASSERT_EQ(serial->ArraySize(), 6);
+   ASSERT_EQ(parallel->ArraySize(), serial->ArraySize());
+
+   for (int i = 0; i < serial->ArraySize(); ++i) {
+      EXPECT_DOUBLE_EQ(parallel->GetXValue(i), serial->GetXValue(i)) << "point " << i;
+      EXPECT_DOUBLE_EQ(parallel->CLs(i), serial->CLs(i)) << "point " << i;
+      EXPECT_DOUBLE_EQ(parallel->CLb(i), serial->CLb(i)) << "point " << i;
+   }
+}
@@ -0,0 +1,134 @@
+// Tests for the RooStats::MetropolisHastings class
+
+#include <RooArgSet.h>
+#include <RooFormulaVar.h>
+#include <RooGaussian.h>
+#include <RooGlobalFunc.h>
+#include <RooRandom.h>
+#include <RooRealVar.h>
+#include <RooStats/MarkovChain.h>
+#include <RooStats/MetropolisHastings.h>
+#include <RooStats/PdfProposal.h>
+#include <RooStats/SequentialProposal.h>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+namespace {
+
+std::unique_ptr<RooStats::MarkovChain> constructChain(RooRealVar &x, RooAbsReal &nll, int nChains, int nBurnIn,
+                                                      RooStats::ProposalFunction &proposal)
+{
+   RooStats::MetropolisHastings mh;
+   mh.SetFunction(nll);
+   mh.SetType(RooStats::MetropolisHastings::kLog);
+   mh.SetSign(RooStats::MetropolisHastings::kNegative);
+   mh.SetParameters(x);
+   mh.SetProposalFunction(proposal);
+   mh.SetNumIters(2000);
+   mh.SetNumChains(nChains);
+   mh.SetNumBurnInSteps(nBurnIn);
+   return std::unique_ptr<RooStats::MarkovChain>{mh.ConstructChain()};
+}
+
+std::unique_ptr<RooStats::MarkovChain> constructChain(RooRealVar &x, RooAbsReal &nll, int nChains, int nBurnIn)
+{
+   RooStats::SequentialProposal proposal{10.0};
+   return constructChain(x, nll, nChains, nBurnIn, proposal);
+}
+
+} // namespace
+
+// Check that several chains are merged with the burn-in removed from each
+// chain, and that the merged chain is reproducible for a fixed seed.
+TEST(MetropolisHastings, MultipleChains)
+{
+   RooRealVar x("x", "x", 0.0, -5.0, 5.0);
+   RooFormulaVar nll("nll", "0.5*x*x", x);
+
+   RooRandom::randomGenerator()->SetSeed(4357);
+   std::unique_ptr<RooStats::MarkovChain> singleChain = constructChain(x, nll, 1, 0);
+   ASSERT_NE(singleChain, nullptr);
+
+   // A single chain contains all steps
+   double sumWeights = 0.0;
+   for (int i = 0; i < singleChain->Size(); ++i) {
+      sumWeights += singleChain->Weight(i);
+   }
+   EXPECT_DOUBLE_EQ(sumWeights, 2000.0);
+
+   const int nChains = 4;
+   const int nBurnIn = 20;
+
+   RooRandom::randomGenerator()->SetSeed(4357);
+   std::unique_ptr<RooStats::MarkovChain> chain1 = constructChain(x, nll, nChains, nBurnIn);
+   RooRandom::randomGenerator()->SetSeed(4357);
+   std::unique_ptr<RooStats::MarkovChain> chain2 = constructChain(x, nll, nChains, nBurnIn);
+   ASSERT_NE(chain1, nullptr);
+   ASSERT_NE(chain2, nullptr);
+
+   ASSERT_EQ(chain1->Size(), chain2->Size());
+   EXPECT_GT(chain1->Size(), 0);
+   EXPECT_LT(chain1->Size(), nChains * (2000 - nBurnIn));
+
+   double sumW = 0.0;
+   double sumWX = 0.0;
+   double sumWXX = 0.0;
+   for (int i = 0; i < chain1->Size(); ++i) {
+      const double x1 = chain1->Get(i)->getRealValue("x");
+      EXPECT_EQ(x1, chain2->Get(i)->getRealValue("x"));
+      EXPECT_EQ(chain1->Weight(i), chain2->Weight(i));
+      EXPECT_EQ(chain1->NLL(i), chain2->NLL(i));
+      EXPECT_DOUBLE_EQ(chain1->NLL(i), 0.5 * x1 * x1);
+
+      const double w = chain1->Weight(i);
+      sumW += w;
+      sumWX += w * x1;
+      sumWXX += w * x1 * x1;
+   }
+
+   // The chains sample a standard normal distribution
+   const double mean = sumWX / sumW;
+   EXPECT_NEAR(mean, 0.0, 0.2);
+   EXPECT_NEAR(sumWXX / sumW - mean * mean, 1.0, 0.2);
+}
+
+// Check that the proposal function is reset before every chain, such that a
+// PdfProposal with proposals left in its cache from previous chains gives the
+// same merged chain as a new one. Otherwise, the result of the parallel
+// construction would depend on which chains are constructed by each worker.
+TEST(MetropolisHastings, MultipleChainsResetProposal)
+{
+   RooRealVar x("x", "x", 0.0, -5.0, 5.0);
+   RooFormulaVar nll("nll", "0.5*x*x", x);
+   RooGaussian proposalPdf("proposalPdf", "proposalPdf", x, RooFit::RooConst(0.0), RooFit::RooConst(2.0));
+
+   // The cache size doesn't divide the number of steps, so there are cached
+   // proposals left at the end of every chain.
+   auto makeProposal = [&]() {
+      auto proposal = std::make_unique<RooStats::PdfProposal>(proposalPdf);
+      proposal->SetCacheSize(300);
+      return proposal;
+   };
+
+   const int nChains = 3;
+   const int nBurnIn = 20;
+
+   std::unique_ptr<RooStats::PdfProposal> newProposal = makeProposal();
+   RooRandom::randomGenerator()->SetSeed(4357);
+   std::unique_ptr<RooStats::MarkovChain> chain1 = constructChain(x, nll, nChains, nBurnIn, *newProposal);
+
+   std::unique_ptr<RooStats::PdfProposal> usedProposal = makeProposal();
+   constructChain(x, nll, 1, 0, *usedProposal);
+   RooRandom::randomGenerator()->SetSeed(4357);
+   std::unique_ptr<RooStats::MarkovChain> chain2 = constructChain(x, nll, nChains, nBurnIn, *usedProposal);
+
+   ASSERT_NE(chain1, nullptr);
+   ASSERT_NE(chain2, nullptr);
+   ASSERT_EQ(chain1->Size(), chain2->Size());
+   for (int i = 0; i < chain1->Size(); ++i) {
+      EXPECT_EQ(chain1->Get(i)->getRealValue("x"), chain2->Get(i)->getRealValue("x"));
+      EXPECT_EQ(chain1->Weight(i), chain2->Weight(i));
+   }
+}
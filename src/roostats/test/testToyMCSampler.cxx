@@ -0,0 +1,74 @@
+// Tests for the RooStats::ToyMCSampler
+
+#include "RooFit/MultiProcess/Config.h"
+#include "RooRandom.h"
+#include "RooRealVar.h"
+#include "RooWorkspace.h"
+#include "RooStats/ProfileLikelihoodTestStat.h"
+#include "RooStats/ToyMCSampler.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::unique_ptr<RooDataSet> runToys(RooWorkspace &ws, int nWorkers)
+{
+   RooAbsPdf &pdf = *ws.pdf("model");
+   RooRealVar &mu = *ws.var("mu");
+   RooArgSet poi{mu};
+
+   RooStats::ProfileLikelihoodTestStat testStat{pdf};
+   RooStats::ToyMCSampler sampler{testStat, 50};
+   sampler.SetPdf(pdf);
+   sampler.SetObservables(RooArgSet{*ws.var("x")});
+   sampler.SetParametersForTestStat(poi);
+   sampler.SetNEventsPerToy(100);
+   sampler.SetNWorkers(nWorkers);
+   sampler.SetReproducibleToys();
+
+   RooRandom::randomGenerator()->SetSeed(1337);
+   return std::unique_ptr<RooDataSet>{sampler.GetSamplingDistributions(poi)};
+}
+
+void expectSameToys(const RooDataSet &result, const RooDataSet &reference)
+{
+   ASSERT_EQ(result.numEntries(), reference.numEntries());
+
+   for (int i = 0; i < reference.numEntries(); ++i) {
+      auto *ts1 = static_cast<RooRealVar *>(reference.get(i)->first());
+      double val1 = ts1->getVal();
+      auto *ts2 = static_cast<RooRealVar *>(result.get(i)->first());
+      EXPECT_DOUBLE_EQ(ts2->getVal(), val1) << "toy " << i;
+   }
+}
+
+} // namespace
+
+// With reproducible toys, the toys are seeded individually in both the serial
+// and the parallel mode, so the sampling distribution must not depend on the
+// number of workers.
+TEST(ToyMCSampler, ResultIndependentOfNWorkers)
+{
+   RooWorkspace ws;
+   ws.factory("Gaussian::model(x[-5, 5], mu[0, -3, 3], sigma[1.0])");
+
+   std::unique_ptr<RooDataSet> resultOneWorker = runToys(ws, 1);
+   std::unique_ptr<RooDataSet> resultTwoWorkers = runToys(ws, 2);
+   std::unique_ptr<RooDataSet> resultFourWorkers = runToys(ws, 4);
+
+   ASSERT_EQ(resultOneWorker->numEntries(), 50);
+   expectSameToys(*resultTwoWorkers, *resultOneWorker);
+   expectSameToys(*resultFourWorkers, *resultOneWorker);
+}
+
+// Running the toys in parallel must not change the global default number of
+// workers of RooFit::MultiProcess.
+TEST(ToyMCSampler, DefaultNWorkersRestored)
+{
+   RooWorkspace ws;
+   ws.factory("Gaussian::model(x[-5, 5], mu[0, -3, 3], sigma[1.0])");
+
+   const unsigned int defaultNWorkers = RooFit::MultiProcess::Config::getDefaultNWorkers();
+   runToys(ws, defaultNWorkers + 1);
+   EXPECT_EQ(RooFit::MultiProcess::Config::getDefaultNWorkers(), defaultNWorkers);
+}
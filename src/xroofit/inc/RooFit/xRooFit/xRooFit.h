@@ -51,6 +51,7 @@ class RooWorkspace;
 class TCanvas;
 
 #include <memory>
+#include <string>
 
 BEGIN_XROOFIT_NAMESPACE
 
@@ -110,6 +111,13 @@ public:
    static int minos(RooAbsReal &nll, const RooFitResult &ufit, const char *parName = "",
                     const std::shared_ptr<ROOT::Fit::FitConfig> &_fitConfig = nullptr);
 
+   // Persistent fit cache, shared by all processes that use the same directory: minimize() looks up and stores fit
+   // results there, keyed by a hash of the model structure, the dataset content, the constant parameter values and the
+   // minimizer configuration. Only used for NLLs that know their dataset (i.e. created with xRooNLLVar), and not
+   // while gDirectory is null, like during the fits of toys. An empty path disables the cache (the default).
+   static void SetFitCacheDir(const char *path);
+   static const char *GetFitCacheDir();
+
    // this class is used to store a shared_ptr in a TDirectory's List, so that retrieval of cached fits
    // can share the fit result (and avoid re-reading from disk as well)
    class StoredFitResult : public TNamed {
@@ -219,6 +227,7 @@ public:
 
    static std::shared_ptr<RooLinkedList> sDefaultNLLOptions;
    static std::shared_ptr<ROOT::Fit::FitConfig> sDefaultFitConfig;
+   static std::string sFitCacheDir;
 
    // Run hypothesis test(s) on the given pdf
    // Uses hypoPoint binning on model parameters to determine points to scan
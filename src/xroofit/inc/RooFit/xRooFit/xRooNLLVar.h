@@ -227,6 +227,12 @@ public:
       addCLsToys(int nToys = 1, int seed = 0, double target = std::numeric_limits<double>::quiet_NaN(),
                  double target_nSigma = std::numeric_limits<double>::quiet_NaN()); // if seed=0 will use a random seed
 
+      // number of forked worker processes that generate and fit the toys in parallel (requires RooFit built with
+      // MultiProcess support). With more than one worker, the toy seeds are derived from the seed and the toy index,
+      // so the toys don't depend on the number of workers, but they differ from the ones of the sequential mode
+      void setNWorkers(int nWorkers) { fNWorkers = nWorkers; }
+      int nWorkers() const { return fNWorkers; }
+
       RooArgList poi() const;
       RooArgList alt_poi() const; // values of the poi in the alt hypothesis (will be nans if not defined)
       RooRealVar &mu_hat();       // throws exception if ufit not available
@@ -284,6 +290,8 @@ public:
       TString tsTitle(bool inWords = false) const;
 
    private:
+      int fNWorkers = 1;
+
       xValueWithError pX_toys(bool alt, double nSigma = std::numeric_limits<double>::quiet_NaN());
       size_t addToys(bool alt, int nToys, int initialSeed = 0, double target = std::numeric_limits<double>::quiet_NaN(),
                      double target_nSigma = std::numeric_limits<double>::quiet_NaN(), bool targetCLs = false,
@@ -0,0 +1,285 @@
+/*
+ * Project: xRooFit
+ *
+ * Copyright (c) 2024, CERN
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted according to the terms
+ * listed in LICENSE (http://roofit.sourceforge.net/license.txt)
+ */
+
+#include "FitCache.h"
+
+#include "RooAbsCategory.h"
+#include "RooAbsData.h"
+#include "RooAbsReal.h"
+#include "RooArgSet.h"
+#include "RooDataHist.h"
+#include "RooFitResult.h"
+#include "RooHistFunc.h"
+#include "RooHistPdf.h"
+#include "RooRealVar.h"
+#include "RooStringVar.h"
+
+#include "Fit/FitConfig.h"
+#include "Math/IOptions.h"
+
+#include "TDirectory.h"
+#include "TFile.h"
+#include "TMD5.h"
+#include "TSystem.h"
+#include "TUUID.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <vector>
+
+BEGIN_XROOFIT_NAMESPACE
+
+namespace FitCache {
+
+namespace {
+
+class Hasher {
+public:
+   void add(std::string const &s)
+   {
+      add(s.size());
+      fMD5.Update(reinterpret_cast<const UChar_t *>(s.data()), s.size());
+   }
+   void add(const char *s) { add(std::string{s ? s : ""}); }
+   void add(double x) { fMD5.Update(reinterpret_cast<const UChar_t *>(&x), sizeof(double)); }
+   void add(std::size_t n) { fMD5.Update(reinterpret_cast<const UChar_t *>(&n), sizeof(std::size_t)); }
+   void add(int i) { fMD5.Update(reinterpret_cast<const UChar_t *>(&i), sizeof(int)); }
+   template <class T>
+   void add(T const *data, std::size_t n)
+   {
+      add(n);
+      if (n > 0) {
+         fMD5.Update(reinterpret_cast<const UChar_t *>(data), n * sizeof(T));
+      }
+   }
+
+   std::string digest()
+   {
+      fMD5.Final();
+      return fMD5.AsString();
+   }
+
+private:
+   TMD5 fMD5;
+};
+
+template <class Coll_t>
+std::vector<RooAbsArg *> sortedByName(Coll_t const &coll)
+{
+   std::vector<RooAbsArg *> out(coll.begin(), coll.end());
+   std::sort(out.begin(), out.end(),
+             [](RooAbsArg *a, RooAbsArg *b) { return std::string{a->GetName()} < std::string{b->GetName()}; });
+   return out;
+}
+
+void addValue(Hasher &hasher, RooAbsArg const &arg)
+{
+   if (auto cat = dynamic_cast<RooAbsCategory const *>(&arg)) {
+      hasher.add(cat->getCurrentIndex());
+   } else if (auto str = dynamic_cast<RooStringVar const *>(&arg)) {
+      hasher.add(str->getVal());
+   } else if (auto real = dynamic_cast<RooAbsReal const *>(&arg)) {
+      hasher.add(real->getVal());
+   }
+}
+
+std::string filePath(std::string const &cacheDir, std::string const &key)
+{
+   // spread the files over subdirectories to keep the directories small
+   return cacheDir + "/" + key.substr(0, 2) + "/" + key + ".root";
+}
+
+// Results that were already loaded or stored by this process
+std::map<std::string, std::shared_ptr<RooFitResult>> &loadedResults()
+{
+   static std::map<std::string, std::shared_ptr<RooFitResult>> results;
+   return results;
+}
+
+std::mutex &loadedResultsMutex()
+{
+   static std::mutex mutex;
+   return mutex;
+}
+
+} // namespace
+
+/// Hash of the content of a dataset: the values of all observables and the
+/// weights of all entries.
+std::string hashData(RooAbsData const &data)
+{
+   Hasher hasher;
+   hasher.add(data.ClassName());
+   hasher.add(std::size_t(data.numEntries()));
+
+   // sort the columns by name, because the spans are keyed by pointer
+   std::map<std::string, std::span<const double>> realColumns;
+   for (auto const &item : data.getBatches()) {
+      realColumns[item.first->GetName()] = item.second;
+   }
+   for (auto const &item : realColumns) {
+      hasher.add(item.first);
+      hasher.add(item.second.data(), item.second.size());
+   }
+   std::map<std::string, std::span<const RooAbsCategory::value_type>> catColumns;
+   for (auto const &item : data.getCategoryBatches()) {
+      catColumns[item.first->GetName()] = item.second;
+   }
+   for (auto const &item : catColumns) {
+      hasher.add(item.first);
+      hasher.add(item.second.data(), item.second.size());
+   }
+   auto weights = data.getWeightBatch(0, data.numEntries());
+   hasher.add(weights.data(), weights.size());
+
+   return hasher.digest();
+}
+
+/// Key of the fit of the given NLL, which is a hash of:
+///  - the model structure: the class, name and servers of every node in the
+///    computation graph, the values of all constant nodes that are neither
+///    parameters nor observables of the dataset, and the contents of histogram
+///    functions and pdfs. The values of the observables are left out, because
+///    they are just the values of whatever entry of the dataset was used last.
+///  - the hash of the dataset content, obtained with hashData().
+///  - the names and ranges of the floating parameters, and the values of the
+///    constant parameters (including the user parameters of the fit).
+///  - the minimizer configuration.
+std::string key(RooAbsReal const &nll, RooAbsCollection const &constPars, RooAbsCollection const &floatPars,
+                ROOT::Fit::FitConfig const &fitConfig, std::string const &dataHash,
+                RooAbsCollection const &observables)
+{
+   Hasher hasher;
+
+   RooArgSet nodes;
+   nll.treeNodeServerList(&nodes);
+   for (RooAbsArg *node : sortedByName(nodes)) {
+      hasher.add(node->ClassName());
+      hasher.add(node->GetName());
+      for (RooAbsArg *server : sortedByName(node->servers())) {
+         hasher.add(server->GetName());
+      }
+      if (node->isFundamental() && !constPars.find(*node) && !floatPars.find(*node) && !observables.find(*node)) {
+         addValue(hasher, *node);
+      }
+      RooDataHist const *hist = nullptr;
+      if (auto histFunc = dynamic_cast<RooHistFunc const *>(node)) {
+         hist = &histFunc->dataHist();
+      } else if (auto histPdf = dynamic_cast<RooHistPdf const *>(node)) {
+         hist = &histPdf->dataHist();
+      }
+      if (hist) {
+         hasher.add(hist->weightArray(), hist->numEntries());
+      }
+   }
+
+   hasher.add(dataHash);
+
+   for (RooAbsArg *par : sortedByName(floatPars)) {
+      hasher.add(par->GetName());
+      if (auto v = dynamic_cast<RooRealVar const *>(par)) {
+         hasher.add(v->getMin());
+         hasher.add(v->getMax());
+      }
+   }
+   for (RooAbsArg *par : sortedByName(constPars)) {
+      hasher.add(par->GetName());
+      addValue(hasher, *par);
+   }
+
+   auto const &opts = fitConfig.MinimizerOptions();
+   hasher.add(opts.MinimizerType());
+   hasher.add(opts.MinimizerAlgorithm());
+   hasher.add(opts.Strategy());
+   hasher.add(opts.Tolerance());
+   hasher.add(opts.Precision());
+   hasher.add(opts.ErrorDef());
+   hasher.add(int(opts.MaxFunctionCalls()));
+   hasher.add(int(opts.MaxIterations()));
+   hasher.add(int(fitConfig.ParabErrors()));
+   hasher.add(int(fitConfig.MinosErrors()));
+   // only the extra options that affect the result of the fit
+   if (auto extraOpts = opts.ExtraOptions()) {
+      for (const char *name : {"StrategySequence", "HesseStrategySequence"}) {
+         std::string value;
+         extraOpts->GetNamedValue(name, value);
+         hasher.add(value);
+      }
+      for (const char *name : {"HesseStrategy", "OptimizeConst"}) {
+         int value = 0;
+         extraOpts->GetIntValue(name, value);
+         hasher.add(value);
+      }
+      double boundaryCheck = 0;
+      extraOpts->GetRealValue("BoundaryCheck", boundaryCheck);
+      hasher.add(boundaryCheck);
+   }
+
+   return hasher.digest();
+}
+
+/// Returns the fit result that was stored with the given key, or a nullptr if
+/// there is none.
+std::shared_ptr<RooFitResult> load(std::string const &cacheDir, std::string const &key)
+{
+   std::lock_guard<std::mutex> lock{loadedResultsMutex()};
+   auto &results = loadedResults();
+   auto found = results.find(key);
+   if (found != results.end()) {
+      return found->second;
+   }
+
+   const std::string path = filePath(cacheDir, key);
+   if (gSystem->AccessPathName(path.c_str())) {
+      return nullptr; // no such file
+   }
+   TDirectory::TContext ctx{nullptr};
+   std::unique_ptr<TFile> file{TFile::Open(path.c_str(), "READ")};
+   if (!file || file->IsZombie()) {
+      return nullptr;
+   }
+   std::shared_ptr<RooFitResult> out{file->Get<RooFitResult>("fitResult")};
+   if (out) {
+      results[key] = out;
+   }
+   return out;
+}
+
+/// Stores the fit result with the given key. The file is first written under
+/// a unique temporary name and then renamed, so that other processes never
+/// see partially written files. If several processes store the same key, the
+/// last one wins, which is fine because the results are equivalent.
+void store(std::string const &cacheDir, std::string const &key, RooFitResult const &fitResult)
+{
+   const std::string path = filePath(cacheDir, key);
+   gSystem->mkdir((cacheDir + "/" + key.substr(0, 2)).c_str(), true);
+
+   const std::string tmpPath = path + "." + TUUID().AsString() + ".tmp";
+   {
+      TDirectory::TContext ctx{nullptr};
+      std::unique_ptr<TFile> file{TFile::Open(tmpPath.c_str(), "RECREATE")};
+      if (!file || file->IsZombie()) {
+         return;
+      }
+      file->WriteObject(&fitResult, "fitResult");
+   }
+   if (gSystem->Rename(tmpPath.c_str(), path.c_str()) != 0) {
+      gSystem->Unlink(tmpPath.c_str());
+      return;
+   }
+
+   std::lock_guard<std::mutex> lock{loadedResultsMutex()};
+   loadedResults()[key] = std::make_shared<RooFitResult>(fitResult);
+}
+
+} // namespace FitCache
+
+END_XROOFIT_NAMESPACE
@@ -0,0 +1,53 @@
+/*
+ * Project: xRooFit
+ *
+ * Copyright (c) 2024, CERN
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted according to the terms
+ * listed in LICENSE (http://roofit.sourceforge.net/license.txt)
+ */
+
+#ifndef xRooFit_FitCache_h
+#define xRooFit_FitCache_h
+
+#include "xRooFit/Config.h"
+
+#include <memory>
+#include <string>
+
+class RooAbsCollection;
+class RooAbsData;
+class RooAbsReal;
+class RooFitResult;
+
+namespace ROOT {
+namespace Fit {
+class FitConfig;
+}
+} // namespace ROOT
+
+BEGIN_XROOFIT_NAMESPACE
+
+/// Persistent cache of fit results in a directory, which can be shared by
+/// many processes. Each fit result is stored in its own file, whose name is a
+/// hash of everything that determines the result of the fit. The files are
+/// written under a temporary name and then atomically renamed, so processes
+/// can read and add to the same directory concurrently without locking.
+namespace FitCache {
+
+std::string hashData(RooAbsData const &data);
+
+std::string key(RooAbsReal const &nll, RooAbsCollection const &constPars, RooAbsCollection const &floatPars,
+                ROOT::Fit::FitConfig const &fitConfig, std::string const &dataHash,
+                RooAbsCollection const &observables);
+
+std::shared_ptr<RooFitResult> load(std::string const &cacheDir, std::string const &key);
+
+void store(std::string const &cacheDir, std::string const &key, RooFitResult const &fitResult);
+
+} // namespace FitCache
+
+END_XROOFIT_NAMESPACE
+
+#endif
@@ -47,6 +47,7 @@
 #include "Math/Minimizer.h"
 #include "RooMinimizer.h"
 #include "coutCapture.h"
+#include "FitCache.h"
 
 #include "TCanvas.h"
 #include "TGraphErrors.h"
@@ -72,6 +73,7 @@ BEGIN_XROOFIT_NAMESPACE
 
 std::shared_ptr<RooLinkedList> xRooFit::sDefaultNLLOptions = nullptr;
 std::shared_ptr<ROOT::Fit::FitConfig> xRooFit::sDefaultFitConfig = nullptr;
+std::string xRooFit::sFitCacheDir;
 
 const char *xRooFit::GetVersion()
 {
@@ -487,6 +489,16 @@ std::shared_ptr<RooLinkedList> xRooFit::defaultNLLOptions()
    return sDefaultNLLOptions;
 }
 
+void xRooFit::SetFitCacheDir(const char *path)
+{
+   sFitCacheDir = path ? path : "";
+}
+
+const char *xRooFit::GetFitCacheDir()
+{
+   return sFitCacheDir.c_str();
+}
+
 std::shared_ptr<ROOT::Fit::FitConfig> xRooFit::createFitConfig()
 {
    return std::make_shared<ROOT::Fit::FitConfig>(*defaultFitConfig());
@@ -874,6 +886,22 @@ std::shared_ptr<const RooFitResult> xRooFit::minimize(RooAbsReal &nll,
       }
    }
 
+   // look up the persistent fit cache, if the nll knows the hash of its dataset. Like the cache in gDirectory, it is
+   // not used when there is no current directory, which is how fits of toys opt out of the caching
+   std::string persistentCacheKey;
+   if (!sFitCacheDir.empty() && cacheDir && nll.getStringAttribute("fitCacheDataHash")) {
+      // the observables of the dataset, which are not part of the key
+      RooArgSet nodes;
+      nll.treeNodeServerList(&nodes);
+      auto obsNames = nll.getStringAttribute("fitCacheObservables");
+      std::unique_ptr<RooAbsCollection> observables{nodes.selectByName(obsNames ? obsNames : "")};
+      persistentCacheKey = FitCache::key(nll, *constPars, *floatPars, fitConfig,
+                                         nll.getStringAttribute("fitCacheDataHash"), *observables);
+      if (auto cachedFit = FitCache::load(sFitCacheDir, persistentCacheKey)) {
+         return cachedFit;
+      }
+   }
+
    if (nll.getAttribute("readOnly"))
       return nullptr;
 
@@ -1505,6 +1533,10 @@ std::shared_ptr<const RooFitResult> xRooFit::minimize(RooAbsReal &nll,
 #endif
    }
 
+   if (out && !persistentCacheKey.empty()) {
+      FitCache::store(sFitCacheDir, persistentCacheKey, *out);
+   }
+
    if (out && cacheDir && cacheDir->IsWritable()) {
       // std::cout << "Saving " << out->GetName() << " " << out->GetTitle() << " to " << nll.GetName() << std::endl;
       //  save a copy of fit result to relevant dir
@@ -53,8 +53,10 @@ This xRooNLLVar object has several special methods, e.g. for fitting and toy dat
 #include "TSystem.h"
 
 #include "coutCapture.h"
+#include "FitCache.h"
 
 #include <chrono>
+#include <optional>
 
 #include "Math/GenAlgoOptions.h"
 
@@ -99,6 +101,13 @@ This xRooNLLVar object has several special methods, e.g. for fitting and toy dat
 #include "TRegexp.h"
 #include "TStopwatch.h"
 
+#ifdef ROOFIT_MULTIPROCESS
+#include "RooFit/MultiProcess/Config.h"
+#include "RooFit/MultiProcess/IndexedTaskJob.h"
+
+#include <cstring>
+#endif
+
 BEGIN_XROOFIT_NAMESPACE
 
 std::set<int> xRooNLLVar::xRooHypoPoint::allowedStatusCodes = {0};
@@ -696,7 +705,15 @@ RooArgList xRooNLLVar::xRooFitResult::ranknp(const char *poi, bool up, bool pref
 xRooNLLVar::xRooFitResult xRooNLLVar::minimize(const std::shared_ptr<ROOT::Fit::FitConfig> &_config)
 {
    auto &nll = *get();
+   // the persistent fit cache needs to know the content and the observables of the dataset. It is not used without a
+   // current directory, like for the fits of toys, so the dataset doesn't need to be hashed then
+   if (strlen(xRooFit::GetFitCacheDir()) > 0 && gDirectory && fData) {
+      nll.setStringAttribute("fitCacheDataHash", FitCache::hashData(*fData).c_str());
+      nll.setStringAttribute("fitCacheObservables", fData->get()->contentsString().c_str());
+   }
    auto out = xRooFit::minimize(nll, (_config) ? _config : fitConfig(), fOpts);
+   nll.setStringAttribute("fitCacheDataHash", nullptr);
+   nll.setStringAttribute("fitCacheObservables", nullptr);
    // add any pars that are const here that aren't in constPars list because they may have been
    // const-optimized and their values cached with the dataset, so if subsequently floated the
    // nll wont evaluate correctly
@@ -2444,6 +2461,44 @@ size_t xRooNLLVar::xRooHypoPoint::addToys(bool alt, int nToys, int initialSeed,
    if (initialSeed) {
       RooRandom::randomGenerator()->SetSeed(initialSeed);
    }
+
+   bool useWorkers = false;
+#ifdef ROOFIT_MULTIPROCESS
+   // In the worker-pool mode, the toys are generated and fitted in batches on forked processes. The seed of each toy is
+   // drawn from a counter-based random stream that is defined by the toy index and hypothesis, so the workers can
+   // reproduce it from the task index alone (task = 2 * toy index + alt).
+   // The default number of workers is restored when the job is done, so it is declared before the job.
+   std::optional<RooFit::MultiProcess::Config::LocalDefaultNWorkers> localNWorkers;
+   std::unique_ptr<RooFit::MultiProcess::IndexedTaskJob> toyJob;
+   ULong64_t seedBase = 0;
+   // The toy indices continue after the toys that are already stored, so that repeated calls with the same seed (like
+   // the nested call above that determines the expected ts value) don't reproduce the same toys.
+   size_t nextToyIndex[2] = {nullToys.size(), altToys.size()}; // for null and alt toys
+   auto toySeed = [&](size_t iToy, bool isAlt) {
+      return int(RooRandom::stream(iToy, isAlt ? 1 : 0, seedBase)->Integer(std::numeric_limits<uint32_t>::max()));
+   };
+   if (fNWorkers > 1) {
+      seedBase = initialSeed ? ULong64_t(initialSeed)
+                             : RooRandom::randomGenerator()->Integer(std::numeric_limits<uint32_t>::max());
+      localNWorkers.emplace(fNWorkers);
+      // the workers send back the value of the test statistic of each toy
+      toyJob = std::make_unique<RooFit::MultiProcess::IndexedTaskJob>([&](size_t task, std::vector<char> &buffer) {
+         const bool isAlt = task % 2;
+         auto toy = isAlt ? generateAlt(toySeed(task / 2, true)) : generateNull(toySeed(task / 2, false));
+         TDirectory::TContext ctx{nullptr}; // disables any saving of fit results for toys
+         const double ts = toy.pll().first;
+         buffer.resize(sizeof(double));
+         std::memcpy(buffer.data(), &ts, sizeof(double));
+         return true;
+      });
+      useWorkers = true;
+   }
+#else
+   if (fNWorkers > 1) {
+      Warning("addToys", "RooFit was built without MultiProcess support, generating the toys sequentially");
+   }
+#endif
+
    do {
       auto &toys = (alt) ? altToys : nullToys;
       if (toys.size() >= maxToys) {
@@ -2459,45 +2514,87 @@ size_t xRooNLLVar::xRooHypoPoint::addToys(bool alt, int nToys, int initialSeed,
                                                      : (alt ? pAlt_toys(target_nSigma) : pNull_toys(target_nSigma)));
       size_t nnToys = std::min(size_t(nToys), (maxToys - toys.size()));
 
-      for (size_t i = 0; i < nnToys; i++) {
-         int seed = RooRandom::randomGenerator()->Integer(std::numeric_limits<uint32_t>::max());
-         auto toy = ((alt) ? generateAlt(seed) : generateNull(seed));
-         {
-            TDirectory::TContext ctx{nullptr}; // disables any saving of fit results for toys
-            toys.push_back(std::make_tuple(seed, toy.pll().first, 1.));
+      if (useWorkers) {
+#ifdef ROOFIT_MULTIPROCESS
+         size_t &firstToy = nextToyIndex[alt];
+         std::vector<size_t> tasks(nnToys);
+         for (size_t i = 0; i < nnToys; i++) {
+            tasks[i] = 2 * (firstToy + i) + alt;
+         }
+         toyJob->run(tasks);
+         std::vector<double> tsValues(nnToys, std::numeric_limits<double>::quiet_NaN());
+         for (size_t i = 0; i < nnToys; i++) {
+            auto const &buffer = toyJob->results()[tasks[i]].buffer;
+            if (buffer.size() == sizeof(double)) {
+               std::memcpy(&tsValues[i], buffer.data(), sizeof(double));
+            }
+         }
+         toyJob->results().clear();
+         // the workers don't report the time of the individual toys, so the average time of the batch is used
+         const double timePerToy = (s.RealTime() - lastTime) / nnToys; // stops the clock
+         for (size_t i = 0; i < nnToys; i++) {
+            toys.push_back(std::make_tuple(toySeed(firstToy + i, alt), tsValues[i], 1.));
+            if (std::isnan(tsValues[i]))
+               nans++;
+            g->SetPoint(g->GetN(), g->GetN(), timePerToy);
          }
-         (alt ? altToysAdded : toysAdded)++;
-         if (std::isnan(std::get<1>(toys.back())))
-            nans++;
-         g->SetPoint(g->GetN(), g->GetN(), s.RealTime() - lastTime); // stops the clock
          lastTime = s.RealTime();
-         if (s.RealTime() > 10) {
-            std::cout << "\r"
-                      << TString::Format("Generated %d/%d %s hypothesis toys [%.2f toys/s]",
-                                         int(alt ? altToysAdded : toysAdded), int(nnToys), alt ? "alt" : "null",
-                                         double(altToysAdded + toysAdded - lasti) / s.RealTime());
-            if (!std::isnan(target)) {
-               std::cout << " [current=" << currVal.first << "+/-" << currVal.second << " target=" << target
-                         << " nSigma=" << target_nSigma << "]";
+         s.Continue();
+         firstToy += nnToys;
+         (alt ? altToysAdded : toysAdded) += nnToys;
+         std::cout << "\r"
+                   << TString::Format("Generated %d %s hypothesis toys with %d workers [%.2f toys/s]",
+                                      int(alt ? altToysAdded : toysAdded), alt ? "alt" : "null", fNWorkers,
+                                      double(altToysAdded + toysAdded) / s2.RealTime());
+         if (!std::isnan(target)) {
+            std::cout << " [current=" << currVal.first << "+/-" << currVal.second << " target=" << target
+                      << " nSigma=" << target_nSigma << "]";
+         }
+         std::cout << "..." << std::flush;
+         s2.Continue();
+         lasti = altToysAdded + toysAdded;
+#endif
+      } else {
+         for (size_t i = 0; i < nnToys; i++) {
+            int seed = RooRandom::randomGenerator()->Integer(std::numeric_limits<uint32_t>::max());
+            auto toy = ((alt) ? generateAlt(seed) : generateNull(seed));
+            {
+               TDirectory::TContext ctx{nullptr}; // disables any saving of fit results for toys
+               toys.push_back(std::make_tuple(seed, toy.pll().first, 1.));
             }
-            std::cout << "..." << std::flush;
-            lasti = altToysAdded + toysAdded;
-            s.Reset();
-            if (!gROOT->IsBatch()) {
-               Draw();
-               if (gPad) {
-                  gPad->Update();
+            (alt ? altToysAdded : toysAdded)++;
+            if (std::isnan(std::get<1>(toys.back())))
+               nans++;
+            g->SetPoint(g->GetN(), g->GetN(), s.RealTime() - lastTime); // stops the clock
+            lastTime = s.RealTime();
+            if (s.RealTime() > 10) {
+               std::cout << "\r"
+                         << TString::Format("Generated %d/%d %s hypothesis toys [%.2f toys/s]",
+                                            int(alt ? altToysAdded : toysAdded), int(nnToys), alt ? "alt" : "null",
+                                            double(altToysAdded + toysAdded - lasti) / s.RealTime());
+               if (!std::isnan(target)) {
+                  std::cout << " [current=" << currVal.first << "+/-" << currVal.second << " target=" << target
+                            << " nSigma=" << target_nSigma << "]";
+               }
+               std::cout << "..." << std::flush;
+               lasti = altToysAdded + toysAdded;
+               s.Reset();
+               if (!gROOT->IsBatch()) {
+                  Draw();
+                  if (gPad) {
+                     gPad->Update();
 #if ROOT_VERSION_CODE >= ROOT_VERSION(6, 30, 00)
-                  gPad->GetCanvas()->ResetUpdated(); // stops previous canvas being replaced in a jupyter notebook
+                     gPad->GetCanvas()->ResetUpdated(); // stops previous canvas being replaced in a jupyter notebook
 #endif
-                  gSystem->ProcessEvents();
+                     gSystem->ProcessEvents();
+                  }
                }
+               s.Start();
+               // std::cout << "Generated " << i << "/" << nToys << (alt ? " alt " : " null ") << " hypothesis toys " ..."
+               // << std::endl;
             }
-            s.Start();
-            // std::cout << "Generated " << i << "/" << nToys << (alt ? " alt " : " null ") << " hypothesis toys " ..."
-            // << std::endl;
+            s.Continue();
          }
-         s.Continue();
       }
       // sort the toys ... put nans first - do by setting all as negative inf (is that still necessary with the custom
       // sort below??)
@@ -1,9 +1,57 @@
+import glob
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
 import unittest
 
 import ROOT
 
 ROOT.gROOT.SetBatch(True)
 
+def createWorkspace():
+    """
+    Creates a workspace (from histograms) containing pdf and dataset
+    for a single-channel, 3-bin model, with sig and bkg samples
+    """
+
+    # create some histograms to represent the samples, syst variations, and obsData
+    from array import array
+
+    bkg = ROOT.TH1D("bkg", "Background", 3, 0, 3)
+    bkg.SetContent(array("d", [0, 15, 14, 13, 0]))  # first and last are under/overflow
+    sig = ROOT.TH1D("sig", "Signal", 3, 0, 3)
+    sig.SetContent(array("d", [0, 4, 5, 6, 0]))
+    bkg_vary1 = bkg.Clone("alphaSyst=1")
+    bkg_vary1.SetContent(array("d", [0, 16, 13, 12, 0]))
+    obsData = ROOT.TH1D("obsData", "Data", 3, 0, 3)
+    obsData.SetContent(array("d", [0, 17, 15, 13, 0]))
+    bkg.SetFillColor(ROOT.kRed)  # can e.g. add style settings to histograms, they will propagate into the workspace
+
+    import ROOT.Experimental.XRooFit as XRF
+
+    # create workspace
+    w = XRF.xRooNode("RooWorkspace", name="combined", title="combined")
+    # create a pdf and add a "SR" channel to it
+    pdf = w["pdfs"].Add("simPdf")
+    sr = pdf.Add("SR")
+    # add our samples to the channel
+    sr_bkg = sr.Add(bkg)
+    sr_sig = sr.Add(sig)
+    # add the variation on the bkg sample
+    sr_bkg.Vary(bkg_vary1)
+    # constrain the nuisance parameter that was created
+    pdf.pars()["alphaSyst"].Constrain("normal")  # normal gaussian constraint
+    # create a signal strength POI and scale the sig term by it
+    w.poi().Add("mu[1]")
+    sr_sig.Multiply("mu")
+    # add the obsData to the channel
+    sr.datasets().Add(obsData)
+
+    return w, bkg, bkg_vary1, sig
+
+
 class XRooFitTests(unittest.TestCase):
 
     def test_oneChannelLimit(self):
@@ -13,38 +61,7 @@ class XRooFitTests(unittest.TestCase):
         and computing the CLs upper limit on the signal strength POI
         """
 
-        # create some histograms to represent the samples, syst variations, and obsData
-        from array import array
-
-        bkg = ROOT.TH1D("bkg", "Background", 3, 0, 3)
-        bkg.SetContent(array("d", [0, 15, 14, 13, 0]))  # first and last are under/overflow
-        sig = ROOT.TH1D("sig", "Signal", 3, 0, 3)
-        sig.SetContent(array("d", [0, 4, 5, 6, 0]))
-        bkg_vary1 = bkg.Clone("alphaSyst=1")
-        bkg_vary1.SetContent(array("d", [0, 16, 13, 12, 0]))
-        obsData = ROOT.TH1D("obsData", "Data", 3, 0, 3)
-        obsData.SetContent(array("d", [0, 17, 15, 13, 0]))
-        bkg.SetFillColor(ROOT.kRed)  # can e.g. add style settings to histograms, they will propagate into the workspace
-
-        import ROOT.Experimental.XRooFit as XRF
-
-        # create workspace
-        w = XRF.xRooNode("RooWorkspace", name="combined", title="combined")
-        # create a pdf and add a "SR" channel to it
-        pdf = w["pdfs"].Add("simPdf")
-        sr = pdf.Add("SR")
-        # add our samples to the channel
-        sr_bkg = sr.Add(bkg)
-        sr_sig = sr.Add(sig)
-        # add the variation on the bkg sample
-        sr_bkg.Vary(bkg_vary1)
-        # constrain the nuisance parameter that was created
-        pdf.pars()["alphaSyst"].Constrain("normal")  # normal gaussian constraint
-        # create a signal strength POI and scale the sig term by it
-        w.poi().Add("mu[1]")
-        sr_sig.Multiply("mu")
-        # add the obsData to the channel
-        sr.datasets().Add(obsData)
+        w, bkg, bkg_vary1, sig = createWorkspace()
 
         # example of accessing expected yields in bins with propagated errors
         w.poi()["mu"].setVal(0)
@@ -91,6 +108,102 @@ class XRooFitTests(unittest.TestCase):
             if hp.asimov():
                 printInfo(hp.asimov(), "  asimov")
 
+    @unittest.skipUnless("roofit_multiprocess" in ROOT.gROOT.GetConfigFeatures(), "requires RooFit MultiProcess")
+    def test_toysWorkerPool(self):
+        """
+        Tests generating and fitting toys on forked workers: the toys must not depend
+        on the number of workers, repeated calls with the same seed must not reproduce
+        the same toys, and the time per toy must be recorded
+        """
+
+        w, _, _, _ = createWorkspace()
+        nll = w.nll("obsData")
+
+        def toySeedsAndValues(toys):
+            return [(ROOT.std.get[0](t), ROOT.std.get[1](t)) for t in toys]
+
+        results = []
+        for nWorkers in [2, 3]:
+            hp = nll.hypoPoint("mu", 1.0, 0.0)
+            hp.setNWorkers(nWorkers)
+            hp.addNullToys(10, 42)
+            hp.addAltToys(10, 42)
+            self.assertEqual(ROOT.gROOT.Get("toyTime").GetN(), 10)
+            hp.addAltToys(10, 42)
+            results.append((toySeedsAndValues(hp.nullToys), toySeedsAndValues(hp.altToys)))
+
+        nullToys, altToys = results[0]
+        self.assertEqual(len(nullToys), 10)
+        self.assertEqual(len(altToys), 20)
+        self.assertEqual(len(set(seed for seed, _ in altToys)), 20)
+        self.assertEqual(results[1], results[0])
+
+    def test_persistentFitCache(self):
+        """
+        Tests the persistent fit cache: a repeated fit is loaded from the cache even if
+        the observables have other values, changing a constant parameter or the dataset
+        gives a new fit, several processes can write the same fit concurrently, and fits without
+        a current directory are not cached
+        """
+
+        import ROOT.Experimental.XRooFit as XRF
+
+        cacheDir = tempfile.mkdtemp(prefix="xroofit_fitcache_")
+        self.addCleanup(shutil.rmtree, cacheDir, True)
+        self.addCleanup(XRF.xRooFit.SetFitCacheDir, "")
+
+        def cachedFits():
+            return glob.glob(os.path.join(cacheDir, "*", "*.root"))
+
+        # several processes that run the same fit at the same time
+        script = (
+            "import sys; sys.path.insert(0, {testDir!r}); import xroofit_python as t; "
+            "import ROOT.Experimental.XRooFit as XRF; XRF.xRooFit.SetFitCacheDir({cacheDir!r}); "
+            "w = t.createWorkspace()[0]; w.nll('obsData').minimize()"
+        ).format(testDir=os.path.dirname(os.path.abspath(__file__)), cacheDir=cacheDir)
+        writers = [subprocess.Popen([sys.executable, "-B", "-c", script]) for _ in range(4)]
+        for writer in writers:
+            self.assertEqual(writer.wait(), 0)
+        self.assertEqual(len(cachedFits()), 1)
+        self.assertEqual(glob.glob(os.path.join(cacheDir, "*", "*.tmp")), [])
+
+        XRF.xRooFit.SetFitCacheDir(cacheDir)
+        w, _, _, _ = createWorkspace()
+        nll = w.nll("obsData")
+
+        # the fit from the other processes is loaded, also with other observable values
+        for obs in nll.get().getObservables(nll.getData().first):
+            if isinstance(obs, ROOT.RooRealVar):
+                obs.setVal(obs.getMin() + 0.3 * (obs.getMax() - obs.getMin()))
+        fit = nll.minimize()
+        self.assertEqual(len(cachedFits()), 1)
+        self.assertEqual(nll.minimize().floatParsFinal()["mu"].getVal(), fit.floatParsFinal()["mu"].getVal())
+        self.assertEqual(len(cachedFits()), 1)
+
+        # changing the value of a constant parameter
+        mu = nll.pars()["mu"]
+        mu.setConstant(True)
+        mu.setVal(0.5)
+        nll.minimize()
+        self.assertEqual(len(cachedFits()), 2)
+        mu.setVal(0.7)
+        nll.minimize()
+        self.assertEqual(len(cachedFits()), 3)
+
+        # changing the dataset
+        nll.setData(nll.generate(True))
+        nll.minimize()
+        self.assertEqual(len(cachedFits()), 4)
+        nll.minimize()
+        self.assertEqual(len(cachedFits()), 4)
+
+        # fits without a current directory, like the fits of toys, don't use the cache
+        ctx = ROOT.TDirectory.TContext(ROOT.nullptr)
+        mu.setVal(0.9)
+        nll.minimize()
+        del ctx
+        self.assertEqual(len(cachedFits()), 4)
+
 
 if __name__ == "__main__":
     unittest.main()